@@ -54,6 +54,12 @@ using namespace std;
 bool hasStarted;
 string packetbuf;
 
+// reused for every UPDATE, grown when there are more falcons or bodies than last time
+vector<_falconunity_falcon_params> falcon_params;
+vector<_falconunity_object_params> object_params;
+// newest physics step reported to the connected client
+unsigned int last_reported_step = 0;
+
 // stolen from: http://stackoverflow.com/questions/236129/splitting-a-string-in-c
 std::vector<std::string> &split(const std::string &s, char delim, std::vector<std::string> &elems) {
     std::stringstream ss(s);
@@ -206,8 +212,8 @@ bool handle_packet(string * packet, SOCKET & socket) {
 		//				S, spring_num, max_force, goalPos, goalOrient, posConstraintLower, posConstraintUpper, orientConstraintLower, orientConstraintUpper, time_in_secs
 		// there may be any number of these
 
-		vector<_falconunity_spring_params *> spring_params;
-		vector<_falconunity_haptic_tip_params *> haptic_params;
+		vector<_falconunity_spring_params> spring_params;
+		vector<_falconunity_haptic_tip_params> haptic_params;
 
 		unsigned int i = 1;
 
@@ -221,7 +227,8 @@ bool handle_packet(string * packet, SOCKET & socket) {
 					return false;
 				}
 
-				_falconunity_haptic_tip_params * params = new _falconunity_haptic_tip_params();
+				haptic_params.push_back(_falconunity_haptic_tip_params());
+				_falconunity_haptic_tip_params * params = &haptic_params.back();
 				sscanf_s(lines[i+1].c_str(), "%d", & params->falcon_num);
 
 				vector<string> elems = split(lines[i+2], '\t');
@@ -257,8 +264,6 @@ bool handle_packet(string * packet, SOCKET & socket) {
 				params->useCompensator = (c != 0);
 				sscanf_s(lines[i+6].c_str(), "%G", & params->time_in_secs);
 
-				haptic_params.push_back(params);
-
 				i += 7;
 
 			} else {
@@ -270,7 +275,8 @@ bool handle_packet(string * packet, SOCKET & socket) {
 				}
 
 			
-				_falconunity_spring_params * params = new _falconunity_spring_params();
+				spring_params.push_back(_falconunity_spring_params());
+				_falconunity_spring_params * params = &spring_params.back();
 
 				sscanf_s(lines[i+1].c_str(), "%d", & params->spring_num);
 				sscanf_s(lines[i+2].c_str(), "%G", & params->max_force);
@@ -346,46 +352,46 @@ bool handle_packet(string * packet, SOCKET & socket) {
 
 				sscanf_s(lines[i+11].c_str(), "%G", & params->time_in_secs);
 
-				spring_params.push_back(params);
-
 				i += 12;
 			}
 		}
 
 		// get read to recieve update data from falconunity
 		float fps;
-		vector <_falconunity_falcon_params *> falcon_params;
-		vector <_falconunity_object_params *> object_params;
-
-		returnval = falcon_update_all(haptic_params, spring_params, &fps, &falcon_params, &object_params);
-
-		for (unsigned int i = 0; i < spring_params.size(); i ++) {
-			delete spring_params[i];
-		}
-
-		for (unsigned int i = 0; i < haptic_params.size(); i ++) {
-			delete haptic_params[i];
+		int num_falcons = 0;
+		int num_objects = 0;
+
+		returnval = falcon_update_batch(haptic_params.empty() ? NULL : &haptic_params[0], haptic_params.size(), spring_params.empty() ? NULL : &spring_params[0], spring_params.size(),
+			falcon_params.empty() ? NULL : &falcon_params[0], falcon_params.size(), &num_falcons, object_params.empty() ? NULL : &object_params[0], object_params.size(), &num_objects,
+			&last_reported_step, &fps);
+
+		if (num_falcons > (int)falcon_params.size() || num_objects > (int)object_params.size()) {
+			// more than last time, grow and read again, the inputs have already been queued
+			falcon_params.resize(num_falcons);
+			object_params.resize(num_objects);
+			falcon_update_batch(NULL, 0, NULL, 0, falcon_params.empty() ? NULL : &falcon_params[0], falcon_params.size(), &num_falcons,
+				object_params.empty() ? NULL : &object_params[0], object_params.size(), &num_objects, &last_reported_step, &fps);
 		}
+		num_falcons = min(num_falcons, (int)falcon_params.size());
+		num_objects = min(num_objects, (int)object_params.size());
 
 		// now build the response packet and send it
 		stringstream out;
 		out << (returnval ? "TRUE" : "FALSE") << "\n";
 		out << fps << "\n";
-		out << falcon_params.size() << "\n";
-
-		for (unsigned int i = 0; i < falcon_params.size(); i ++) {
-			out << falcon_params[i]->tipPositions[0] << '\t' << falcon_params[i]->tipPositions[1] << '\t' << falcon_params[i]->tipPositions[2] << '\n';
-			out << falcon_params[i]->godPositions[0] << '\t' << falcon_params[i]->godPositions[1] << '\t' << falcon_params[i]->godPositions[2] << '\n';
-			out << falcon_params[i]->curforces[0] << '\t' << falcon_params[i]->curforces[1] << '\t' << falcon_params[i]->curforces[2] << '\n';
-			out << falcon_params[i]->buttons[0] << '\t' << falcon_params[i]->buttons[1] << '\t' << falcon_params[i]->buttons[2] << '\t' << falcon_params[i]->buttons[3] << '\n';
-			delete falcon_params[i];
+		out << num_falcons << "\n";
+
+		for (int i = 0; i < num_falcons; i ++) {
+			out << falcon_params[i].tipPositions[0] << '\t' << falcon_params[i].tipPositions[1] << '\t' << falcon_params[i].tipPositions[2] << '\n';
+			out << falcon_params[i].godPositions[0] << '\t' << falcon_params[i].godPositions[1] << '\t' << falcon_params[i].godPositions[2] << '\n';
+			out << falcon_params[i].curforces[0] << '\t' << falcon_params[i].curforces[1] << '\t' << falcon_params[i].curforces[2] << '\n';
+			out << falcon_params[i].buttons[0] << '\t' << falcon_params[i].buttons[1] << '\t' << falcon_params[i].buttons[2] << '\t' << falcon_params[i].buttons[3] << '\n';
 		}
 
-		out << object_params.size() << "\n";
-		for (unsigned int i = 0; i < object_params.size(); i ++) {
-			out << object_params[i]->object_num << '\t' << object_params[i]->pos[0] << '\t' << object_params[i]->pos[1] << '\t' << object_params[i]->pos[2] << '\t'
-				<< object_params[i]->orient[0] << '\t' << object_params[i]->orient[1] << '\t' << object_params[i]->orient[2] << '\t' << object_params[i]->orient[3] << '\t' << object_params[i]->orient[4] << '\n';
-			delete object_params[i];
+		out << num_objects << "\n";
+		for (int i = 0; i < num_objects; i ++) {
+			out << object_params[i].object_num << '\t' << object_params[i].pos[0] << '\t' << object_params[i].pos[1] << '\t' << object_params[i].pos[2] << '\t'
+				<< object_params[i].orient[0] << '\t' << object_params[i].orient[1] << '\t' << object_params[i].orient[2] << '\t' << object_params[i].orient[3] << '\n';
 		}
 
 		out << "\n";
@@ -1057,6 +1063,7 @@ int __cdecl main(void)
 		}
 
 		packetbuf.clear();
+		last_reported_step = 0;
 		printf("Connection from %s, port %d\n", inet_ntoa(client_info.sin_addr), htons(client_info.sin_port)) ;
 
 		// Receive until the peer shuts down the connection
@@ -1142,18 +1142,29 @@ public class FalconUnityCall{
 	[DllImport("falconunity")]
 	public static extern bool getCalibrated(int falcon_num);
 	
-	// not implemented, don't use
+	// start recording every servo tick of a falcon, up to about a minute
 	[DllImport("falconunity")]
 	public static extern bool startLog(int falcon_num);
 	
-	// not implemented, don't use
+	// stop recording and copy the log out, positions and forces are 3 floats per tick, delta_ts 1
+	// num_entries is the room in the arrays going in and the ticks copied coming out, false if any were lost
 	[DllImport("falconunity")]
-	public static extern bool stopLog(int falcon_num, int num_entries, float [] god_obj_positions, float [] haptic_tip_positions, float [] god_obj_forces, float [] haptic_tip_forces, float [] delta_ts);
+	public static extern bool stopLog(int falcon_num, ref int num_entries, float [] god_obj_positions, float [] haptic_tip_positions, float [] god_obj_forces, float [] haptic_tip_forces, float [] delta_ts);
 	
 	// place a concave shape in the physics world with the following parameters 
 	[DllImport("falconunity")]
 	public static extern bool sendDynamicShape(int body_num, float [] shape, int num_tris, float weight, float k, float [] startPos, float []startOrient, float [] linearFactors, float [] angularFactors, float friction );
 	
+	// collision shapes for sendDynamicShapeWithType, auto is a static mesh if weight is 0 and a convex hull otherwise
+	public const int SHAPE_AUTO = 0;
+	public const int SHAPE_GIMPACT = 1;
+	public const int SHAPE_CONVEX_HULL = 2;
+	public const int SHAPE_STATIC_MESH = 3;
+	
+	// same as sendDynamicShape, with the collision shape picked by the caller.  use SHAPE_GIMPACT for concave objects that move
+	[DllImport("falconunity")]
+	public static extern bool sendDynamicShapeWithType(int body_num, float [] shape, int num_tris, float weight, float k, float [] startPos, float []startOrient, float [] linearFactors, float [] angularFactors, float friction, int shape_type );
+	
 	// remove the given shape from the physics world
 	[DllImport("falconunity")]
 	public static extern bool removeDynamicShape(int body_num);
@@ -1191,6 +1202,57 @@ public class FalconUnityCall{
 	[DllImport("falconunity")]
 	public static extern bool lerpSpring(int spring_num, float max_force, float dampingFactor, float []goalPos, float []goalOrient, float [] posConstraintLower, float [] posConstraintUpper, float [] orientConstraintLower, float [] orientConstraintUpper, int [] directionality, float time_in_secs);
 	
+	
+	// same layouts as the _falconunity_*_params structs in falconunity.h, so arrays of them are passed without copying
+	[StructLayout(LayoutKind.Sequential)]
+	public struct HapticTipParams {
+		public int falcon_num;
+		public Vector3 pos;
+		public Quaternion orient;
+		public Vector3 scale;
+		public int useCompensator;
+		public float time_in_secs;
+	}
+	
+	[StructLayout(LayoutKind.Sequential)]
+	public struct SpringParams {
+		public int spring_num;
+		public float max_force;
+		public float dampingFactor;
+		public Vector3 goalPos;
+		public Quaternion goalOrient;
+		public Vector3 posConstraintLower;
+		public Vector3 posConstraintUpper;
+		public Vector3 orientConstraintLower;
+		public Vector3 orientConstraintUpper;
+		public int directionality0, directionality1, directionality2, directionality3, directionality4, directionality5;
+		public float time_in_secs;
+	}
+	
+	[StructLayout(LayoutKind.Sequential)]
+	public struct FalconParams {
+		public int falcon_num;
+		public Vector3 tipPosition;
+		public Vector3 godPosition;
+		public int button0, button1, button2, button3;
+		public Vector3 force;
+	}
+	
+	[StructLayout(LayoutKind.Sequential)]
+	public struct ObjectParams {
+		public int object_num;
+		public Vector3 pos;
+		public Quaternion orient;
+	}
+	
+	// once a frame: queue haptic transforms and spring lerps, and read every falcon, and every body that moved after
+	// last_step, from the same physics step.  keep last_step between calls, starting at 0; it is advanced once every
+	// changed body fit.  the arrays are the caller's and can be reused every frame; if num_falcon_params or
+	// num_object_params comes back bigger than the array, grow it and call again next frame
+	[DllImport("falconunity")]
+	public static extern bool falcon_update_batch(HapticTipParams [] haptic_params, int num_haptic_params, SpringParams [] spring_params, int num_spring_params,
+		[Out] FalconParams [] falcon_params, int max_falcon_params, out int num_falcon_params, [Out] ObjectParams [] object_params, int max_object_params, out int num_object_params,
+		ref uint last_step, out float fps);
 
 	
 	
@@ -28,12 +28,19 @@
 #include <cstdlib>
 #include <csignal>
 #include <map>
+#include <algorithm>
 #include <boost/array.hpp>
 #include <boost/thread.hpp> 
 #include <boost/timer/timer.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 #include <btBulletDynamicsCommon.h>
 #include "BulletCollision/Gimpact/btGImpactShape.h"
 #include "BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h"
+#include "BulletCollision/CollisionShapes/btShapeHull.h"
 #include "hr_time.h"
 
 #ifndef M_PI
@@ -59,24 +66,308 @@ using namespace libnifalcon;
 
 #define MAX_FALCON_FORCE 9
 
+// physics runs on its own thread, in fixed steps, decoupled from the 1khz servo loop
+#define PHYSICS_TIMESTEP (1.0f/1000.0f)
+#define PHYSICS_MAX_SUBSTEPS 10
+// servo loop period where we pace it ourselves, HDAL runs its own
+#define SERVO_PERIOD (1.0/1000.0)
+// longest the servo loop extrapolates a god object between physics steps, in seconds
+#define MAX_PROXY_EXTRAPOLATION 0.01f
+
+// haptic log, in servo ticks per falcon (about a minute at 1khz, 52 bytes each)
+#define LOG_CAPACITY 65536
+#define LOG_COPY_CHUNK 256
+
 using namespace std;
 //for errors
 char last_error[1024]="none";
+boost::mutex last_error_mutex;	// set_error is called from the physics thread as well as the API threads
+
+// Registries for things Unity refers to by id (bodies, springs).  IdTable finds the slot for an id,
+// SlotIndex hands out generational handles to slots and keeps the live entries dense, so owners can
+// store their data in plain arrays and walk them straight through.  A handle whose entry has since been
+// removed (even if the id was reused) no longer resolves.  Storage only grows; removing and re-adding
+// entries doesn't allocate once the high water mark has been reached.
+
+// open addressing hash from id to slot, linear probing
+class IdTable {
+private:
+	struct Entry {
+		int id;
+		unsigned int slot;
+		bool used;
+	};
+
+	vector<Entry> entries;	// power of two
+	unsigned int count;
+
+	unsigned int bucket(int id) const {
+		return ((unsigned int)id * 2654435761u) & (entries.size() - 1);
+	}
+
+	void grow() {
+		vector<Entry> old;
+		old.swap(entries);
+		entries.resize(old.empty() ? 64 : old.size() * 2);
+		for (unsigned int i = 0; i < entries.size(); i ++) {
+			entries[i].used = false;
+		}
+		count = 0;
+		for (unsigned int i = 0; i < old.size(); i ++) {
+			if (old[i].used)
+				insert(old[i].id, old[i].slot);
+		}
+	}
+
+public:
+	IdTable() : count(0) { }
+
+	bool find(int id, unsigned int & slot) const {
+		if (entries.empty())
+			return false;
+		for (unsigned int i = bucket(id); entries[i].used; i = (i + 1) & (entries.size() - 1)) {
+			if (entries[i].id == id) {
+				slot = entries[i].slot;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// id must not be in the table
+	void insert(int id, unsigned int slot) {
+		if ((count + 1) * 2 > entries.size())
+			grow();
+		unsigned int i = bucket(id);
+		while (entries[i].used) {
+			i = (i + 1) & (entries.size() - 1);
+		}
+		entries[i].id = id;
+		entries[i].slot = slot;
+		entries[i].used = true;
+		count ++;
+	}
+
+	void erase(int id) {
+		if (entries.empty())
+			return;
+		unsigned int mask = entries.size() - 1;
+		unsigned int i = bucket(id);
+		while (entries[i].used && entries[i].id != id) {
+			i = (i + 1) & mask;
+		}
+		if (!entries[i].used)
+			return;
+
+		// shift the rest of the run back, so lookups never need tombstones
+		unsigned int j = i;
+		while (true) {
+			j = (j + 1) & mask;
+			if (!entries[j].used)
+				break;
+			unsigned int home = bucket(entries[j].id);
+			// move j into the hole at i unless its home lies cyclically in (i, j]
+			if (i <= j ? (home <= i || home > j) : (home <= i && home > j)) {
+				entries[i] = entries[j];
+				i = j;
+			}
+		}
+		entries[i].used = false;
+		count --;
+	}
+
+	void clear() {
+		for (unsigned int i = 0; i < entries.size(); i ++) {
+			entries[i].used = false;
+		}
+		count = 0;
+	}
+};
+
+struct SlotHandle {
+	unsigned int slot;
+	unsigned int generation;	// 0 never refers to anything
+};
+
+class SlotIndex {
+private:
+	struct Slot {
+		unsigned int dense;			// entry, or next free slot
+		unsigned int generation;	// bumped every time the slot is freed
+	};
+
+	vector<Slot> slots;
+	vector<unsigned int> denseSlots;	// slot of each entry
+	vector<int> denseIds;				// id of each entry
+	unsigned int freeSlots;				// head of the free list
+	IdTable ids;
+
+public:
+	SlotIndex() : freeSlots(NO_SLOT) { }
+
+	static const unsigned int NO_SLOT = 0xffffffff;
+
+	unsigned int size() const {
+		return denseIds.size();
+	}
+
+	int idAt(unsigned int dense) const {
+		return denseIds[dense];
+	}
+
+	SlotHandle handleAt(unsigned int dense) const {
+		SlotHandle h;
+		h.slot = denseSlots[dense];
+		h.generation = slots[h.slot].generation;
+		return h;
+	}
+
+	// handle of an id, with generation 0 if there's no such entry
+	SlotHandle find(int id) const {
+		SlotHandle h;
+		h.slot = 0;
+		h.generation = 0;
+		if (ids.find(id, h.slot))
+			h.generation = slots[h.slot].generation;
+		return h;
+	}
+
+	// entry a handle refers to, or -1 if it's stale
+	int dense(SlotHandle h) const {
+		if (h.generation == 0 || h.slot >= slots.size() || slots[h.slot].generation != h.generation)
+			return -1;
+		return slots[h.slot].dense;
+	}
+
+	// adds an entry at the end, id must not be in use; the owner appends its data at size() - 1
+	SlotHandle insert(int id) {
+		unsigned int s = freeSlots;
+		if (s == NO_SLOT) {
+			s = slots.size();
+			Slot slot;
+			slot.generation = 1;
+			slots.push_back(slot);
+		} else {
+			freeSlots = slots[s].dense;
+		}
+
+		slots[s].dense = denseIds.size();
+		denseSlots.push_back(s);
+		denseIds.push_back(id);
+		ids.insert(id, s);
+
+		SlotHandle h;
+		h.slot = s;
+		h.generation = slots[s].generation;
+		return h;
+	}
+
+	// removes an entry; the last entry moves into its place, so the owner must move its data the same way
+	// (data[dense] = data[size()], then drop the last)
+	void remove(unsigned int dense) {
+		unsigned int s = denseSlots[dense];
+		unsigned int last = denseIds.size() - 1;
+
+		ids.erase(denseIds[dense]);
+		if (dense != last) {
+			denseSlots[dense] = denseSlots[last];
+			denseIds[dense] = denseIds[last];
+			slots[denseSlots[dense]].dense = dense;
+		}
+		denseSlots.pop_back();
+		denseIds.pop_back();
+
+		slots[s].generation ++;
+		if (slots[s].generation == 0)
+			slots[s].generation = 1;
+		slots[s].dense = freeSlots;
+		freeSlots = s;
+	}
+
+	void clear() {
+		while (size() > 0) {
+			remove(size() - 1);
+		}
+	}
+};
+
+// a SlotIndex with one value per entry
+template <class T> class SlotMap {
+private:
+	SlotIndex index;
+	vector<T> values;
+
+public:
+	unsigned int size() const {
+		return values.size();
+	}
+
+	T & at(unsigned int dense) {
+		return values[dense];
+	}
+
+	int idAt(unsigned int dense) const {
+		return index.idAt(dense);
+	}
+
+	SlotHandle handle(int id) const {
+		return index.find(id);
+	}
+
+	// value of a handle, or NULL if it's stale
+	T * get(SlotHandle h) {
+		int d = index.dense(h);
+		return d < 0 ? NULL : &values[d];
+	}
+
+	T * find(int id) {
+		return get(index.find(id));
+	}
+
+	// id must not be in use
+	SlotHandle insert(int id, const T & value) {
+		SlotHandle h = index.insert(id);
+		values.push_back(value);
+		return h;
+	}
+
+	bool remove(int id) {
+		int d = index.dense(index.find(id));
+		if (d < 0)
+			return false;
+		index.remove(d);
+		values[d] = values.back();
+		values.pop_back();
+		return true;
+	}
+
+	void clear() {
+		index.clear();
+		values.clear();
+	}
+};
 
 
 //but there should only be one world
 btDefaultCollisionConfiguration* collisionConfiguration;
 btCollisionDispatcher* dispatcher;
 btBroadphaseInterface*	broadphase;
-vector<btRigidBody*> rigidBodies;
 btSequentialImpulseConstraintSolver* solver;
-map<int, btRigidBody *> sentRigidBodies;
+SlotMap<btRigidBody *> sentRigidBodies;	// body_num -> body, god object spheres belong to their falcons
 btDiscreteDynamicsWorld* dynamicsWorld;
 boost::recursive_mutex collision_mutex ;
 
 #define TOTAL_FRAMES 5
 float frame_times[TOTAL_FRAMES];
 int next_frame;
+boost::mutex frame_times_mutex;	// frame_times is written by the servo thread and read by the physics thread
+
+// record one servo tick, called by the servo thread
+void recordFrameTime(float elapsedTime) {
+	boost::mutex::scoped_lock lock(frame_times_mutex);
+	frame_times[next_frame] = elapsedTime;
+	next_frame = (next_frame + 1) % TOTAL_FRAMES;
+}
 
 class MyKinematicMotionState : public btMotionState {
 public:
@@ -90,56 +381,149 @@ protected:
     btTransform mPos1;
 };
 
+// Motion state of a sent body.  Bullet only calls setWorldTransform for bodies it has moved in a step, never for
+// sleeping or static ones, so the bodies in dirtyBodies are exactly the ones whose poses need publishing.
+class TrackedMotionState;
+vector<TrackedMotionState *> dirtyBodies;	// physics thread only
+
+class TrackedMotionState : public btDefaultMotionState {
+public:
+	int body_num;
+	bool dirty;
+
+	TrackedMotionState(int body_num, const btTransform & startTrans) : btDefaultMotionState(startTrans), body_num(body_num), dirty(false) { }
+
+	virtual void setWorldTransform(const btTransform & worldTrans) {
+		btDefaultMotionState::setWorldTransform(worldTrans);
+		markDirty();
+	}
+
+	void markDirty() {
+		if (!dirty) {
+			dirty = true;
+			dirtyBodies.push_back(this);
+		}
+	}
+
+	void clearDirty() {
+		if (dirty) {
+			dirty = false;
+			dirtyBodies.erase(std::find(dirtyBodies.begin(), dirtyBodies.end(), this));
+		}
+	}
+};
+
 
 #ifndef _WIN32 
 vector<FalconDevice *>falcons;
 boost::shared_ptr<FalconFirmware> ff;
+
+struct FalconInfo {
+	bool homing;	// no forces until the user has homed the falcon
+};
+vector<FalconInfo> falconInfo;
+
+// libnifalcon stand-ins for the HDAL calls FalconInterface makes.  Servo loop only, after runIOLoop.
+typedef FalconDevice * HDLDeviceHandle;
+FalconDevice * currentFalcon;
+
+void hdlMakeCurrent(HDLDeviceHandle falcon) {
+	currentFalcon = falcon;
+}
+
+void hdlToolPosition(double pos[3]) {
+	boost::array<double,3> p = currentFalcon->getPosition();
+	for (int i = 0; i < 3; i ++) {
+		pos[i] = p[i];
+	}
+}
+
+void hdlSetToolForce(double force[3]) {
+	boost::array<double,3> f;
+	for (int i = 0; i < 3; i ++) {
+		f[i] = force[i];
+	}
+	currentFalcon->setForce(f);
+}
+
+void hdlToolButtons(int * buttons) {
+	*buttons = currentFalcon->getFalconGrip()->getDigitalInputs();
+}
 #else
 HDLOpHandle servo_op;
 #endif
 
 
+// State of a god object as of the last physics step.  The servo loop renders against this instead of the
+// bullet world, so it never waits on a step, however long the step takes.
+struct GodObjectProxy {
+	bool valid;				// false until a god object is set and stepped
+	unsigned int step;		// physics step this was published by
+	btVector3 position;
+	btVector3 linearVelocity;
+	btScalar invMass;
+	bool inContact;			// touched something during the step
+	btVector3 contactNormal;	// out of the touched surface, towards the god object
+	float restitution;		// 1 - restitution of the touched object
+};
+
+// One servo tick of the haptic log, in haptics world coordinates except tipForce, which is what was sent
+struct LogRecord {
+	float godObjPosition[3];
+	float tipPosition[3];
+	float godObjForce[3];		// coupling spring pulling the god object towards the tip
+	float tipForce[3];
+	float deltaT;
+};
+
+typedef boost::lockfree::spsc_queue<LogRecord> LogRing;
+
+// One per device.  Everything is held by value, so a servo tick works on one allocation.  The servo loop and
+// the physics thread share it under mutex, which is never held across calls into other locking methods.
 class FalconInterface {
 
 private:
-	boost::recursive_mutex * mutex ;
+	boost::mutex mutex ;
 
 	HDLDeviceHandle falconHandle;
 	btRigidBody * godObject;
 	bool godObjectIsSphere;
 
-	btVector3 * scale;
-	btTransform * transform;
+	btVector3 scale;
+	btTransform transform;
 	float maxForce;
 	float minDistToMaxForceInMeters;
 	float maxDistToMaxForceInMeters;
-	btVector3 * constantForce;
+	btVector3 constantForce;
 	
-	bool collideFlag;
+	bool collideFlag;		// contact reported by the step in progress
+	bool contactLastStep;	// contact reported by the previous step, latched before the next one
 	float collideObjRestitution;
+	float contactRestitution;
+	btVector3 collideNormal;
 
-	btVector3 * curTipPosition;
+	btVector3 curTipPosition;
 
 	int buttonMask;
 
 
-	btVector3 * applyForceVector;
+	btVector3 applyForceVector;
 	float applyForceTimeLeft;
 	
 	bool compensatorActivated;
 
 
-	btVector3 * savedForces[TOTAL_FRAMES];
+	btVector3 savedForces[TOTAL_FRAMES];
 	int curForceNum;
 
 	// for lerping
 
-	btVector3 * posLerpStart;
-	btVector3 * posLerpEnd;
-	btVector3 * scaleLerpStart;
-	btVector3 * scaleLerpEnd;
-	btQuaternion * rotationLerpStart;
-	btQuaternion * rotationLerpEnd;
+	btVector3 posLerpStart;
+	btVector3 posLerpEnd;
+	btVector3 scaleLerpStart;
+	btVector3 scaleLerpEnd;
+	btQuaternion rotationLerpStart;
+	btQuaternion rotationLerpEnd;
 
 	float lerpTotalTime;
 	float lerpElapsedTime;
@@ -147,47 +531,104 @@ private:
 	btScalar collideObjMass;
 	btScalar collideObjImpulse;
 
+	// virtual coupling between the servo loop and the physics thread
+
+	GodObjectProxy proxy;		// written by the physics thread, read by the servo loop
+	unsigned int proxyStepSeen;
+	float proxyAge;				// time since the servo loop first saw the current proxy
+	float couplingStiffness;	// k of the coupling spring, set by the servo loop
+	btTransform physicsTransform;	// haptic transform the god object was last compensated for
+
+	// haptic log.  The servo loop pushes a record per tick without taking anything but its own mutex; the
+	// API thread starts, stops and drains it.  The ring is allocated by the first startLogging and kept.
+
+	LogRing * logRing;
+	boost::atomic<bool> logging;
+	boost::atomic<unsigned int> logDropped;	// ticks lost to a full ring
+
+	void logTick(const btVector3 & godObjPos, const btVector3 & tipPos, const btVector3 & godObjForce, const btVector3 & tipForce, float deltaT) {
+		LogRecord r;
+		for (int i = 0; i < 3; i ++) {
+			r.godObjPosition[i] = godObjPos[i];
+			r.tipPosition[i] = tipPos[i];
+			r.godObjForce[i] = godObjForce[i];
+			r.tipForce[i] = tipForce[i];
+		}
+		r.deltaT = deltaT;
+		if (! logRing->push(r))
+			logDropped.fetch_add(1, boost::memory_order_relaxed);
+	}
+
+	void setTransformLocked(const btTransform & trans, const btVector3 & scale) {
+		transform = trans;
+		this->scale = scale;
+	}
+
+	void clearLerpParamsLocked() {
+		lerpTotalTime = 0;
+		lerpElapsedTime = 0;
+	}
+
 public:
+	BT_DECLARE_ALIGNED_ALLOCATOR();
+
 	FalconInterface(HDLDeviceHandle falcon, float maxForceInNewtons) {
 		falconHandle = falcon;
 
 		godObject = 0;
 		godObjectIsSphere = false;
-		scale = new btVector3(1,1,1);
-		transform = new btTransform(btQuaternion(0,0,0,1), btVector3(0,0,0));
-		curTipPosition = new btVector3(0,0,0);
-		constantForce = new btVector3(0,0,0);
+		scale.setValue(1,1,1);
+		transform = btTransform(btQuaternion(0,0,0,1), btVector3(0,0,0));
+		curTipPosition.setValue(0,0,0);
+		constantForce.setValue(0,0,0);
 
 		maxForce = maxForceInNewtons;
-		mutex = new boost::recursive_mutex();
 		collideFlag = false;
+		contactLastStep = false;
+		collideObjRestitution = 1;
+		contactRestitution = 1;
+		collideNormal.setValue(0,0,0);
 
-		applyForceVector = NULL;
+		applyForceVector.setValue(0,0,0);
 		applyForceTimeLeft = 0;
 
-		posLerpStart = NULL;
-		posLerpEnd = NULL;
-		rotationLerpStart = NULL;
-		rotationLerpEnd = NULL;
-		scaleLerpStart = NULL;
-		scaleLerpEnd = NULL;
-
 		lerpTotalTime = 0;
 		lerpElapsedTime = 0;
 
 		compensatorActivated = false;
 		curForceNum = 0;
 		for (int i = 0; i < TOTAL_FRAMES; i ++) {
-			savedForces[i] = new btVector3(0,0,0);
+			savedForces[i].setValue(0,0,0);
 		}
 
 		collideObjMass = 1;
 		collideObjImpulse = 0;
 
+		proxy.valid = false;
+		proxy.step = 0;
+		proxy.position.setValue(0,0,0);
+		proxy.linearVelocity.setValue(0,0,0);
+		proxy.invMass = 0;
+		proxy.inContact = false;
+		proxy.contactNormal.setValue(0,0,0);
+		proxy.restitution = 1;
+		proxyStepSeen = 0;
+		proxyAge = 0;
+		couplingStiffness = 0;
+		physicsTransform = transform;
+
+		logRing = 0;
+		logging = false;
+		logDropped = 0;
+	}
+
+	// the servo loop must have stopped
+	~FalconInterface() {
+		delete logRing;
 	}
 
 	void setGodObject (btRigidBody * godObject, float minToMaxForce, float maxToMaxForce, bool isSphere) {
-	    boost::recursive_mutex::scoped_lock lock2( *mutex ) ;
+	    boost::mutex::scoped_lock lock2( mutex ) ;
 
 		this->godObject = godObject;
 
@@ -198,30 +639,33 @@ public:
 		maxDistToMaxForceInMeters = maxToMaxForce;
 
 		godObjectIsSphere = isSphere;
+
+		// the servo loop keeps rendering the old god object until the next step publishes this one
+		physicsTransform = transform;
+		if (godObject == 0) {
+			proxy.valid = false;
+		}
 	}
 
 	bool isGodObjectSphere() {
 		return godObjectIsSphere;
 	}
 
-	~FalconInterface() {
-		clearLerpParams();
-		for (int i = 0; i < TOTAL_FRAMES; i ++) {
-			delete savedForces[i];
-		}
-		if (applyForceVector != NULL)
-			delete applyForceVector;
-		delete scale;
-		delete transform;
-		delete constantForce;
-		delete curTipPosition;
-		delete mutex;
-		
+	// god object position extrapolated over the time since the step that published it.  While in contact,
+	// motion into the touched surface is dropped so a slow step can't let the tip sink into it.
+	btVector3 getProxyPosition() {
+		btVector3 v = proxy.linearVelocity;
+		if (proxy.inContact) {
+			btScalar into = v.dot(proxy.contactNormal);
+			if (into < 0)
+				v -= proxy.contactNormal * into;
+		}
+		return proxy.position + v * min(proxyAge, MAX_PROXY_EXTRAPOLATION);
 	}
 
-	void update(float deltaT) {
-	    boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-		boost::recursive_mutex::scoped_lock lock2( *mutex ) ;
+	// servo loop side: read the falcon, render the coupling spring against the proxy, send the force
+	void updateHaptics(float deltaT) {
+		boost::mutex::scoped_lock lock2( mutex ) ;
 
 		// get lastest haptic tip position
 		hdlMakeCurrent(falconHandle);
@@ -239,32 +683,33 @@ public:
 			float t = lerpElapsedTime / lerpTotalTime;
 			t = min(t, 1.0f);
 
-			btTransform newTf(rotationLerpStart->slerp(*rotationLerpEnd, t), posLerpStart->lerp(*posLerpEnd, t));
-
-			if (! collideFlag && godObject != 0 && compensatorActivated) {
-				// apply compensator to the god object to prevent the haptic tip from feeling the forces of moving the transform
-
-				godObject->setWorldTransform(btTransform(godObject->getWorldTransform().getRotation(), newTf * transform->invXform(godObject->getWorldTransform().getOrigin())));
-
-			}
-			setTransform(newTf, scaleLerpStart->lerp(*scaleLerpEnd, t));
+			// the physics thread moves the god object along with the transform if the compensator is on
+			setTransformLocked(btTransform(rotationLerpStart.slerp(rotationLerpEnd, t), posLerpStart.lerp(posLerpEnd, t)), scaleLerpStart.lerp(scaleLerpEnd, t));
 
 		}
 
-		newPos[0] *= (*scale)[0];
-		newPos[1] *= (*scale)[1];
-		newPos[2] *= (*scale)[2];
+		newPos[0] *= scale[0];
+		newPos[1] *= scale[1];
+		newPos[2] *= scale[2];
 		
-		newPos = ((*transform) * newPos);
+		newPos = (transform * newPos);
 
 		btVector3 hapticForce(0, 0, 0);
+		btVector3 godObjPos(0, 0, 0);
+		btVector3 godObjForce(0, 0, 0);
 
-		// have we set the godObject? If not, skip over the spring calcs
-		if (godObject != 0) {
-		
+		// has the physics thread published a god object? If not, skip over the spring calcs
+		if (proxy.valid) {
+
+			if (proxy.step != proxyStepSeen) {
+				proxyStepSeen = proxy.step;
+				proxyAge = 0;
+			} else {
+				proxyAge += deltaT;
+			}
 			
 			// get god object position, convert to haptics world coordinates
-			btVector3 godObjPos = godObject->getWorldTransform().getOrigin();
+			godObjPos = getProxyPosition();
 
 			// calc distance between haptic tip and god object
 			btVector3 distance = godObjPos - newPos;
@@ -272,7 +717,9 @@ public:
 			// if collided, use restitution from collision object
 			// if not colided, decay restitution
 			// calc spring constant: k
-			if (! collideFlag) {
+			if (proxy.inContact) {
+				collideObjRestitution = proxy.restitution;
+			} else {
 				collideObjRestitution += .1f * (1 - collideObjRestitution);
 			}
 		
@@ -282,63 +729,39 @@ public:
 				distToMaxForce = minDistToMaxForceInMeters * .00001;
 
 			float k = maxForce / distToMaxForce;
+			couplingStiffness = k;
 		
 			// calculate spring forces
 			btVector3 springForce = -k * distance;
+			godObjForce = springForce;
 
-			// use mass and k to calc damping force: c
-			float c;
-			
-			if (godObject->getInvMass() == 0) { 
+			if (proxy.invMass == 0) { 
 				// Godobject is static, use movement of haptic tip to calc damping forces
 
-				c = 2 * sqrt( k * .003f );
-				btVector3 x_prime = ((*curTipPosition) - newPos) / deltaT;
+				float c = 2 * sqrt( k * .003f );
+				btVector3 x_prime = (curTipPosition - newPos) / deltaT;
 
 				springForce += -c * x_prime; // add damping force based on velocity of haptic tip to the spring forces
 
-			} else {
-				
-				c= 2 * sqrt( k / godObject->getInvMass() );
-
-				btVector3 dampingForce = -c * godObject->getLinearVelocity();;
-
-
-				// calc total force and apply to god object
-				btVector3 totalForce = springForce + dampingForce;
-				if (applyForceTimeLeft > 0) {
-					totalForce += *applyForceVector;
-					applyForceTimeLeft -= deltaT;
-				}
-				
-				if (collideObjMass == 0 && collideFlag) {
-					totalForce = distance.normalized() * collideObjImpulse /1000.0f;
-				}
-
-
-				// apply to God Object
-				godObject->activate();
-				godObject->applyCentralForce(totalForce);
-
-
 			}
+			// a dynamic god object gets the same spring, plus damping, from the physics thread
 
 
 			// send spring force to haptic device
 
-			if (scale->getX() < 0)
+			if (scale.getX() < 0)
 				springForce[0] *= -1;
-			if (scale->getY() < 0)
+			if (scale.getY() < 0)
 				springForce[1] *= -1;
-			if (scale->getZ() < 0)
+			if (scale.getZ() < 0)
 				springForce[2] *= -1;
 
 
-			hapticForce += btTransform(transform->getRotation(), btVector3(0,0,0)) * springForce;
+			hapticForce += btTransform(transform.getRotation(), btVector3(0,0,0)) * springForce;
 		}
 
 
-		hapticForce += *constantForce;
+		hapticForce += constantForce;
 		hapticForce *= -1;
 
 		boost::array<double,3> to_send;
@@ -348,31 +771,102 @@ public:
 
 		hdlSetToolForce(to_send.c_array());
 
-		// clear colision flag
-		collideFlag = false;
-
 		// download button states
 		hdlToolButtons(&buttonMask);
 
-		curTipPosition->setValue(newPos[0], newPos[1], newPos[2]);
+		curTipPosition = newPos;
 
 		curForceNum ++;
 		curForceNum = curForceNum % TOTAL_FRAMES;
-		savedForces[curForceNum]->setValue(hapticForce[0], hapticForce[1], hapticForce[2]);
+		savedForces[curForceNum] = hapticForce;
+
+		if (logging.load(boost::memory_order_acquire))
+			logTick(godObjPos, newPos, godObjForce, hapticForce, deltaT);
+	}
+
+	// physics thread side, called with collision_mutex held before each step: pull the god object
+	// towards the latest tip position with the coupling spring
+	void updatePhysics(float deltaT) {
+		boost::mutex::scoped_lock lock2( mutex ) ;
+
+		// the tick callback only sets collideFlag during a step, so latch what the last step saw and
+		// start the coming one clear
+		contactLastStep = collideFlag;
+		collideFlag = false;
+
+		if (godObject == 0)
+			return;
+
+		if (! contactLastStep && compensatorActivated) {
+			// apply compensator to the god object to prevent the haptic tip from feeling the forces of moving the transform
+
+			godObject->setWorldTransform(btTransform(godObject->getWorldTransform().getRotation(), transform * physicsTransform.invXform(godObject->getWorldTransform().getOrigin())));
+
+		}
+		physicsTransform = transform;
+
+		if (godObject->getInvMass() == 0 || couplingStiffness == 0)
+			return;
+
+		btVector3 distance = godObject->getWorldTransform().getOrigin() - curTipPosition;
+
+		float k = couplingStiffness;
+		btVector3 springForce = -k * distance;
+
+		// use mass and k to calc damping force: c
+		float c= 2 * sqrt( k / godObject->getInvMass() );
+
+		btVector3 dampingForce = -c * godObject->getLinearVelocity();;
+
+
+		// calc total force and apply to god object
+		btVector3 totalForce = springForce + dampingForce;
+		if (applyForceTimeLeft > 0) {
+			totalForce += applyForceVector;
+			applyForceTimeLeft -= deltaT;
+		}
+		
+		if (collideObjMass == 0 && contactLastStep) {
+			totalForce = distance.normalized() * collideObjImpulse /1000.0f;
+		}
+
+
+		// apply to God Object
+		godObject->activate();
+		godObject->applyCentralForce(totalForce);
+	}
 
+	// physics thread side, called with collision_mutex held after each step
+	void publishGodObject(unsigned int step) {
+		boost::mutex::scoped_lock lock2( mutex ) ;
+
+		if (godObject == 0) {
+			proxy.valid = false;
+			return;
+		}
+
+		proxy.position = godObject->getWorldTransform().getOrigin();
+		proxy.linearVelocity = godObject->getLinearVelocity();
+		proxy.invMass = godObject->getInvMass();
+		proxy.inContact = collideFlag;
+		proxy.contactNormal = collideNormal;
+		proxy.restitution = contactRestitution;
+		proxy.step = step;
+		proxy.valid = true;
 	}
 
-	void setHasCollided(float restitution, btScalar objectMass, btScalar appliedImpulse) {
+	void setHasCollided(float restitution, btScalar objectMass, btScalar appliedImpulse, const btVector3 & normal) {
 		collideFlag = true;
-		collideObjRestitution = 1.0f - restitution;
+		contactRestitution = 1.0f - restitution;
+		collideNormal = normal;
 		this->collideObjMass = objectMass;
 		this->collideObjImpulse = appliedImpulse;
 	}
 
 	btVector3 getPosition() {
-	    boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
+	    boost::mutex::scoped_lock lock_it( mutex ) ;
 
-		return * curTipPosition;
+		return curTipPosition;
 	}
 
 	btRigidBody * getGodObject() {
@@ -384,73 +878,114 @@ public:
 	}
 
 	btVector3 getAveragedForces() {
-	    boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
+	    boost::mutex::scoped_lock lock_it( mutex ) ;
 		btVector3 sum(0,0,0);
 		for (int i = 0; i < TOTAL_FRAMES; i ++) {
-			sum += *(savedForces[i]);
+			sum += savedForces[i];
 		}
 		return sum / TOTAL_FRAMES;
 	}
 
 	void setConstantForce(const btVector3 & force) {
-	    boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
+	    boost::mutex::scoped_lock lock_it( mutex ) ;
 
-		delete constantForce;
-		constantForce = new btVector3(force);
+		constantForce = force;
 	}
 
 	bool getButtonState(int num) {
-	    boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
+	    boost::mutex::scoped_lock lock_it( mutex ) ;
 
 		int i = 1 << num;
 		return (buttonMask & i) > 0;
 	}
 
+	// API thread: starts a new log, dropping anything left from the last one
+	void startLogging() {
+		if (logRing == 0) {
+			logRing = new LogRing(LOG_CAPACITY);
+		} else {
+			logging.store(false, boost::memory_order_release);
+			LogRecord r;
+			while (logRing->pop(r)) { }
+		}
+		logDropped = 0;
+		logging.store(true, boost::memory_order_release);
+	}
+
+	// API thread: stops logging and copies up to num_entries records into the arrays (3 floats each,
+	// 1 for delta_ts; any may be NULL), setting num_entries to the number copied.  Returns the number
+	// of ticks that didn't fit, in the ring or in the arrays.
+	unsigned int stopLogging(int & num_entries, float * god_obj_positions, float * haptic_tip_positions, float * god_obj_forces, float * haptic_tip_forces, float * delta_ts) {
+		logging.store(false, boost::memory_order_release);
+
+		unsigned int max = num_entries > 0 ? num_entries : 0;
+		num_entries = 0;
+		if (logRing == 0)
+			return 0;
+
+		unsigned int lost = logDropped.load(boost::memory_order_relaxed);
+		unsigned int n = 0;
+		LogRecord chunk[LOG_COPY_CHUNK];
+		size_t got;
+		while ((got = logRing->pop(chunk, LOG_COPY_CHUNK)) > 0) {
+			for (size_t j = 0; j < got; j ++) {
+				if (n >= max) {
+					lost ++;
+					continue;
+				}
+				const LogRecord & r = chunk[j];
+				for (int i = 0; i < 3; i ++) {
+					if (god_obj_positions != 0)
+						god_obj_positions[n * 3 + i] = r.godObjPosition[i];
+					if (haptic_tip_positions != 0)
+						haptic_tip_positions[n * 3 + i] = r.tipPosition[i];
+					if (god_obj_forces != 0)
+						god_obj_forces[n * 3 + i] = r.godObjForce[i];
+					if (haptic_tip_forces != 0)
+						haptic_tip_forces[n * 3 + i] = r.tipForce[i];
+				}
+				if (delta_ts != 0)
+					delta_ts[n] = r.deltaT;
+				n ++;
+			}
+		}
+
+		num_entries = n;
+		return lost;
+	}
+
 	void applyForce(const btVector3 & force, float time_in_secs) {
-	    boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
-		if (applyForceVector != NULL)
-			delete applyForceVector;
-		
-		applyForceVector = new btVector3(force);
+	    boost::mutex::scoped_lock lock_it( mutex ) ;
+
+		applyForceVector = force;
 		applyForceTimeLeft = time_in_secs;
 	}
 
 	void setTransform(const btTransform & trans, const btVector3 & scale) {
-	    boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
-
-		delete transform;
-		delete this->scale;
+	    boost::mutex::scoped_lock lock_it( mutex ) ;
 
-		transform = new btTransform(trans);
-		this->scale = new btVector3(scale);
+		setTransformLocked(trans, scale);
 	}
 
 	void setTransform(const btTransform & trans, const btVector3 & scale, bool useGodObjectCompensator, float lerpTime) {
-	    boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
+	    boost::mutex::scoped_lock lock_it( mutex ) ;
 
 		compensatorActivated = useGodObjectCompensator;
 
-		clearLerpParams();
+		clearLerpParamsLocked();
 		if (lerpTime <= 0) {
-			
-			if (! collideFlag && godObject != 0 && compensatorActivated) {
-				// apply compensator to the god object to prevent the haptic tip from feeling the forces of moving the transform
-
-				godObject->setWorldTransform(btTransform(godObject->getWorldTransform().getRotation(), trans * transform->invXform(godObject->getWorldTransform().getOrigin())));
-
-			}
-
-			setTransform(trans, scale);
+			// the compensator is applied by the physics thread before its next step
+			setTransformLocked(trans, scale);
 			return;
 		}
 
-		posLerpStart = new btVector3(transform->getOrigin());
-		rotationLerpStart = new btQuaternion(transform->getRotation());
-		scaleLerpStart = new btVector3(*this->scale);
+		posLerpStart = transform.getOrigin();
+		rotationLerpStart = transform.getRotation();
+		scaleLerpStart = this->scale;
 
-		posLerpEnd = new btVector3(trans.getOrigin());
-		rotationLerpEnd = new btQuaternion(trans.getRotation());
-		scaleLerpEnd = new btVector3(scale);
+		posLerpEnd = trans.getOrigin();
+		rotationLerpEnd = trans.getRotation();
+		scaleLerpEnd = scale;
 
 		lerpTotalTime = lerpTime;
 		lerpElapsedTime = 0;
@@ -458,37 +993,9 @@ public:
 	}
 
 	void clearLerpParams() {
-		boost::recursive_mutex::scoped_lock lock_it( *mutex ) ;
-
-		if (posLerpStart != NULL)
-			delete posLerpStart;
+		boost::mutex::scoped_lock lock_it( mutex ) ;
 
-		if (posLerpEnd != NULL)
-			delete posLerpEnd;
-
-		if (rotationLerpStart != NULL) 
-			delete rotationLerpStart;
-
-		if (rotationLerpEnd != NULL)
-			delete rotationLerpEnd;
-
-		if (scaleLerpStart != NULL)
-			delete scaleLerpStart;
-
-		if (scaleLerpEnd != NULL)
-			delete scaleLerpEnd;
-
-
-		posLerpStart = NULL;
-		posLerpEnd = NULL;
-		rotationLerpStart = NULL;
-		rotationLerpEnd = NULL;
-		scaleLerpStart = NULL;
-		scaleLerpEnd = NULL;
-
-		lerpTotalTime = 0;
-		lerpElapsedTime = 0;
-		
+		clearLerpParamsLocked();
 	}
 };
 /*
@@ -519,148 +1026,130 @@ void EulerXYZToQuaternion(btVector3 &euler, btQuaternion &quat)
 }
 */
 
-class DampedSpring {
-private:
-	boost::recursive_mutex * mutex ;
-
-	btRigidBody * obj;
-	btVector3 * springPos;
-	btVector3 * posConstraintLower;
-	btVector3 * posConstraintUpper;
-	btQuaternion * springOrient;
-	btVector3 * orientConstraintLower;
-	btVector3 * orientConstraintUpper;
-	float maxForce;
-	float dampingFactor;
-	int springDirectionalityCodes[6];
+// Spring parameters for every spring, one array per parameter, indexed by slot.  Bullet types go in
+// btAlignedObjectArrays so they stay 16 byte aligned.
+struct SpringParamArrays {
+	btAlignedObjectArray<btVector3> pos;
+	btAlignedObjectArray<btQuaternion> orient;
+	btAlignedObjectArray<btVector3> posLower;
+	btAlignedObjectArray<btVector3> posUpper;
+	btAlignedObjectArray<btVector3> orientLower;
+	btAlignedObjectArray<btVector3> orientUpper;
+	vector<float> maxForce;
+	vector<float> dampingFactor;
+
+	void set(unsigned int i, float force, float dFactor, const btVector3 & goalPos, const btQuaternion & goalOrient, const btVector3 & pConstl, const btVector3 & pConstu, const btVector3 & oConstl, const btVector3 & oConstu) {
+		pos[i] = goalPos;
+		orient[i] = goalOrient;
+		posLower[i] = pConstl;
+		posUpper[i] = pConstu;
+		orientLower[i] = oConstl;
+		orientUpper[i] = oConstu;
+		maxForce[i] = force;
+		dampingFactor[i] = dFactor;
+	}
 
+	void copy(unsigned int to, const SpringParamArrays & from, unsigned int i) {
+		set(to, from.maxForce[i], from.dampingFactor[i], from.pos[i], from.orient[i], from.posLower[i], from.posUpper[i], from.orientLower[i], from.orientUpper[i]);
+	}
 
-	// for lerping
+	void resize(unsigned int n) {
+		pos.resize(n);
+		orient.resize(n);
+		posLower.resize(n);
+		posUpper.resize(n);
+		orientLower.resize(n);
+		orientUpper.resize(n);
+		maxForce.resize(n);
+		dampingFactor.resize(n);
+	}
+};
 
-	btVector3 * springPosLerpStart;
-	btVector3 * posConstraintLowerLerpStart;
-	btVector3 * posConstraintUpperLerpStart;
-	btQuaternion * springOrientLerpStart;
-	btVector3 * orientConstraintLowerLerpStart;
-	btVector3 * orientConstraintUpperLerpStart;
-	float maxForceLerpStart;
-	float dampingFactorLerpStart;
-
-	btVector3 * springPosLerpEnd;
-	btVector3 * posConstraintLowerLerpEnd;
-	btVector3 * posConstraintUpperLerpEnd;
-	btQuaternion * springOrientLerpEnd;
-	btVector3 * orientConstraintLowerLerpEnd;
-	btVector3 * orientConstraintUpperLerpEnd;
-	float maxForceLerpEnd;
-	float dampingFactorLerpEnd;
+// All the damped springs, structure of arrays.  Slots are kept dense (removing one moves the last spring
+// into its slot), and update() walks them in slot order.  Physics thread only, with collision_mutex held.
+class SpringPool {
+private:
+	SlotIndex index;					// spring_num -> slot
+	vector<SlotHandle> bodyHandles;
+	vector<btRigidBody *> bodies;		// resolved from bodyHandles at the start of each update
+	vector<boost::array<int,6> > directionality;
+
+	SpringParamArrays params;
+	SpringParamArrays lerpStart;
+	SpringParamArrays lerpEnd;
+	vector<float> lerpTotalTime;
+	vector<float> lerpElapsedTime;
+
+	void setDirectionality(unsigned int i, const int * springDirectionality) {
+		for (int j = 0; j < 6; j ++) {
+			directionality[i][j] = springDirectionality != 0 ? springDirectionality[j] : 0;
+		}
+	}
 
+	void resize(unsigned int n) {
+		bodyHandles.resize(n);
+		bodies.resize(n);
+		directionality.resize(n);
+		params.resize(n);
+		lerpStart.resize(n);
+		lerpEnd.resize(n);
+		lerpTotalTime.resize(n);
+		lerpElapsedTime.resize(n);
+	}
 
-	float lerpTotalTime;
-	float lerpElapsedTime;
+	void lerpAll(float deltaT) {
+		// are we lerping?  if so, set the params to the lerped values
+		for (unsigned int i = 0; i < size(); i ++) {
+			if (!(lerpTotalTime[i] >= lerpElapsedTime[i] && lerpTotalTime[i] != 0))
+				continue;
 
+			lerpElapsedTime[i] += deltaT;
 
-public:
+			float t = lerpElapsedTime[i] / lerpTotalTime[i];
+			t = min(t, 1.0f);
 
-	DampedSpring(btRigidBody * b, float force, float dFactor, const btVector3 & goalPos, const btQuaternion & goalOrient, const btVector3 & pConstl, const btVector3 & pConstu, const btVector3 & oConstl, const btVector3 & oConstu, const int * springDirectionality) {
-		obj = b;
-		springPos = new btVector3(goalPos);
-		posConstraintLower = new btVector3(pConstl);
-		posConstraintUpper = new btVector3(pConstu);
-		springOrient = new btQuaternion(goalOrient);
-		orientConstraintLower = new btVector3(oConstl);
-		orientConstraintUpper = new btVector3(oConstu);
-		maxForce = force;
-		dampingFactor = dFactor;
-		if (springDirectionality != 0) {
-			for (int i = 0; i < 6; i ++) {
-				springDirectionalityCodes[i] = springDirectionality[i];
-			}
-		} else {
-			for (int i = 0; i < 6; i ++) {
-				springDirectionalityCodes[i] = 0;
-			}
+			params.pos[i] = lerpStart.pos[i].lerp(lerpEnd.pos[i], t);
+			params.orient[i] = lerpStart.orient[i].slerp(lerpEnd.orient[i], t);
+			params.posLower[i] = lerpStart.posLower[i].lerp(lerpEnd.posLower[i], t);
+			params.posUpper[i] = lerpStart.posUpper[i].lerp(lerpEnd.posUpper[i], t);
+			params.orientLower[i] = lerpStart.orientLower[i].lerp(lerpEnd.orientLower[i], t);
+			params.orientUpper[i] = lerpStart.orientUpper[i].lerp(lerpEnd.orientUpper[i], t);
+			params.maxForce[i] = (lerpEnd.maxForce[i] - lerpStart.maxForce[i]) * t + lerpStart.maxForce[i];
+			params.dampingFactor[i] = (lerpEnd.dampingFactor[i] - lerpStart.dampingFactor[i]) * t + lerpStart.dampingFactor[i];
 		}
-
-		mutex = new boost::recursive_mutex();
-
-		lerpTotalTime = 0;
-		lerpElapsedTime = 0;
-		maxForceLerpStart = 0;
-		maxForceLerpEnd = 0;
-		dampingFactorLerpStart = 0;
-		dampingFactorLerpEnd = 0;
-		springPosLerpStart = NULL;
-		posConstraintLowerLerpStart = NULL;
-		posConstraintUpperLerpStart = NULL;
-		springOrientLerpStart = NULL;
-		orientConstraintLowerLerpStart = NULL;
-		orientConstraintUpperLerpStart = NULL;
-		springPosLerpEnd = NULL;
-		posConstraintLowerLerpEnd = NULL;
-		posConstraintUpperLerpEnd = NULL;
-		springOrientLerpEnd = NULL;
-		orientConstraintLowerLerpEnd = NULL;
-		orientConstraintUpperLerpEnd = NULL;
-	}
-
-	~DampedSpring() {
-
-		clearLerpParams();
-
-		delete springPos;
-		delete posConstraintLower;
-		delete posConstraintUpper;
-		delete springOrient;
-		delete orientConstraintLower;
-		delete orientConstraintUpper;
-		delete mutex;
 	}
 
-	void update(float deltaT) {
-		boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-		boost::recursive_mutex::scoped_lock lock2( *mutex ) ;
-
-		
-		// are we lerping?  if so, call setParams with the lerped values
-		if (lerpTotalTime >= lerpElapsedTime && lerpTotalTime != 0) {
-
-			lerpElapsedTime += deltaT;
-
-			float t = lerpElapsedTime / lerpTotalTime;
-			t = min(t, 1.0f);
-
-			float f = (maxForceLerpEnd - maxForceLerpStart) * t + maxForceLerpStart;
-			float d = (dampingFactorLerpEnd - dampingFactorLerpStart) * t + dampingFactorLerpStart;
-			
-			setParams(f, d, springPosLerpStart->lerp(*springPosLerpEnd, t), springOrientLerpStart->slerp(*springOrientLerpEnd, t), posConstraintLowerLerpStart->lerp(*posConstraintLowerLerpEnd, t), posConstraintUpperLerpStart->lerp(*posConstraintUpperLerpEnd, t), orientConstraintLowerLerpStart->lerp(*orientConstraintLowerLerpEnd, t), orientConstraintUpperLerpStart->lerp(*orientConstraintUpperLerpEnd, t), &(springDirectionalityCodes[0]) );
-
-		}
+	void updateLinear(unsigned int s) {
+		btRigidBody * obj = bodies[s];
+		const btVector3 & springPos = params.pos[s];
+		const btVector3 & posConstraintLower = params.posLower[s];
+		const btVector3 & posConstraintUpper = params.posUpper[s];
+		const int * springDirectionalityCodes = directionality[s].data();
 
 		// calculate linear forces from spring model
 
 		btVector3 curPos = obj->getWorldTransform().getOrigin();
 
 		// calc distance between current position and goal object
-		btVector3 distance = curPos - *springPos;
+		btVector3 distance = curPos - springPos;
 
 		bool reset = false;
 		btVector3 v = obj->getLinearVelocity();
 		for (int i = 0; i < 3; i ++) {
-			if ((*posConstraintLower)[i] < 0) {
-				if (distance[i] < (*posConstraintLower)[i]) {
+			if (posConstraintLower[i] < 0) {
+				if (distance[i] < posConstraintLower[i]) {
 
-					distance[i] = (*posConstraintLower)[i];
+					distance[i] = posConstraintLower[i];
 					reset = true;
 					v[i] = 0;
 
 				}
 			}
 
-			if ((*posConstraintUpper)[i] > 0) {
-				if (distance[i] > (*posConstraintUpper)[i]) {
+			if (posConstraintUpper[i] > 0) {
+				if (distance[i] > posConstraintUpper[i]) {
 
-					distance[i] = (*posConstraintUpper)[i];
+					distance[i] = posConstraintUpper[i];
 					reset = true;
 					v[i] = 0;
 
@@ -668,14 +1157,14 @@ public:
 			}
 		}
 		if (reset) {
-			btTransform trans(obj->getWorldTransform().getRotation(), btVector3(*springPos + distance));
+			btTransform trans(obj->getWorldTransform().getRotation(), btVector3(springPos + distance));
 			obj->setWorldTransform(trans);
 			obj->setLinearVelocity(v);
-			curPos = *springPos + distance;
+			curPos = springPos + distance;
 		}
 
 
-		float k = maxForce;
+		float k = params.maxForce[s];
 
 		// calculate spring forces
 		btVector3 springForce = -k * distance;
@@ -695,7 +1184,7 @@ public:
 		}
 
 		// use mass and k to calc damping force: c
-		float c = dampingFactor * 2 * sqrt( k / obj->getInvMass() );
+		float c = params.dampingFactor[s] * 2 * sqrt( k / obj->getInvMass() );
 		btVector3 dampingForce = -c * v;
 
 
@@ -711,8 +1200,14 @@ public:
 		// apply to Object
 		obj->activate();
 		obj->applyCentralForce(totalForce);
+	}
 
-
+	void updateAngular(unsigned int s) {
+		btRigidBody * obj = bodies[s];
+		const btQuaternion & springOrient = params.orient[s];
+		const btVector3 & orientConstraintLower = params.orientLower[s];
+		const btVector3 & orientConstraintUpper = params.orientUpper[s];
+		const int * springDirectionalityCodes = directionality[s].data();
 
 		// calculate rotational forces from spring model
 
@@ -720,47 +1215,21 @@ public:
 
 		// calc distance between current position and goal object
 
-		v = obj->getAngularVelocity();
+		btVector3 v = obj->getAngularVelocity();
 		
-		// Multiply the current rotation times the inverse of the last one to get the amount rotated, then convert this to euler angles and add to sumRotation
-		/*
-		btVector3 eulerRotation;
-		QuaternionToEulerXYZ(curRotation * (*lastRotation).inverse(), eulerRotation);
-
-		(*sumRotation) += eulerRotation;
-
-		// Due to loss of precision, over time sumRotation will be off.  Therefore if sumRotation < the actual rotation then use the actual rotation
-
-		btVector3 actualRotation;
-		QuaternionToEulerXYZ(curRotation * (*springOrient).inverse(), actualRotation);
-
-		for (int i = 0; i < 3; i ++) {
-			if (abs((*sumRotation)[i]) <  abs(actualRotation[i])) {
-				(*sumRotation)[i] = actualRotation[i];
-			}
-		}
-
-		*/
-		
-		// what I actually need here is the distance rotated from the goal in each dimension. hmmmm
-		// TODO: So to do this:
-		//	Every time we find a constraint violation, find the difference in euler rotation
-		//	Build a quaternion out of this difference
-		//  rotation correction by this quaternion, it will represent the sum of violated constraint corrections
-		//  after we're done, multiply the object's rotation by the correction
-
-		// now that we're doing this with axisangle, it's the same story but don't use sum rotation 
+		// the distance rotated from the goal in each dimension, as axis angle.  Every constraint violation
+		// adds to a correction quaternion, which is applied to the object's rotation afterwards
 		btQuaternion correction(0,0,0,1);
 		btVector3 rotDegree = curRotation.getAngle() * curRotation.getAxis();
 
-		reset = false;
+		bool reset = false;
 		for (int i = 0; i < 3; i ++) {
-			if ((*orientConstraintLower)[i] < 0) {
-				if (rotDegree[i] < (*orientConstraintLower)[i]) {
+			if (orientConstraintLower[i] < 0) {
+				if (rotDegree[i] < orientConstraintLower[i]) {
 
 					btVector3 cor(0,0,0);
 					cor[i] = 1;
-					btScalar corAmt = (*orientConstraintLower)[i] - rotDegree[i];
+					btScalar corAmt = orientConstraintLower[i] - rotDegree[i];
 
 					btQuaternion tempQuat(cor,corAmt);
 					correction = tempQuat * correction;
@@ -771,12 +1240,12 @@ public:
 				}
 			}
 
-			if ((*orientConstraintUpper)[i] > 0) {
-				if (rotDegree[i] > (*orientConstraintUpper)[i]) {
+			if (orientConstraintUpper[i] > 0) {
+				if (rotDegree[i] > orientConstraintUpper[i]) {
 
 					btVector3 cor(0,0,0);
 					cor[i] = 1;
-					btScalar corAmt = (*orientConstraintUpper)[i] - rotDegree[i];
+					btScalar corAmt = orientConstraintUpper[i] - rotDegree[i];
 
 					btQuaternion tempQuat(cor, corAmt);
 					correction = tempQuat * correction;
@@ -794,22 +1263,11 @@ public:
 		}
 		
 		
-		k = maxForce;
-
-		// calculate spring forces
-//		springForce = -k * (*sumRotation);
+		float k = params.maxForce[s];
 
 		// calculations with pure quaternions
-		btQuaternion torqueQuat = (*springOrient).nearest(curRotation) * (*springOrient).inverse() ;
-		springForce = torqueQuat.getAxis() * (-k * torqueQuat.getAngle());
-
-		/*		static int counter = 0;
-		counter ++;
-		if (counter % 50 == 0) {
-			cout <<curRotation.getX() << ", " << curRotation.getY() << ", " << curRotation.getZ() << ", " << curRotation.getW() << " -> " << (*springOrient).getX() << ", " << (*springOrient).getY() << ", " << (*springOrient).getZ() << ", " << (*springOrient).getW() << "\n";
-			cout << "  : " << torqueQuat.getAxis().getX() << ", " << torqueQuat.getAxis().getY() << ", " << torqueQuat.getAxis().getZ() << " % " << torqueQuat.getAngle() << "\n";
-		} */
-
+		btQuaternion torqueQuat = springOrient.nearest(curRotation) * springOrient.inverse() ;
+		btVector3 springForce = torqueQuat.getAxis() * (-k * torqueQuat.getAngle());
 
 		// are there restrictions on the direction of the spring?  If so, check the cardinality of the spring force's directions to see if they've been violated
 		// if so, zero out that dimension's forces and set the velocity for that dimension to zero
@@ -829,13 +1287,13 @@ public:
 
 
 		// use mass and k to calc damping force: c
-		c= dampingFactor * 2 * sqrt( k / obj->getInvMass() );
+		float c = params.dampingFactor[s] * 2 * sqrt( k / obj->getInvMass() );
 
 
-		dampingForce = -c * v;
+		btVector3 dampingForce = -c * v;
 
 		// calc total force and apply to god object
-		totalForce = springForce + dampingForce;
+		btVector3 totalForce = springForce + dampingForce;
 		
 		// if the directionality is 2 then we dont' want any forces at all on this dimension
 		for (int i = 0; i < 3; i ++) {
@@ -843,284 +1301,947 @@ public:
 				totalForce[i] = 0;
 		}
 
-//		if (counter % 50 == 0) { cout << "  Force:   " << totalForce.getX() << ", " << totalForce.getY() << ", " << totalForce.getZ() << "\n";	}
-
 		// apply to Object
 		obj->activate();
 		btVector3 min;
 		btVector3 max;
 		obj->getAabb(min, max);
 		obj->applyTorque(totalForce * (max - min).length());
+	}
 
-		// save current dist
-//		lastRotation->setValue(curRotation[0], curRotation[1], curRotation[2], curRotation[3]);
+public:
+	unsigned int size() {
+		return index.size();
+	}
 
+	// slot of a spring, or -1
+	int find(int spring_num) {
+		return index.dense(index.find(spring_num));
 	}
 
-	void setParams(float force, float dampingFactor, const btVector3 & goalPos, const btQuaternion & goalOrient, const btVector3 & pConstl, const btVector3 & pConstu, const btVector3 & oConstl, const btVector3 & oConstu, const int * springDirectionality) {
-		boost::recursive_mutex::scoped_lock lock2( *mutex ) ;
+	// adds a spring, replacing any with the same number
+	void add(int spring_num, SlotHandle body, btRigidBody * b, float force, float dFactor, const btVector3 & goalPos, const btQuaternion & goalOrient, const btVector3 & pConstl, const btVector3 & pConstu, const btVector3 & oConstl, const btVector3 & oConstu, const int * springDirectionality) {
+		int i = find(spring_num);
+		if (i < 0) {
+			index.insert(spring_num);
+			i = size() - 1;
+			resize(i + 1);
+		}
 
-		maxForce = force;
-		this->dampingFactor = dampingFactor;
-		springPos->setValue(goalPos[0], goalPos[1], goalPos[2]);
-		posConstraintLower->setValue(pConstl[0], pConstl[1], pConstl[2]);
-		posConstraintUpper->setValue(pConstu[0], pConstu[1], pConstu[2]);
+		bodyHandles[i] = body;
+		bodies[i] = b;
+		params.set(i, force, dFactor, goalPos, goalOrient, pConstl, pConstu, oConstl, oConstu);
+		setDirectionality(i, springDirectionality);
+		lerpTotalTime[i] = 0;
+		lerpElapsedTime[i] = 0;
+	}
 
-		if (springDirectionality != 0) {
-			for (int i = 0; i < 6; i ++) {
-				springDirectionalityCodes[i] = springDirectionality[i];
-			}
-		} else {
-			for (int i = 0; i < 6; i ++) {
-				springDirectionalityCodes[i] = 0;
-			}
+	void remove(unsigned int i) {
+		unsigned int last = size() - 1;
+		index.remove(i);
+
+		if (i != last) {
+			bodyHandles[i] = bodyHandles[last];
+			bodies[i] = bodies[last];
+			directionality[i] = directionality[last];
+			params.copy(i, params, last);
+			lerpStart.copy(i, lerpStart, last);
+			lerpEnd.copy(i, lerpEnd, last);
+			lerpTotalTime[i] = lerpTotalTime[last];
+			lerpElapsedTime[i] = lerpElapsedTime[last];
 		}
 
+		resize(last);
+	}
 
-//		btVector3 diff;
-		// compute shortest rotation between previous goal orientation and the new one
-		// add this to the sumRotation value
-//		QuaternionToEulerXYZ(goalOrient * (*springOrient).inverse(), diff);
-//		(*sumRotation) += diff;
+	void clear() {
+		index.clear();
+		resize(0);
+	}
 
-		springOrient->setValue(goalOrient[0], goalOrient[1], goalOrient[2], goalOrient[3]);
-		orientConstraintLower->setValue(oConstl[0], oConstl[1], oConstl[2]);
-		orientConstraintUpper->setValue(oConstu[0], oConstu[1], oConstu[2]);
+	void setParams(unsigned int i, float force, float dFactor, const btVector3 & goalPos, const btQuaternion & goalOrient, const btVector3 & pConstl, const btVector3 & pConstu, const btVector3 & oConstl, const btVector3 & oConstu, const int * springDirectionality) {
+		lerpTotalTime[i] = 0;
+		lerpElapsedTime[i] = 0;
+		params.set(i, force, dFactor, goalPos, goalOrient, pConstl, pConstu, oConstl, oConstu);
+		setDirectionality(i, springDirectionality);
 	}
 
-	void clearLerpParams() {
-		boost::recursive_mutex::scoped_lock lock2( *mutex ) ;
+	// save the current params, the provided ones, and the time to lerp
+	void lerpParams(unsigned int i, float force, float dFactor, const btVector3 & goalPos, const btQuaternion & goalOrient, const btVector3 & pConstl, const btVector3 & pConstu, const btVector3 & oConstl, const btVector3 & oConstu, const int * springDirectionality, float time_in_secs) {
+		if (time_in_secs == 0) {
+			setParams(i, force, dFactor, goalPos, goalOrient, pConstl, pConstu, oConstl, oConstu, springDirectionality);
+			return;
+		}
 
-		if (springPosLerpStart != NULL)
-			delete springPosLerpStart;
+		setDirectionality(i, springDirectionality);
+		lerpStart.copy(i, params, i);
+		lerpEnd.set(i, force, dFactor, goalPos, goalOrient, pConstl, pConstu, oConstl, oConstu);
+		lerpTotalTime[i] = time_in_secs;
+		lerpElapsedTime[i] = 0;
+	}
 
-		if (posConstraintLowerLerpStart != NULL)
-			delete posConstraintLowerLerpStart;
+	void update(float deltaT) {
+		// springs whose body has been removed (or removed and sent again) go with it
+		for (unsigned int i = size(); i -- > 0; ) {
+			btRigidBody ** b = sentRigidBodies.get(bodyHandles[i]);
+			if (b == NULL)
+				remove(i);
+			else
+				bodies[i] = *b;
+		}
 
-		if (posConstraintUpperLerpStart != NULL) 
-			delete posConstraintUpperLerpStart;
+		lerpAll(deltaT);
+		for (unsigned int i = 0; i < size(); i ++) {
+			updateLinear(i);
+		}
+		for (unsigned int i = 0; i < size(); i ++) {
+			updateAngular(i);
+		}
+	}
+};
 
-		if (springOrientLerpStart != NULL)
-			delete springOrientLerpStart;
+//falcon info is architecture independent
+vector<FalconInterface *> falconInterfaces;
 
-		if (orientConstraintLowerLerpStart != NULL)
-			delete orientConstraintLowerLerpStart;
+SpringPool springs;
+float springTime = 0;		// physics thread only
 
-		if (orientConstraintUpperLerpStart != NULL)
-			delete orientConstraintUpperLerpStart;
+bool done=true;
+boost::thread handle_thread;
+boost::thread physics_thread;
+
+// Everything the read APIs return, as of the end of a physics step
+struct FalconSnapshot {
+	float tipPosition[3];
+	float godPosition[3];
+	bool hasGodObject;
+	float forces[3];
+	int buttons[4];
+};
 
-		if (springPosLerpEnd != NULL)
-			delete springPosLerpEnd;
+struct BodySnapshot {
+	int body_num;
+	unsigned int changed;	// step the pose last changed in
+	float pos[3];
+	float orient[4];
+};
 
-		if (posConstraintLowerLerpEnd != NULL)
-			delete posConstraintLowerLerpEnd;
+struct WorldSnapshot {
+	unsigned int step;
+	float fps;
+	float springTime;	// seconds the step spent updating springs
+	vector<FalconSnapshot> falcons;
+	vector<BodySnapshot> bodies;	// sorted by body_num
+};
 
-		if (posConstraintUpperLerpEnd != NULL)
-			delete posConstraintUpperLerpEnd;
+// Triple buffered world snapshots.  The physics thread fills the back buffer and swaps it with the middle
+// one; readers swap the middle one for the front one when it holds a newer snapshot.  Neither side ever
+// waits for the other, and the buffers keep their capacity, so steady state publishing doesn't allocate.
+// Readers are serialized among themselves by readerMutex, which the physics thread never takes.
+#define SNAPSHOT_INDEX 3
+#define SNAPSHOT_FRESH 4
 
-		if (springOrientLerpEnd != NULL) 
-			delete springOrientLerpEnd;
+class SnapshotBuffer {
+private:
+	WorldSnapshot buffers[3];
+	boost::atomic<int> middle;
+	int back;		// physics thread only
+	int front;		// readers only, under readerMutex
 
-		if (orientConstraintLowerLerpEnd != NULL)
-			delete orientConstraintLowerLerpEnd;
+public:
+	boost::mutex readerMutex;
 
-		if (orientConstraintUpperLerpEnd != NULL)
-			delete orientConstraintUpperLerpEnd;
+	SnapshotBuffer() : middle(1), back(0), front(2) {
+		clear();
+	}
 
+	// only while no physics thread is running.  Readers can still be in the read APIs, so take their lock.
+	void clear() {
+		boost::mutex::scoped_lock lock(readerMutex);
+		for (int i = 0; i < 3; i ++) {
+			buffers[i].step = 0;
+			buffers[i].fps = 0;
+			buffers[i].springTime = 0;
+			buffers[i].falcons.clear();
+			buffers[i].bodies.clear();
+		}
+		middle.store(1);
+		back = 0;
+		front = 2;
+	}
 
-		springPosLerpStart = NULL;
-		posConstraintLowerLerpStart = NULL;
-		posConstraintUpperLerpStart = NULL;
-		springOrientLerpStart = NULL;
-		orientConstraintLowerLerpStart = NULL;
-		orientConstraintUpperLerpStart = NULL;
-		springPosLerpEnd = NULL;
-		posConstraintLowerLerpEnd = NULL;
-		posConstraintUpperLerpEnd = NULL;
-		springOrientLerpEnd = NULL;
-		orientConstraintLowerLerpEnd = NULL;
-		orientConstraintUpperLerpEnd = NULL;
-		
-		lerpTotalTime = 0;
-		lerpElapsedTime = 0;
-		maxForceLerpStart = 0;
-		maxForceLerpEnd = 0;
-		dampingFactorLerpStart = 0;
-		dampingFactorLerpEnd = 0;
+	WorldSnapshot & getBack() {
+		return buffers[back];
+	}
 
+	void publish() {
+		back = middle.exchange(back | SNAPSHOT_FRESH, boost::memory_order_acq_rel) & SNAPSHOT_INDEX;
 	}
 
-	void lerpParams(float force, float dampingFactor, const btVector3 & goalPos, const btQuaternion & goalOrient, const btVector3 & pConstl, const btVector3 & pConstu, const btVector3 & oConstl, const btVector3 & oConstu, const int * springDirectionality, float time_in_secs) {
-		// save the current params, the provided ones, and the time to lerp
-		boost::recursive_mutex::scoped_lock lock2( *mutex ) ;
-		
-		clearLerpParams();
-		if (time_in_secs == 0) {
-			setParams(force, dampingFactor, goalPos, goalOrient, pConstl, pConstu, oConstl, oConstu, springDirectionality);
-			return;
+	// latest snapshot, call with readerMutex held
+	const WorldSnapshot & getFront() {
+		if (middle.load(boost::memory_order_relaxed) & SNAPSHOT_FRESH) {
+			front = middle.exchange(front, boost::memory_order_acq_rel) & SNAPSHOT_INDEX;
 		}
+		return buffers[front];
+	}
+};
+
+SnapshotBuffer snapshots;
+
+// poses of the sent bodies, sorted by body_num.  The physics thread only updates the dirty ones, then copies
+// the lot into each snapshot, so publishing is still linear in the number of bodies, as is a batch read.
+vector<BodySnapshot> bodyPoses;		// physics thread only
+
+#ifdef _WIN32
+bool testHDLError();
+HDLServoOpExitCode updateHDL(void* pUserData);
+#endif
+void updateHaptics();
+void updatePhysics();
+void set_error(string error);
+bool initCollisions();
+int initFalcons();
+bool check_falcon_num(int n);
+bool check_falcon_num(int n){
+    return (n>=0 && n<falconInterfaces.size());
+}
+
+#ifndef _WIN32 
+void updateHaptics(){
+	CStopWatch clock;	// time since the loop started
+	double nextTick = 0;
+	double lastTick = 0;
+
+	clock.startTimer();
+    while(true){
+        if(done){
+            return;
+        }
+
+		// wait for the next tick.  Deadlines are absolute, so oversleeping one tick shortens the next one
+		// instead of adding up; a loop more than a tick behind starts again from now rather than bursting
+		nextTick += SERVO_PERIOD;
+		clock.stopTimer();
+		double now = clock.getElapsedTime();
+		if (nextTick > now) {
+			boost::this_thread::sleep(boost::posix_time::microseconds((boost::int64_t)((nextTick - now) * 1000000)));
+		} else if (now - nextTick > SERVO_PERIOD) {
+			nextTick = now;
+		}
+
+		clock.stopTimer();
+		now = clock.getElapsedTime();
+		float elapsedTime = (float)(now - lastTick);
+		lastTick = now;
+
+		recordFrameTime(elapsedTime);
+
+        for(unsigned int i=0;i<falcons.size();i++){
+            
+            FalconDevice * dev = falcons[i];
+            if(dev->runIOLoop()){
+            
+            if(falconInfo[i].homing){
+                    dev->getFalconFirmware()->setLEDStatus(libnifalcon::FalconFirmware::RED_LED);
+                if(dev->getFalconFirmware()->isHomed()){
+                    dev->getFalconFirmware()->setLEDStatus(libnifalcon::FalconFirmware::GREEN_LED);
+                    falconInfo[i].homing = false;
+                }
+                
+            }
+            else{
+                falconInterfaces[i]->updateHaptics(elapsedTime);
+            }
+            }
+            
+        }
+    }
+    
+}
+#else
+
+HDLServoOpExitCode updateHDL(void* pUserData){
+	static CStopWatch stopWatch;
+	
+	stopWatch.stopTimer();
+	
+	float elapsedTime = (float)stopWatch.getElapsedTime();
+	stopWatch.startTimer();
+
+	recordFrameTime(elapsedTime);
+
+	// physics is stepped by updatePhysics(), the servo loop only renders against the god object proxies
+	for(unsigned int i=0;i<falconInterfaces.size();i++){
+		falconInterfaces[i]->updateHaptics(elapsedTime);
+	}
+
+	return HDL_SERVOOP_CONTINUE;
+}
+
+
+void updateHaptics(){
+
+	
+	if (falconInterfaces.size() <= 0) {
+
+		// nothing to servo, physics runs on its own
+		return;
+
+	} else {
+
 
-		if (springDirectionality != 0) {
-			for (int i = 0; i < 6; i ++) {
-				springDirectionalityCodes[i] = springDirectionality[i];
+		//create a servo op
+		servo_op = hdlCreateServoOp(updateHDL,
+									 (void*)0,
+									 false);
+		if(!testHDLError()){
+			set_error("error creating servo op");
+			return;
+		}
+		while(true){
+			if(done){
+				return;
 			}
+			Sleep(100);
+		} 
+
+	}
+
+}
+#endif
+
+BodySnapshot * findBodyPose(int body_num);
+
+// fill and publish a snapshot, called by the physics thread with collision_mutex held
+void publishSnapshot(unsigned int step) {
+	WorldSnapshot & s = snapshots.getBack();
+	s.step = step;
+
+	float sum = 0;
+	{
+		boost::mutex::scoped_lock lock(frame_times_mutex);
+		for (int i = 0; i < TOTAL_FRAMES; i ++) {
+			sum += frame_times[i];
+		}
+	}
+	// no servo ticks yet (no falcon attached) reads as 0, not inf
+	s.fps = (sum > 0) ? 1.0f / ( sum / TOTAL_FRAMES) : 0;
+	s.springTime = springTime;
+
+	s.falcons.resize(falconInterfaces.size());
+	for (unsigned int i = 0; i < falconInterfaces.size(); i ++) {
+		FalconSnapshot & fs = s.falcons[i];
+
+		btVector3 p = falconInterfaces[i]->getPosition();
+		btVector3 force = falconInterfaces[i]->getAveragedForces();
+		btRigidBody * go = falconInterfaces[i]->getGodObject();
+		btVector3 g = go != 0 ? go->getWorldTransform().getOrigin() : btVector3(0,0,0);
+		fs.hasGodObject = go != 0;
+		for (int j = 0; j < 3; j ++) {
+			fs.tipPosition[j] = (float)p[j];
+			fs.godPosition[j] = (float)g[j];
+			fs.forces[j] = (float)force[j];
+		}
+
+		for (int j = 0; j < 4; j ++) {
+			fs.buttons[j] = falconInterfaces[i]->getButtonState(j);
+		}
+	}
+
+	for (unsigned int i = 0; i < dirtyBodies.size(); i ++) {
+		TrackedMotionState * ms = dirtyBodies[i];
+		BodySnapshot * bs = findBodyPose(ms->body_num);
+		ms->dirty = false;
+		// no pose to update (not a sent body, or already removed)
+		if (bs == NULL)
+			continue;
+		btVector3 p = ms->m_graphicsWorldTrans.getOrigin();
+		btQuaternion q = ms->m_graphicsWorldTrans.getRotation();
+
+		bs->changed = step;
+		bs->pos[0] = p.getX();
+		bs->pos[1] = p.getY();
+		bs->pos[2] = p.getZ();
+		bs->orient[0] = q.getX();
+		bs->orient[1] = q.getY();
+		bs->orient[2] = q.getZ();
+		bs->orient[3] = q.getW();
+	}
+	dirtyBodies.clear();
+
+	// plain data, keeps the snapshot's capacity.  Every body, every step: getDynamicShapePose reads any of them
+	s.bodies = bodyPoses;
+
+	snapshots.publish();
+}
+
+// where body_num is, or would go, in a list sorted by body_num
+unsigned int lowerBoundBody(const vector<BodySnapshot> & bodies, int body_num) {
+	unsigned int lo = 0;
+	unsigned int hi = bodies.size();
+	while (lo < hi) {
+		unsigned int mid = (lo + hi) / 2;
+		if (bodies[mid].body_num < body_num)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// body in a snapshot, or NULL
+const BodySnapshot * findBody(const WorldSnapshot & s, int body_num) {
+	unsigned int i = lowerBoundBody(s.bodies, body_num);
+	if (i < s.bodies.size() && s.bodies[i].body_num == body_num)
+		return &s.bodies[i];
+	return NULL;
+}
+
+// physics thread
+BodySnapshot * findBodyPose(int body_num) {
+	unsigned int i = lowerBoundBody(bodyPoses, body_num);
+	if (i < bodyPoses.size() && bodyPoses[i].body_num == body_num)
+		return &bodyPoses[i];
+	return NULL;
+}
+
+// Collision shapes are cached by content, so every body sent with the same triangles (and shape type) shares
+// one shape, and re-sending a mesh doesn't rebuild it.  Shapes are built on the caller's thread and released
+// on the physics thread, so the cache has its own lock, never held while building or deleting.
+
+struct CachedShape {
+	size_t hash;
+	int type;
+	vector<float> triangles;	// what the shape was built from, to tell hash collisions apart
+	btTriangleMesh * mesh;		// NULL for convex hulls
+	btCollisionShape * shape;
+	int refs;
+
+	~CachedShape() {
+		delete shape;
+		delete mesh;
+	}
+};
+
+boost::unordered_multimap<size_t, CachedShape *> shapeCache;
+boost::mutex shape_cache_mutex;
+
+// static bodies get a bvh mesh, dynamic ones a convex hull; gimpact only if asked for
+int resolveShapeType(int shape_type, float weight) {
+	if (shape_type == FALCONUNITY_SHAPE_AUTO)
+		return weight == 0 ? FALCONUNITY_SHAPE_STATIC_MESH : FALCONUNITY_SHAPE_CONVEX_HULL;
+	return shape_type;
+}
+
+size_t hashShape(int type, const float * shape, int num_tris) {
+	size_t h = boost::hash_range(shape, shape + num_tris * 9);
+	boost::hash_combine(h, type);
+	return h;
+}
+
+CachedShape * buildShape(int type, const float * shape, int num_tris) {
+	CachedShape * cs = new CachedShape();
+	cs->type = type;
+	cs->triangles.assign(shape, shape + num_tris * 9);
+	cs->mesh = NULL;
+	cs->refs = 1;
+
+	if (type == FALCONUNITY_SHAPE_CONVEX_HULL) {
+		// hull of every vertex, then reduced to the points that matter
+		btConvexHullShape all(shape, num_tris * 3, 3 * sizeof(float));
+		btShapeHull hull(&all);
+		hull.buildHull(all.getMargin());
+		cs->shape = new btConvexHullShape((const btScalar *)hull.getVertexPointer(), hull.numVertices());
+	} else {
+		cs->mesh = new btTriangleMesh();
+		for(int i=0;i<num_tris;i++){
+			const float * p = shape+i*9;
+			btVector3 v1(p[0],p[1],p[2]);
+			btVector3 v2(p[3],p[4],p[5]);
+			btVector3 v3(p[6],p[7],p[8]);
+			cs->mesh->addTriangle(v1,v2,v3);
+		}
+
+		if (type == FALCONUNITY_SHAPE_STATIC_MESH) {
+			cs->shape = new btBvhTriangleMeshShape(cs->mesh, true);
 		} else {
-			for (int i = 0; i < 6; i ++) {
-				springDirectionalityCodes[i] = 0;
+			btGImpactMeshShape * gimpact = new btGImpactMeshShape(cs->mesh);
+			gimpact->setLocalScaling(btVector3(1.f,1.f,1.f));
+			gimpact->updateBound(); 
+			cs->shape = gimpact;
+		}
+	}
+
+	cs->shape->setMargin(0.0055f); 
+	cs->shape->setUserPointer(cs);
+	return cs;
+}
+
+// a shape for these triangles, shared if one's already been built
+btCollisionShape * acquireShape(int type, const float * shape, int num_tris) {
+	size_t h = hashShape(type, shape, num_tris);
+	size_t len = num_tris * 9;
+
+	{
+		boost::mutex::scoped_lock lock_it( shape_cache_mutex ) ;
+		std::pair<boost::unordered_multimap<size_t, CachedShape *>::iterator, boost::unordered_multimap<size_t, CachedShape *>::iterator> r = shapeCache.equal_range(h);
+		for (boost::unordered_multimap<size_t, CachedShape *>::iterator it = r.first; it != r.second; ++it) {
+			CachedShape * cs = it->second;
+			if (cs->type == type && cs->triangles.size() == len && std::equal(shape, shape + len, cs->triangles.begin())) {
+				cs->refs ++;
+				return cs->shape;
 			}
 		}
+	}
 
+	CachedShape * cs = buildShape(type, shape, num_tris);
+	cs->hash = h;
 
-		springPosLerpStart = new btVector3(*springPos);
-		posConstraintLowerLerpStart = new btVector3(*posConstraintLower);
-		posConstraintUpperLerpStart = new btVector3(*posConstraintUpper);
-		springOrientLerpStart = new btQuaternion(*springOrient);
-		orientConstraintLowerLerpStart = new btVector3(*orientConstraintLower);
-		orientConstraintUpperLerpStart = new btVector3(*orientConstraintUpper);
-		
-		springPosLerpEnd = new btVector3(goalPos);
-		posConstraintLowerLerpEnd = new btVector3(pConstl);
-		posConstraintUpperLerpEnd = new btVector3(pConstu);
-		springOrientLerpEnd = new btQuaternion(goalOrient);
-		orientConstraintLowerLerpEnd = new btVector3(oConstl);
-		orientConstraintUpperLerpEnd = new btVector3(oConstu);
+	boost::mutex::scoped_lock lock_it( shape_cache_mutex ) ;
+	shapeCache.insert(std::make_pair(h, cs));
+	return cs->shape;
+}
+
+// shapes that didn't come from the cache (god object spheres) are just deleted
+void releaseShape(btCollisionShape * shape) {
+	CachedShape * cs = (CachedShape *)shape->getUserPointer();
+	if (cs == NULL) {
+		delete shape;
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock_it( shape_cache_mutex ) ;
+		if (-- cs->refs > 0)
+			return;
+
+		std::pair<boost::unordered_multimap<size_t, CachedShape *>::iterator, boost::unordered_multimap<size_t, CachedShape *>::iterator> r = shapeCache.equal_range(cs->hash);
+		for (boost::unordered_multimap<size_t, CachedShape *>::iterator it = r.first; it != r.second; ++it) {
+			if (it->second == cs) {
+				shapeCache.erase(it);
+				break;
+			}
+		}
+	}
+
+	delete cs;
+}
+
+// Mutation APIs don't touch the bullet world, they queue a command that the physics thread applies at the
+// start of its next step.  Callers never wait on a step, and every mutation lands between two steps, in the
+// order it was made.  Anything expensive (building meshes and bodies) is done by the caller before queueing.
+// falcon_update_batch hands its whole input over as one CMD_BATCH, whatever its size (see BatchBuffer).
+
+#define COMMAND_QUEUE_SIZE 1024
+
+enum CommandType {
+	CMD_SET_FORCE_FIELD,
+	CMD_APPLY_FORCE,
+	CMD_SET_GOD_OBJECT,			// prebuilt sphere body, or body_num of a sent body
+	CMD_REMOVE_GOD_OBJECT,
+	CMD_UPDATE_HAPTIC_TRANSFORM,
+	CMD_SET_GRAVITY,
+	CMD_ADD_BODY,				// prebuilt body
+	CMD_REMOVE_BODY,
+	CMD_UPDATE_BODY,
+	CMD_SET_BODY_POSE,
+	CMD_APPLY_FORCE_TO_BODY,
+	CMD_ADD_SPRING,
+	CMD_REMOVE_SPRING,
+	CMD_SET_SPRING,
+	CMD_LERP_SPRING,
+	CMD_BATCH					// falcon_update_batch inputs, in the batch buffers
+};
+
+struct ForceCommand {
+	float force[3];
+	float time_in_secs;
+};
+
+struct GodObjectCommand {
+	btRigidBody * body;			// sphere built by the caller, or NULL to use Command::body_num
+	float minDistToMaxForce;
+	float maxDistToMaxForce;
+};
+
+struct BodyCommand {
+	btRigidBody * body;			// CMD_ADD_BODY
+	float weight;
+	float hardness;
+	float linearFactors[3];
+	float angularFactors[3];
+	float friction;
+	float pos[3];				// pose, or linear force
+	float orient[4];			// orientation, or torque
+};
+
+struct BatchCommand {
+	unsigned int generation;	// batch buffer the inputs are in
+	unsigned int hapticEnd;		// inputs up to here are this batch's, the ones before it were applied already
+	unsigned int springEnd;
+};
+
+// plain old data, so the lock-free queue can copy it around
+struct Command {
+	int type;
+	int id;						// falcon, body or spring number
+	int body_num;				// body a spring or god object attaches to
+	union {
+		ForceCommand force;
+		GodObjectCommand godObject;
+		BodyCommand body;
+		_falconunity_haptic_tip_params haptic;
+		_falconunity_spring_params spring;
+		BatchCommand batch;
+	};
+};
+
+boost::lockfree::queue<Command, boost::lockfree::capacity<COMMAND_QUEUE_SIZE> > commands;
+
+bool queueCommand(const Command & c) {
+	if (! commands.push(c)) {
+		set_error("command queue full");
+		return false;
+	}
+	return true;
+}
+
+// Double buffered falcon_update_batch inputs.  Callers append to the back buffer under batch_mutex and queue
+// a CMD_BATCH marking how far it goes.  When the physics thread reaches a marker for the back buffer, it
+// swaps the two, then applies the front one without the lock.  The front buffer is only cleared by that
+// swap, once every marker for it has been applied, so a frame's worth of inputs never waits on the queue's
+// capacity, and lands between two steps in the order it was made like any other command.
+struct BatchBuffer {
+	vector<_falconunity_haptic_tip_params> haptics;
+	vector<_falconunity_spring_params> springs;
+};
+
+boost::mutex batch_mutex;
+BatchBuffer batchBuffers[2];
+int batchBack = 0;					// under batch_mutex
+unsigned int batchGeneration = 1;	// of the back buffer, under batch_mutex
+unsigned int batchFrontGeneration = 0;	// physics thread only, from here down
+unsigned int batchHapticsApplied = 0;
+unsigned int batchSpringsApplied = 0;
+
+// only while no physics thread is running
+void clearBatches() {
+	boost::mutex::scoped_lock lock(batch_mutex);
+	for (int i = 0; i < 2; i ++) {
+		batchBuffers[i].haptics.clear();
+		batchBuffers[i].springs.clear();
+	}
+	// markers from before are gone with the queue, the next one swaps
+	batchGeneration ++;
+}
+
+void removeSphereGodObject(int falcon_num);
+bool removeBody(int body_num);
+
+// slot of a spring, or -1
+int findSpring(int spring_num) {
+	int i = springs.find(spring_num);
+	if (i < 0) {
+		set_error("bad spring number");
+	}
+	return i;
+}
+
+btRigidBody * findRigidBody(int body_num) {
+	btRigidBody ** b = sentRigidBodies.find(body_num);
+	if (b == NULL) {
+		set_error("bad body number");
+		return NULL;
+	}
+	return *b;
+}
+
+void deleteRigidBody(btRigidBody * rb) {
+	delete rb->getMotionState();
+	releaseShape(rb->getCollisionShape());
+	delete rb;
+}
+
+// physics thread, with collision_mutex held.  falcon_num was checked when the input was queued.
+void applyHapticTransform(const _falconunity_haptic_tip_params & h) {
+	falconInterfaces[h.falcon_num]->setTransform(btTransform(btQuaternion(h.orient[0], h.orient[1], h.orient[2], h.orient[3]), btVector3(h.pos[0], h.pos[1], h.pos[2])), btVector3(h.scale[0], h.scale[1], h.scale[2]), h.useCompensator != 0, h.time_in_secs);
+}
+
+// physics thread, with collision_mutex held
+void applySpringParams(const _falconunity_spring_params & s, bool lerp) {
+	int i = findSpring(s.spring_num);
+	if (i < 0)
+		return;
+
+	btVector3 goal(s.goalPos[0], s.goalPos[1], s.goalPos[2]);
+	btVector3 pConstl(s.posConstraintLower[0], s.posConstraintLower[1], s.posConstraintLower[2]);
+	btVector3 pConstu(s.posConstraintUpper[0], s.posConstraintUpper[1], s.posConstraintUpper[2]);
+	btQuaternion orient(s.goalOrient[0], s.goalOrient[1], s.goalOrient[2], s.goalOrient[3]);
+	btVector3 oConstl(s.orientConstraintLower[0], s.orientConstraintLower[1], s.orientConstraintLower[2]);
+	btVector3 oConstu(s.orientConstraintUpper[0], s.orientConstraintUpper[1], s.orientConstraintUpper[2]);
+
+	if (lerp)
+		springs.lerpParams(i, s.max_force, s.dampingFactor, goal, orient, pConstl, pConstu, oConstl, oConstu, &(s.directionality[0]), s.time_in_secs);
+	else
+		springs.setParams(i, s.max_force, s.dampingFactor, goal, orient, pConstl, pConstu, oConstl, oConstu, &(s.directionality[0]));
+}
+
+// physics thread, with collision_mutex held
+void applyBatch(const BatchCommand & b) {
+	if (b.generation != batchFrontGeneration) {
+		// first marker for the back buffer, everything in the front one has been applied
+		boost::mutex::scoped_lock lock(batch_mutex);
+		batchBack ^= 1;
+		batchBuffers[batchBack].haptics.clear();
+		batchBuffers[batchBack].springs.clear();
+		batchFrontGeneration = batchGeneration ++;
+		batchHapticsApplied = 0;
+		batchSpringsApplied = 0;
+	}
+	const BatchBuffer & front = batchBuffers[batchBack ^ 1];
+	for (; batchHapticsApplied < b.hapticEnd; batchHapticsApplied ++) {
+		applyHapticTransform(front.haptics[batchHapticsApplied]);
+	}
+	for (; batchSpringsApplied < b.springEnd; batchSpringsApplied ++) {
+		applySpringParams(front.springs[batchSpringsApplied], true);
+	}
+}
+
+// physics thread, with collision_mutex held
+void applyCommand(const Command & c) {
+	switch (c.type) {
+	case CMD_SET_FORCE_FIELD:
+		falconInterfaces[c.id]->setConstantForce(btVector3(c.force.force[0], c.force.force[1], c.force.force[2]));
+		break;
+
+	case CMD_APPLY_FORCE:
+		falconInterfaces[c.id]->applyForce(btVector3(c.force.force[0], c.force.force[1], c.force.force[2]), c.force.time_in_secs);
+		break;
+
+	case CMD_SET_GOD_OBJECT: {
+		btRigidBody * rigidBody = c.godObject.body;
+		if (rigidBody == NULL) {
+			rigidBody = findRigidBody(c.body_num);
+			if (rigidBody == NULL)
+				break;
+		}
+
+		if (falconInterfaces[c.id]->isGodObjectSphere())
+			removeSphereGodObject(c.id);
+
+		if (c.godObject.body != NULL)
+			dynamicsWorld->addRigidBody(rigidBody);
+
+		falconInterfaces[c.id]->setGodObject(rigidBody, c.godObject.minDistToMaxForce, c.godObject.maxDistToMaxForce, c.godObject.body != NULL);
+		break;
+	}
+
+	case CMD_REMOVE_GOD_OBJECT:
+		if (falconInterfaces[c.id]->isGodObjectSphere())
+			removeSphereGodObject(c.id);
+
+		falconInterfaces[c.id]->setGodObject(0, 0, 0, false);
+		break;
 
-		maxForceLerpStart = maxForce;
-		maxForceLerpEnd = force;
+	case CMD_UPDATE_HAPTIC_TRANSFORM:
+		applyHapticTransform(c.haptic);
+		break;
 
-		dampingFactorLerpStart = this->dampingFactor;
-		dampingFactorLerpEnd = dampingFactor;
+	case CMD_SET_GRAVITY:
+		dynamicsWorld->setGravity(btVector3(c.force.force[0], c.force.force[1], c.force.force[2]));
+		break;
 
-		lerpTotalTime = time_in_secs;
-		lerpElapsedTime = 0;
+	case CMD_ADD_BODY:
+		//first see if the shape number is already in there, if so, delete it first
+		if (sentRigidBodies.find(c.id) != NULL) {
+			removeBody(c.id);
+		}
+		dynamicsWorld->addRigidBody(c.body.body);
+		sentRigidBodies.insert(c.id, c.body.body);
+		{
+			BodySnapshot bs;
+			bs.body_num = c.id;
+			bs.changed = 0;
+			bodyPoses.insert(bodyPoses.begin() + lowerBoundBody(bodyPoses, c.id), bs);
+			((TrackedMotionState *)c.body.body->getMotionState())->markDirty();
+		}
+		break;
+
+	case CMD_REMOVE_BODY:
+		if (! removeBody(c.id))
+			set_error("bad body number");
+		break;
+
+	case CMD_UPDATE_BODY: {
+		btRigidBody * rigidBody = findRigidBody(c.id);
+		if (rigidBody == NULL)
+			break;
+
+		btCollisionShape * sh = rigidBody->getCollisionShape();
+		float weight = c.body.weight;
+		if (weight != 0 && sh->isNonMoving()) {
+			set_error("static mesh bodies can't be given weight, send the shape again as a dynamic one");
+			weight = 0;
+		}
+		btVector3 inertia(0,0,0);
+		if (weight != 0)
+			sh->calculateLocalInertia(weight, inertia);
+
+		rigidBody->setMassProps(weight, inertia);
+		rigidBody->setRestitution(c.body.hardness);
+		rigidBody->setLinearFactor(btVector3(c.body.linearFactors[0], c.body.linearFactors[1], c.body.linearFactors[2]));
+		rigidBody->setAngularFactor(btVector3(c.body.angularFactors[0], c.body.angularFactors[1], c.body.angularFactors[2]));
+		rigidBody->setFriction(c.body.friction);
+		break;
 	}
 
-};
-
-//falcon info is architecture independent
-vector<FalconInterface *> falconInterfaces;
+	case CMD_SET_BODY_POSE: {
+		btRigidBody * rigidBody = findRigidBody(c.id);
+		if (rigidBody == NULL)
+			break;
+
+		btTransform pose(btQuaternion(c.body.orient[0],c.body.orient[1],c.body.orient[2],c.body.orient[3]),btVector3(c.body.pos[0],c.body.pos[1],c.body.pos[2]));
+		rigidBody->setWorldTransform(pose);
+		// bullet won't sync the motion state of a sleeping body, so the pose is published from here
+		rigidBody->getMotionState()->setWorldTransform(pose);
+		rigidBody->setLinearVelocity(btVector3(0,0,0));
+		rigidBody->setAngularVelocity(btVector3(0,0,0));
+		break;
+	}
 
-map<int, DampedSpring *> springs;
+	case CMD_APPLY_FORCE_TO_BODY: {
+		btRigidBody * rigidBody = findRigidBody(c.id);
+		if (rigidBody == NULL)
+			break;
 
-bool done=true;
-boost::thread handle_thread;
+		rigidBody->applyCentralForce(btVector3(c.body.pos[0],c.body.pos[1],c.body.pos[2]));
+		rigidBody->applyTorque(btVector3(c.body.orient[0],c.body.orient[1],c.body.orient[2]));
 
-#ifdef _WIN32
-bool testHDLError();
-HDLServoOpExitCode updateHDL(void* pUserData);
-#endif
-void updateHaptics();
-void set_error(string error);
-bool initCollisions();
-int initFalcons();
-bool check_falcon_num(int n);
-bool check_falcon_num(int n){
-    return (n>=0 && n<falconInterfaces.size());
-}
+		rigidBody->activate();
+		break;
+	}
 
-#ifndef _WIN32 
-void updateHaptics(){
-    
-    while(true){
-        if(done){
-            return;
-        }
-        for(int i=0;i<falcons.size();i++){
-            
-            FalconDevice * dev = falcons[i];
-            if(dev->runIOLoop()){
-            
-            if(falconInfo[i].homing){
-                    dev->getFalconFirmware()->setLEDStatus(libnifalcon::FalconFirmware::RED_LED);
-                if(dev->getFalconFirmware()->isHomed()){
-                    dev->getFalconFirmware()->setLEDStatus(libnifalcon::FalconFirmware::GREEN_LED);
-                    falconInfo[i].homing = false;
-                }
-                
-            }
-            else{
-                moveAndGenerateForces(i);
-            }
-            }
-            
-        }
-    }
-    
-}
-#else
+	case CMD_ADD_SPRING: {
+		const _falconunity_spring_params & s = c.spring;
+		btRigidBody * b = findRigidBody(c.body_num);
+		if (b == NULL)
+			break;
 
-HDLServoOpExitCode updateHDL(void* pUserData){
-	static CStopWatch stopWatch;
-	
-	stopWatch.stopTimer();
-	
-	float elapsedTime = (float)stopWatch.getElapsedTime();
-	stopWatch.startTimer();
+		springs.add(c.id, sentRigidBodies.handle(c.body_num), b, s.max_force, s.dampingFactor, btVector3(s.goalPos[0], s.goalPos[1], s.goalPos[2]), btQuaternion(s.goalOrient[0], s.goalOrient[1], s.goalOrient[2], s.goalOrient[3]),
+			btVector3(s.posConstraintLower[0], s.posConstraintLower[1], s.posConstraintLower[2]), btVector3(s.posConstraintUpper[0], s.posConstraintUpper[1], s.posConstraintUpper[2]),
+			btVector3(s.orientConstraintLower[0], s.orientConstraintLower[1], s.orientConstraintLower[2]), btVector3(s.orientConstraintUpper[0], s.orientConstraintUpper[1], s.orientConstraintUpper[2]), &(s.directionality[0]));
+		break;
+	}
 
-	frame_times[next_frame] = elapsedTime;
-	next_frame = (next_frame + 1) % TOTAL_FRAMES;
+	case CMD_REMOVE_SPRING: {
+		int i = findSpring(c.id);
+		if (i < 0)
+			break;
 
-//	if (elapsedTime > 0.005f) {
-//		printf("TimeBank: %f\n", elapsedTime);
-//		elapsedTime = 0.005f;
-//	}
+		springs.remove(i);
+		break;
+	}
 
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-//	dynamicsWorld->stepSimulation(elapsedTime, 20, 1.0f/2000.0f);
-	dynamicsWorld->stepSimulation(elapsedTime, 10, 1.0f/1000.0f);
-//	dynamicsWorld->stepSimulation(elapsedTime, 0); // sigh, this would be nice
-	lock_it.unlock();
+	case CMD_SET_SPRING:
+	case CMD_LERP_SPRING:
+		applySpringParams(c.spring, c.type == CMD_LERP_SPRING);
+		break;
 
-	for(unsigned int i=0;i<falconInterfaces.size();i++){
-		falconInterfaces[i]->update(elapsedTime);
+	case CMD_BATCH:
+		applyBatch(c.batch);
+		break;
 	}
+}
 
-	for (std::map<int,DampedSpring *>::iterator it=springs.begin(); it!=springs.end(); ++it) {
-		it->second->update(elapsedTime);
+// physics thread, at the start of a step
+void applyCommands() {
+	Command c;
+	while (commands.pop(c)) {
+		applyCommand(c);
 	}
+}
 
+// once the physics thread is gone, drop whatever it didn't get to
+void discardCommands() {
+	Command c;
+	while (commands.pop(c)) {
+		if (c.type == CMD_ADD_BODY)
+			deleteRigidBody(c.body.body);
+		else if (c.type == CMD_SET_GOD_OBJECT && c.godObject.body != NULL)
+			deleteRigidBody(c.godObject.body);
+	}
+}
 
-	return HDL_SERVOOP_CONTINUE;
+void fillSpringCommand(Command & c, int type, int spring_num, float max_force, float dampingFactor, float goalPos[3], float goalOrient[4], float posConstraintLower[3], float posConstraintUpper[3], float orientConstraintLower[3], float orientConstraintUpper[3], int directionality[6], float time_in_secs) {
+	c.type = type;
+	c.id = spring_num;
+	_falconunity_spring_params & s = c.spring;
+	s.spring_num = spring_num;
+	s.max_force = max_force;
+	s.dampingFactor = dampingFactor;
+	for (int i = 0; i < 3; i ++) {
+		s.goalPos[i] = goalPos[i];
+		s.posConstraintLower[i] = posConstraintLower[i];
+		s.posConstraintUpper[i] = posConstraintUpper[i];
+		s.orientConstraintLower[i] = orientConstraintLower[i];
+		s.orientConstraintUpper[i] = orientConstraintUpper[i];
+	}
+	for (int i = 0; i < 4; i ++) {
+		s.goalOrient[i] = goalOrient[i];
+	}
+	for (int i = 0; i < 6; i ++) {
+		s.directionality[i] = directionality != 0 ? directionality[i] : 0;
+	}
+	s.time_in_secs = time_in_secs;
 }
 
+void updatePhysics(){
+	CStopWatch stopWatch;
+	CStopWatch springWatch;
+	unsigned int step = 0;
 
-void updateHaptics(){
+	stopWatch.startTimer();
+	while(true){
+		if(done){
+			return;
+		}
 
-	
-	if (falconInterfaces.size() <= 0) {
+		stopWatch.stopTimer();
+		float elapsedTime = (float)stopWatch.getElapsedTime();
+		stopWatch.startTimer();
 
-		while(true) {
-			if (done) {
-				return;
-			}
+		boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
 
-			Sleep(1);
+		// everything the API queued since the last step
+		applyCommands();
 
-			updateHDL(0);
+		// couple god objects to the latest tip positions, and drive the springs
+		for(unsigned int i=0;i<falconInterfaces.size();i++){
+			falconInterfaces[i]->updatePhysics(elapsedTime);
 		}
+		springWatch.startTimer();
+		springs.update(elapsedTime);
+		springWatch.stopTimer();
+		springTime = (float)springWatch.getElapsedTime();
 
-	} else {
-
+		dynamicsWorld->stepSimulation(elapsedTime, PHYSICS_MAX_SUBSTEPS, PHYSICS_TIMESTEP);
+		step ++;
 
-		//create a servo op
-		servo_op = hdlCreateServoOp(updateHDL,
-									 (void*)0,
-									 false);
-		if(!testHDLError()){
-			set_error("error creating servo op");
-			return;
+		// hand the stepped god objects over to the servo loop
+		for(unsigned int i=0;i<falconInterfaces.size();i++){
+			falconInterfaces[i]->publishGodObject(step);
 		}
-		while(true){
-			if(done){
-				return;
-			}
-			Sleep(100);
-		} 
 
-	}
+		// and everything else over to the read APIs
+		publishSnapshot(step);
 
+		lock_it.unlock();
+
+		boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+	}
 }
-#endif
+
 #ifdef _WIN32
 bool testHDLError()
 {
@@ -1134,6 +2255,7 @@ bool testHDLError()
 }
 #endif
 void set_error(string error){
+    boost::mutex::scoped_lock lock(last_error_mutex);
     sprintf(last_error, "%s", error.c_str());
 }
 
@@ -1148,6 +2270,7 @@ void collisionCheckTickCallback(btDynamicsWorld *world, btScalar timeStep) {
 		int found = -1;
 		float rest = 0;
 		btScalar mass;
+		btScalar normalSign = 1; // normals point from body 1 to body 0
 		for (unsigned int k = 0; k < falconInterfaces.size(); k ++) {
 			btCollisionObject* test = falconInterfaces[k]->getGodObject();
 			if (test == obA) {
@@ -1159,6 +2282,7 @@ void collisionCheckTickCallback(btDynamicsWorld *world, btScalar timeStep) {
 				found = k;
 				rest = obA->getRestitution();
 				mass = obA->isStaticOrKinematicObject () ? 0 : 1;
+				normalSign = -1;
 				break;
 			} 
 		}
@@ -1171,7 +2295,7 @@ void collisionCheckTickCallback(btDynamicsWorld *world, btScalar timeStep) {
 			btManifoldPoint& pt = contactManifold->getContactPoint(j);
 			if (pt.getDistance()<=0.f)
 			{
-				falconInterfaces[found]->setHasCollided(rest, mass, pt.getAppliedImpulse());
+				falconInterfaces[found]->setHasCollided(rest, mass, pt.getAppliedImpulse(), pt.m_normalWorldOnB * normalSign);
 				break;
 			}
 		}
@@ -1228,6 +2352,7 @@ int initFalcons(){
         FalconDevice * dev = new FalconDevice();
 		falcons.push_back(dev);
         falconInfo.push_back(FalconInfo());
+		falconInterfaces.push_back(new FalconInterface(dev, MAX_FALCON_FORCE));
         
         
 		dev->setFalconFirmware<FalconFirmwareNovintSDK>();
@@ -1316,6 +2441,10 @@ bool closeFalconUnity(){
     if(!done){
         done = true;
         handle_thread.join();
+        physics_thread.join();
+        discardCommands();
+        clearBatches();
+        snapshots.clear();
         
 #ifdef _WIN32 
 
@@ -1336,21 +2465,24 @@ bool closeFalconUnity(){
 			hdlUninitDevice(falconInterfaces[i]->getHDLHandle());
 #endif
         }
+#ifndef _WIN32
+		falcons.clear();
+		falconInfo.clear();
+#endif
         //
         
         //remove the rigidbodies from the dynamics world and delete them
-   		for(std::vector<btRigidBody*>::iterator it = rigidBodies.begin(); it != rigidBodies.end(); ++it) {
-			btRigidBody* rb = (btRigidBody*)*it;
+   		for(unsigned int i = 0; i < sentRigidBodies.size(); i++) {
+			btRigidBody* rb = sentRigidBodies.at(i);
 			dynamicsWorld->removeRigidBody(rb);
-			delete rb->getMotionState();
-			delete rb->getCollisionShape();
-			delete rb;
+			deleteRigidBody(rb);
 		}
-
-		// delete springed objects
-		for (std::map<int,DampedSpring *>::iterator it=springs.begin(); it!=springs.end(); ++it) {
-			delete it->second;
+		for(unsigned int i = 0; i < falconInterfaces.size(); i++) {
+			if (falconInterfaces[i]->isGodObjectSphere())
+				removeSphereGodObject(i);
 		}
+
+		// delete springs
 		springs.clear();
 
         //delete dynamics world
@@ -1366,8 +2498,9 @@ bool closeFalconUnity(){
         
         delete collisionConfiguration;
 
-		rigidBodies.clear();
 		sentRigidBodies.clear();
+		bodyPoses.clear();
+		dirtyBodies.clear();
 		for (unsigned int i = 0; i < falconInterfaces.size(); i ++) {
 			delete falconInterfaces[i];
 		}
@@ -1381,24 +2514,35 @@ int initFalconUnity(){
     if(!done){
         closeFalconUnity();
     }
-	next_frame = 0;
+	{
+		boost::mutex::scoped_lock lock(frame_times_mutex);
+		next_frame = 0;
+	}
     if(!initCollisions()){
         return false;
     }
 	done = false;
+    discardCommands();
+    clearBatches();
     int num_falcons = initFalcons();
-    //start the thread
+    //start the threads
     handle_thread = boost::thread(updateHaptics);
+    physics_thread = boost::thread(updatePhysics);
     return num_falcons;
 }
 
 
+// the read APIs serve from the latest snapshot, they never take collision_mutex
+
 bool getTipPosition(int falcon_num, float pos_out[3]){
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
 
-	btVector3 p = falconInterfaces[falcon_num]->getPosition();
+	boost::mutex::scoped_lock lock_it( snapshots.readerMutex ) ;
+	const WorldSnapshot & s = snapshots.getFront();
+	if ((size_t)falcon_num >= s.falcons.size()) {set_error("falcon not simulated yet"); return false;}
+
     for(int i=0;i<3;i++){
-        pos_out[i] = (float)p[i];
+        pos_out[i] = s.falcons[falcon_num].tipPosition[i];
     }
 	
     return true;
@@ -1407,18 +2551,17 @@ bool getTipPosition(int falcon_num, float pos_out[3]){
 bool getGodPosition(int falcon_num, float pos_out[3]){
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
 
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-	btRigidBody * go = falconInterfaces[falcon_num]->getGodObject();
-	if (go == 0) {
+	boost::mutex::scoped_lock lock_it( snapshots.readerMutex ) ;
+	const WorldSnapshot & s = snapshots.getFront();
+	if ((size_t)falcon_num >= s.falcons.size() || ! s.falcons[falcon_num].hasGodObject) {
 		for(int i=0;i<3;i++){
 			pos_out[i] = 0;
 		}
 		set_error("Falcon does not have a God Object set (call setSphereGodObject())");
 		return false;
 	}
-	btVector3 p = go->getWorldTransform().getOrigin();
     for(int i=0;i<3;i++){
-        pos_out[i] = (float)p[i];
+        pos_out[i] = s.falcons[falcon_num].godPosition[i];
     }
     return true;
 }
@@ -1426,9 +2569,12 @@ bool getGodPosition(int falcon_num, float pos_out[3]){
 bool getFalconForces(int falcon_num, float force_out[3]){
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
 
-	btVector3 p = falconInterfaces[falcon_num]->getAveragedForces();
+	boost::mutex::scoped_lock lock_it( snapshots.readerMutex ) ;
+	const WorldSnapshot & s = snapshots.getFront();
+	if ((size_t)falcon_num >= s.falcons.size()) {set_error("falcon not simulated yet"); return false;}
+
     for(int i=0;i<3;i++){
-        force_out[i] = (float)p[i];
+        force_out[i] = s.falcons[falcon_num].forces[i];
     }
 	
     return true;
@@ -1437,20 +2583,31 @@ bool getFalconForces(int falcon_num, float force_out[3]){
 bool setForceField(int falcon_num, float force[3]){
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
 
-	btVector3 f(force[0], force[1], force[2]);
-	falconInterfaces[falcon_num]->setConstantForce(f);
-    return true;
+	Command c;
+	c.type = CMD_SET_FORCE_FIELD;
+	c.id = falcon_num;
+	for (int i = 0; i < 3; i ++) {
+		c.force.force[i] = force[i];
+	}
+	c.force.time_in_secs = 0;
+    return queueCommand(c);
 }
 bool applyForce(int falcon_num, float force[3], float time_in_secs){
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
 	
-	btVector3 f(force[0], force[1], force[2]);
-	falconInterfaces[falcon_num]->applyForce(f, time_in_secs);
-    return true;
+	Command c;
+	c.type = CMD_APPLY_FORCE;
+	c.id = falcon_num;
+	for (int i = 0; i < 3; i ++) {
+		c.force.force[i] = force[i];
+	}
+	c.force.time_in_secs = time_in_secs;
+    return queueCommand(c);
 }
 
 void getLastError(char * buffer){ //pass the error out
     
+    boost::mutex::scoped_lock lock(last_error_mutex);
     sprintf(buffer, "%s", last_error);
     
 }
@@ -1458,17 +2615,13 @@ void getLastError(char * buffer){ //pass the error out
 bool getFalconButtonStates(int falcon_num, int buttons[4]){
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
 
-#ifndef _WIN32
-    for(int i=0;i<4;i++){
-        buttons[i] = falcons[falcon_num]->getFalconGrip()->getDigitalInput(i)?1:0;
-    }  
+	boost::mutex::scoped_lock lock_it( snapshots.readerMutex ) ;
+	const WorldSnapshot & s = snapshots.getFront();
+	if ((size_t)falcon_num >= s.falcons.size()) {set_error("falcon not simulated yet"); return false;}
 
-#else
-	buttons[0] = falconInterfaces[falcon_num]->getButtonState(0);
-	buttons[1] = falconInterfaces[falcon_num]->getButtonState(1);
-	buttons[2] = falconInterfaces[falcon_num]->getButtonState(2);
-	buttons[3] = falconInterfaces[falcon_num]->getButtonState(3);
-#endif
+    for(int i=0;i<4;i++){
+        buttons[i] = s.falcons[falcon_num].buttons[i];
+    }
 
     return true;
 }
@@ -1477,30 +2630,17 @@ void removeSphereGodObject(int falcon_num) {
 	btRigidBody * oldRigidBody = falconInterfaces[falcon_num]->getGodObject();
 
 	if (oldRigidBody != NULL) {
-		for(unsigned int i = 0;i< rigidBodies.size();i++){
-			if(oldRigidBody == rigidBodies[i]){
-				rigidBodies.erase(rigidBodies.begin()+i);
-				break;
-			}
-		}
 		//delete from bullet
 		dynamicsWorld->removeRigidBody(oldRigidBody);
 		//delete actual data
-		delete oldRigidBody->getMotionState();
-		delete oldRigidBody->getCollisionShape();
-		delete oldRigidBody;
+		deleteRigidBody(oldRigidBody);
 		
 	}
 }
 
 bool setSphereGodObject(int falcon_num, float radius, float mass, float pos[3], float minDistToMaxForce, float maxDistToMaxForce) {        
-    boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;    
-
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
     
-	if (falconInterfaces[falcon_num]->isGodObjectSphere())
-		removeSphereGodObject(falcon_num);
-
 	btCollisionShape * sh = new btSphereShape(radius);
     sh->setMargin(0.f); 
 
@@ -1515,47 +2655,44 @@ bool setSphereGodObject(int falcon_num, float radius, float mass, float pos[3],
 	rigidBody->setAngularFactor(0);
 	rigidBody->setDamping(0, 0);
 //	rigidBody->setFriction(0);
-	dynamicsWorld->addRigidBody(rigidBody);
 
-	rigidBodies.push_back(rigidBody);
-
-	falconInterfaces[falcon_num]->setGodObject(rigidBody, minDistToMaxForce, maxDistToMaxForce, true);
+	// the physics thread swaps out the old sphere and adds this one to the world
+	Command c;
+	c.type = CMD_SET_GOD_OBJECT;
+	c.id = falcon_num;
+	c.body_num = -1;
+	c.godObject.body = rigidBody;
+	c.godObject.minDistToMaxForce = minDistToMaxForce;
+	c.godObject.maxDistToMaxForce = maxDistToMaxForce;
+	if (!queueCommand(c)) {
+		deleteRigidBody(rigidBody);
+		return false;
+	}
 	return true;
 }
 
 
 bool setRigidBodyGodObject(int falcon_num, int body_num, float minDistToMaxForce, float maxDistToMaxForce) {        
-    boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;    
-
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
     
-	map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it == sentRigidBodies.end()){
-        return false;
-    }
-	btRigidBody * rigidBody = it->second;
-
-	if (falconInterfaces[falcon_num]->isGodObjectSphere())
-		removeSphereGodObject(falcon_num);
-
-
-	falconInterfaces[falcon_num]->setGodObject(rigidBody, minDistToMaxForce, maxDistToMaxForce, false);
-	return true;
+	Command c;
+	c.type = CMD_SET_GOD_OBJECT;
+	c.id = falcon_num;
+	c.body_num = body_num;
+	c.godObject.body = NULL;
+	c.godObject.minDistToMaxForce = minDistToMaxForce;
+	c.godObject.maxDistToMaxForce = maxDistToMaxForce;
+	return queueCommand(c);
 
 }
 
 bool removeGodObject(int falcon_num) {
-    boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;    
-
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
     
-	if (falconInterfaces[falcon_num]->isGodObjectSphere())
-		removeSphereGodObject(falcon_num);
-
-
-	falconInterfaces[falcon_num]->setGodObject(0, 0, 0, false);
-
-	return true;
+	Command c;
+	c.type = CMD_REMOVE_GOD_OBJECT;
+	c.id = falcon_num;
+	return queueCommand(c);
 }
 
 
@@ -1575,51 +2712,36 @@ bool getCalibrated(int falcon_num){
 
 
 
-bool sendDynamicShape(int body_num, float * shape, int num_tris, float weight, float k, float startPos[3], float startOrient[4], float linearFactors[3], float angularFactors[3], float friction) {
+bool sendDynamicShapeWithType(int body_num, float * shape, int num_tris, float weight, float k, float startPos[3], float startOrient[4], float linearFactors[3], float angularFactors[3], float friction, int shape_type) {
     if(k<0 || k > 1){
         set_error("invalid hardness, must be between 0 and 1");
         return false;
     }
+	// hashShape walks num_tris * 9 floats, and a shape without triangles has no inertia to speak of
+	if (shape == NULL || num_tris <= 0) {
+		set_error("shape must have at least one triangle");
+		return false;
+	}
         
-    boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;    
-    
-    //first see if the shape number is already in there, if so, delete it first
-    map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it != sentRigidBodies.end()){ 
-        removeDynamicShape(body_num); //alread there, delete it
-    }
-	
-/*	btConvexHullShape * sh = new btConvexHullShape();
-    for(int i=0;i<num_tris;i++){
-        float * p = shape+i*3;
-        btVector3 v1(p[0],p[1],p[2]);
-		sh->addPoint(v1);
-    }
-	sh->recalcLocalAabb();
-	*/
-	
-    btTriangleMesh * m = new btTriangleMesh();
-    for(int i=0;i<num_tris;i++){
-        float * p = shape+i*9;
-        btVector3 v1(p[0],p[1],p[2]);
-        btVector3 v2(p[3],p[4],p[5]);
-        btVector3 v3(p[6],p[7],p[8]);
-        m->addTriangle(v1,v2,v3);
-    }
-    
-	btGImpactMeshShape * sh = new btGImpactMeshShape(m);
-	sh->setLocalScaling(btVector3(1.f,1.f,1.f));
-	sh->updateBound(); 
-
-//    btCollisionShape * sh = new btConvexTriangleMeshShape(m,true); 
+	int type = resolveShapeType(shape_type, weight);
+	if (type < FALCONUNITY_SHAPE_AUTO || type > FALCONUNITY_SHAPE_STATIC_MESH) {
+		set_error("invalid shape type");
+		return false;
+	}
+	if (type == FALCONUNITY_SHAPE_STATIC_MESH && weight != 0) {
+		set_error("static meshes must have zero weight");
+		return false;
+	}
 
-    sh->setMargin(0.0055f); 
+    //the shape and body are built here, on the caller's thread, the physics thread only adds them to the world
+	btCollisionShape * sh = acquireShape(type, shape, num_tris);
 	
-    btDefaultMotionState* motionState = new btDefaultMotionState(btTransform(btQuaternion(startOrient[0],startOrient[1],startOrient[2],startOrient[3]),btVector3(startPos[0],startPos[1],startPos[2])));
+    TrackedMotionState* motionState = new TrackedMotionState(body_num, btTransform(btQuaternion(startOrient[0],startOrient[1],startOrient[2],startOrient[3]),btVector3(startPos[0],startPos[1],startPos[2])));
 	btScalar mass = weight;
     btVector3 inertia(0,0,0);
 
-    sh->calculateLocalInertia(mass,inertia);
+	if (mass != 0)
+		sh->calculateLocalInertia(mass,inertia);
     btRigidBody::btRigidBodyConstructionInfo rigidBodyCI(mass,motionState,sh,inertia);
     
 	btRigidBody* rigidBody = new btRigidBody(rigidBodyCI);
@@ -1628,285 +2750,305 @@ bool sendDynamicShape(int body_num, float * shape, int num_tris, float weight, f
 	rigidBody->setAngularFactor(btVector3(angularFactors[0], angularFactors[1], angularFactors[2]));
 	rigidBody->setFriction(friction);
 //	rigidBody->setDamping(0,0);
-	dynamicsWorld->addRigidBody(rigidBody);
-	
-	rigidBodies.push_back(rigidBody);
-	sentRigidBodies[body_num] = rigidBody;
+
+	Command c;
+	c.type = CMD_ADD_BODY;
+	c.id = body_num;
+	c.body.body = rigidBody;
+	if (!queueCommand(c)) {
+		deleteRigidBody(rigidBody);
+		return false;
+	}
 
 	return true;
      
 }
 
-bool removeDynamicShape(int body_num) {
+bool sendDynamicShape(int body_num, float * shape, int num_tris, float weight, float k, float startPos[3], float startOrient[4], float linearFactors[3], float angularFactors[3], float friction) {
+	return sendDynamicShapeWithType(body_num, shape, num_tris, weight, k, startPos, startOrient, linearFactors, angularFactors, friction, FALCONUNITY_SHAPE_AUTO);
+}
 
-    boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-    //delete from the collision objects array we maintain
-	map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it == sentRigidBodies.end()){
+// physics thread
+bool removeBody(int body_num) {
+	btRigidBody ** b = sentRigidBodies.find(body_num);
+    if(b == NULL){
         return false;
     }
-    for(unsigned int i = 0;i< rigidBodies.size();i++){
-        if(it->second == rigidBodies[i]){
-            rigidBodies.erase(rigidBodies.begin()+i);
-            break;
-        }
-    }
+	btRigidBody * rb = *b;
     //delete from bullet
-    dynamicsWorld->removeRigidBody(it->second);
+    dynamicsWorld->removeRigidBody(rb);
+    //drop its pose; its springs notice their handle has gone stale and go at the next step
+	((TrackedMotionState *)rb->getMotionState())->clearDirty();
+	bodyPoses.erase(bodyPoses.begin() + lowerBoundBody(bodyPoses, body_num));
     //delete actual data
-	delete it->second->getMotionState();
-	delete it->second->getCollisionShape();
-    delete it->second;
-    //delete from our list
-    sentRigidBodies.erase(it);
+	deleteRigidBody(rb);
+    //delete from our list, which bumps the slot's generation
+    sentRigidBodies.remove(body_num);
     return true;
 }
 
-bool updateDynamicShape(int body_num, float weight, float hardness, float linearFactors[3], float angularFactors[3], float friction ) {
-
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it == sentRigidBodies.end()){
-        return false;
-    }
+bool removeDynamicShape(int body_num) {
+	Command c;
+	c.type = CMD_REMOVE_BODY;
+	c.id = body_num;
+	return queueCommand(c);
+}
 
-	btRigidBody * rigidBody = it->second;
-	btCollisionShape * sh = rigidBody->getCollisionShape();
-	btVector3 inertia(0,0,0);
-	sh->calculateLocalInertia(weight, inertia);
+bool updateDynamicShape(int body_num, float weight, float hardness, float linearFactors[3], float angularFactors[3], float friction ) {
 
-	rigidBody->setMassProps(weight, inertia);
-	rigidBody->setRestitution(hardness);
-	rigidBody->setLinearFactor(btVector3(linearFactors[0], linearFactors[1], linearFactors[2]));
-	rigidBody->setAngularFactor(btVector3(angularFactors[0], angularFactors[1], angularFactors[2]));
-	rigidBody->setFriction(friction);
+	Command c;
+	c.type = CMD_UPDATE_BODY;
+	c.id = body_num;
+	c.body.weight = weight;
+	c.body.hardness = hardness;
+	for (int i = 0; i < 3; i ++) {
+		c.body.linearFactors[i] = linearFactors[i];
+		c.body.angularFactors[i] = angularFactors[i];
+	}
+	c.body.friction = friction;
 
-	return true;
+	return queueCommand(c);
 }
 
 bool setDynamicShapePose(int body_num,float startPos[3], float startOrient[4]) {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it == sentRigidBodies.end()){
-        return false;
-    }
-	btRigidBody * rigidBody = it->second;
-
-	rigidBody->setWorldTransform(btTransform(btQuaternion(startOrient[0],startOrient[1],startOrient[2],startOrient[3]),btVector3(startPos[0],startPos[1],startPos[2])));
-	rigidBody->setLinearVelocity(btVector3(0,0,0));
-	rigidBody->setAngularVelocity(btVector3(0,0,0));
+	Command c;
+	c.type = CMD_SET_BODY_POSE;
+	c.id = body_num;
+	for (int i = 0; i < 3; i ++) {
+		c.body.pos[i] = startPos[i];
+	}
+	for (int i = 0; i < 4; i ++) {
+		c.body.orient[i] = startOrient[i];
+	}
 
-	return true;
+	return queueCommand(c);
 }
 
 bool applyForceToShape(int body_num, float linear[3], float torque[3]) {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it == sentRigidBodies.end()){
-        return false;
-    }
-	btRigidBody * rigidBody = it->second;
-
-	rigidBody->applyCentralForce(btVector3(linear[0],linear[1],linear[2]));
-	rigidBody->applyTorque(btVector3(torque[0],torque[1],torque[2]));
-
-	rigidBody->activate();
+	Command c;
+	c.type = CMD_APPLY_FORCE_TO_BODY;
+	c.id = body_num;
+	for (int i = 0; i < 3; i ++) {
+		c.body.pos[i] = linear[i];
+		c.body.orient[i] = torque[i];
+	}
 
-	return true;
+	return queueCommand(c);
 }
 
 bool getDynamicShapePose(int body_num, float pos[3], float orient[4]) {
 
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
+	boost::mutex::scoped_lock lock_it( snapshots.readerMutex ) ;
 
-	map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it == sentRigidBodies.end()){
+	// bodies show up once they've been through a physics step
+	const BodySnapshot * b = findBody(snapshots.getFront(), body_num);
+    if(b == NULL){
         return false;
     }
-	btTransform trans;
-	it->second->getMotionState()->getWorldTransform(trans);
-	btVector3 p = trans.getOrigin();
-	btQuaternion q = trans.getRotation();
-
-	pos[0] = p.getX();
-	pos[1] = p.getY();
-	pos[2] = p.getZ();
-	
-	orient[0] = q.getX();
-	orient[1] = q.getY();
-	orient[2] = q.getZ();
-	orient[3] = q.getW();
+
+	for (int i = 0; i < 3; i ++) {
+		pos[i] = b->pos[i];
+	}
+	for (int i = 0; i < 4; i ++) {
+		orient[i] = b->orient[i];
+	}
 
 	return true;
 }
 
 
 bool addSpringToShape(int body_num, int spring_num, float max_force, float dampingFactor, float goalPos[3], float goalOrient[4], float posConstraintLower[3], float posConstraintUpper[3], float orientConstraintLower[3], float orientConstraintUpper[3], int directionality[6]) {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	map<int, btRigidBody *>::iterator it = sentRigidBodies.find(body_num);
-    if(it == sentRigidBodies.end()){
-        return false;
-    }
-	btRigidBody * b = it->second;
-
-	btVector3 goal(goalPos[0], goalPos[1], goalPos[2]);
-	btVector3 pConstl(posConstraintLower[0], posConstraintLower[1], posConstraintLower[2]);
-	btVector3 pConstu(posConstraintUpper[0], posConstraintUpper[1], posConstraintUpper[2]);
-	btQuaternion orient(goalOrient[0], goalOrient[1], goalOrient[2], goalOrient[3]);
-	btVector3 oConstl(orientConstraintLower[0], orientConstraintLower[1], orientConstraintLower[2]);
-	btVector3 oConstu(orientConstraintUpper[0], orientConstraintUpper[1], orientConstraintUpper[2]);
-
-	DampedSpring * so = new DampedSpring(b, max_force, dampingFactor, goal, orient, pConstl, pConstu, oConstl, oConstu, &(directionality[0]));
+	Command c;
+	fillSpringCommand(c, CMD_ADD_SPRING, spring_num, max_force, dampingFactor, goalPos, goalOrient, posConstraintLower, posConstraintUpper, orientConstraintLower, orientConstraintUpper, directionality, 0);
+	c.body_num = body_num;
 
-	springs[spring_num] = so;
-
-	return true;
+	return queueCommand(c);
 }
 
 bool removeSpring(int spring_num) {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	map<int, DampedSpring *>::iterator it = springs.find(spring_num);
-    if(it == springs.end()){
-        return false;
-    }
-
-	delete it->second;
-	springs.erase(it);
+	Command c;
+	c.type = CMD_REMOVE_SPRING;
+	c.id = spring_num;
 
-	return true;
+	return queueCommand(c);
 }
 
 bool setSpring(int spring_num, float max_force, float dampingFactor, float goalPos[3], float goalOrient[4], float posConstraintLower[3], float posConstraintUpper[3], float orientConstraintLower[3], float orientConstraintUpper[3], int directionality[6]) {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	map<int, DampedSpring *>::iterator it = springs.find(spring_num);
-    if(it == springs.end()){
-        return false;
-    }
-
-	btVector3 goal(goalPos[0], goalPos[1], goalPos[2]);
-	btVector3 pConstl(posConstraintLower[0], posConstraintLower[1], posConstraintLower[2]);
-	btVector3 pConstu(posConstraintUpper[0], posConstraintUpper[1], posConstraintUpper[2]);
-	btQuaternion orient(goalOrient[0], goalOrient[1], goalOrient[2], goalOrient[3]);
-	btVector3 oConstl(orientConstraintLower[0], orientConstraintLower[1], orientConstraintLower[2]);
-	btVector3 oConstu(orientConstraintUpper[0], orientConstraintUpper[1], orientConstraintUpper[2]);
-
-	it->second->setParams(max_force, dampingFactor, goal, orient, pConstl, pConstu, oConstl, oConstu, &(directionality[0]));
+	Command c;
+	fillSpringCommand(c, CMD_SET_SPRING, spring_num, max_force, dampingFactor, goalPos, goalOrient, posConstraintLower, posConstraintUpper, orientConstraintLower, orientConstraintUpper, directionality, 0);
 
-	return true;
+	return queueCommand(c);
 }
 
 
 bool lerpSpring(int spring_num, float max_force, float dampingFactor, float goalPos[3], float goalOrient[4], float posConstraintLower[3], float posConstraintUpper[3], float orientConstraintLower[3], float orientConstraintUpper[3], int directionality[6], float time_in_secs) {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	map<int, DampedSpring *>::iterator it = springs.find(spring_num);
-    if(it == springs.end()){
-        return false;
-    }
+	Command c;
+	fillSpringCommand(c, CMD_LERP_SPRING, spring_num, max_force, dampingFactor, goalPos, goalOrient, posConstraintLower, posConstraintUpper, orientConstraintLower, orientConstraintUpper, directionality, time_in_secs);
 
-	btVector3 goal(goalPos[0], goalPos[1], goalPos[2]);
-	btVector3 pConstl(posConstraintLower[0], posConstraintLower[1], posConstraintLower[2]);
-	btVector3 pConstu(posConstraintUpper[0], posConstraintUpper[1], posConstraintUpper[2]);
-	btQuaternion orient(goalOrient[0], goalOrient[1], goalOrient[2], goalOrient[3]);
-	btVector3 oConstl(orientConstraintLower[0], orientConstraintLower[1], orientConstraintLower[2]);
-	btVector3 oConstu(orientConstraintUpper[0], orientConstraintUpper[1], orientConstraintUpper[2]);
-
-	it->second->lerpParams(max_force, dampingFactor, goal, orient, pConstl, pConstu, oConstl, oConstu, &(directionality[0]), time_in_secs);
-
-	return true;
+	return queueCommand(c);
 }
 
 float getFPS() {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
+	boost::mutex::scoped_lock lock_it( snapshots.readerMutex ) ;
 
-	float sum = 0;
+	return snapshots.getFront().fps;
+}
 
-	for (int i = 0; i < TOTAL_FRAMES; i ++) {
-		sum += frame_times[i];
-	}
+float getSpringUpdateTime() {
+	boost::mutex::scoped_lock lock_it( snapshots.readerMutex ) ;
 
-	return 1.0f / ( sum / TOTAL_FRAMES);
+	return snapshots.getFront().springTime;
 }
 
 
 bool startLog(int falcon_num) {
-//	falconInterfaces[falcon_num]->startLogging();
-	return false;
+    if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
+
+	falconInterfaces[falcon_num]->startLogging();
+	return true;
 }
 
 bool stopLog(int falcon_num, int & num_entries, float * god_obj_positions, float * haptic_tip_positions, float * god_obj_forces, float * haptic_tip_forces, float * delta_ts) {
+    if(!check_falcon_num(falcon_num)){num_entries = 0; set_error("bad falcon number"); return false;}
 
-//	falconInterfaces[falcon_num]->stopLogging();
-	return false;
+	unsigned int lost = falconInterfaces[falcon_num]->stopLogging(num_entries, god_obj_positions, haptic_tip_positions, god_obj_forces, haptic_tip_forces, delta_ts);
+	if (lost > 0) {
+		char buffer[64];
+		sprintf(buffer, "log truncated, %u ticks lost", lost);
+		set_error(buffer);
+		return false;
+	}
+	return true;
 }
 
 
 bool setGravity(float force[3]) {
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
-
-	dynamicsWorld->setGravity(btVector3(force[0],force[1],force[2]));
-	return true;
+	Command c;
+	c.type = CMD_SET_GRAVITY;
+	c.id = 0;
+	for (int i = 0; i < 3; i ++) {
+		c.force.force[i] = force[i];
+	}
+	c.force.time_in_secs = 0;
+	return queueCommand(c);
 }
 
 
 bool updateHapticTransform(int falcon_num, float * pos, float * rot, float * scale, bool useCompensator, float time_in_secs) {
 
-   boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;    
-
     if(!check_falcon_num(falcon_num)){set_error("bad falcon number"); return false;}
 
-	falconInterfaces[falcon_num]->setTransform(btTransform(btQuaternion(rot[0], rot[1], rot[2], rot[3]), btVector3(pos[0], pos[1], pos[2])), btVector3(scale[0], scale[1], scale[2]), useCompensator, time_in_secs);
+	Command c;
+	c.type = CMD_UPDATE_HAPTIC_TRANSFORM;
+	c.id = falcon_num;
+	_falconunity_haptic_tip_params & h = c.haptic;
+	h.falcon_num = falcon_num;
+	for (int i = 0; i < 3; i ++) {
+		h.pos[i] = pos[i];
+		h.scale[i] = scale[i];
+	}
+	for (int i = 0; i < 4; i ++) {
+		h.orient[i] = rot[i];
+	}
+	h.useCompensator = useCompensator;
+	h.time_in_secs = time_in_secs;
 
-	return true;
+	return queueCommand(c);
 }
 
 
-bool falcon_update_all(std::vector<_falconunity_haptic_tip_params *> haptic_params, std::vector<_falconunity_spring_params *> spring_params, float * fps, std::vector<_falconunity_falcon_params *> * falcon_params, std::vector<_falconunity_object_params *> * object_params) {
+bool falcon_update_batch(const _falconunity_haptic_tip_params * haptic_params, int num_haptic_params, const _falconunity_spring_params * spring_params, int num_spring_params,
+	_falconunity_falcon_params * falcon_params, int max_falcon_params, int * num_falcon_params, _falconunity_object_params * object_params, int max_object_params, int * num_object_params,
+	unsigned int * last_step, float * fps) {
 
-	boost::recursive_mutex::scoped_lock lock_it( collision_mutex ) ;
+	bool ok = true;
 
-	for (unsigned int i = 0; i < haptic_params.size(); i ++) {
-		updateHapticTransform(haptic_params[i]->falcon_num, haptic_params[i]->pos, haptic_params[i]->orient, haptic_params[i]->scale, haptic_params[i]->useCompensator, haptic_params[i]->time_in_secs);
+	// inputs go to the next physics step as one command, so the whole batch is taken or none of it is
+	for (int i = 0; i < num_haptic_params; i ++) {
+		if (! check_falcon_num(haptic_params[i].falcon_num)) {
+			set_error("bad falcon number");
+			ok = false;
+		}
 	}
-
-	for (unsigned int i = 0; i < spring_params.size(); i ++) {
-		lerpSpring(spring_params[i]->spring_num, spring_params[i]->max_force, spring_params[i]->dampingFactor, spring_params[i]->goalPos, spring_params[i]->goalOrient, spring_params[i]->posConstraintLower, spring_params[i]->posConstraintUpper, spring_params[i]->orientConstraintLower, spring_params[i]->orientConstraintUpper, spring_params[i]->directionality, spring_params[i]->time_in_secs);
+	if (ok && (num_haptic_params > 0 || num_spring_params > 0)) {
+		boost::mutex::scoped_lock lock_batch( batch_mutex ) ;
+		BatchBuffer & b = batchBuffers[batchBack];
+		size_t num_haptics = b.haptics.size();
+		size_t num_springs = b.springs.size();
+		if (num_haptic_params > 0)
+			b.haptics.insert(b.haptics.end(), haptic_params, haptic_params + num_haptic_params);
+		if (num_spring_params > 0)
+			b.springs.insert(b.springs.end(), spring_params, spring_params + num_spring_params);
+
+		Command c;
+		c.type = CMD_BATCH;
+		c.id = 0;
+		c.batch.generation = batchGeneration;
+		c.batch.hapticEnd = (unsigned int)b.haptics.size();
+		c.batch.springEnd = (unsigned int)b.springs.size();
+		if (! queueCommand(c)) {
+			b.haptics.resize(num_haptics);
+			b.springs.resize(num_springs);
+			ok = false;
+		}
 	}
 
-	for (unsigned int i = 0; i < falconInterfaces.size(); i ++) {
-		_falconunity_falcon_params * temp = new _falconunity_falcon_params();
+	// everything is read from one snapshot, so falcons and bodies are from the same step
+	boost::mutex::scoped_lock lock_snapshot( snapshots.readerMutex ) ;
+	const WorldSnapshot & s = snapshots.getFront();
+
+	int num_falcons = (int)s.falcons.size();
+	for (int i = 0; i < num_falcons && i < max_falcon_params; i ++) {
+		_falconunity_falcon_params & out = falcon_params[i];
+		const FalconSnapshot & fs = s.falcons[i];
 		
-		getFalconButtonStates(i, temp->buttons);
+		for (int j = 0; j < 4; j ++) {
+			out.buttons[j] = fs.buttons[j];
+		}
+		for (int j = 0; j < 3; j ++) {
+			out.godPositions[j] = fs.hasGodObject ? fs.godPosition[j] : 0;
+			out.tipPositions[j] = fs.tipPosition[j];
+			out.curforces[j] = fs.forces[j];
+		}
+		out.falcon_num = i;
+	}
 
-		getGodPosition(i, temp->godPositions);
-		getTipPosition(i, temp->tipPositions);
-		getFalconForces(i, temp->curforces);
-		temp->falcon_num = i;
+	// only the bodies that moved since the caller's last call, packed.  a cursor past the current step is from
+	// before a restart, so everything is reported again
+	unsigned int since = (last_step != NULL && *last_step <= s.step) ? *last_step : 0;
+	int num_bodies = 0;
+	for (unsigned int i = 0; i < s.bodies.size(); i ++) {
+		const BodySnapshot & bs = s.bodies[i];
+		if (bs.changed <= since)
+			continue;
 
-		(*falcon_params).push_back(temp);
+		if (num_bodies < max_object_params) {
+			_falconunity_object_params & out = object_params[num_bodies];
+			out.object_num = bs.body_num;
+			for (int j = 0; j < 3; j ++) {
+				out.pos[j] = bs.pos[j];
+			}
+			for (int j = 0; j < 4; j ++) {
+				out.orient[j] = bs.orient[j];
+			}
+		}
+		num_bodies ++;
 	}
 
-	for (std::map<int,btRigidBody *>::iterator it=sentRigidBodies.begin(); it!=sentRigidBodies.end(); ++it) {
-		_falconunity_object_params * temp = new _falconunity_object_params();
-		
-		temp->object_num = it->first;
-		getDynamicShapePose(it->first, temp->pos, temp->orient);
-		
-		(*object_params).push_back(temp);
+	// if some didn't fit, the next call reports them all again
+	if (last_step != NULL && num_bodies <= max_object_params) {
+		*last_step = s.step;
 	}
 
-	*fps = getFPS();
+	*num_falcon_params = num_falcons;
+	*num_object_params = num_bodies;
+	*fps = s.fps;
 
-	return true;
+	return ok;
 }
 
 
+#ifdef _WIN32
 BOOL WINAPI DllMain(
     HINSTANCE hinstDLL,  // handle to DLL module
     DWORD fdwReason,     // reason for calling function
@@ -1937,3 +3079,4 @@ BOOL WINAPI DllMain(
     }
     return TRUE;  // Successful DLL_PROCESS_ATTACH.
 }
+#endif
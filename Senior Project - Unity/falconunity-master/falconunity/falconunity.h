@@ -56,11 +56,17 @@ struct _falconunity_haptic_tip_params {
 	float pos[3];
 	float orient[4];
 	float scale[3];
-	bool useCompensator;
+	int useCompensator;		// int rather than bool, so the struct has the same layout in C#
 	float time_in_secs;
 
 };
 
+// collision shapes for sendDynamicShapeWithType
+#define FALCONUNITY_SHAPE_AUTO			0	// static mesh if weight is 0, convex hull otherwise
+#define FALCONUNITY_SHAPE_GIMPACT		1	// concave and dynamic
+#define FALCONUNITY_SHAPE_CONVEX_HULL	2	// hull of the triangles
+#define FALCONUNITY_SHAPE_STATIC_MESH	3	// concave, weight must be 0
+
 #ifdef _WIN32
 #define DLLEXPORT __declspec(dllexport)
 #else
@@ -70,6 +76,7 @@ extern "C" {
     DLLEXPORT int initFalconUnity(); //returns number of falcons
     DLLEXPORT bool closeFalconUnity(); //close all falcons
 	DLLEXPORT float getFPS();
+	DLLEXPORT float getSpringUpdateTime(); //seconds the last physics step spent on springs, for profiling
 
 
 	DLLEXPORT bool getTipPosition(int falcon_num, float pos_out[3]);
@@ -79,8 +86,8 @@ extern "C" {
     DLLEXPORT void getLastError(char * buffer); //pass the error out
     DLLEXPORT bool getCalibrated(int falcon_num);
 
-	DLLEXPORT bool startLog(int falcon_num);
-	DLLEXPORT bool stopLog(int falcon_num, int & num_entries, float * god_obj_positions, float * haptic_tip_positions, float * god_obj_forces, float * haptic_tip_forces, float * delta_ts);
+	DLLEXPORT bool startLog(int falcon_num); //record every servo tick, up to about a minute
+	DLLEXPORT bool stopLog(int falcon_num, int & num_entries, float * god_obj_positions, float * haptic_tip_positions, float * god_obj_forces, float * haptic_tip_forces, float * delta_ts); //num_entries in: room in the arrays, out: ticks copied. false if any were lost
 
 	DLLEXPORT bool setForceField(int falcon_num, float force[3]); //set the falcon to send this constant force
     DLLEXPORT bool setSphereGodObject(int falcon_num, float radius, float mass, float pos[3], float minDistToMaxForce, float maxDistToMaxForce); //set end effector to a sphere    
@@ -91,6 +98,7 @@ extern "C" {
 	DLLEXPORT bool setGravity(float force[3]);
 
     DLLEXPORT bool sendDynamicShape(int body_num, float * shape, int num_tris, float weight, float hardness, float startPos[3], float startOrient[4], float linearFactors[3], float angularFactors[3], float friction );
+    DLLEXPORT bool sendDynamicShapeWithType(int body_num, float * shape, int num_tris, float weight, float hardness, float startPos[3], float startOrient[4], float linearFactors[3], float angularFactors[3], float friction, int shape_type );
 	DLLEXPORT bool removeDynamicShape(int body_num);
     DLLEXPORT bool updateDynamicShape(int body_num, float weight, float hardness, float linearFactors[3], float angularFactors[3], float friction );
 	DLLEXPORT bool getDynamicShapePose(int body_num, float pos[3], float orient[4]);
@@ -103,16 +111,19 @@ extern "C" {
 	DLLEXPORT bool setSpring(int spring_num, float max_force, float dampingFactor, float goalPos[3], float goalOrient[4], float posConstraintLower[3], float posConstraintUpper[3], float orientConstraintLower[3], float orientConstraintUpper[3], int directionality[6]);
 
 	DLLEXPORT bool applyForce(int falcon_num, float force[3], float time_in_secs);
+
+	// one call per frame: hands every haptic transform and spring lerp to the next physics step as one command, however
+	// many there are, then fills the caller's falcon and body arrays from a single physics step.  only bodies whose
+	// poses changed after the step in last_step are returned, so idle and sleeping bodies aren't copied out, though
+	// every call still checks every body.  each caller keeps its own last_step, starting at 0 (everything); it is set
+	// to the step that was read once every changed body fit.  all arrays belong to the caller; the inputs are copied.
+	// num_falcon_params and num_object_params are set to how many there are, which may be more than the max that were
+	// written, so the caller can grow its arrays.  returns false (see getLastError) if the inputs were rejected, which
+	// happens to all of them at once (a bad falcon number, or a full command queue); the outputs are filled either way
+	DLLEXPORT bool falcon_update_batch(const _falconunity_haptic_tip_params * haptic_params, int num_haptic_params, const _falconunity_spring_params * spring_params, int num_spring_params,
+		_falconunity_falcon_params * falcon_params, int max_falcon_params, int * num_falcon_params, _falconunity_object_params * object_params, int max_object_params, int * num_object_params,
+		unsigned int * last_step, float * fps);
 	
 };
 
-extern "C++" {
-
-#include <vector>
-using namespace std;
-
-	DLLEXPORT bool falcon_update_all(std::vector<_falconunity_haptic_tip_params *> haptic_params, std::vector<_falconunity_spring_params *> spring_params, float * fps, std::vector<_falconunity_falcon_params *> * falcon_params, std::vector<_falconunity_object_params *> * object_params);
-
-}
-
 #endif
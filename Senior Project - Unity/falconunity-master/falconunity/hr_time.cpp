@@ -1,10 +1,9 @@
- #include <windows.h>
- 
  #ifndef hr_timer
  #include "hr_time.h"
  #define hr_timer
  #endif
  
+#ifdef _WIN32
  double CStopWatch::LIToSecs( LARGE_INTEGER & L) {
      return ((double)L.QuadPart /(double)frequency.QuadPart) ;
  }
@@ -27,4 +26,23 @@
      LARGE_INTEGER time;
      time.QuadPart = timer.stop.QuadPart - timer.start.QuadPart;
      return LIToSecs( time) ;
- }
\ No newline at end of file
+ }
+#else
+ CStopWatch::CStopWatch(){
+     timer.start.tv_sec=0;
+     timer.start.tv_nsec=0;
+     timer.stop = timer.start;
+ }
+ 
+ void CStopWatch::startTimer( ) {
+     clock_gettime(CLOCK_MONOTONIC, &timer.start) ;
+ }
+ 
+ void CStopWatch::stopTimer( ) {
+     clock_gettime(CLOCK_MONOTONIC, &timer.stop) ;
+ }
+ 
+ double CStopWatch::getElapsedTime() {
+     return (double)(timer.stop.tv_sec - timer.start.tv_sec) + (double)(timer.stop.tv_nsec - timer.start.tv_nsec) * 1e-9 ;
+ }
+#endif
\ No newline at end of file
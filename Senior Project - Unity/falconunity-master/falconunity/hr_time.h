@@ -1,16 +1,28 @@
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <time.h>
+#endif
  
+ // monotonic stop watch: QueryPerformanceCounter on windows, CLOCK_MONOTONIC elsewhere
  typedef struct {
+#ifdef _WIN32
      LARGE_INTEGER start;
      LARGE_INTEGER stop;
+#else
+     timespec start;
+     timespec stop;
+#endif
  } stopWatch;
  
  class CStopWatch {
  
  private:
      stopWatch timer;
+#ifdef _WIN32
      LARGE_INTEGER frequency;
      double LIToSecs( LARGE_INTEGER & L) ;
+#endif
  public:
      CStopWatch() ;
      void startTimer( ) ;
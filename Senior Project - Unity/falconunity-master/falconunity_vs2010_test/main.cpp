@@ -25,9 +25,102 @@
 
 
 #include <iostream>
+#include <cstring>
+#include <windows.h>
 using namespace std;
 #include "../falconunity/falconunity.h"
+
+// per step cost of the spring pass with 1, 100 and 1000 sprung cubes: falconunity_test bench
+void benchSprings() {
+	// unit cube, 12 triangles
+	float c[8][3] = {{-.01f,-.01f,-.01f},{.01f,-.01f,-.01f},{.01f,.01f,-.01f},{-.01f,.01f,-.01f},{-.01f,-.01f,.01f},{.01f,-.01f,.01f},{.01f,.01f,.01f},{-.01f,.01f,.01f}};
+	int faces[12][3] = {{0,1,2},{0,2,3},{4,6,5},{4,7,6},{0,4,5},{0,5,1},{1,5,6},{1,6,2},{2,6,7},{2,7,3},{3,7,4},{3,4,0}};
+	float cube[12 * 9];
+	for (int t = 0; t < 12; t ++)
+		for (int v = 0; v < 3; v ++)
+			for (int j = 0; j < 3; j ++)
+				cube[t * 9 + v * 3 + j] = c[faces[t][v]][j];
+
+	float orient[4] = {0,0,0,1};
+	float lf[3] = {1,1,1};
+	float af[3] = {1,1,1};
+	float zero[3] = {0,0,0};
+	float gravity[3] = {0,0,0};
+	int dir[6] = {0,0,0,0,0,0};
+	int counts[3] = {1, 100, 1000};
+
+	initFalconUnity();
+	setGravity(gravity);
+
+	static _falconunity_spring_params lerps[1000];
+	static _falconunity_object_params objects[1000];
+	_falconunity_falcon_params falcons[4];
+
+	for (int n = 0; n < 3; n ++) {
+		for (int i = 0; i < counts[n]; i ++) {
+			float pos[3] = {(i % 10) * .05f, ((i / 10) % 10) * .05f, (i / 100) * .05f};
+			float goal[3] = {pos[0], pos[1] + .01f, pos[2]};
+			// setup is one command per call, and 2000 of them outrun the queue, so wait when it's full
+			while (!sendDynamicShape(i, cube, 12, 1, .5f, pos, orient, lf, af, .5f))
+				Sleep(1);
+			while (!addSpringToShape(i, i, 10, 1, goal, orient, zero, zero, zero, zero, dir))
+				Sleep(1);
+
+			_falconunity_spring_params & l = lerps[i];
+			memset(&l, 0, sizeof(l));
+			l.spring_num = i;
+			l.max_force = 10;
+			l.dampingFactor = 1;
+			for (int j = 0; j < 3; j ++)
+				l.goalPos[j] = goal[j];
+			for (int j = 0; j < 4; j ++)
+				l.goalOrient[j] = orient[j];
+			l.time_in_secs = .01f;
+		}
+
+		// let it settle, then average over a second's worth of frames, each lerping every spring in one batch
+		Sleep(1000);
+		float total = 0;
+		int rejected = 0;
+		unsigned int last_step = 0;
+		unsigned int first_step = 0;
+		LARGE_INTEGER frequency, first_time, last_time;
+		QueryPerformanceFrequency(&frequency);
+		for (int s = 0; s < 100; s ++) {
+			int num_falcons, num_objects;
+			float fps;
+			for (int i = 0; i < counts[n]; i ++)
+				lerps[i].goalPos[1] += (s % 2) ? -.001f : .001f;
+			if (!falcon_update_batch(NULL, 0, lerps, counts[n], falcons, 4, &num_falcons, objects, 1000, &num_objects, &last_step, &fps))
+				rejected ++;
+			// last_step is the physics step the outputs came from
+			if (s == 0) {
+				first_step = last_step;
+				QueryPerformanceCounter(&first_time);
+			}
+			QueryPerformanceCounter(&last_time);
+			total += getSpringUpdateTime();
+			Sleep(10);
+		}
+		double seconds = (double)(last_time.QuadPart - first_time.QuadPart) / frequency.QuadPart;
+		cout << counts[n] << " springs: " << total / 100 * 1e6 << " us per step, " << (last_step - first_step) / seconds << " steps per second, "
+			<< getFPS() << " servo ticks per second, " << rejected << " of 100 batches rejected" << endl;
+
+		for (int i = 0; i < counts[n]; i ++) {
+			while (!removeDynamicShape(i))
+				Sleep(1);
+		}
+		Sleep(100);
+	}
+
+	closeFalconUnity();
+}
+
 int main(int argc, char ** argv){
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		benchSprings();
+		return 0;
+	}
     
    // initFalconUnity();
     float verts[] = {-20, 0, 20,
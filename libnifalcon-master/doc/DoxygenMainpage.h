@@ -85,6 +85,12 @@ The falcon provides a grip connection mechanism that allows the user to attach m
 The falcon has firmware that is loaded on first connection to the host computer. For most needs, firmware is important because it defines the communications format for the falcon.
 */
 
+/**
+@defgroup EstimatorClasses Estimator Classes
+
+Estimator classes turn the timestamped positions coming out of the kinematics into velocity and acceleration values, for rendering damping and friction without having to differentiate over jittery host loop times.
+*/
+
 /**
 @defgroup UtilityClasses Utility Classes
 
@@ -14,7 +14,6 @@
 #include "falcon/core/FalconDevice.h"
 #include "falcon/firmware/FalconFirmwareNovintSDK.h"
 #include "falcon/util/FalconCLIBase.h"
-#include "falcon/util/FalconFirmwareBinaryNvent.h"
 #include "falcon/kinematic/stamper/StamperUtils.h"
 #include "falcon/core/FalconGeometry.h"
 #include "falcon/gmtl/gmtl.h"
@@ -63,17 +62,10 @@ bool initialise()
 	if(!firmware_loaded)
 	{
 		std::cout << "Loading firmware" << std::endl;
-		uint8_t* firmware_block;
-		long firmware_size;
 		{
-
-			firmware_block = const_cast<uint8_t*>(NOVINT_FALCON_NVENT_FIRMWARE);
-			firmware_size = NOVINT_FALCON_NVENT_FIRMWARE_SIZE;
-
-
 			for(int i = 0; i < 10; ++i)
 			{
-				if(!falcon.getFalconFirmware()->loadFirmware(skip_checksum, NOVINT_FALCON_NVENT_FIRMWARE_SIZE, const_cast<uint8_t*>(NOVINT_FALCON_NVENT_FIRMWARE)))
+				if(!falcon.loadRegisteredFirmware("nvent", skip_checksum))
 
 				{
 					cout << "Firmware loading try failed";
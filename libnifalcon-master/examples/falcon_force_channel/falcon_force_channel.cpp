@@ -0,0 +1,109 @@
+/***
+ * @file falcon_force_channel.cpp
+ * @brief Compares writing application rate forces with setForce() against the force channel
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ * Plays a sine force, updated at a typical application frame rate, into a simulated falcon. The first run
+ * writes each frame's force with setForce(), the second pushes it through the force channel with its
+ * default playout delay. For each run, prints the fastest the force sent to the falcon changed between
+ * two servo ticks, next to the fastest the sine itself changes. A staircase shows up as a rate far above
+ * the sine's, since each frame's whole change lands in one tick.
+ *
+ * Usage: falcon_force_channel [frame rate in Hz] [sine frequency in Hz] [amplitude in N]
+ */
+
+#include "falcon/core/FalconDevice.h"
+#include "falcon/core/FalconClock.h"
+#include "falcon/core/FalconState.h"
+#include "falcon/comm/FalconCommSimulated.h"
+#include "falcon/firmware/FalconFirmwareNovintSDK.h"
+#include "falcon/kinematic/FalconKinematicStamper.h"
+#include <boost/array.hpp>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace libnifalcon;
+
+const static double RUN_TIME = 3.0;
+const static double SETTLE_TIME = 0.5;
+
+void runSine(double frame_rate, double frequency, double amplitude, bool use_channel)
+{
+	FalconDevice dev;
+	dev.setFalconComm<FalconCommSimulated>();
+	dev.setFalconFirmware<FalconFirmwareNovintSDK>();
+	dev.setFalconKinematic<FalconKinematicStamper>();
+
+	boost::shared_ptr<FalconCommSimulated> sim = boost::dynamic_pointer_cast<FalconCommSimulated>(dev.getFalconComm());
+	sim->setFirmwareLoaded(true);
+	if(!dev.open(0))
+	{
+		std::cout << "Cannot open simulated falcon - Error: " << dev.getErrorCode() << std::endl;
+		return;
+	}
+	dev.getFalconFirmware()->setHomingMode(true);
+
+	unsigned int flags = FalconDevice::FALCON_LOOP_FIRMWARE | FalconDevice::FALCON_LOOP_KINEMATIC;
+	double begin = FalconClock::getTime();
+	double now = begin;
+	double next_frame = begin;
+	double last_force = 0.0;
+	double last_time = 0.0;
+	double max_rate = 0.0;
+	unsigned int ticks = 0;
+	FalconState state;
+	while((now = FalconClock::getTime()) - begin < RUN_TIME)
+	{
+		//The application side, one new force per frame
+		if(now >= next_frame)
+		{
+			next_frame += 1.0 / frame_rate;
+			boost::array<double, 3> force = {{0.0, 0.0, amplitude * sin(2.0 * M_PI * frequency * (now - begin))}};
+			if(use_channel)
+			{
+				dev.getForceChannel().pushForceSetpoint(now, force);
+			}
+			else
+			{
+				dev.setForce(force);
+			}
+		}
+		if(!dev.runIOLoop(flags))
+		{
+			continue;
+		}
+		dev.getState(state);
+		//Rate against the loop's own clock, which is what the channel renders against
+		if(now - begin >= SETTLE_TIME && now > last_time)
+		{
+			double rate = fabs(state.force[2] - last_force) / (now - last_time);
+			if(rate > max_rate) max_rate = rate;
+			++ticks;
+		}
+		last_force = state.force[2];
+		last_time = now;
+	}
+	std::cout << (use_channel ? "Force channel: " : "setForce():    ")
+			  << "fastest force change " << max_rate << " N/s over " << ticks << " ticks" << std::endl;
+	dev.close();
+}
+
+int main(int argc, char** argv)
+{
+	double frame_rate = 60.0;
+	double frequency = 2.0;
+	double amplitude = 2.0;
+	if(argc > 1) frame_rate = atof(argv[1]);
+	if(argc > 2) frequency = atof(argv[2]);
+	if(argc > 3) amplitude = atof(argv[3]);
+	std::cout << amplitude << " N " << frequency << " Hz sine, updated at " << frame_rate << " Hz, "
+			  << "changes at up to " << 2.0 * M_PI * frequency * amplitude << " N/s" << std::endl;
+	runSine(frame_rate, frequency, amplitude, false);
+	runSine(frame_rate, frequency, amplitude, true);
+	return 0;
+}
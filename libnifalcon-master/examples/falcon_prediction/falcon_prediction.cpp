@@ -0,0 +1,112 @@
+/***
+ * @file falcon_prediction.cpp
+ * @brief Stiff wall contact on the simulated falcon, with and without latency compensation
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ * Runs a virtual wall against FalconCommSimulated twice, once computing the wall force from the measured
+ * position and once from the predicted position (FalconDevice::FALCON_LOOP_PREDICTION). The simulated hand
+ * leans into the wall the whole time. Without prediction the USB latency makes the wall buzz; with it, the
+ * contact velocity and the penetration swing should both drop noticeably.
+ *
+ * Usage: falcon_prediction [stiffness (N/m)] [round trip latency (s)]
+ */
+
+#include "falcon/core/FalconDevice.h"
+#include "falcon/core/FalconClock.h"
+#include "falcon/comm/FalconCommSimulated.h"
+#include "falcon/firmware/FalconFirmwareNovintSDK.h"
+#include "falcon/kinematic/FalconKinematicStamper.h"
+#include "falcon/estimator/FalconVelocityEstimatorKalman.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace libnifalcon;
+
+const static double WALL_Z = 0.11;
+const static double RUN_TIME = 3.0;
+const static double SETTLE_TIME = 1.0;
+
+void runWall(double stiffness, double latency, bool predict)
+{
+	FalconDevice dev;
+	dev.setFalconComm<FalconCommSimulated>();
+	dev.setFalconFirmware<FalconFirmwareNovintSDK>();
+	dev.setFalconKinematic<FalconKinematicStamper>();
+	dev.setFalconVelocityEstimator<FalconVelocityEstimatorKalman>();
+
+	boost::shared_ptr<FalconCommSimulated> sim = boost::dynamic_pointer_cast<FalconCommSimulated>(dev.getFalconComm());
+	sim->setLatency(latency);
+	sim->setFirmwareLoaded(true);
+	//Hand starts 5mm outside the wall and leans toward a point 1cm inside it
+	boost::array<double, 3> start = {{0.0, 0.0, WALL_Z + 0.005}};
+	boost::array<double, 3> target = {{0.0, 0.0, WALL_Z - 0.01}};
+	sim->setSimulatedPosition(start);
+	sim->setHandTarget(target, 200.0, 1.0);
+
+	if(!dev.open(0))
+	{
+		std::cout << "Cannot open simulated falcon - Error: " << dev.getErrorCode() << std::endl;
+		return;
+	}
+	dev.getFalconFirmware()->setHomingMode(true);
+
+	unsigned int flags = FalconDevice::FALCON_LOOP_FIRMWARE | FalconDevice::FALCON_LOOP_KINEMATIC | FalconDevice::FALCON_LOOP_ESTIMATOR;
+	if(predict)
+	{
+		flags |= FalconDevice::FALCON_LOOP_PREDICTION;
+	}
+
+	double begin = FalconClock::getTime();
+	double now = begin;
+	double speed_sq_sum = 0.0;
+	double max_penetration = 0.0;
+	double min_penetration = 1.0;
+	unsigned int samples = 0;
+	while((now = FalconClock::getTime()) - begin < RUN_TIME)
+	{
+		if(!dev.runIOLoop(flags))
+		{
+			continue;
+		}
+		boost::array<double, 3> pos = predict ? dev.getPredictedPosition() : dev.getPosition();
+		boost::array<double, 3> force = {{0.0, 0.0, 0.0}};
+		if(pos[2] < WALL_Z)
+		{
+			force[2] = stiffness * (WALL_Z - pos[2]);
+		}
+		dev.setForce(force);
+
+		if(now - begin < SETTLE_TIME)
+		{
+			continue;
+		}
+		boost::array<double, 3> true_vel = sim->getSimulatedVelocity();
+		double penetration = WALL_Z - sim->getSimulatedPosition()[2];
+		speed_sq_sum += true_vel[2] * true_vel[2];
+		if(penetration > max_penetration) max_penetration = penetration;
+		if(penetration < min_penetration) min_penetration = penetration;
+		++samples;
+	}
+	std::cout << (predict ? "Predicted position: " : "Measured position:  ")
+			  << "RMS contact velocity " << (samples ? sqrt(speed_sq_sum / samples) * 1000.0 : 0.0) << " mm/s, "
+			  << "penetration " << min_penetration * 1000.0 << " to " << max_penetration * 1000.0 << " mm, "
+			  << "measured round trip " << dev.getFalconFirmware()->getRoundTripTime() * 1000.0 << " ms" << std::endl;
+	dev.close();
+}
+
+int main(int argc, char** argv)
+{
+	double stiffness = 1500.0;
+	double latency = 0.001;
+	if(argc > 1) stiffness = atof(argv[1]);
+	if(argc > 2) latency = atof(argv[2]);
+	std::cout << "Wall stiffness " << stiffness << " N/m, simulated round trip " << latency * 1000.0 << " ms" << std::endl;
+	runWall(stiffness, latency, false);
+	runWall(stiffness, latency, true);
+	return 0;
+}
@@ -0,0 +1,88 @@
+/***
+ * @file falcon_scheduler.cpp
+ * @brief Falcon behaviors written as C++20 coroutines, run by FalconDeviceScheduler
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ * Runs two behaviors against FalconCommSimulated on one thread. One waits for homing, then for the center
+ * grip button, and reports where the grip was when it was pressed. The other measures the sample rate over
+ * a fixed number of samples. The main loop plays the user, pressing the center button after a second.
+ *
+ * Needs a C++20 compiler, as FalconDeviceScheduler is built on coroutines.
+ */
+
+#include "falcon/core/FalconDevice.h"
+#include "falcon/core/FalconClock.h"
+#include "falcon/comm/FalconCommSimulated.h"
+#include "falcon/firmware/FalconFirmwareNovintSDK.h"
+#include "falcon/kinematic/FalconKinematicStamper.h"
+#include "falcon/grip/FalconGripFourButton.h"
+#include "falcon/util/FalconDeviceScheduler.h"
+#include <iostream>
+
+using namespace libnifalcon;
+
+const static unsigned int RATE_SAMPLES = 1000;
+const static double PRESS_TIME = 1.0;
+const static double RELEASE_TIME = 1.1;
+const static double RUN_TIME = 5.0;
+
+FalconTask reportCenterPress(FalconDeviceScheduler& scheduler)
+{
+	co_await scheduler.homed();
+	std::cout << "Homed, waiting for the center button" << std::endl;
+	co_await scheduler.buttonPressed(FalconGripFourButton::CENTER_BUTTON);
+	const FalconState& state = scheduler.getState();
+	std::cout << "Center button pressed at (" << state.position[0] << ", " << state.position[1] << ", " << state.position[2] << ") m" << std::endl;
+}
+
+FalconTask measureRate(FalconDeviceScheduler& scheduler)
+{
+	double begin = (co_await scheduler.nextSample()).timestamp;
+	for(unsigned int i = 1; i < RATE_SAMPLES; ++i)
+	{
+		co_await scheduler.nextSample();
+	}
+	double elapsed = scheduler.getState().timestamp - begin;
+	std::cout << RATE_SAMPLES << " samples in " << elapsed * 1000.0 << " ms (" << (RATE_SAMPLES - 1) / elapsed << " Hz)" << std::endl;
+}
+
+int main()
+{
+	FalconDevice dev;
+	dev.setFalconComm<FalconCommSimulated>();
+	dev.setFalconFirmware<FalconFirmwareNovintSDK>();
+	dev.setFalconKinematic<FalconKinematicStamper>();
+	dev.setFalconGrip<FalconGripFourButton>();
+
+	boost::shared_ptr<FalconCommSimulated> sim = boost::dynamic_pointer_cast<FalconCommSimulated>(dev.getFalconComm());
+	sim->setFirmwareLoaded(true);
+
+	if(!dev.open(0))
+	{
+		std::cout << "Cannot open simulated falcon - Error: " << dev.getErrorCode() << std::endl;
+		return 1;
+	}
+	dev.getFalconFirmware()->setHomingMode(true);
+
+	FalconDeviceScheduler scheduler(dev);
+	scheduler.spawn(reportCenterPress(scheduler));
+	scheduler.spawn(measureRate(scheduler));
+
+	double begin = FalconClock::getTime();
+	double now = begin;
+	while(scheduler.getTaskCount() > 0 && (now = FalconClock::getTime()) - begin < RUN_TIME)
+	{
+		sim->setGripButtons((now - begin >= PRESS_TIME && now - begin < RELEASE_TIME) ? FalconGripFourButton::CENTER_BUTTON : 0);
+		scheduler.runIOLoop();
+	}
+	if(scheduler.getTaskCount() > 0)
+	{
+		std::cout << scheduler.getTaskCount() << " behaviors did not finish" << std::endl;
+	}
+	dev.close();
+	return 0;
+}
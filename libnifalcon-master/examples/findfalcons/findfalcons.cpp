@@ -10,13 +10,18 @@
  *
  * Project info at http://libnifalcon.nonpolynomial.com/
  *
+ * Usage: findfalcons [--metrics file]
+ *
+ * With --metrics, each falcon's I/O loop metrics are written to the file in Prometheus text format after
+ * every 1000 loops, labeled with the falcon's index.
  */
 
 #include "falcon/core/FalconLogger.h"
 #include "falcon/core/FalconDevice.h"
 #include "falcon/firmware/FalconFirmwareNovintSDK.h"
-#include "falcon/util/FalconFirmwareBinaryNvent.h"
 #include <iostream>
+#include <sstream>
+#include <cstring>
 #include <cstdio>
 #include <cstdlib>
 #include <csignal>
@@ -52,7 +57,7 @@ void sigproc(int i)
 	exit(0);
 }
 
-void runFalconTest()
+void runFalconTest(const std::string& metrics_file)
 {
 	boost::shared_ptr<FalconFirmware> f;
 	FalconKinematic* k;
@@ -99,7 +104,7 @@ void runFalconTest()
 			std::cout << "Loading firmware" << std::endl;
 			for(int i = 0; i < 10; ++i)
 			{
-				if(!dev.getFalconFirmware()->loadFirmware(true, NOVINT_FALCON_NVENT_FIRMWARE_SIZE, const_cast<uint8_t*>(NOVINT_FALCON_NVENT_FIRMWARE)))
+				if(!dev.loadRegisteredFirmware("nvent", true))
 				{
 					std::cout << "Could not load firmware" << std::endl;
 					return;
@@ -127,6 +132,15 @@ void runFalconTest()
 				printf("Loops: %8d | Enc1: %5d | Enc2: %5d | Enc3: %5d \n", (j*1000)+i,  f->getEncoderValues()[0], f->getEncoderValues()[1], f->getEncoderValues()[2]);
 				++count;
 			}
+			if(!metrics_file.empty())
+			{
+				std::ostringstream labels;
+				labels << "device=\"" << z << "\"";
+				if(!dev.getMetrics().writePrometheus(metrics_file, labels.str()))
+				{
+					std::cout << "Cannot write metrics to " << metrics_file << std::endl;
+				}
+			}
 		}
 		f->setLEDStatus(0);
 		dev.runIOLoop();
@@ -147,6 +161,20 @@ int main(int argc, char** argv)
 	configureLogging(logPattern, logLevel);
 #endif
 
-	runFalconTest();
+	std::string metrics_file;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+		{
+			metrics_file = argv[++i];
+		}
+		else
+		{
+			std::cout << "Usage: findfalcons [--metrics file]" << std::endl;
+			return 1;
+		}
+	}
+
+	runFalconTest(metrics_file);
 	return 0;
 }
@@ -15,7 +15,6 @@
 #include "falcon/core/FalconLogger.h"
 #include "falcon/core/FalconDevice.h"
 #include "falcon/firmware/FalconFirmwareNovintSDK.h"
-#include "falcon/util/FalconFirmwareBinaryNvent.h"
 #include <iostream>
 #include <cstdio>
 #include <cstdlib>
@@ -62,13 +61,14 @@ void runFalconTest()
 	unsigned int count;
 	unsigned int error_count = 0;
 	unsigned int loop_count = 0;
-	std::vector<FalconDevice> dev;
+	//Devices own lock free queues and can't be copied, so the vector holds pointers
+	std::vector<boost::shared_ptr<FalconDevice> > dev;
 
 	
-	dev.push_back(FalconDevice());
-	dev[0].setFalconFirmware<FalconFirmwareNovintSDK>();
+	dev.push_back(boost::shared_ptr<FalconDevice>(new FalconDevice()));
+	dev[0]->setFalconFirmware<FalconFirmwareNovintSDK>();
 
-	if(!dev[0].getDeviceCount(num_falcons))
+	if(!dev[0]->getDeviceCount(num_falcons))
 	{
 		std::cout << "Cannot get device count" << std::endl;
 		return;
@@ -90,10 +90,10 @@ void runFalconTest()
 	
 	for(int i = 0; i < num_falcons; ++i)
 	{
-		dev.push_back(FalconDevice());
-		dev[i].setFalconFirmware<FalconFirmwareNovintSDK>();
+		dev.push_back(boost::shared_ptr<FalconDevice>(new FalconDevice()));
+		dev[i]->setFalconFirmware<FalconFirmwareNovintSDK>();
 		std::cout << "Opening falcon " << i << std::endl;
-		if(!dev[i].open(i))
+		if(!dev[i]->open(i))
 		{
 			std::cout << "Cannot open falcon - Error: " << std::endl; // << dev.getErrorCode() << std::endl;
 			return;
@@ -102,12 +102,12 @@ void runFalconTest()
 	}		
 	for(int i = 0; i < num_falcons; ++i)
 	{
-		if(!dev[i].isFirmwareLoaded())
+		if(!dev[i]->isFirmwareLoaded())
 		{
 			std::cout << "Loading firmware" << std::endl;
 			for(int z = 0; z < 10; ++z)
 			{
-				if(!dev[i].getFalconFirmware()->loadFirmware(true, NOVINT_FALCON_NVENT_FIRMWARE_SIZE, const_cast<uint8_t*>(NOVINT_FALCON_NVENT_FIRMWARE)))
+				if(!dev[i]->loadRegisteredFirmware("nvent", true))
 				{
 					std::cout << "Could not load firmware" << std::endl;
 					return;
@@ -118,7 +118,7 @@ void runFalconTest()
 					break;
 				}
 			}
-			if(!dev[i].isFirmwareLoaded())
+			if(!dev[i]->isFirmwareLoaded())
 			{
 				std::cout << "Firmware didn't load correctly. Try running findfalcons again" << std::endl;
 				return;
@@ -128,25 +128,25 @@ void runFalconTest()
 
 	for(int i = 0; i < num_falcons; ++i)
 	{
-		f = dev[i].getFalconFirmware();
+		f = dev[i]->getFalconFirmware();
 		for(int j = 0; j < 3; ++j)
 		{
 			f->setLEDStatus(2 << (j % 3));
 			for(int k = 0; k < 1000; )
 			{
-				if(dev[i].runIOLoop()) ++k;
+				if(dev[i]->runIOLoop()) ++k;
 				else continue;
 				printf("Loops: %8d | Enc1: %5d | Enc2: %5d | Enc3: %5d \n", (j*1000)+k,  f->getEncoderValues()[0], f->getEncoderValues()[1], f->getEncoderValues()[2]);
 				++count;
 			}
 		}
 		f->setLEDStatus(0);
-		dev[i].runIOLoop();
+		dev[i]->runIOLoop();
 	}
 
 	for(int i = 0; i < num_falcons; ++i)
 	{
-		dev[i].close();
+		dev[i]->close();
 	}
 }
 
@@ -0,0 +1,543 @@
+/***
+ * @file libnifalcon_bench.cpp
+ * @brief Full I/O loop benchmark against simulated falcons
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ * Runs the complete FalconDevice pipeline (NovintSDK firmware, Stamper kinematics, Kalman estimator,
+ * prediction and a virtual wall) against FalconCommSimulated, so loop performance can be tracked without
+ * hardware. Each configured round trip latency is run with a single device, then the scaling latency is
+ * run with 1 to 16 devices, one I/O thread each.
+ *
+ * For every run, reports I/O loops and samples per second, runIOLoop() cycle time percentiles, heap
+ * allocations per loop and process CPU use (100% = one core).
+ *
+ * Then measures bring-up, the time from open() to the first sample of falcons that need firmware, for
+ * 1 and N devices: sequential uploads waiting on every chunk, sequential pipelined uploads, parallel
+ * pipelined uploads, and devices the firmware cache says are already loaded.
+ *
+ * Latencies are simulated USB round trips, given in milliseconds on the command line (default 0, 1 and 2
+ * ms, with 1 ms for scaling and bring-up). The JSON output reports them in seconds.
+ *
+ * Usage: libnifalcon_bench [-t seconds per run] [-l round trip ms,ms,...] [-s scaling round trip ms] [-d max devices] [-b bring-up devices] [-j json file]
+ */
+
+#include "falcon/core/FalconDevice.h"
+#include "falcon/core/FalconClock.h"
+#include "falcon/core/FalconMetrics.h"
+#include "falcon/comm/FalconCommSimulated.h"
+#include "falcon/firmware/FalconFirmwareNovintSDK.h"
+#include "falcon/kinematic/FalconKinematicStamper.h"
+#include "falcon/estimator/FalconVelocityEstimatorKalman.h"
+#include "falcon/util/FalconFirmwareLoaderBoostThread.h"
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <new>
+
+#if defined(WIN32) || defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace libnifalcon;
+
+const static double WALL_Z = 0.11;
+const static double WALL_STIFFNESS = 1500.0;
+
+//Every heap allocation in the process goes through here, so allocations in the loop can be counted
+static boost::atomic<uint64_t> s_allocations(0);
+
+void* operator new(std::size_t size)
+{
+	s_allocations.fetch_add(1, boost::memory_order_relaxed);
+	void* p = malloc(size ? size : 1);
+	if(p == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+	free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+	free(p);
+}
+
+//C++14 sized deletes, so they don't bypass the replacements above
+void operator delete(void* p, std::size_t) throw()
+{
+	operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) throw()
+{
+	operator delete[](p);
+}
+
+/**
+ * Process CPU time (user and system), in seconds
+ */
+double getCPUTime()
+{
+#if defined(WIN32) || defined(_WIN32)
+	FILETIME create_time, exit_time, kernel_time, user_time;
+	if(!GetProcessTimes(GetCurrentProcess(), &create_time, &exit_time, &kernel_time, &user_time))
+	{
+		return 0.0;
+	}
+	ULARGE_INTEGER kernel, user;
+	kernel.LowPart = kernel_time.dwLowDateTime;
+	kernel.HighPart = kernel_time.dwHighDateTime;
+	user.LowPart = user_time.dwLowDateTime;
+	user.HighPart = user_time.dwHighDateTime;
+	return (double)(kernel.QuadPart + user.QuadPart) * 1e-7;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec * 1e-6 +
+		(double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec * 1e-6;
+#endif
+}
+
+struct BenchDevice
+{
+	FalconDevice device;
+	boost::shared_ptr<FalconCommSimulated> sim;
+	FalconHistogram cycleTime; /**< runIOLoop() time, in nanoseconds */
+	uint64_t loops;
+	uint64_t samples;
+};
+
+struct BenchResult
+{
+	double latency;
+	unsigned int devices;
+	double seconds;
+	double loopsPerSecond;
+	double samplesPerSecond;
+	double p50;
+	double p99;
+	double p999;
+	double allocationsPerLoop;
+	double cpuPercent;
+};
+
+static boost::atomic<bool> s_running(false);
+static boost::atomic<bool> s_stopping(false);
+
+void runDevice(BenchDevice* bench)
+{
+	unsigned int flags = FalconDevice::FALCON_LOOP_FIRMWARE | FalconDevice::FALCON_LOOP_KINEMATIC |
+		FalconDevice::FALCON_LOOP_ESTIMATOR | FalconDevice::FALCON_LOOP_PREDICTION;
+	while(!s_running.load(boost::memory_order_acquire))
+	{
+	}
+	while(!s_stopping.load(boost::memory_order_relaxed))
+	{
+		double begin = FalconClock::getTime();
+		bool sample = bench->device.runIOLoop(flags);
+		bench->cycleTime.record((uint64_t)((FalconClock::getTime() - begin) * 1e9));
+		++bench->loops;
+		if(!sample)
+		{
+			continue;
+		}
+		++bench->samples;
+		boost::array<double, 3> pos = bench->device.getPredictedPosition();
+		boost::array<double, 3> force = {{0.0, 0.0, 0.0}};
+		if(pos[2] < WALL_Z)
+		{
+			force[2] = WALL_STIFFNESS * (WALL_Z - pos[2]);
+		}
+		bench->device.setForce(force);
+	}
+}
+
+/**
+ * Percentile over the cycle times of all devices, in seconds
+ */
+double getPercentile(const std::vector<BenchDevice*>& devices, double percentile)
+{
+	uint64_t count = 0;
+	for(unsigned int i = 0; i < devices.size(); ++i)
+	{
+		count += devices[i]->cycleTime.getCount();
+	}
+	if(count == 0)
+	{
+		return 0.0;
+	}
+	uint64_t target = (uint64_t)(percentile / 100.0 * count + 0.5);
+	if(target < 1) target = 1;
+	uint64_t seen = 0;
+	for(unsigned int b = 0; b < FalconHistogram::BUCKET_COUNT; ++b)
+	{
+		for(unsigned int i = 0; i < devices.size(); ++i)
+		{
+			seen += devices[i]->cycleTime.getBucketCount(b);
+		}
+		if(seen >= target)
+		{
+			return FalconHistogram::getBucketUpperBound(b) * 1e-9;
+		}
+	}
+	return FalconHistogram::getBucketUpperBound(FalconHistogram::BUCKET_COUNT - 1) * 1e-9;
+}
+
+bool runBench(double latency, unsigned int device_count, double seconds, BenchResult& result)
+{
+	std::vector<BenchDevice*> devices;
+	for(unsigned int i = 0; i < device_count; ++i)
+	{
+		BenchDevice* bench = new BenchDevice;
+		bench->loops = 0;
+		bench->samples = 0;
+		bench->device.setFalconComm<FalconCommSimulated>();
+		bench->device.setFalconFirmware<FalconFirmwareNovintSDK>();
+		bench->device.setFalconKinematic<FalconKinematicStamper>();
+		bench->device.setFalconVelocityEstimator<FalconVelocityEstimatorKalman>();
+		bench->sim = boost::dynamic_pointer_cast<FalconCommSimulated>(bench->device.getFalconComm());
+		bench->sim->setLatency(latency);
+		bench->sim->setFirmwareLoaded(true);
+		//Hand leans into the wall, so the kinematics and force path do real work
+		boost::array<double, 3> start = {{0.0, 0.0, WALL_Z + 0.005}};
+		boost::array<double, 3> target = {{0.0, 0.0, WALL_Z - 0.01}};
+		bench->sim->setSimulatedPosition(start);
+		bench->sim->setHandTarget(target, 200.0, 1.0);
+		devices.push_back(bench);
+		if(!bench->device.open(0))
+		{
+			std::cerr << "Cannot open simulated falcon - Error: " << bench->device.getErrorCode() << std::endl;
+			for(unsigned int j = 0; j < devices.size(); ++j) delete devices[j];
+			return false;
+		}
+		bench->device.getFalconFirmware()->setHomingMode(true);
+	}
+
+	s_running = false;
+	s_stopping = false;
+	std::vector<boost::shared_ptr<boost::thread> > threads;
+	for(unsigned int i = 0; i < device_count; ++i)
+	{
+		threads.push_back(boost::shared_ptr<boost::thread>(new boost::thread(runDevice, devices[i])));
+	}
+
+	uint64_t allocations = s_allocations.load();
+	double cpu_begin = getCPUTime();
+	double begin = FalconClock::getTime();
+	s_running.store(true, boost::memory_order_release);
+	boost::this_thread::sleep(boost::posix_time::microseconds((long)(seconds * 1e6)));
+	s_stopping = true;
+	for(unsigned int i = 0; i < device_count; ++i)
+	{
+		threads[i]->join();
+	}
+	double elapsed = FalconClock::getTime() - begin;
+	double cpu = getCPUTime() - cpu_begin;
+	//Joining allocates nothing, but thread teardown might; the count is a ceiling
+	allocations = s_allocations.load() - allocations;
+
+	uint64_t loops = 0;
+	uint64_t samples = 0;
+	for(unsigned int i = 0; i < device_count; ++i)
+	{
+		loops += devices[i]->loops;
+		samples += devices[i]->samples;
+	}
+	result.latency = latency;
+	result.devices = device_count;
+	result.seconds = elapsed;
+	result.loopsPerSecond = loops / elapsed;
+	result.samplesPerSecond = samples / elapsed;
+	result.p50 = getPercentile(devices, 50.0);
+	result.p99 = getPercentile(devices, 99.0);
+	result.p999 = getPercentile(devices, 99.9);
+	result.allocationsPerLoop = loops ? (double)allocations / loops : 0.0;
+	result.cpuPercent = cpu / elapsed * 100.0;
+
+	for(unsigned int i = 0; i < device_count; ++i)
+	{
+		devices[i]->device.close();
+		delete devices[i];
+	}
+	return true;
+}
+
+enum BringupMode
+{
+	BRINGUP_SEQUENTIAL, /**< One device after the other, waiting on every chunk's echo */
+	BRINGUP_PIPELINED, /**< One device after the other, default upload window */
+	BRINGUP_PARALLEL, /**< All devices at once, default upload window */
+	BRINGUP_CACHED, /**< Firmware already running and in the cache, upload skipped */
+	BRINGUP_MODE_COUNT
+};
+
+const static char* BRINGUP_MODE_NAMES[BRINGUP_MODE_COUNT] = {"sequential", "pipelined", "parallel", "cached"};
+
+struct BringupResult
+{
+	BringupMode mode;
+	double latency;
+	unsigned int devices;
+	double seconds; /**< open() of the first device to the first sample of the last device */
+	bool skipped; /**< True if every upload was skipped by the cache */
+};
+
+/**
+ * Runs I/O loops until the device returns a sample
+ */
+bool waitForSample(FalconDevice& device, double timeout)
+{
+	double end = FalconClock::getTime() + timeout;
+	while(FalconClock::getTime() < end)
+	{
+		if(device.runIOLoop())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool runBringup(BringupMode mode, double latency, unsigned int device_count, const std::string& cache_file, BringupResult& result)
+{
+	std::vector<BenchDevice*> devices;
+	std::vector<FalconDevice*> loaders;
+	for(unsigned int i = 0; i < device_count; ++i)
+	{
+		BenchDevice* bench = new BenchDevice;
+		bench->device.setFalconComm<FalconCommSimulated>();
+		bench->device.setFalconFirmware<FalconFirmwareNovintSDK>();
+		bench->sim = boost::dynamic_pointer_cast<FalconCommSimulated>(bench->device.getFalconComm());
+		bench->sim->setLatency(latency);
+		bench->sim->setFirmwareLoaded(mode == BRINGUP_CACHED);
+		bench->device.getFalconFirmware()->setUploadWindow(mode == BRINGUP_SEQUENTIAL ? 1 : bench->device.getFalconFirmware()->getUploadWindow());
+		bench->device.setFirmwareCacheFile(cache_file);
+		devices.push_back(bench);
+		loaders.push_back(&bench->device);
+	}
+
+	bool ok = true;
+	double begin = FalconClock::getTime();
+	for(unsigned int i = 0; i < device_count && ok; ++i)
+	{
+		ok = devices[i]->device.open(0);
+	}
+	if(ok && mode == BRINGUP_PARALLEL)
+	{
+		ok = FalconFirmwareLoaderBoostThread::loadRegisteredFirmware(loaders, "nvent", false);
+	}
+	else
+	{
+		for(unsigned int i = 0; i < device_count && ok; ++i)
+		{
+			ok = devices[i]->device.loadRegisteredFirmware("nvent", false);
+		}
+	}
+	for(unsigned int i = 0; i < device_count && ok; ++i)
+	{
+		ok = waitForSample(devices[i]->device, 1.0);
+	}
+	result.seconds = FalconClock::getTime() - begin;
+	if(!ok)
+	{
+		std::cerr << "Bring-up failed (" << BRINGUP_MODE_NAMES[mode] << ", " << device_count << " device(s))" << std::endl;
+	}
+	result.mode = mode;
+	result.latency = latency;
+	result.devices = device_count;
+	result.skipped = true;
+	for(unsigned int i = 0; i < device_count; ++i)
+	{
+		result.skipped = result.skipped && devices[i]->device.wasFirmwareUploadSkipped();
+		devices[i]->device.close();
+		delete devices[i];
+	}
+	return ok;
+}
+
+void printBringup(const BringupResult& r)
+{
+	std::cout << "bring-up " << BRINGUP_MODE_NAMES[r.mode] << ", latency " << r.latency * 1000.0 << " ms, "
+			  << r.devices << " device(s): " << r.seconds * 1000.0 << " ms to first sample"
+			  << (r.skipped ? " (upload skipped)" : "") << std::endl;
+}
+
+void writeBringup(std::ostream& out, const BringupResult& r)
+{
+	out << "{\"mode\":\"" << BRINGUP_MODE_NAMES[r.mode] << "\",\"latency\":" << r.latency << ",\"devices\":" << r.devices
+		<< ",\"seconds\":" << r.seconds << ",\"upload_skipped\":" << (r.skipped ? "true" : "false") << "}";
+}
+
+void printResult(const BenchResult& r)
+{
+	std::cout << "latency " << r.latency * 1000.0 << " ms, " << r.devices << " device(s): "
+			  << r.loopsPerSecond << " loops/s, " << r.samplesPerSecond << " samples/s, cycle p50 "
+			  << r.p50 * 1e6 << " us, p99 " << r.p99 * 1e6 << " us, p99.9 " << r.p999 * 1e6 << " us, "
+			  << r.allocationsPerLoop << " allocs/loop, cpu " << r.cpuPercent << "%" << std::endl;
+}
+
+void writeResult(std::ostream& out, const BenchResult& r)
+{
+	out << "{\"latency\":" << r.latency << ",\"devices\":" << r.devices << ",\"seconds\":" << r.seconds
+		<< ",\"loops_per_second\":" << r.loopsPerSecond << ",\"samples_per_second\":" << r.samplesPerSecond
+		<< ",\"cycle_p50\":" << r.p50 << ",\"cycle_p99\":" << r.p99 << ",\"cycle_p999\":" << r.p999
+		<< ",\"allocations_per_loop\":" << r.allocationsPerLoop << ",\"cpu_percent\":" << r.cpuPercent << "}";
+}
+
+int main(int argc, char** argv)
+{
+	double seconds = 2.0;
+	double scaling_latency = 0.001;
+	unsigned int max_devices = 16;
+	unsigned int bringup_devices = 4;
+	std::vector<double> latencies;
+	std::string json_file;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(!strcmp(argv[i], "-t") && i + 1 < argc)
+		{
+			seconds = atof(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-d") && i + 1 < argc)
+		{
+			max_devices = atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-s") && i + 1 < argc)
+		{
+			scaling_latency = atof(argv[++i]) / 1000.0;
+		}
+		else if(!strcmp(argv[i], "-b") && i + 1 < argc)
+		{
+			bringup_devices = atoi(argv[++i]);
+		}
+		else if(!strcmp(argv[i], "-j") && i + 1 < argc)
+		{
+			json_file = argv[++i];
+		}
+		else if(!strcmp(argv[i], "-l") && i + 1 < argc)
+		{
+			std::stringstream list(argv[++i]);
+			std::string latency;
+			while(std::getline(list, latency, ','))
+			{
+				latencies.push_back(atof(latency.c_str()) / 1000.0);
+			}
+		}
+		else
+		{
+			std::cout << "Usage: libnifalcon_bench [-t seconds per run] [-l round trip ms,ms,...] [-s scaling round trip ms] [-d max devices] [-b bring-up devices] [-j json file]" << std::endl;
+			return 1;
+		}
+	}
+	if(latencies.empty())
+	{
+		//No latency measures the library alone, the rest are typical full speed and full/low speed USB
+		latencies.push_back(0.0);
+		latencies.push_back(0.001);
+		latencies.push_back(0.002);
+	}
+
+	std::vector<BenchResult> latency_results;
+	std::vector<BenchResult> scaling_results;
+	BenchResult result;
+	for(unsigned int i = 0; i < latencies.size(); ++i)
+	{
+		if(!runBench(latencies[i], 1, seconds, result))
+		{
+			return 1;
+		}
+		printResult(result);
+		latency_results.push_back(result);
+	}
+	for(unsigned int devices = 1; devices <= max_devices; devices *= 2)
+	{
+		if(!runBench(scaling_latency, devices, seconds, result))
+		{
+			return 1;
+		}
+		printResult(result);
+		scaling_results.push_back(result);
+	}
+
+	//Bring-up, with a throwaway cache that the cached runs find already filled in
+	std::vector<BringupResult> bringup_results;
+	BringupResult bringup;
+	std::string cache_file = "libnifalcon_bench_firmware.cache";
+	std::remove(cache_file.c_str());
+	std::vector<unsigned int> bringup_counts;
+	bringup_counts.push_back(1);
+	if(bringup_devices > 1)
+	{
+		bringup_counts.push_back(bringup_devices);
+	}
+	for(unsigned int c = 0; c < bringup_counts.size() && bringup_devices > 0; ++c)
+	{
+		for(unsigned int m = 0; m < BRINGUP_MODE_COUNT; ++m)
+		{
+			if(!runBringup((BringupMode)m, scaling_latency, bringup_counts[c], cache_file, bringup))
+			{
+				std::remove(cache_file.c_str());
+				return 1;
+			}
+			printBringup(bringup);
+			bringup_results.push_back(bringup);
+		}
+	}
+	std::remove(cache_file.c_str());
+
+	if(!json_file.empty())
+	{
+		std::ofstream out(json_file.c_str());
+		if(!out.is_open())
+		{
+			std::cerr << "Cannot write " << json_file << std::endl;
+			return 1;
+		}
+		out.precision(9);
+		out << "{\"hardware_threads\":" << boost::thread::hardware_concurrency() << ",\"latency\":[";
+		for(unsigned int i = 0; i < latency_results.size(); ++i)
+		{
+			out << (i ? "," : "") << std::endl;
+			writeResult(out, latency_results[i]);
+		}
+		out << std::endl << "],\"scaling\":[";
+		for(unsigned int i = 0; i < scaling_results.size(); ++i)
+		{
+			out << (i ? "," : "") << std::endl;
+			writeResult(out, scaling_results[i]);
+		}
+		out << std::endl << "],\"bringup\":[";
+		for(unsigned int i = 0; i < bringup_results.size(); ++i)
+		{
+			out << (i ? "," : "") << std::endl;
+			writeBringup(out, bringup_results[i]);
+		}
+		out << std::endl << "]}" << std::endl;
+	}
+	return 0;
+}
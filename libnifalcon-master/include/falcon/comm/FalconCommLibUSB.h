@@ -12,9 +12,12 @@
 #ifndef FALCONCOMMLIBUSB_H
 #define FALCONCOMMLIBUSB_H
 
+#include <string>
+#include <vector>
 #include "falcon/core/FalconComm.h"
 
 struct timeval;
+struct libusb_device;
 struct libusb_device_handle;
 struct libusb_transfer;
 struct libusb_context;
@@ -38,6 +41,12 @@ namespace libnifalcon
  * by default by the FalconDevice constructor, so it is usually not needed.
  * However, it is left here for code compatibility for code that already used comm behavior setting, which
  * was required before libnifalcon v1.0
+ *
+ * Falcons found on the bus are kept in a registry, ordered by bus/port path so indexes stay stable, along with
+ * their serial numbers. Where libusb supports hotplug, the registry is kept up to date by hotplug callbacks and
+ * the bus is only walked once; otherwise it is rescanned on every getDeviceCount()/open(), but serial numbers
+ * are still only read once per device. Unplugging is detected through hotplug departure events and
+ * LIBUSB_TRANSFER_NO_DEVICE transfer results, and reported through isDisconnected().
  */
 
 	class FalconCommLibUSB : public FalconComm
@@ -83,6 +92,25 @@ namespace libnifalcon
 		 */
 		virtual bool close();
 
+		/**
+		 * Returns the serial number of the device at the specified index
+		 *
+		 * @param[in] index Index of the device
+		 * @param[out] serial Serial number of the device (bus/port path if the serial can't be read)
+		 *
+		 * @return True if the serial was retrieved, false otherwise. Error code set if false.
+		 */
+		virtual bool getDeviceSerial(unsigned int index, std::string& serial);
+
+		/**
+		 * Opens the device with the specified serial number (or bus/port path), straight from the registry
+		 *
+		 * @param[in] serial Serial number of the device to open
+		 *
+		 * @return True if device is opened successfully, false otherwise. Error code set if false.
+		 */
+		virtual bool openBySerial(const std::string& serial);
+
 				/**
 		 * Read a specified number of bytes from the device
 		 *
@@ -156,11 +184,29 @@ namespace libnifalcon
 		 */
 		static void cb_out(struct libusb_transfer *transfer);
 
+		/**
+		 * Callback for completion of a control transfer queued by controlTransfers()
+		 */
+		static void cb_control(struct libusb_transfer *transfer);
+
+		/**
+		 * Mutator function needed by the hotplug callback for registry updates
+		 *
+		 * @param device Device that arrived or left
+		 * @param arrived True for arrival, false for departure
+		 */
+		void setHotplugEvent(struct libusb_device* device, bool arrived);
+
 		/**
 		 * Mutator function needed by static callbacks for class updates
 		 */
 		void setHasBytesAvailable(bool v);
 
+		/**
+		 * Mutator function needed by static callbacks for class updates
+		 */
+		void setDisconnected();
+
 		/**
 		 * Mutator function needed by static callbacks for class updates
 		 */
@@ -193,6 +239,92 @@ namespace libnifalcon
 		 */
 		void issueRead();
 	protected:
+		/**
+		 * Vendor control request without a data stage, as used to configure the FTDI
+		 */
+		struct ControlRequest
+		{
+			uint8_t requestType; /**< bmRequestType */
+			uint8_t request; /**< bRequest */
+			uint16_t value; /**< wValue */
+			const char* description; /**< What the request does, for error messages */
+		};
+
+		/**
+		 * Queues a run of control requests asynchronously and waits for all of them. The device executes
+		 * them in order, back to back, instead of the host waiting out a full round trip for each. There is
+		 * no guarantee on the spacing between them, so modem line changes that need the previous state to
+		 * have settled (the bootloader DTR pulse) go in batches of their own.
+		 *
+		 * @param requests Requests to send, in order
+		 * @param count Number of requests
+		 *
+		 * @return true if every request succeeded, false otherwise (m_deviceErrorCode holds the first failure)
+		 */
+		bool controlTransfers(const ControlRequest* requests, unsigned int count);
+
+		/**
+		 * Registry entry for a falcon seen on the bus
+		 */
+		struct DeviceEntry
+		{
+			libusb_device* device; /**< Referenced libusb device */
+			std::string path; /**< Bus/port path, stable for as long as the device stays in the same port */
+			std::string serial; /**< Serial number, empty until read */
+			bool hasSerial; /**< True once reading the serial has been attempted */
+		};
+
+		/**
+		 * Brings the registry up to date, either by dispatching pending hotplug events or by rescanning the bus
+		 *
+		 * @return True on success, false otherwise. Error code set if false.
+		 */
+		bool refreshRegistry();
+
+		/**
+		 * Adds a device to the registry, if it isn't already in it
+		 *
+		 * @param device Device to add
+		 */
+		void addRegistryDevice(libusb_device* device);
+
+		/**
+		 * Removes a device from the registry, and flags the connection as lost if it was the open device
+		 *
+		 * @param device Device to remove
+		 */
+		void removeRegistryDevice(libusb_device* device);
+
+		/**
+		 * Claims and initializes a device from the registry
+		 *
+		 * @param entry Registry entry of the device to open. Only read before the first libusb call, as
+		 * hotplug callbacks may change the registry during the transfers.
+		 *
+		 * @return True if device is opened successfully, false otherwise. Error code set if false.
+		 */
+		bool openDevice(const DeviceEntry& entry);
+
+		/**
+		 * Falcons currently known to be on the bus, ordered by path
+		 */
+		std::vector<DeviceEntry> m_registry;
+
+		/**
+		 * True if libusb delivers hotplug events on this platform
+		 */
+		bool m_hasHotplug;
+
+		/**
+		 * Handle for the registered hotplug callback
+		 */
+		int m_hotplugHandle;
+
+		/**
+		 * Device currently open, NULL if none
+		 */
+		libusb_device* m_openDevice;
+
 		/**
 		 * True if we currently have a write queued
 		 */ 
@@ -0,0 +1,266 @@
+/***
+ * @file FalconCommSimulated.h
+ * @brief Simulated falcon, for testing libnifalcon without hardware
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONCOMMSIMULATED_H
+#define FALCONCOMMSIMULATED_H
+
+#include <boost/array.hpp>
+#include "falcon/core/FalconComm.h"
+#include "falcon/core/FalconLogger.h"
+#include "falcon/kinematic/FalconKinematicStamper.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconCommSimulated
+ * @ingroup CommClasses
+ *
+ * FalconCommSimulated emulates a falcon running the Novint SDK firmware, so the firmware, kinematics and
+ * device code can be exercised (and benchmarked) without hardware attached.
+ *
+ * The emulation covers
+ * - The firmware loading handshake (firmware mode echoes everything written to it, and the device does not
+ *   answer I/O packets until firmware has been loaded and normal mode set)
+ * - The 16 byte I/O packet format, including LEDs, homing and grip nibbles
+ * - USB latency, as a configurable delay between a packet being written and its reply becoming readable
+ * - The mechanics, as a point mass in cartesian space. Motor values are turned back into a cartesian force
+ *   by inverting the Stamper kinematics force mapping, and encoder values are generated from the simulated
+ *   position through inverse kinematics, so they carry the same quantization as the real encoders.
+ *
+ * The user's hand is modelled as a spring/damper pulling the end effector toward a target position
+ * (see setHandTarget()). Time comes from FalconClock, so the simulation runs against the wall clock and
+ * behaves the same whether the I/O loop runs fast, slow or jittery.
+ *
+ * FalconCommSimulated is never chosen by default. Use FalconDevice::setFalconComm<FalconCommSimulated>()
+ * and cast FalconDevice::getFalconComm() to configure it.
+ */
+	class FalconCommSimulated : public FalconComm
+	{
+	public:
+		/**
+		 * Constructor
+		 *
+		 *
+		 */
+		FalconCommSimulated();
+
+		/**
+		 * Destructor
+		 *
+		 *
+		 */
+		~FalconCommSimulated();
+
+		virtual bool getDeviceCount(unsigned int& count);
+		virtual bool getDeviceSerial(unsigned int index, std::string& serial);
+		virtual bool open(unsigned int index);
+		virtual bool close();
+		virtual bool read(uint8_t* str, unsigned int size);
+		virtual bool write(uint8_t* str, unsigned int size);
+		virtual bool readBlocking(uint8_t* str, unsigned int size);
+		virtual bool writeBlocking(uint8_t* str, unsigned int size);
+		virtual bool setFirmwareMode();
+		virtual bool setNormalMode();
+
+		/**
+		 * Advances the simulation to the current time, and makes replies available once their latency has passed
+		 */
+		virtual void poll();
+
+		/**
+		 * Reset the internal state of the communications object (bytes read/written, etc...)
+		 */
+		virtual void reset();
+
+		/**
+		 * Sets the number of simulated devices reported by getDeviceCount()
+		 *
+		 * @param count Number of devices
+		 */
+		void setDeviceCount(unsigned int count) { m_deviceCount = count; }
+
+		/**
+		 * Sets the simulated USB latency. Motor values take effect half way through the round trip, which is
+		 * also when the encoders are sampled for the reply.
+		 *
+		 * @param round_trip Time between a packet being written and its reply becoming readable, in seconds
+		 */
+		void setLatency(double round_trip) { m_latency = round_trip; }
+
+		/**
+		 * Skips the firmware loading handshake, so the device answers I/O packets as soon as it is opened
+		 *
+		 * @param loaded True to simulate a device with firmware already loaded
+		 */
+		void setFirmwareLoaded(bool loaded) { m_isFirmwareLoaded = loaded; }
+
+		/**
+		 * Sets the serial rate of the bootloader link used while loading firmware. Each byte written in
+		 * firmware mode takes 10 bit times to be echoed, and echoes are only readable after half the USB
+		 * latency. Echoes that don't fit the FTDI receive buffer (ECHO_BUFFER_SIZE bytes) are lost.
+		 *
+		 * @param baud Bits per second, defaults to 140000 like the real firmware load
+		 */
+		void setFirmwareBaudRate(double baud) { m_firmwareBaudRate = baud; }
+
+		/**
+		 * Sets whether the legs report homed as soon as homing mode is requested. Defaults to true.
+		 *
+		 * @param auto_home True to home on the first packet with homing mode set
+		 */
+		void setAutoHome(bool auto_home) { m_autoHome = auto_home; }
+
+		/**
+		 * Sets the mechanical parameters of the end effector
+		 *
+		 * @param mass Effective mass at the end effector, in kg
+		 * @param damping Viscous damping of the mechanism, in N*s/m
+		 */
+		void setMechanics(double mass, double damping)
+		{
+			m_mass = mass;
+			m_damping = damping;
+		}
+
+		/**
+		 * Sets the hand model. The end effector is pulled toward the target by a spring/damper, which is
+		 * how a user holding the grip behaves to a first approximation. A stiffness of 0 lets go of the grip.
+		 *
+		 * @param target Position the hand is trying to hold, in cartesian coordinates (meters)
+		 * @param stiffness Hand stiffness, in N/m
+		 * @param damping Hand damping, in N*s/m
+		 */
+		void setHandTarget(const boost::array<double, 3>& target, double stiffness, double damping)
+		{
+			m_handTarget = target;
+			m_handStiffness = stiffness;
+			m_handDamping = damping;
+		}
+
+		/**
+		 * Sets the state of the grip buttons reported by the device
+		 *
+		 * @param buttons Bitfield of pressed buttons (lower nibble is used)
+		 */
+		void setGripButtons(unsigned int buttons) { m_gripButtons = buttons & 0x0f; }
+
+		/**
+		 * Moves the end effector to a position and stops it there
+		 *
+		 * @param position Position in cartesian coordinates (meters)
+		 */
+		void setSimulatedPosition(const boost::array<double, 3>& position);
+
+		/**
+		 * Returns the true (unquantized) simulated position
+		 *
+		 * @return Position in cartesian coordinates (meters)
+		 */
+		boost::array<double, 3> getSimulatedPosition() const { return m_position; }
+
+		/**
+		 * Returns the true simulated velocity
+		 *
+		 * @return Velocity in meters/second
+		 */
+		boost::array<double, 3> getSimulatedVelocity() const { return m_velocity; }
+
+		/**
+		 * Returns the cartesian force currently applied by the motors
+		 *
+		 * @return Force in newtons
+		 */
+		boost::array<double, 3> getSimulatedForce() const { return m_motorForce; }
+
+		/**
+		 * Returns the LED bitfield last written to the device
+		 *
+		 * @return LED bitfield (see FalconFirmware LED enum)
+		 */
+		unsigned int getLEDStatus() const { return m_ledStatus; }
+
+		/**
+		 * Simulates the USB cable being pulled. Everything up to close() fails with
+		 * FALCON_COMM_DEVICE_DISCONNECTED_ERROR, and opening fails until simulatePlug() is called.
+		 */
+		void simulateUnplug();
+
+		/**
+		 * Simulates the USB cable being plugged back in
+		 *
+		 * @param power_cycled True if the device lost power while unplugged, which loses the firmware and homing
+		 */
+		void simulatePlug(bool power_cycled);
+	protected:
+		/**
+		 * Checks that the device is open and plugged in, setting the error code if not
+		 *
+		 * @return true if I/O can go ahead
+		 */
+		bool checkConnected();
+
+		/**
+		 * Integrates the mechanics up to a point in time
+		 *
+		 * @param time Time to advance to, in seconds (FalconClock)
+		 */
+		void advance(double time);
+
+		/**
+		 * Applies the motor values of the pending packet and samples the encoders for its reply
+		 *
+		 */
+		void applyPendingPacket();
+
+		unsigned int m_deviceCount; /**< Number of devices reported */
+		unsigned int m_openIndex; /**< Index of the open device */
+		bool m_isUnplugged; /**< True while the simulated cable is pulled */
+		double m_latency; /**< Round trip latency, in seconds */
+		bool m_isFirmwareMode; /**< True while in firmware loading mode */
+		bool m_isFirmwareLoaded; /**< True once firmware has been loaded */
+		bool m_autoHome; /**< True to home on request */
+		unsigned int m_homingStatus; /**< Homed legs bitfield */
+		unsigned int m_ledStatus; /**< LED bitfield from the last packet */
+		unsigned int m_gripButtons; /**< Grip button bitfield */
+
+		enum {
+			ECHO_BUFFER_SIZE = 256 /**< FTDI receive buffer size */
+		};
+		uint8_t m_echoBuffer[ECHO_BUFFER_SIZE]; /**< Firmware mode echo buffer */
+		double m_echoTimes[ECHO_BUFFER_SIZE]; /**< Time each echoed byte arrives in the FTDI */
+		unsigned int m_echoSize; /**< Bytes in the echo buffer */
+		double m_firmwareBaudRate; /**< Bootloader link rate, in bits per second */
+		double m_lineFreeTime; /**< Time the bootloader link finishes echoing everything written */
+
+		boost::array<int, 3> m_pendingMotor; /**< Motor values of the packet in flight */
+		bool m_hasPendingPacket; /**< True if a packet is in flight */
+		bool m_hasPendingApply; /**< True if the packet in flight has not reached the device yet */
+		double m_pendingApplyTime; /**< Time the packet in flight reaches the device */
+		double m_pendingReplyTime; /**< Time the reply to the packet in flight becomes readable */
+		uint8_t m_reply[16]; /**< Reply packet */
+
+		double m_lastTime; /**< Time the simulation has been advanced to */
+		double m_mass; /**< Effective end effector mass */
+		double m_damping; /**< Mechanism damping */
+		boost::array<double, 3> m_position; /**< Simulated position */
+		boost::array<double, 3> m_velocity; /**< Simulated velocity */
+		boost::array<double, 3> m_motorForce; /**< Cartesian force applied by the motors */
+		boost::array<double, 3> m_handTarget; /**< Hand target position */
+		double m_handStiffness; /**< Hand stiffness */
+		double m_handDamping; /**< Hand damping */
+
+		FalconKinematicStamper m_kinematic; /**< Kinematics used to map between motor and cartesian space */
+	private:
+		DECLARE_LOGGER();
+	};
+}
+
+#endif
@@ -0,0 +1,211 @@
+/***
+ * @file FalconBinaryLog.h
+ * @brief Low overhead binary logging backend, usable from the I/O loop
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONBINARYLOG_H
+#define FALCONBINARYLOG_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <boost/atomic.hpp>
+
+namespace libnifalcon
+{
+/**
+ * @class FalconLogSite
+ * @ingroup CoreClasses
+ *
+ * Static description of a single log statement, created once per call site by the LOG_* macros when
+ * ENABLE_BINARY_LOGGING is defined. Records only carry a pointer to their site, so the file, line, level
+ * and logger name never get copied on the hot path. Each site also carries its own rate limit.
+ */
+	class FalconLogSite
+	{
+	public:
+		/**
+		 * Constructor
+		 *
+		 * @param file Source file of the statement
+		 * @param line Source line of the statement
+		 * @param level Log level (see FalconBinaryLog level enum)
+		 * @param logger Logger name (the class name passed to INIT_LOGGER)
+		 * @param max_per_second Most records this site may emit per second, 0 for no limit
+		 */
+		FalconLogSite(const char* file, int line, int level, const char* logger, unsigned int max_per_second);
+
+		/**
+		 * Checks the site's rate limit and counts the record against it
+		 *
+		 * @return true if the record should be written, false if it has to be dropped
+		 */
+		bool allow();
+
+		const char* file; /**< Source file */
+		int line; /**< Source line */
+		int level; /**< Log level */
+		const char* logger; /**< Logger name */
+		unsigned int maxPerSecond; /**< Rate limit, 0 for none */
+		boost::atomic<uint32_t> windowStart; /**< Second the current rate window started in */
+		boost::atomic<uint32_t> windowCount; /**< Records allowed in the current window */
+		boost::atomic<uint32_t> suppressed; /**< Records dropped by the rate limit, reported with the next record */
+	};
+
+/**
+ * @struct FalconLogRecord
+ * @ingroup CoreClasses
+ *
+ * Fixed size binary log record. The payload holds the streamed arguments as tagged values, in the order
+ * they were streamed; strings are copied in, truncated if the payload runs out.
+ */
+	struct FalconLogRecord
+	{
+		enum {
+			PAYLOAD_SIZE = 44 /**< Bytes available for arguments, keeps records at 64 bytes */
+		};
+
+		double timestamp; /**< FalconClock time the record was made at */
+		const FalconLogSite* site; /**< Call site */
+		uint16_t thread; /**< Index of the ring (thread) the record was written from */
+		uint8_t size; /**< Bytes of payload used */
+		uint8_t truncated; /**< Non-zero if arguments did not fit */
+		uint8_t payload[PAYLOAD_SIZE]; /**< Tagged arguments */
+	};
+
+/**
+ * @class FalconLogRecordBuilder
+ * @ingroup CoreClasses
+ *
+ * Collects streamed log arguments into a FalconLogRecord, and hands it to FalconBinaryLog when destroyed.
+ * Supports the argument types libnifalcon logs: strings, integers, floating point and booleans.
+ */
+	class FalconLogRecordBuilder
+	{
+	public:
+		/**
+		 * Constructor
+		 *
+		 * @param site Call site the record belongs to
+		 */
+		FalconLogRecordBuilder(const FalconLogSite& site);
+
+		/**
+		 * Destructor. Queues the record.
+		 */
+		~FalconLogRecordBuilder();
+
+		FalconLogRecordBuilder& operator<<(const char* value);
+		FalconLogRecordBuilder& operator<<(const std::string& value);
+		FalconLogRecordBuilder& operator<<(char value);
+		FalconLogRecordBuilder& operator<<(bool value);
+		FalconLogRecordBuilder& operator<<(int value) { return putSigned(value); }
+		FalconLogRecordBuilder& operator<<(long value) { return putSigned(value); }
+		FalconLogRecordBuilder& operator<<(long long value) { return putSigned(value); }
+		FalconLogRecordBuilder& operator<<(unsigned int value) { return putUnsigned(value); }
+		FalconLogRecordBuilder& operator<<(unsigned long value) { return putUnsigned(value); }
+		FalconLogRecordBuilder& operator<<(unsigned long long value) { return putUnsigned(value); }
+		FalconLogRecordBuilder& operator<<(double value);
+		FalconLogRecordBuilder& operator<<(float value) { return *this << (double)value; }
+	protected:
+		FalconLogRecordBuilder& putSigned(int64_t value);
+		FalconLogRecordBuilder& putUnsigned(uint64_t value);
+
+		/**
+		 * Appends a tagged value to the payload
+		 *
+		 * @param tag Value type
+		 * @param data Value bytes
+		 * @param size Number of value bytes
+		 */
+		void put(uint8_t tag, const void* data, unsigned int size);
+
+		FalconLogRecord m_record; /**< Record being built */
+	};
+
+/**
+ * @class FalconBinaryLog
+ * @ingroup CoreClasses
+ *
+ * Binary logging backend for FalconLogger.h. Building with ENABLE_BINARY_LOGGING (instead of the log4cxx
+ * ENABLE_LOGGING) turns every LOG_* statement into a 64 byte record written to a lock-free single
+ * producer/single consumer ring owned by the calling thread: a clock read, a few stores per argument and
+ * no formatting, locks or system calls, so logging can stay on in the I/O loop.
+ *
+ * Some other thread has to drain the rings, by calling drain() periodically (FalconBinaryLogBoostThread in
+ * the util library does this from a background thread). Records are formatted as text on that thread.
+ * When a ring is full, records are dropped and counted (see getDroppedCount()).
+ *
+ * Two knobs keep the volume down:
+ * - FALCON_BINARY_LOG_LEVEL (compile time, defaults to LEVEL_DEBUG) compiles out statements below it
+ * - FALCON_BINARY_LOG_RATE (compile time, defaults to 100) caps records per second from each call site.
+ *   Records dropped by the cap are reported as a count on the site's next record.
+ *
+ * Up to MAX_THREADS threads can log at the same time. Rings are never freed, but when a thread exits its
+ * ring goes back on a free list and is handed to the next thread that starts logging.
+ */
+	class FalconBinaryLog
+	{
+	public:
+		enum {
+			LEVEL_DEBUG = 0,
+			LEVEL_INFO,
+			LEVEL_WARN,
+			LEVEL_ERROR,
+			LEVEL_FATAL
+		};
+
+		enum {
+			RING_SIZE = 1024, /**< Records per thread ring */
+			MAX_THREADS = 32 /**< Most threads that can log at the same time */
+		};
+
+		/**
+		 * Queues a record on the calling thread's ring. Called by FalconLogRecordBuilder.
+		 *
+		 * @param record Record to queue
+		 */
+		static void write(FalconLogRecord& record);
+
+		/**
+		 * Formats every queued record as a line of text. Must only be called from one thread at a time.
+		 *
+		 * @param out Stream to write to
+		 *
+		 * @return Number of records written
+		 */
+		static unsigned int drain(std::ostream& out);
+
+		/**
+		 * Formats a single record as text (without a trailing newline)
+		 *
+		 * @param record Record to format
+		 * @param out Stream to write to
+		 */
+		static void format(const FalconLogRecord& record, std::ostream& out);
+
+		/**
+		 * Returns the number of records dropped because a ring was full or too many threads logged
+		 *
+		 * @return Dropped record count
+		 */
+		static uint64_t getDroppedCount();
+
+		/**
+		 * Returns the name of a log level
+		 *
+		 * @param level Log level
+		 *
+		 * @return Level name
+		 */
+		static const char* getLevelName(int level);
+	};
+}
+
+#endif
@@ -0,0 +1,75 @@
+/***
+ * @file FalconClock.h
+ * @brief Portable monotonic clock used to timestamp falcon samples
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONCLOCK_H
+#define FALCONCLOCK_H
+
+#if defined(WIN32) || defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
+
+namespace libnifalcon
+{
+/**
+ * @class FalconClock
+ * @ingroup CoreClasses
+ *
+ * FalconClock wraps the highest resolution monotonic clock available on the platform (QueryPerformanceCounter
+ * on windows, mach_absolute_time on OS X, CLOCK_MONOTONIC everywhere else). Timestamps are only meaningful
+ * relative to each other, and are never affected by wall clock adjustments.
+ */
+	class FalconClock
+	{
+	public:
+		/**
+		 * Returns the current value of the monotonic clock
+		 *
+		 * @return Time in seconds from an unspecified starting point
+		 */
+		static double getTime()
+		{
+#if defined(WIN32) || defined(_WIN32)
+			static double period = 0.0;
+			LARGE_INTEGER count;
+			if(period == 0.0)
+			{
+				LARGE_INTEGER freq;
+				QueryPerformanceFrequency(&freq);
+				period = 1.0 / (double)freq.QuadPart;
+			}
+			QueryPerformanceCounter(&count);
+			return (double)count.QuadPart * period;
+#elif defined(__APPLE__)
+			static double period = 0.0;
+			if(period == 0.0)
+			{
+				mach_timebase_info_data_t info;
+				mach_timebase_info(&info);
+				period = ((double)info.numer / (double)info.denom) * 1e-9;
+			}
+			return (double)mach_absolute_time() * period;
+#else
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+		}
+	};
+}
+
+#endif
@@ -13,6 +13,7 @@
 #define FALCONCOMMBASE_H
 
 #include <stdint.h>
+#include <string>
 #include "falcon/core/FalconCore.h"
 
 namespace libnifalcon
@@ -78,6 +79,11 @@ namespace libnifalcon
  *
  * While FalconComm is mainly geared toward making sure we can talk to the device, it can also be used for
  * test purposes, like building network interfaces to emulate the falcon hardware.
+ *
+ * Communications cores that can tell devices apart report a serial number for each of them
+ * (getDeviceSerial()), which lets a device be found again with openBySerial() after indexes have shifted,
+ * i.e. after the device was unplugged and plugged back in. Cores that can detect unplugging report it
+ * through isDisconnected(); FalconDevice uses this to reconnect automatically.
  */
  
 	class FalconComm : public FalconCore
@@ -91,7 +97,9 @@ namespace libnifalcon
 			FALCON_COMM_DEVICE_INDEX_OUT_OF_RANGE_ERROR, /*!< Device index for opening out of range of available devices */
 			FALCON_COMM_FIRMWARE_NOT_FOUND_ERROR, /*!< Firmware file not found */
 			FALCON_COMM_WRITE_ERROR, /*!< Write timeout hit, underflow, etc... */
-			FALCON_COMM_READ_ERROR /*!< Read timeout hit, underflow, etc... */
+			FALCON_COMM_READ_ERROR, /*!< Read timeout hit, underflow, etc... */
+			FALCON_COMM_DEVICE_DISCONNECTED_ERROR, /*!< Device was unplugged while open */
+			FALCON_COMM_NOT_SUPPORTED_ERROR /*!< Operation not supported by this communications core */
 		};
 
 		/**
@@ -101,6 +109,7 @@ namespace libnifalcon
 		 */
 		FalconComm() :
 			m_isCommOpen(false),
+			m_isDisconnected(false),
 			m_hasBytesAvailable(false),
 			m_bytesAvailable(0)
 		{}
@@ -137,6 +146,54 @@ namespace libnifalcon
 		 * @return True if device is closed successfully, false otherwise. Error code set if false.
 		 */
 		virtual bool close() = 0;
+
+		/**
+		 * Returns the serial number of the device at the specified index
+		 *
+		 * @param[in] index Index of the device
+		 * @param[out] serial Serial number of the device
+		 *
+		 * @return True if the serial was retrieved, false otherwise (or if not supported). Error code set if false.
+		 */
+		virtual bool getDeviceSerial(unsigned int /*index*/, std::string& /*serial*/)
+		{
+			m_errorCode = FALCON_COMM_NOT_SUPPORTED_ERROR;
+			return false;
+		}
+
+		/**
+		 * Opens the device with the specified serial number. The default implementation looks the serial up
+		 * with getDeviceSerial() and opens by index; cores with a faster path should override it.
+		 *
+		 * @param[in] serial Serial number of the device to open
+		 *
+		 * @return True if device is opened successfully, false otherwise. Error code set if false.
+		 */
+		virtual bool openBySerial(const std::string& serial)
+		{
+			unsigned int count;
+			if(!getDeviceCount(count))
+			{
+				return false;
+			}
+			for(unsigned int i = 0; i < count; ++i)
+			{
+				std::string device_serial;
+				if(getDeviceSerial(i, device_serial) && device_serial == serial)
+				{
+					return open(i);
+				}
+			}
+			m_errorCode = FALCON_COMM_DEVICE_NOT_FOUND_ERROR;
+			return false;
+		}
+
+		/**
+		 * Returns the serial number of the currently open device
+		 *
+		 * @return Serial number, empty if no device is open or the core can't tell
+		 */
+		const std::string& getOpenDeviceSerial() const { return m_openDeviceSerial; }
 		
 		/**
 		 * Read a specified number of bytes from the device
@@ -226,6 +283,14 @@ namespace libnifalcon
 		 */
 		bool isCommOpen() { return m_isCommOpen; }
 
+		/**
+		 * Returns whether the open device has been unplugged. Stays true until the device is closed
+		 * and reopened.
+		 *
+		 * @return True if the device was lost while open, false otherwise
+		 */
+		bool isDisconnected() { return m_isDisconnected; }
+
 		/**
 		 * Reset the internal state of the communications object (bytes read/written, etc...)
 		 */
@@ -265,6 +330,8 @@ namespace libnifalcon
 		int m_lastBytesRead;	/**< Number of bytes read in last read operation */
 		int m_lastBytesWritten; /**< Number of bytes written in the last write operation */
 		bool m_isCommOpen; 	/**< Whether or not the communications are open */
+		bool m_isDisconnected; /**< Whether or not the open device has been unplugged */
+		std::string m_openDeviceSerial; /**< Serial number of the open device */
 		bool m_hasBytesAvailable; /**< Whether or not the object has bytes available to read */
 		int m_bytesAvailable; /**< Number of bytes object has available to read */
 	};
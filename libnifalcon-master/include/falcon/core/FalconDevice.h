@@ -16,12 +16,18 @@
 #include <string>
 #include <boost/shared_ptr.hpp>
 #include <boost/array.hpp>
+#include <boost/atomic.hpp>
 #include "falcon/core/FalconLogger.h"
 #include "falcon/core/FalconCore.h"
 #include "falcon/core/FalconComm.h"
 #include "falcon/core/FalconFirmware.h"
 #include "falcon/core/FalconKinematic.h"
 #include "falcon/core/FalconGrip.h"
+#include "falcon/core/FalconVelocityEstimator.h"
+#include "falcon/core/FalconState.h"
+#include "falcon/core/FalconForceChannel.h"
+#include "falcon/core/FalconFlightRecorder.h"
+#include "falcon/core/FalconMetrics.h"
 
 namespace libnifalcon
 {
@@ -37,6 +43,7 @@ namespace libnifalcon
  * - Firmware
  * - Grip
  * - Kinematics
+ * - Velocity Estimation (optional)
  *
  * Once these behaviors are established, FalconDevice can be used to get/set common parameters (end
  * effector position, force generation, LED status, button/grip status, etc...) without have to refer
@@ -51,6 +58,42 @@ namespace libnifalcon
  * - Close device
  *
  * All of the above functions can be achieved through using the FalconDevice object.
+ *
+ * Every time runIOLoop() receives a new sample from the falcon, it timestamps it, runs the velocity
+ * estimator (if one is set) and publishes a FalconState snapshot. getState() can be called from any
+ * thread to retrieve a consistent copy of the last snapshot without blocking the I/O loop.
+ *
+ * @section PositionPrediction Position Prediction
+ *
+ * By the time a force is written to the falcon, the position it was computed from is already a USB round
+ * trip old, and the force takes effect another half round trip later. At high stiffness that lag is enough
+ * to make contact buzz. When runIOLoop() is given the FALCON_LOOP_PREDICTION flag and a velocity estimator
+ * is set, the position is extrapolated to the expected actuation time using the measured round trip
+ * (FalconFirmware::getRoundTripTime()) and the estimated velocity and acceleration. The prediction is
+ * clamped (see setPredictionLimits()), used for the kinematic force mapping, and exposed through
+ * getPredictedPosition() and the state snapshot so applications can compute their forces against it.
+ *
+ * @section Reconnection Reconnection
+ *
+ * If the communications core reports the device as unplugged (FalconComm::isDisconnected()), runIOLoop()
+ * fails with FALCON_DEVICE_DISCONNECTED. With setAutoReconnect() enabled, runIOLoop() instead retries
+ * opening the same device (by serial number when the core supports it, otherwise by index) at a limited
+ * rate. Once it is back, the firmware is checked and reloaded if the device was power cycled, and the
+ * LED and homing settings carry over since they live in the firmware object. Reconnecting blocks the
+ * loop for the firmware check, so expect one long iteration.
+ *
+ * @section FlightRecorder Flight Recorder
+ *
+ * Every sample (and every loop status change, such as an unplug) is appended to a FalconFlightRecorder,
+ * which by default keeps the last FLIGHT_RECORDER_SIZE records in memory. Use getFlightRecorder() to
+ * move it to a memory mapped file (before the I/O loop starts) or dump it, and setFlightRecorderDumpFile()
+ * with dumpRequestedFlightRecord() to have it dumped when something goes wrong.
+ *
+ * @section Metrics Metrics
+ *
+ * The I/O loop keeps a FalconMetrics up to date with sample rate and round trip histograms, position
+ * solve statistics, and error counters from the firmware and kinematics. Use getMetrics() to read them or
+ * export them to a Prometheus text file or shared memory, from a thread other than the I/O thread.
  */
 
 	class FalconDevice : public FalconCore
@@ -63,13 +106,20 @@ namespace libnifalcon
 			FALCON_DEVICE_NO_GRIP_SET, /**< Error for no grip policy set */
 			FALCON_DEVICE_NO_FIRMWARE_LOADED, /**< Error for no firmware loaded */
 			FALCON_DEVICE_FIRMWARE_NOT_VALID, /**< Error for firmware file missing */
-			FALCON_DEVICE_FIRMWARE_CHECKSUM_MISMATCH /**< Error for checksum mismatch during firmware loading */
+			FALCON_DEVICE_FIRMWARE_CHECKSUM_MISMATCH, /**< Error for checksum mismatch during firmware loading */
+			FALCON_DEVICE_DISCONNECTED /**< Error for device unplugged (and not reconnected yet) */
+		};
+
+		enum {
+			FLIGHT_RECORDER_SIZE = 4096 /**< Default flight recorder capacity, about 4 seconds of samples */
 		};
 
 		enum {
 			FALCON_LOOP_FIRMWARE = 0x1, /**< runIOLoop should run firmware update (device read/write) */
 			FALCON_LOOP_KINEMATIC = 0x2, /**< runIOLoop should run kinematic update (end effector position and force calculation) */
-			FALCON_LOOP_GRIP = 0x4  /**< runIOLoop should run grip information update */
+			FALCON_LOOP_GRIP = 0x4,  /**< runIOLoop should run grip information update */
+			FALCON_LOOP_ESTIMATOR = 0x8,  /**< runIOLoop should run velocity/acceleration estimation (requires kinematic update) */
+			FALCON_LOOP_PREDICTION = 0x10  /**< runIOLoop should compute forces against the predicted position (requires estimation, off by default) */
 		};
 
 		/**
@@ -123,6 +173,45 @@ namespace libnifalcon
 		 */
 		bool loadFirmware(bool skip_checksum);
 
+		/**
+		 * Loads a firmware image from memory
+		 *
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 * @param firmware_size Size of the firmware image
+		 * @param buffer Firmware image
+		 *
+		 * @return true if firmware is loaded successfully, false otherwise
+		 */
+		bool loadFirmware(bool skip_checksum, const unsigned int& firmware_size, uint8_t* buffer);
+
+		/**
+		 * Loads one of the images compiled into the library (see FalconFirmwareRegistry). The image is only
+		 * unpacked if it actually has to be uploaded.
+		 *
+		 * @param name Registered image name, "nvent" is the recommended firmware
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 * @param retries Number of upload attempts
+		 *
+		 * @return true if firmware is loaded successfully, false otherwise
+		 */
+		bool loadRegisteredFirmware(const std::string& name, bool skip_checksum, unsigned int retries = 1);
+
+		/**
+		 * Sets a file that remembers which firmware image (by CRC32) was last loaded to each device serial.
+		 * When set, the loadFirmware() calls skip the upload if the device already runs the requested image
+		 * (it answers I/O packets and the cache has a matching checksum for its serial). Defaults to no cache.
+		 *
+		 * @param filename Cache file, empty to turn the cache off
+		 */
+		void setFirmwareCacheFile(const std::string& filename) { m_firmwareCacheFile = filename; }
+
+		/**
+		 * Returns whether the last loadFirmware() call skipped the upload thanks to the firmware cache
+		 *
+		 * @return true if the upload was skipped
+		 */
+		bool wasFirmwareUploadSkipped() const { return m_wasFirmwareUploadSkipped; }
+
 		/**
 		 * Returns the number of falcons currectly connected to the system
 		 *
@@ -152,11 +241,14 @@ namespace libnifalcon
 		 * - If firmware not set, return false
 		 * - Run firmware IO Loop, return false if fails
 		 * - If falcon is homed and kinematic behavior is set, Run kinematic update, return false if fails
-		 * - If grip behavior is set, run grip update, return false if fails
+		 * - If grip behavior is set, run grip update, return false if fails. New samples also queue debounced
+		 *   button events (see FalconGrip::popEvent())
+		 * - If a new sample was received and a velocity estimator is set, run estimator update
+		 * - Publish the state snapshot returned by getState()
 		 *
 		 * @return true on success, false otherwise
 		 */
-		bool runIOLoop(unsigned int exe_flags = (FALCON_LOOP_FIRMWARE | FALCON_LOOP_KINEMATIC | FALCON_LOOP_GRIP));
+		bool runIOLoop(unsigned int exe_flags = (FALCON_LOOP_FIRMWARE | FALCON_LOOP_KINEMATIC | FALCON_LOOP_GRIP | FALCON_LOOP_ESTIMATOR));
 
 		/**
 		 * Set communications behavior type, and create a new internal object from it.
@@ -192,6 +284,14 @@ namespace libnifalcon
 		template<class T>
 		void setFalconKinematic();
 
+		/**
+		 * Set velocity estimator behavior, and create a new internal object from it.
+		 *
+		 * Template should be a subclass of FalconVelocityEstimator
+		 */
+		template<class T>
+		void setFalconVelocityEstimator();
+
 		/**
 		 * Return the position given by the kinematic behavior.
 		 *
@@ -200,7 +300,51 @@ namespace libnifalcon
 		boost::array<double, 3> getPosition() { return m_position; }
 
 		/**
-		 * Set the instantanious force for the next I/O loop
+		 * Return the velocity given by the velocity estimator behavior. Zero if no estimator is set.
+		 *
+		 * @return Array of 3 doubles, representing velocity in meters/second
+		 */
+		boost::array<double, 3> getVelocity() { return m_ioState.velocity; }
+
+		/**
+		 * Return the acceleration given by the velocity estimator behavior. Zero if no estimator is set.
+		 *
+		 * @return Array of 3 doubles, representing acceleration in meters/second^2
+		 */
+		boost::array<double, 3> getAcceleration() { return m_ioState.acceleration; }
+
+		/**
+		 * Return the position extrapolated to when the next force write takes effect. Same as getPosition()
+		 * unless the I/O loop runs with FALCON_LOOP_PREDICTION and a velocity estimator is set.
+		 *
+		 * @return Array of 3 doubles, representing 3D cartesian coordinate
+		 */
+		boost::array<double, 3> getPredictedPosition() { return m_predictedPosition; }
+
+		/**
+		 * Sets how far the position predictor is allowed to extrapolate. Guards against bad velocity
+		 * estimates and latency spikes throwing the predicted position across the workspace.
+		 *
+		 * @param max_horizon Longest time to extrapolate over, in seconds
+		 * @param max_distance Largest distance the prediction may move away from the measured position, in meters
+		 */
+		void setPredictionLimits(double max_horizon, double max_distance)
+		{
+			m_maxPredictionHorizon = max_horizon;
+			m_maxPredictionDistance = max_distance;
+		}
+
+		/**
+		 * Copies the state snapshot published by the last I/O loop. Safe to call from any thread while
+		 * another thread is running runIOLoop().
+		 *
+		 * @param state Snapshot to copy into
+		 */
+		void getState(FalconState& state) const;
+
+		/**
+		 * Set the instantanious force for the next I/O loop. Ignored while the force channel is active
+		 * (see getForceChannel()).
 		 *
 		 * @param force Force vector, in cartesian coordinates (x,y,z)
 		 */
@@ -211,6 +355,14 @@ namespace libnifalcon
 			m_forceVec[2] = force[2];
 		}
 
+		/**
+		 * Get the channel used to send force setpoints and linear force models to the I/O loop from
+		 * another thread. The I/O loop interpolates/evaluates them every tick (see FalconForceChannel).
+		 *
+		 * @return Reference to the device's force channel
+		 */
+		FalconForceChannel& getForceChannel() { return m_forceChannel; }
+
 		/**
 		 * Get communication behavior object pointer
 		 *
@@ -239,6 +391,13 @@ namespace libnifalcon
 		 */
 		boost::shared_ptr<FalconKinematic> getFalconKinematic() { return m_falconKinematic; }
 
+		/**
+		 * Get velocity estimator behavior object pointer
+		 *
+		 * @return Non-smart pointer to internal falcon velocity estimator object
+		 */
+		boost::shared_ptr<FalconVelocityEstimator> getFalconVelocityEstimator() { return m_falconVelocityEstimator; }
+
 		/**
 		 * Checks whether the falcon communications are open
 		 *
@@ -259,14 +418,167 @@ namespace libnifalcon
 		 * @return Number of errors generated by the I/O loop since device creation
 		 */
 		unsigned int getErrorCount() { return m_errorCount; }
+
+		/**
+		 * Sets whether runIOLoop() should try to reopen the device after it has been unplugged
+		 *
+		 * @param auto_reconnect True to reconnect automatically, false to fail with FALCON_DEVICE_DISCONNECTED
+		 * @param interval Minimum time between reconnection attempts, in seconds
+		 */
+		void setAutoReconnect(bool auto_reconnect, double interval = 0.5)
+		{
+			m_autoReconnect = auto_reconnect;
+			m_reconnectInterval = interval;
+		}
+
+		/**
+		 * Checks whether the device has been lost and not reconnected yet
+		 *
+		 * @return True if the device was unplugged while open
+		 */
+		bool isDisconnected() { return m_isReconnectPending || (m_falconComm != NULL && m_falconComm->isDisconnected()); }
+
+		/**
+		 * Get the number of times the device has been reconnected
+		 *
+		 * @return Number of successful reconnections since the device was opened
+		 */
+		unsigned int getReconnectCount() { return m_reconnectCount; }
+
+		/**
+		 * Returns the flight recorder, which keeps the recent history of the I/O loop
+		 *
+		 * @return Flight recorder. Only the I/O loop may append to it, and it may only be moved (open(),
+		 * allocate(), close()) while the I/O loop is not running.
+		 */
+		FalconFlightRecorder& getFlightRecorder() { return m_flightRecorder; }
+
+		/**
+		 * Sets a file for the flight recorder to be dumped to (as CSV) when the I/O loop hits a kinematic
+		 * error, fails firmware I/O or loses the device. The I/O loop only flags the dump; it is written by the next call to
+		 * dumpRequestedFlightRecord(). Must not be called while that runs.
+		 *
+		 * @param filename File to dump to, empty to turn automatic dumps off
+		 * @param seconds How much history to dump, 0 for the whole ring
+		 */
+		void setFlightRecorderDumpFile(const std::string& filename, double seconds = 0.0)
+		{
+			m_flightDumpFile = filename;
+			m_flightDumpSeconds = seconds;
+		}
+
+		/**
+		 * Writes the flight recorder to the file set by setFlightRecorderDumpFile(), if the I/O loop has
+		 * hit an error since the last call. Dumps are formatted and written by the calling thread, so this
+		 * should be polled from an application or helper thread, not the I/O thread. At most one dump is
+		 * written a second; errors in between are covered by the next one.
+		 *
+		 * @return true if a dump was written
+		 */
+		bool dumpRequestedFlightRecord();
+
+		/**
+		 * Returns the I/O loop metrics
+		 *
+		 * @return Metrics. Only the I/O loop may update them.
+		 */
+		FalconMetrics& getMetrics() { return m_metrics; }
 	protected:
+		/**
+		 * Appends the current loop state to the flight recorder, requesting a dump if the status is an error
+		 *
+		 * @param status FalconFlightRecord status flags
+		 */
+		void recordFlight(uint8_t status);
+
+		/**
+		 * Tries to reopen a device that was unplugged, and reload its firmware if needed. Rate limited by the
+		 * reconnect interval.
+		 *
+		 * @return true if the device is back and ready for I/O, false otherwise
+		 */
+		bool reconnect();
+
+		/**
+		 * Copies the I/O loop's working state into the snapshot read by getState()
+		 *
+		 */
+		void publishState();
+
+		/**
+		 * Extrapolates the last position using the velocity estimator results
+		 *
+		 * @param horizon Time to extrapolate over, in seconds (clamped to the prediction limits)
+		 * @param predicted Array to write the predicted position to
+		 */
+		void predictPosition(double horizon, boost::array<double, 3>& predicted);
+
+		/**
+		 * Loads a firmware image, unless the firmware cache says the device already runs it
+		 *
+		 * @param image Firmware image
+		 * @param retries Number of upload attempts
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 *
+		 * @return true if firmware is loaded, false otherwise (FALCON_DEVICE_FIRMWARE_NOT_VALID if the image is empty)
+		 */
+		bool loadFirmwareImage(const std::vector<uint8_t>& image, unsigned int retries, bool skip_checksum);
+
+		/**
+		 * Checks the firmware cache for the device's serial and asks the device whether it runs firmware
+		 *
+		 * @param checksum CRC32 of the image to load
+		 *
+		 * @return true if the upload can be skipped, false otherwise
+		 */
+		bool isFirmwareCached(uint32_t checksum);
+
+		/**
+		 * Uploads a firmware image, and records it in the firmware cache on success
+		 *
+		 * @param buffer Firmware image
+		 * @param firmware_size Size of the firmware image
+		 * @param checksum CRC32 of the image
+		 * @param retries Number of upload attempts
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 *
+		 * @return true if firmware is loaded, false otherwise
+		 */
+		bool uploadFirmware(uint8_t* buffer, unsigned int firmware_size, uint32_t checksum, unsigned int retries, bool skip_checksum);
+
 		unsigned int m_errorCount;	/**< Number of errors in I/O loops */
+		unsigned int m_deviceIndex; /**< Index the device was opened with */
+		std::string m_deviceSerial; /**< Serial number of the open device, empty if the comm core can't tell */
+		bool m_autoReconnect; /**< True to reconnect after unplugging */
+		bool m_isReconnectPending; /**< True from losing the device until it has been reconnected */
+		double m_reconnectInterval; /**< Minimum time between reconnection attempts, in seconds */
+		double m_lastReconnectAttempt; /**< Time of the last reconnection attempt (FalconClock) */
+		unsigned int m_reconnectCount; /**< Number of successful reconnections */
+		std::string m_firmwareCacheFile; /**< File mapping device serials to loaded firmware checksums */
+		bool m_wasFirmwareUploadSkipped; /**< True if the last firmware load was skipped by the cache */
+		FalconFlightRecorder m_flightRecorder; /**< Recent loop history */
+		uint8_t m_flightStatus; /**< Status flags to add to the next flight record */
+		bool m_isIOFailing; /**< True from a failed firmware I/O loop until the next successful one */
+		std::string m_flightDumpFile; /**< File to dump the flight recorder to on errors */
+		double m_flightDumpSeconds; /**< History to dump on errors */
+		double m_lastFlightDump; /**< Time of the last automatic dump */
+		boost::atomic<bool> m_flightDumpRequested; /**< Set by the I/O loop on errors, cleared by dumpRequestedFlightRecord() */
+		FalconMetrics m_metrics; /**< I/O loop counters and histograms */
 		boost::shared_ptr<FalconComm> m_falconComm; /**< Falcon communication object */
 		boost::shared_ptr<FalconKinematic> m_falconKinematic; /**<  Falcon kinematics object */
 		boost::shared_ptr<FalconFirmware> m_falconFirmware; /**<  Falcon firmware object */
 		boost::shared_ptr<FalconGrip> m_falconGrip; /**< Falcon grip object */
+		boost::shared_ptr<FalconVelocityEstimator> m_falconVelocityEstimator; /**< Falcon velocity estimator object */
 		boost::array<double, 3> m_position;	/**< Current position in 3D cartesian coordinates */
 		boost::array<double, 3> m_forceVec;	/**< Current force in 3D cartesian coordinates */
+		FalconForceChannel m_forceChannel; /**< Force commands from application threads */
+		boost::array<double, 3> m_predictedPosition; /**< Position extrapolated to the next actuation time */
+		double m_maxPredictionHorizon; /**< Longest prediction horizon, in seconds */
+		double m_maxPredictionDistance; /**< Largest prediction offset, in meters */
+		uint64_t m_lastOutputCount; /**< Firmware output count at the last sample, used to detect new samples */
+		FalconState m_ioState; /**< State being built by the I/O loop */
+		FalconState m_publishedState; /**< Last published state, guarded by m_stateSequence */
+		boost::atomic<uint32_t> m_stateSequence; /**< Seqlock sequence for m_publishedState, odd while a write is in progress */
 	private:
 		DECLARE_LOGGER();
 	};
@@ -303,6 +615,12 @@ namespace libnifalcon
 		m_falconKinematic.reset(new T());
 	}
 
+	template<class T>
+	void FalconDevice::setFalconVelocityEstimator()
+	{
+		m_falconVelocityEstimator.reset(new T());
+	}
+
 }
 
 #endif
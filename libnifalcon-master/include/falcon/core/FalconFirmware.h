@@ -17,6 +17,7 @@
 #include <string>
 #include <cstdlib>
 #include <deque>
+#include <vector>
 #include "boost/array.hpp"
 #include "boost/shared_ptr.hpp"
 #include "falcon/core/FalconComm.h"
@@ -85,6 +86,10 @@ namespace libnifalcon
 			FALCON_FIRMWARE_CHECKSUM_MISMATCH /**< Error for checksum mismatch during firmware loading */
 		} FalconFirmwareErrorValues;
 
+		enum {
+			NO_REGISTERED_IMAGE = 0xffffffff /**< m_registeredImage value when the image didn't come from FalconFirmwareRegistry */
+		};
+
 
 		/**
 		 * Constructor
@@ -140,6 +145,14 @@ namespace libnifalcon
 			m_forceValues[1] = force[1];
 			m_forceValues[2] = force[2];
 		}
+
+		/**
+		 * Returns the forces that will be sent in the next I/O loop
+		 *
+		 * @return Signed 16-bit integers representing the motor forces
+		 */
+		boost::array<int, 3> getForces() { return m_forceValues; }
+
 		/**
 		 * Returns an array of current motor encoder values from the last I/O loop
 		 *
@@ -212,6 +225,47 @@ namespace libnifalcon
 		 */
 		bool setFirmwareFile(const std::string& filename);
 
+		/**
+		 * Reads the file set by setFirmwareFile()
+		 *
+		 * @param image Vector to fill with the firmware image
+		 *
+		 * @return true if the file was read, false otherwise
+		 */
+		bool readFirmwareFile(std::vector<uint8_t>& image);
+
+		/**
+		 * Sets the image reloadFirmware() sends, without uploading it. Used when the device is known to
+		 * already run the image.
+		 *
+		 * @param image Firmware image
+		 */
+		void setFirmwareImage(const std::vector<uint8_t>& image) { m_firmwareImage = image; m_registeredImage = NO_REGISTERED_IMAGE; }
+
+		/**
+		 * Sets a FalconFirmwareRegistry image as the one reloadFirmware() sends, without uploading it or
+		 * unpacking it. Used when the device is known to already run the image.
+		 *
+		 * @param index Registry image index
+		 */
+		void setRegisteredFirmwareImage(unsigned int index) { m_firmwareImage.clear(); m_registeredImage = index; }
+
+		/**
+		 * Sets how many chunks of firmware may be on their way to the bootloader before their echo has
+		 * been read back. More than one keeps the serial line busy while echoes make their way back over
+		 * USB. The FTDI receive buffer has to hold every echo in flight, so keep this low.
+		 *
+		 * @param chunks Chunks in flight (62 bytes each), 1 to wait for every echo before sending on
+		 */
+		void setUploadWindow(unsigned int chunks) { m_uploadWindow = (chunks > 0) ? chunks : 1; }
+
+		/**
+		 * Returns the number of firmware chunks allowed in flight during upload
+		 *
+		 * @return Chunks in flight
+		 */
+		unsigned int getUploadWindow() const { return m_uploadWindow; }
+
         /**
 		 * Conveinence function, calls loadFirmware with a certain number of retries
 		 *
@@ -243,6 +297,16 @@ namespace libnifalcon
 		 */
 		bool loadFirmware(bool skip_checksum, const unsigned int& firmware_size, uint8_t* buffer);
 
+		/**
+		 * Loads the last firmware that was successfully loaded again. Used when a device comes back from being
+		 * unplugged or power cycled, without the application having to keep the firmware buffer around.
+		 *
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 *
+		 * @return true if firmware is loaded successfully, false otherwise (including when no firmware was ever loaded)
+		 */
+		bool reloadFirmware(bool skip_checksum = false);
+
 		/**
 		 * Used to reset the state of the communications if reloading firmware more than once in the same session
 		 *
@@ -250,6 +314,8 @@ namespace libnifalcon
 		virtual void resetFirmwareState()
 		{
 			m_hasWritten = false;
+			m_roundTripTime = 0.0;
+			m_lastRoundTripTime = 0.0;
 		}
 
 		/**
@@ -265,10 +331,50 @@ namespace libnifalcon
 		 * @return number of successful I/O loops
 		 */		
 		uint64_t getLoopCount() { return m_loopCount; }
+
+		/**
+		 * Get the number of complete packets parsed from the falcon. Changes every time new encoder
+		 * values are available.
+		 *
+		 * @return number of packets received
+		 */
+		uint64_t getOutputCount() { return m_outputCount; }
+
+		/**
+		 * Get the measured time between writing a packet and reading its reply, smoothed over
+		 * recent loops. This is the USB latency the force computation has to make up for.
+		 *
+		 * @return Round trip time in seconds, 0 if no round trip has been measured yet
+		 */
+		double getRoundTripTime() { return m_roundTripTime; }
+
+		/**
+		 * Returns the unsmoothed round trip time of the last packet
+		 *
+		 * @return Round trip time in seconds, 0 if no round trip has been measured yet
+		 */
+		double getLastRoundTripTime() { return m_lastRoundTripTime; }
+
+		/**
+		 * Returns the number of malformed packets thrown away since the firmware object was created
+		 *
+		 * @return Malformed packet count
+		 */
+		uint64_t getMalformedPacketCount() { return m_malformedPacketCount; }
+
+		/**
+		 * Returns the number of I/O loops that found no reply waiting for the last write
+		 *
+		 * @return Read underrun count
+		 */
+		uint64_t getReadUnderrunCount() { return m_readUnderrunCount; }
 	protected:
 		boost::shared_ptr<FalconComm> m_falconComm; /**< Communications object for I/O */
 		std::string m_firmwareFilename; /**< Filename of the firmware to load */
+		std::vector<uint8_t> m_firmwareImage; /**< Last firmware image loaded successfully, for reloadFirmware() */
+		unsigned int m_registeredImage; /**< Registry index of the last image loaded, if it came from FalconFirmwareRegistry */
 		bool m_isFirmwareLoaded; /**< True if firmware has been loaded, false otherwise */
+		unsigned int m_uploadWindow; /**< Firmware chunks in flight during upload */
 
 		//Values sent to falcon
 		bool m_homingMode;		/**< True if homing mode is on, false for homing mode off */
@@ -280,8 +386,13 @@ namespace libnifalcon
 		unsigned int m_homingStatus; /**< Current homing status from the last I/O loop */
 
 		uint64_t m_loopCount; /**< Number of successful loops that have been run by this firmware instance */
-		uint64_t m_outputCount; /**< Number of successful loops that have been run by this firmware instance */
+		uint64_t m_outputCount; /**< Number of complete packets that have been parsed by this firmware instance */
 		bool m_hasWritten; /**< True if we're waiting for a read return */
+		double m_lastWriteTime; /**< Time the last I/O packet was written (FalconClock) */
+		double m_roundTripTime; /**< Smoothed write to read time, in seconds */
+		double m_lastRoundTripTime; /**< Write to read time of the last packet, in seconds */
+		uint64_t m_malformedPacketCount; /**< Number of malformed packets thrown away */
+		uint64_t m_readUnderrunCount; /**< Number of loops with no reply waiting */
 	private:
 		DECLARE_LOGGER();
 	};
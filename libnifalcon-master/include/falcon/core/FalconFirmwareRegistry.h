@@ -0,0 +1,113 @@
+/***
+ * @file FalconFirmwareRegistry.h
+ * @brief Firmware images compiled into libnifalcon, stored compressed and unpacked on demand
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONFIRMWAREREGISTRY_H
+#define FALCONFIRMWAREREGISTRY_H
+
+#include <stdint.h>
+#include <string>
+
+namespace libnifalcon
+{
+/**
+ * @class FalconFirmwareRegistry
+ * @ingroup CoreClasses
+ *
+ * Firmware images shipped with libnifalcon. Unlike the arrays in FalconFirmwareBinaryNvent.h and
+ * FalconFirmwareBinaryTest.h, which are copied into every translation unit that includes them, the
+ * registry's images live once in the library, LZSS compressed. An image is unpacked into a buffer shared
+ * by the whole process the first time getImage() is called for it, and stays there until exit.
+ *
+ * Images can be looked up by name or by CRC32 (the same checksum the FalconDevice firmware cache
+ * stores). Names and checksums are available without unpacking anything, so callers that end up
+ * skipping the upload never pay for it. See FalconDevice::loadRegisteredFirmware().
+ *
+ * All functions are thread safe.
+ */
+	class FalconFirmwareRegistry
+	{
+	public:
+		/**
+		 * Returns the number of registered images
+		 *
+		 * @return Image count
+		 */
+		static unsigned int getImageCount();
+
+		/**
+		 * Finds an image by name
+		 *
+		 * @param name Image name ("nvent" or "test")
+		 * @param index Set to the image index if found
+		 *
+		 * @return true if found, false otherwise
+		 */
+		static bool findImage(const std::string& name, unsigned int& index);
+
+		/**
+		 * Finds an image by CRC32 checksum
+		 *
+		 * @param checksum CRC32 of the unpacked image
+		 * @param index Set to the image index if found
+		 *
+		 * @return true if found, false otherwise
+		 */
+		static bool findImage(uint32_t checksum, unsigned int& index);
+
+		/**
+		 * Finds the image a buffer returned by getImage() belongs to
+		 *
+		 * @param buffer Buffer to look for
+		 * @param index Set to the image index if found
+		 *
+		 * @return true if the buffer is a registry image, false otherwise
+		 */
+		static bool findImage(const uint8_t* buffer, unsigned int& index);
+
+		/**
+		 * Returns the name of an image
+		 *
+		 * @param index Image index
+		 *
+		 * @return Image name
+		 */
+		static const char* getName(unsigned int index);
+
+		/**
+		 * Returns the unpacked size of an image
+		 *
+		 * @param index Image index
+		 *
+		 * @return Size in bytes
+		 */
+		static unsigned int getSize(unsigned int index);
+
+		/**
+		 * Returns the CRC32 checksum of an unpacked image
+		 *
+		 * @param index Image index
+		 *
+		 * @return CRC32
+		 */
+		static uint32_t getChecksum(unsigned int index);
+
+		/**
+		 * Returns an unpacked image, unpacking it on first use
+		 *
+		 * @param index Image index
+		 *
+		 * @return Image of getSize() bytes, NULL if the index is out of range or the image is corrupt
+		 */
+		static const uint8_t* getImage(unsigned int index);
+	};
+}
+
+#endif
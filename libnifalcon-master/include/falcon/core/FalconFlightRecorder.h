@@ -0,0 +1,218 @@
+/***
+ * @file FalconFlightRecorder.h
+ * @brief Always-on ring of per sample telemetry, optionally backed by a memory mapped file
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONFLIGHTRECORDER_H
+#define FALCONFLIGHTRECORDER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+#include "falcon/core/FalconMappedFile.h"
+
+namespace libnifalcon
+{
+/**
+ * @struct FalconFlightRecord
+ * @ingroup CoreClasses
+ *
+ * One 64 byte flight recorder entry, written for every sample the I/O loop receives and for every loop
+ * status change. Layout is fixed so recorder files can be read by other tools.
+ */
+	struct FalconFlightRecord
+	{
+		enum {
+			STATUS_OK = 0x0, /**< Sample processed normally */
+			STATUS_KINEMATIC_ERROR = 0x1, /**< Position could not be computed from the encoders */
+			STATUS_GRIP_ERROR = 0x2, /**< Grip update failed */
+			STATUS_DISCONNECTED = 0x4, /**< Device was unplugged */
+			STATUS_RECONNECTED = 0x8, /**< First sample after reconnecting */
+			STATUS_IO_ERROR = 0x10 /**< Firmware I/O failed, first loop of a run of failures */
+		};
+
+		uint64_t sequence; /**< Record number, starting at 0 when the recorder is opened */
+		double timestamp; /**< Time the sample was received (FalconClock), in seconds */
+		float roundTripTime; /**< Smoothed USB round trip time, in seconds */
+		int16_t encoders[3]; /**< Raw encoder values */
+		int16_t motorForces[3]; /**< Encoder space forces written in the same loop */
+		float position[3]; /**< End effector position, in meters */
+		float force[3]; /**< Commanded cartesian force, in newtons */
+		uint8_t homingStatus; /**< Homing status bitfield */
+		uint8_t digitalInputs; /**< Grip button bitfield */
+		uint8_t status; /**< Loop status flags */
+		uint8_t reserved; /**< Padding */
+		uint32_t errorCount; /**< Device error count at the time of the record */
+	};
+
+/**
+ * @class FalconFlightRecorder
+ * @ingroup CoreClasses
+ *
+ * FalconFlightRecorder keeps the last N FalconFlightRecords in a ring, so the lead up to a problem can be
+ * looked at after the fact without paying for continuous logging. Appending a record is a handful of
+ * stores; there are no locks, allocations or system calls.
+ *
+ * The ring either lives on the heap (allocate()), or in a memory mapped file (open()). A mapped ring
+ * survives the process crashing, and can be read by another process while the device runs: the file
+ * starts with a 64 byte header (magic "NIFFLT1", version, record size, capacity, write index) followed by
+ * the records. Records can be overwritten while read, so readers should copy first, then re-read the write
+ * index and drop records it has lapped, as copyRecords() does.
+ *
+ * FalconDevice owns one of these, always on (see FalconDevice::getFlightRecorder()).
+ */
+	class FalconFlightRecorder
+	{
+	public:
+		/**
+		 * File header for memory mapped rings
+		 */
+		struct Header
+		{
+			char magic[8]; /**< "NIFFLT1" */
+			uint32_t version; /**< Format version */
+			uint32_t recordSize; /**< sizeof(FalconFlightRecord) */
+			uint64_t capacity; /**< Number of records in the ring */
+			uint64_t writeIndex; /**< Sequence number of the next record to be written */
+			uint8_t reserved[32]; /**< Padding to 64 bytes */
+		};
+
+		/**
+		 * Constructor. The recorder does nothing until allocate() or open() are called.
+		 */
+		FalconFlightRecorder();
+
+		/**
+		 * Destructor
+		 */
+		~FalconFlightRecorder();
+
+		/**
+		 * Keeps the ring in memory, replacing any existing ring. Must not be called while another thread
+		 * appends (for FalconDevice's recorder, while the I/O loop runs).
+		 *
+		 * @param capacity Number of records to keep
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool allocate(unsigned int capacity);
+
+		/**
+		 * Keeps the ring in a memory mapped file, replacing any existing ring. The file is created or
+		 * overwritten. Must not be called while another thread appends (for FalconDevice's recorder, while
+		 * the I/O loop runs).
+		 *
+		 * @param filename File to map
+		 * @param capacity Number of records to keep
+		 *
+		 * @return true on success, false if the file could not be created or mapped
+		 */
+		bool open(const std::string& filename, unsigned int capacity);
+
+		/**
+		 * Releases the ring (and unmaps its file). Must not be called while another thread appends.
+		 */
+		void close();
+
+		/**
+		 * Appends a record, overwriting the oldest one if the ring is full. The sequence number is filled in.
+		 * Only one thread may append.
+		 *
+		 * @param record Record to append
+		 */
+		void append(FalconFlightRecord& record)
+		{
+			if(m_header == NULL)
+			{
+				return;
+			}
+			uint64_t index = m_header->writeIndex;
+			record.sequence = index;
+			m_records[index % m_header->capacity] = record;
+			storeWriteIndex(index + 1);
+		}
+
+		/**
+		 * Copies the most recent records out of the ring, oldest first
+		 *
+		 * @param records Vector to fill
+		 * @param seconds Only copy records this recent (relative to the newest record), 0 for all
+		 *
+		 * @return Number of records copied
+		 */
+		unsigned int copyRecords(std::vector<FalconFlightRecord>& records, double seconds = 0.0) const;
+
+		/**
+		 * Writes the most recent records as CSV text, oldest first
+		 *
+		 * @param out Stream to write to
+		 * @param seconds Only dump records this recent, 0 for all
+		 *
+		 * @return Number of records written
+		 */
+		unsigned int dump(std::ostream& out, double seconds = 0.0) const;
+
+		/**
+		 * Writes the most recent records as CSV to a file
+		 *
+		 * @param filename File to write
+		 * @param seconds Only dump records this recent, 0 for all
+		 *
+		 * @return true if the file was written, false otherwise
+		 */
+		bool dump(const std::string& filename, double seconds = 0.0) const;
+
+		/**
+		 * Returns whether the recorder has a ring
+		 *
+		 * @return true if allocate() or open() succeeded
+		 */
+		bool isOpen() const { return m_header != NULL; }
+
+		/**
+		 * Returns the number of records the ring holds
+		 *
+		 * @return Ring capacity
+		 */
+		unsigned int getCapacity() const { return m_header ? (unsigned int)m_header->capacity : 0; }
+
+		/**
+		 * Returns the number of records appended since the ring was created
+		 *
+		 * @return Record count
+		 */
+		uint64_t getRecordCount() const { return m_header ? m_header->writeIndex : 0; }
+	protected:
+		/**
+		 * Publishes the write index after the record it covers
+		 *
+		 * @param index New write index
+		 */
+		void storeWriteIndex(uint64_t index);
+
+		/**
+		 * Fills in a fresh header at the start of the ring memory
+		 *
+		 * @param capacity Number of records
+		 */
+		void initializeHeader(unsigned int capacity);
+
+		//Rings are owned, not shared
+		FalconFlightRecorder(const FalconFlightRecorder&);
+		FalconFlightRecorder& operator=(const FalconFlightRecorder&);
+
+		Header* m_header; /**< Ring header */
+		FalconFlightRecord* m_records; /**< Ring records, following the header */
+		std::vector<uint8_t> m_heap; /**< Storage for heap rings */
+		FalconMappedFile m_file; /**< Storage for file rings */
+	};
+}
+
+#endif
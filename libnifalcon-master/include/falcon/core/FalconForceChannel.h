@@ -0,0 +1,187 @@
+/***
+ * @file FalconForceChannel.h
+ * @brief Thread safe channel for feeding force commands to the I/O loop at a lower rate than it runs
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONFORCECHANNEL_H
+#define FALCONFORCECHANNEL_H
+
+#include <boost/array.hpp>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+
+namespace libnifalcon
+{
+/**
+ * @struct FalconForceCommand
+ * @ingroup CoreClasses
+ *
+ * A single command sent through a FalconForceChannel. Either a force setpoint, or a local linear model of
+ * the force field around an anchor point:
+ *
+ * F(x) = force + stiffness * (x - anchor)
+ *
+ * Stiffness is a row major 3x3 matrix in N/m. A contact plane with normal n and stiffness k is
+ * stiffness = -k * n * n', anchored on the plane.
+ */
+	struct FalconForceCommand
+	{
+		enum {
+			FORCE_SETPOINT = 0, /**< Interpolate between timestamped forces */
+			FORCE_LINEAR_MODEL /**< Evaluate force + stiffness * (x - anchor) against the current position */
+		};
+
+		int type; /**< FORCE_SETPOINT or FORCE_LINEAR_MODEL */
+		double timestamp; /**< Time the command was generated at (FalconClock), in seconds */
+		boost::array<double, 3> force; /**< Force (setpoint) or force at the anchor (linear model), in newtons */
+		boost::array<double, 9> stiffness; /**< Row major stiffness matrix, linear models only */
+		boost::array<double, 3> anchor; /**< Anchor position, linear models only */
+	};
+
+/**
+ * @class FalconForceChannel
+ * @ingroup CoreClasses
+ *
+ * Graphics and physics threads tend to update forces at 60-200Hz, while the falcon runs at 1kHz. Writing
+ * forces straight through FalconDevice::setForce() at the application rate turns into a staircase that
+ * the user feels as roughness. FalconForceChannel takes the application's commands through a lock-free
+ * single producer/single consumer queue, and the I/O loop turns them into a force every servo tick:
+ *
+ * - Force setpoints are timestamped and played back with a small delay, so the loop can always interpolate
+ *   between two known setpoints instead of stepping to the newest one. The delay follows the measured
+ *   interval between setpoints (one and a half of them), and never drops below setPlayoutDelay(). If the
+ *   application stalls, the last setpoint is held.
+ * - Linear models are evaluated against the current (or predicted) position every tick, so stiffness is
+ *   rendered at the servo rate no matter how slowly the application runs. A new model is cross faded in
+ *   over a short blend time to avoid steps when the application moves the anchor.
+ *
+ * Exactly one thread may push commands, and only the I/O loop may call evaluate(). Get the channel for a
+ * device with FalconDevice::getForceChannel(); once a command has been pushed, it overrides
+ * FalconDevice::setForce() until clear() is called.
+ */
+	class FalconForceChannel
+	{
+	public:
+		enum {
+			QUEUE_SIZE = 64, /**< Number of commands that can be queued between I/O loops */
+			HISTORY_SIZE = 8 /**< Number of setpoints kept for interpolation */
+		};
+
+		/**
+		 * Constructor
+		 *
+		 */
+		FalconForceChannel();
+
+		/**
+		 * Queues a force setpoint, timestamped with the current time
+		 *
+		 * @param force Force vector, in newtons
+		 *
+		 * @return true if queued, false if the queue is full
+		 */
+		bool pushForceSetpoint(const boost::array<double, 3>& force);
+
+		/**
+		 * Queues a force setpoint
+		 *
+		 * @param timestamp Time the setpoint is for (FalconClock), in seconds
+		 * @param force Force vector, in newtons
+		 *
+		 * @return true if queued, false if the queue is full
+		 */
+		bool pushForceSetpoint(double timestamp, const boost::array<double, 3>& force);
+
+		/**
+		 * Queues a local linear force model, timestamped with the current time
+		 *
+		 * @param force Force at the anchor, in newtons
+		 * @param stiffness Row major 3x3 stiffness matrix, in N/m
+		 * @param anchor Anchor position, in meters
+		 *
+		 * @return true if queued, false if the queue is full
+		 */
+		bool pushForceModel(const boost::array<double, 3>& force, const boost::array<double, 9>& stiffness, const boost::array<double, 3>& anchor);
+
+		/**
+		 * Queues a command
+		 *
+		 * @param command Command to queue
+		 *
+		 * @return true if queued, false if the queue is full
+		 */
+		bool push(const FalconForceCommand& command);
+
+		/**
+		 * Drops all commands, and hands force control back to FalconDevice::setForce(). Producer side.
+		 */
+		void clear() { m_clearRequested.store(true, boost::memory_order_release); }
+
+		/**
+		 * Sets the shortest delay setpoints are played back with. The channel lengthens it to one and a half
+		 * measured setpoint intervals when the application runs slower than that. Defaults to 1/60s.
+		 *
+		 * @param delay Minimum playout delay, in seconds
+		 */
+		void setPlayoutDelay(double delay) { m_playoutDelay = delay; }
+
+		/**
+		 * Sets the time a new linear model takes to fully replace the previous one
+		 *
+		 * @param blend_time Cross fade time, in seconds
+		 */
+		void setModelBlendTime(double blend_time) { m_blendTime = blend_time; }
+
+		/**
+		 * Returns whether the channel is driving the force. I/O loop side.
+		 *
+		 * @return true once a command has been received and until clear() is processed
+		 */
+		bool isActive() const { return m_isActive; }
+
+		/**
+		 * Drains the queue and computes the force for this servo tick. I/O loop side.
+		 *
+		 * @param now Current time (FalconClock), in seconds
+		 * @param position Position to evaluate linear models at, in meters
+		 * @param force Array to write the force to
+		 *
+		 * @return true if the channel is active and force was written, false otherwise
+		 */
+		bool evaluate(double now, const boost::array<double, 3>& position, boost::array<double, 3>& force);
+	protected:
+		/**
+		 * Evaluates a linear model at a position
+		 *
+		 * @param command Linear model command
+		 * @param position Position to evaluate at
+		 * @param force Array to write the force to
+		 */
+		static void evaluateModel(const FalconForceCommand& command, const boost::array<double, 3>& position, boost::array<double, 3>& force);
+
+		boost::lockfree::spsc_queue<FalconForceCommand, boost::lockfree::capacity<QUEUE_SIZE> > m_queue; /**< Commands from the application */
+		boost::atomic<bool> m_clearRequested; /**< Set by clear(), processed by the I/O loop */
+		double m_playoutDelay; /**< Setpoint playout delay */
+		double m_blendTime; /**< Linear model cross fade time */
+
+		//I/O loop side state
+		bool m_isActive; /**< True while the channel drives the force */
+		int m_mode; /**< Type of the last command received */
+		FalconForceCommand m_setpoints[HISTORY_SIZE]; /**< Setpoint history, ring buffer */
+		unsigned int m_setpointHead; /**< Index of the newest setpoint */
+		unsigned int m_setpointCount; /**< Number of valid setpoints */
+		double m_setpointInterval; /**< Smoothed time between setpoints, 0 until two have arrived */
+		FalconForceCommand m_model; /**< Current linear model */
+		FalconForceCommand m_previousModel; /**< Linear model being faded out */
+		bool m_hasPreviousModel; /**< True while cross fading */
+		double m_modelStartTime; /**< Time the current model was received */
+	};
+}
+
+#endif
@@ -13,10 +13,24 @@
 #define FALCONGRIP_H
 
 #include <cstdlib>
+#include <boost/lockfree/spsc_queue.hpp>
 #include "falcon/core/FalconCore.h"
 
 namespace libnifalcon
 {
+/**
+ * @struct FalconGripEvent
+ * @ingroup GripClasses
+ *
+ * A debounced press or release of a grip digital input, as queued by FalconGrip::updateEvents()
+ */
+	struct FalconGripEvent
+	{
+		double timestamp; /**< Time of the sample the input first changed in (FalconClock), in seconds */
+		unsigned int button; /**< Bit of the input, as in the getDigitalInputs() bitfield */
+		bool pressed; /**< true for a press, false for a release */
+	};
+
 /**
  * @class FalconGrip
  * @ingroup CoreClasses
@@ -34,6 +48,10 @@ namespace libnifalcon
 			FALCON_GRIP_INDEX_OUT_OF_RANGE = 4000 /**< Returned if button index requested is out of range for the current grip */
 		};
 
+		enum {
+			EVENT_QUEUE_SIZE = 256 /**< Button events held until drained */
+		};
+
 
 		/**
 		 * Constructor. Defines the grip capabilities.
@@ -45,7 +63,11 @@ namespace libnifalcon
 		FalconGrip(int32_t digital_inputs, int32_t analog_inputs) :
 			m_numDigitalInputs(digital_inputs),
 			m_numAnalogInputs(analog_inputs),
-			m_digitalInputs(0)
+			m_digitalInputs(0),
+			m_debounceTime(0.0),
+			m_debouncedInputs(0),
+			m_pendingInputs(0),
+			m_droppedEventCount(0)
 		{
 		}
 
@@ -124,12 +146,64 @@ namespace libnifalcon
 			}
 			return m_analogInputs[index];
 		}
+
+		/**
+		 * Sets how long a digital input has to hold a new value before it counts as a press or release
+		 *
+		 * @param seconds Debounce time, 0 to take every change (the default)
+		 */
+		void setDebounceTime(double seconds) { m_debounceTime = seconds; }
+
+		/**
+		 * Returns the debounce time
+		 *
+		 * @return Debounce time, in seconds
+		 */
+		double getDebounceTime() const { return m_debounceTime; }
+
+		/**
+		 * Returns the bitfield of debounced digital inputs, which lags getDigitalInputs() by the debounce time
+		 *
+		 * @return Bitfield of debounced digital inputs
+		 */
+		unsigned int getDebouncedInputs() const { return m_debouncedInputs; }
+
+		/**
+		 * Runs edge detection on the digital inputs parsed by the last runGripLoop(), queueing an event for
+		 * every debounced press and release. Called by FalconDevice from the I/O loop for every new sample.
+		 *
+		 * @param timestamp Time the sample was received (FalconClock), in seconds
+		 */
+		void updateEvents(double timestamp);
+
+		/**
+		 * Takes the oldest button event off the queue. Events are produced by the I/O thread, and can be
+		 * drained from any one thread at a time.
+		 *
+		 * @param event Event to fill in
+		 *
+		 * @return true if an event was returned, false if the queue was empty
+		 */
+		bool popEvent(FalconGripEvent& event) { return m_events.pop(event); }
+
+		/**
+		 * Returns the number of events thrown away because the queue was full
+		 *
+		 * @return Dropped event count
+		 */
+		unsigned int getDroppedEventCount() const { return m_droppedEventCount; }
 	protected:
 		unsigned int m_numDigitalInputs; /**< Number of digital inputs available on the grip */
 		unsigned int m_numAnalogInputs; /**< Number of analog inputs available on the grip */
 		//I think assuming 32 digital inputs and 128 analog is enough
 		unsigned int m_digitalInputs; /**< Bitfield to hold digital input values */
 		int m_analogInputs[128]; /**< Array of analog input values */
+		double m_debounceTime; /**< Time an input has to be stable before it is reported, in seconds */
+		unsigned int m_debouncedInputs; /**< Bitfield of debounced digital inputs */
+		unsigned int m_pendingInputs; /**< Bitfield of inputs that differ from their debounced value */
+		double m_changeTimes[32]; /**< Time each pending input first changed */
+		unsigned int m_droppedEventCount; /**< Events lost to a full queue */
+		boost::lockfree::spsc_queue<FalconGripEvent, boost::lockfree::capacity<EVENT_QUEUE_SIZE> > m_events; /**< Events waiting to be drained */
 	};
 }
 
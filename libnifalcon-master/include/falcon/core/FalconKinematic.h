@@ -40,7 +40,11 @@ namespace libnifalcon
 		 *
 		 *
 		 */
-		FalconKinematic() {}
+		FalconKinematic() :
+			m_lastSolveIterations(0),
+			m_lastSolveConverged(true),
+			m_lastForceSaturated(false)
+		{}
 
 		/**
 		 * Destructor
@@ -102,6 +106,32 @@ namespace libnifalcon
 		 */
 
 		virtual bool getForces(const boost::array<double, 3> &position, const boost::array<double, 3>& cart_force, boost::array<int, 3> &enc_force) = 0;
+
+		/**
+		 * Returns the number of iterations the last getPosition() call took, for kinematics that solve
+		 * iteratively
+		 *
+		 * @return Iteration count, 0 for closed form kinematics
+		 */
+		unsigned int getLastSolveIterations() { return m_lastSolveIterations; }
+
+		/**
+		 * Returns whether the last getPosition() call converged
+		 *
+		 * @return false if the solver gave up and left the position where it was
+		 */
+		bool isLastSolveConverged() { return m_lastSolveConverged; }
+
+		/**
+		 * Returns whether the last getForces() call had to scale the force down to stay inside motor limits
+		 *
+		 * @return true if the torques saturated
+		 */
+		bool isLastForceSaturated() { return m_lastForceSaturated; }
+	protected:
+		unsigned int m_lastSolveIterations; /**< Iterations used by the last position solve */
+		bool m_lastSolveConverged; /**< True if the last position solve converged */
+		bool m_lastForceSaturated; /**< True if the last force was scaled down for motor limits */
 	};
 }
 
@@ -1,6 +1,6 @@
 /***
  * @file FalconLogging.h
- * @brief Logging defines for log4cxx
+ * @brief Logging defines for log4cxx, or the binary logging backend
  * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
  * @license BSD License
  *
@@ -98,6 +98,56 @@ namespace log4cxx {
 #define LOG_ERROR(msg) LLOG_ERROR(logger, msg)
 #define LOG_FATAL(msg) LLOG_FATAL(logger, msg)
 
+#elif ENABLE_BINARY_LOGGING
+/*
+ * Binary backend (see FalconBinaryLog). Statements are cheap enough to leave on in the I/O loop. Records
+ * are drained and formatted by FalconBinaryLog::drain(), usually from FalconBinaryLogBoostThread.
+ *
+ * FALCON_BINARY_LOG_LEVEL compiles out statements below a level (e.g. -DFALCON_BINARY_LOG_LEVEL=LEVEL_WARN),
+ * FALCON_BINARY_LOG_RATE caps the records per second each statement can produce (0 for no cap).
+ */
+#include "falcon/core/FalconBinaryLog.h"
+
+#ifndef FALCON_BINARY_LOG_LEVEL
+#define FALCON_BINARY_LOG_LEVEL LEVEL_DEBUG
+#endif
+
+#ifndef FALCON_BINARY_LOG_RATE
+#define FALCON_BINARY_LOG_RATE 100
+#endif
+
+#define LDECLARE_LOGGER(logger)           const char* logger
+#define LDEFINE_LOGGER(logger, hierarchy) const char* LINIT_LOGGER(logger, hierarchy)
+#define LINIT_LOGGER(logger, hierarchy)   logger(hierarchy)
+
+#define DECLARE_LOGGER()         LDECLARE_LOGGER(logger)
+#define DEFINE_LOGGER(hierarchy) LDEFINE_LOGGER(logger, hierarchy)
+#define INIT_LOGGER(hierarchy)   LINIT_LOGGER(logger, hierarchy)
+
+#define LLOG_BINARY(logger, level, msg)									\
+	do {																\
+		if(::libnifalcon::FalconBinaryLog::level >= ::libnifalcon::FalconBinaryLog::FALCON_BINARY_LOG_LEVEL) \
+		{																\
+			static ::libnifalcon::FalconLogSite falcon_log_site(__FILE__, __LINE__, ::libnifalcon::FalconBinaryLog::level, logger, FALCON_BINARY_LOG_RATE); \
+			if(falcon_log_site.allow())									\
+			{															\
+				::libnifalcon::FalconLogRecordBuilder(falcon_log_site) << msg; \
+			}															\
+		}																\
+	} while(0)
+
+#define LLOG_DEBUG(logger, msg) LLOG_BINARY(logger, LEVEL_DEBUG, msg)
+#define LLOG_INFO(logger, msg)  LLOG_BINARY(logger, LEVEL_INFO, msg)
+#define LLOG_WARN(logger, msg)  LLOG_BINARY(logger, LEVEL_WARN, msg)
+#define LLOG_ERROR(logger, msg) LLOG_BINARY(logger, LEVEL_ERROR, msg)
+#define LLOG_FATAL(logger, msg) LLOG_BINARY(logger, LEVEL_FATAL, msg)
+
+#define LOG_DEBUG(msg) LLOG_DEBUG(logger, msg)
+#define LOG_INFO(msg)  LLOG_INFO(logger, msg)
+#define LOG_WARN(msg)  LLOG_WARN(logger, msg)
+#define LOG_ERROR(msg) LLOG_ERROR(logger, msg)
+#define LOG_FATAL(msg) LLOG_FATAL(logger, msg)
+
 #else
 
 #define LDECLARE_LOGGER(logger)   void* __unused_##logger
@@ -0,0 +1,91 @@
+/***
+ * @file FalconMappedFile.h
+ * @brief Minimal cross platform read/write memory mapped file
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONMAPPEDFILE_H
+#define FALCONMAPPEDFILE_H
+
+#include <stddef.h>
+#include <string>
+
+namespace libnifalcon
+{
+/**
+ * @class FalconMappedFile
+ * @ingroup CoreClasses
+ *
+ * Creates a file of a fixed size and maps it shared and writable, so other processes can watch what
+ * libnifalcon writes to it. Used by FalconFlightRecorder and FalconMetrics.
+ */
+	class FalconMappedFile
+	{
+	public:
+		/**
+		 * Constructor
+		 */
+		FalconMappedFile();
+
+		/**
+		 * Destructor. Unmaps the file.
+		 */
+		~FalconMappedFile();
+
+		/**
+		 * Creates (or truncates) a file, sizes it and maps it. The mapping starts out zeroed.
+		 *
+		 * @param filename File to map
+		 * @param size Size of the file, in bytes
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool open(const std::string& filename, size_t size);
+
+		/**
+		 * Unmaps and closes the file, if open
+		 */
+		void close();
+
+		/**
+		 * Returns the mapped memory
+		 *
+		 * @return Start of the mapping, NULL if not open
+		 */
+		void* getData() { return m_mapping; }
+
+		/**
+		 * Returns the size of the mapping
+		 *
+		 * @return Size in bytes, 0 if not open
+		 */
+		size_t getSize() const { return m_size; }
+
+		/**
+		 * Returns whether a file is mapped
+		 *
+		 * @return true if open
+		 */
+		bool isOpen() const { return m_mapping != NULL; }
+	protected:
+		//Mappings are owned, not shared
+		FalconMappedFile(const FalconMappedFile&);
+		FalconMappedFile& operator=(const FalconMappedFile&);
+
+		void* m_mapping; /**< Mapped view */
+		size_t m_size; /**< Size of the mapped view */
+#if defined(WIN32) || defined(_WIN32)
+		void* m_file; /**< File handle */
+		void* m_fileMapping; /**< File mapping handle */
+#else
+		int m_file; /**< File descriptor */
+#endif
+	};
+}
+
+#endif
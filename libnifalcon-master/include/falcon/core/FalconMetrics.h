@@ -0,0 +1,333 @@
+/***
+ * @file FalconMetrics.h
+ * @brief Counters and latency histograms for the I/O loop, with Prometheus and shared memory export
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONMETRICS_H
+#define FALCONMETRICS_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <boost/atomic.hpp>
+#include "falcon/core/FalconMappedFile.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconHistogram
+ * @ingroup CoreClasses
+ *
+ * Log-linear (HDR style) histogram of unsigned integer values. Each power of two range is split into
+ * SUB_BUCKETS linear buckets, so every recorded value lands in a bucket within about 6% of it, and values
+ * below 2*SUB_BUCKETS are counted exactly. Values past 2^MAX_BITS are counted in the last bucket.
+ *
+ * record() is a few relaxed atomic stores, and can be called from the I/O loop. It expects a single
+ * writer; any number of threads can read.
+ */
+	class FalconHistogram
+	{
+	public:
+		enum {
+			SUB_BUCKET_BITS = 4,
+			SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+			MAX_BITS = 44,
+			BUCKET_COUNT = 2 * SUB_BUCKETS + (MAX_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKETS
+		};
+
+		/**
+		 * Constructor
+		 */
+		FalconHistogram();
+
+		/**
+		 * Adds a value to the histogram
+		 *
+		 * @param value Value to add
+		 */
+		void record(uint64_t value)
+		{
+			//Single writer, so load/store is enough and keeps this wait-free without locked instructions
+			boost::atomic<uint64_t>& bucket = m_buckets[getBucketIndex(value)];
+			bucket.store(bucket.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+			m_sum.store(m_sum.load(boost::memory_order_relaxed) + value, boost::memory_order_relaxed);
+			m_count.store(m_count.load(boost::memory_order_relaxed) + 1, boost::memory_order_relaxed);
+		}
+
+		/**
+		 * Returns the number of values recorded
+		 *
+		 * @return Value count
+		 */
+		uint64_t getCount() const { return m_count.load(boost::memory_order_relaxed); }
+
+		/**
+		 * Returns the sum of values recorded
+		 *
+		 * @return Value sum
+		 */
+		uint64_t getSum() const { return m_sum.load(boost::memory_order_relaxed); }
+
+		/**
+		 * Returns the number of values recorded into a bucket
+		 *
+		 * @param index Bucket index, from 0 to BUCKET_COUNT - 1
+		 *
+		 * @return Bucket count
+		 */
+		uint64_t getBucketCount(unsigned int index) const { return m_buckets[index].load(boost::memory_order_relaxed); }
+
+		/**
+		 * Returns the value at a percentile, as the upper bound of the bucket it falls in
+		 *
+		 * @param percentile Percentile, from 0 to 100
+		 *
+		 * @return Value, 0 if nothing has been recorded
+		 */
+		uint64_t getPercentile(double percentile) const;
+
+		/**
+		 * Zeroes the histogram. Not safe against a concurrent record().
+		 */
+		void reset();
+
+		/**
+		 * Returns the bucket a value is counted in
+		 *
+		 * @param value Value
+		 *
+		 * @return Bucket index
+		 */
+		static unsigned int getBucketIndex(uint64_t value);
+
+		/**
+		 * Returns the largest value counted in a bucket
+		 *
+		 * @param index Bucket index
+		 *
+		 * @return Inclusive upper bound of the bucket
+		 */
+		static uint64_t getBucketUpperBound(unsigned int index);
+	protected:
+		boost::atomic<uint64_t> m_buckets[BUCKET_COUNT]; /**< Value counts per bucket */
+		boost::atomic<uint64_t> m_count; /**< Number of values recorded */
+		boost::atomic<uint64_t> m_sum; /**< Sum of values recorded */
+	};
+
+/**
+ * @class FalconMetrics
+ * @ingroup CoreClasses
+ *
+ * Fixed set of counters and histograms describing how the I/O loop is doing, filled in by FalconDevice
+ * (see FalconDevice::getMetrics()). Updates are wait-free, and are made from the I/O thread only.
+ *
+ * Two export paths are provided, both meant to be run from a thread other than the I/O thread:
+ *
+ * - writePrometheus() writes the Prometheus text exposition format, either to a stream or to a file that
+ *   is replaced atomically (for node_exporter's textfile collector or similar). Time histograms are
+ *   exported in seconds.
+ * - openSnapshot()/publishSnapshot() copy the raw values into a memory mapped FalconMetrics::Snapshot, so
+ *   another process can read them without parsing text. The snapshot is guarded by a sequence lock: a
+ *   reader should read the sequence, copy the data, and retry if the sequence was odd or has changed.
+ */
+	class FalconMetrics
+	{
+	public:
+		/**
+		 * Counters
+		 */
+		enum Counter {
+			COUNTER_SAMPLES, /**< Samples received from the falcon */
+			COUNTER_IO_ERRORS, /**< Firmware I/O loop failures */
+			COUNTER_MALFORMED_PACKETS, /**< Malformed packets thrown away by the firmware */
+			COUNTER_READ_UNDERRUNS, /**< Loops that found no reply waiting for the last write */
+			COUNTER_KINEMATIC_ERRORS, /**< Position solves that failed outright */
+			COUNTER_KINEMATIC_NONCONVERGENCE, /**< Position solves that did not converge */
+			COUNTER_TORQUE_SATURATION, /**< Forces that had to be scaled down for motor limits */
+			COUNTER_RECONNECTS, /**< Successful reconnections */
+			COUNTER_COUNT
+		};
+
+		/**
+		 * Histograms
+		 */
+		enum Histogram {
+			HISTOGRAM_SAMPLE_PERIOD, /**< Time between samples, in nanoseconds */
+			HISTOGRAM_ROUND_TRIP, /**< USB write to read time, in nanoseconds */
+			HISTOGRAM_KINEMATIC_ITERATIONS, /**< Iterations per position solve */
+			HISTOGRAM_COUNT
+		};
+
+		/**
+		 * Memory mapped snapshot layout
+		 */
+		struct Snapshot
+		{
+			char magic[8]; /**< "NIFMET1" */
+			uint32_t version; /**< Format version */
+			uint32_t bucketCount; /**< FalconHistogram::BUCKET_COUNT */
+			uint32_t counterCount; /**< COUNTER_COUNT */
+			uint32_t histogramCount; /**< HISTOGRAM_COUNT */
+			volatile uint64_t sequence; /**< Sequence lock, odd while being written */
+			double timestamp; /**< Time of the last publish (FalconClock), in seconds */
+			uint64_t counters[COUNTER_COUNT]; /**< Counter values */
+			struct
+			{
+				uint64_t count; /**< Number of values recorded */
+				uint64_t sum; /**< Sum of values recorded */
+				uint64_t buckets[FalconHistogram::BUCKET_COUNT]; /**< Value counts per bucket */
+			} histograms[HISTOGRAM_COUNT]; /**< Histogram values */
+		};
+
+		/**
+		 * Constructor
+		 */
+		FalconMetrics();
+
+		/**
+		 * Destructor
+		 */
+		~FalconMetrics();
+
+		/**
+		 * Adds to a counter
+		 *
+		 * @param counter Counter to add to
+		 * @param amount Amount to add
+		 */
+		void increment(Counter counter, uint64_t amount = 1)
+		{
+			m_counters[counter].store(m_counters[counter].load(boost::memory_order_relaxed) + amount, boost::memory_order_relaxed);
+		}
+
+		/**
+		 * Sets a counter, for values that are counted elsewhere
+		 *
+		 * @param counter Counter to set
+		 * @param value New value
+		 */
+		void setCounter(Counter counter, uint64_t value)
+		{
+			m_counters[counter].store(value, boost::memory_order_relaxed);
+		}
+
+		/**
+		 * Returns a counter value
+		 *
+		 * @param counter Counter to read
+		 *
+		 * @return Counter value
+		 */
+		uint64_t getCounter(Counter counter) const { return m_counters[counter].load(boost::memory_order_relaxed); }
+
+		/**
+		 * Adds a value to a histogram
+		 *
+		 * @param histogram Histogram to add to
+		 * @param value Value to add
+		 */
+		void record(Histogram histogram, uint64_t value) { m_histograms[histogram].record(value); }
+
+		/**
+		 * Adds a time to a histogram
+		 *
+		 * @param histogram Histogram to add to
+		 * @param seconds Time, in seconds. Negative times are ignored.
+		 */
+		void recordTime(Histogram histogram, double seconds)
+		{
+			if(seconds >= 0.0)
+			{
+				m_histograms[histogram].record((uint64_t)(seconds * 1e9));
+			}
+		}
+
+		/**
+		 * Returns a histogram
+		 *
+		 * @param histogram Histogram to return
+		 *
+		 * @return Histogram
+		 */
+		const FalconHistogram& getHistogram(Histogram histogram) const { return m_histograms[histogram]; }
+
+		/**
+		 * Zeroes all counters and histograms. Not safe against a concurrent update.
+		 */
+		void reset();
+
+		/**
+		 * Writes all metrics in Prometheus text exposition format
+		 *
+		 * @param out Stream to write to
+		 * @param labels Labels to add to every sample, without braces (for example device="0"). May be empty.
+		 */
+		void writePrometheus(std::ostream& out, const std::string& labels = "") const;
+
+		/**
+		 * Writes all metrics in Prometheus text exposition format to a file. The file is written under a
+		 * temporary name and renamed over the old one, so scrapers never see it half written.
+		 *
+		 * @param filename File to write
+		 * @param labels Labels to add to every sample, without braces. May be empty.
+		 *
+		 * @return true if the file was written, false otherwise
+		 */
+		bool writePrometheus(const std::string& filename, const std::string& labels = "") const;
+
+		/**
+		 * Creates a memory mapped snapshot file. Values are not copied until publishSnapshot() is called.
+		 *
+		 * @param filename File to map
+		 *
+		 * @return true on success, false if the file could not be created or mapped
+		 */
+		bool openSnapshot(const std::string& filename);
+
+		/**
+		 * Unmaps the snapshot file
+		 */
+		void closeSnapshot();
+
+		/**
+		 * Copies the current values into the snapshot file
+		 *
+		 * @return true if a snapshot file is open, false otherwise
+		 */
+		bool publishSnapshot();
+
+		/**
+		 * Returns the Prometheus name of a counter
+		 *
+		 * @param counter Counter
+		 *
+		 * @return Metric name
+		 */
+		static const char* getCounterName(Counter counter);
+
+		/**
+		 * Returns the Prometheus name of a histogram
+		 *
+		 * @param histogram Histogram
+		 *
+		 * @return Metric name
+		 */
+		static const char* getHistogramName(Histogram histogram);
+	protected:
+		//Metrics are owned by a device, not shared
+		FalconMetrics(const FalconMetrics&);
+		FalconMetrics& operator=(const FalconMetrics&);
+
+		boost::atomic<uint64_t> m_counters[COUNTER_COUNT]; /**< Counter values */
+		FalconHistogram m_histograms[HISTOGRAM_COUNT]; /**< Histograms */
+		FalconMappedFile m_snapshotFile; /**< Shared memory snapshot */
+	};
+}
+
+#endif
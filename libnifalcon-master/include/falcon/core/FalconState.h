@@ -0,0 +1,70 @@
+/***
+ * @file FalconState.h
+ * @brief Snapshot of the falcon state published by the I/O loop
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONSTATE_H
+#define FALCONSTATE_H
+
+#include <stdint.h>
+#include <boost/array.hpp>
+
+namespace libnifalcon
+{
+/**
+ * @struct FalconState
+ * @ingroup CoreClasses
+ *
+ * FalconState is a plain copy of everything the I/O loop knows about the falcon after its last new sample.
+ * FalconDevice publishes one of these every loop, and FalconDevice::getState() can be called from any
+ * thread to get a consistent copy of it, which makes it the preferred way for application threads to
+ * read the device while FalconDevice::runIOLoop() runs in an I/O thread.
+ */
+	struct FalconState
+	{
+		enum {
+			MAX_ANALOG_INPUTS = 8 /**< Grip analog inputs carried in the snapshot */
+		};
+
+		FalconState() :
+			timestamp(0.0),
+			sampleCount(0),
+			homingStatus(0),
+			isHomed(false),
+			digitalInputs(0),
+			debouncedInputs(0)
+		{
+			encoders.assign(0);
+			position.assign(0.0);
+			velocity.assign(0.0);
+			acceleration.assign(0.0);
+			predictedPosition.assign(0.0);
+			force.assign(0.0);
+			analogInputs.assign(0);
+			roundTripTime = 0.0;
+		}
+
+		double timestamp; /**< Monotonic time (see FalconClock) the sample was received at, in seconds */
+		uint64_t sampleCount; /**< Number of samples received from the falcon since the device was opened */
+		boost::array<int, 3> encoders; /**< Raw encoder values of the 3 legs */
+		boost::array<double, 3> position; /**< End effector position, in cartesian coordinates (meters) */
+		boost::array<double, 3> velocity; /**< Estimated end effector velocity (meters/second) */
+		boost::array<double, 3> acceleration; /**< Estimated end effector acceleration (meters/second^2) */
+		boost::array<double, 3> predictedPosition; /**< Position extrapolated to when the next force write takes effect (equal to position if prediction is off) */
+		double roundTripTime; /**< Smoothed USB round trip time, in seconds */
+		boost::array<double, 3> force; /**< Force sent in the last I/O loop, from setForce() or the force channel (newtons) */
+		unsigned int homingStatus; /**< Homing status bitfield, as returned by FalconFirmware::getHomingModeStatus() */
+		bool isHomed; /**< True if all 3 legs are homed */
+		unsigned int digitalInputs; /**< Bitfield of grip digital inputs */
+		unsigned int debouncedInputs; /**< Bitfield of grip digital inputs after debouncing (see FalconGrip::setDebounceTime()) */
+		boost::array<int, MAX_ANALOG_INPUTS> analogInputs; /**< First MAX_ANALOG_INPUTS grip analog inputs, 0 if the grip has fewer */
+	};
+}
+
+#endif
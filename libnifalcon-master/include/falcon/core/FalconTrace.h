@@ -0,0 +1,163 @@
+/***
+ * @file FalconTrace.h
+ * @brief Scoped trace spans for the I/O loop, exported as Chrome trace JSON
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONTRACE_H
+#define FALCONTRACE_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <boost/atomic.hpp>
+#include "falcon/core/FalconClock.h"
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+/*
+ * FALCON_TRACE_SCOPE(name) records a span from the statement to the end of the enclosing block. name has
+ * to be a string literal; only the pointer is kept. Spans are compiled out unless ENABLE_TRACING is
+ * defined, and are skipped at run time until FalconTrace::setEnabled(true) is called.
+ */
+#ifdef ENABLE_TRACING
+#define FALCON_TRACE_CONCAT_INNER(a, b) a##b
+#define FALCON_TRACE_CONCAT(a, b) FALCON_TRACE_CONCAT_INNER(a, b)
+#define FALCON_TRACE_SCOPE(name) ::libnifalcon::FalconTraceScope FALCON_TRACE_CONCAT(falcon_trace_scope_, __LINE__)(name)
+#else
+#define FALCON_TRACE_SCOPE(name)
+#endif
+
+namespace libnifalcon
+{
+/**
+ * @class FalconTrace
+ * @ingroup CoreClasses
+ *
+ * Collects trace spans from the I/O loop, to see where the time goes when the loop period spikes.
+ *
+ * Each thread that records a span gets its own ring of the last RING_SIZE spans (up to MAX_THREADS
+ * threads at once; a ring is handed to a new thread once its owner exits), so recording is a timestamp
+ * read and a few stores, with no locks or atomic read-modify-write.
+ * Old spans are overwritten, so the rings always hold the most recent history. Timestamps come from the
+ * CPU time stamp counter where there is one, and are converted to FalconClock time on export.
+ *
+ * writeChromeTrace() writes the rings as Chrome trace event JSON, which loads in chrome://tracing and
+ * in the Perfetto UI. It can be called from any thread while spans are being recorded.
+ *
+ * FalconTrace is only built into the library with ENABLE_TRACING.
+ */
+	class FalconTrace
+	{
+	public:
+		enum {
+			RING_SIZE = 16384, /**< Spans kept per thread */
+			MAX_THREADS = 32 /**< Threads that can record spans */
+		};
+
+		/**
+		 * Reads the trace clock
+		 *
+		 * @return Clock ticks, only meaningful relative to other ticks
+		 */
+		static uint64_t getTicks()
+		{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+			return __rdtsc();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+			return __builtin_ia32_rdtsc();
+#else
+			return (uint64_t)(FalconClock::getTime() * 1e9);
+#endif
+		}
+
+		/**
+		 * Turns span recording on or off. Recording starts off.
+		 *
+		 * @param enabled true to record spans
+		 */
+		static void setEnabled(bool enabled);
+
+		/**
+		 * Returns whether spans are being recorded
+		 *
+		 * @return true if recording
+		 */
+		static bool isEnabled() { return s_enabled.load(boost::memory_order_relaxed); }
+
+		/**
+		 * Records a span in the calling thread's ring. Usually called by FalconTraceScope.
+		 *
+		 * @param name Span name, which must outlive the trace (a string literal)
+		 * @param begin Ticks at the start of the span
+		 * @param end Ticks at the end of the span
+		 */
+		static void write(const char* name, uint64_t begin, uint64_t end);
+
+		/**
+		 * Writes the recorded spans as Chrome trace event JSON
+		 *
+		 * @param out Stream to write to
+		 * @param seconds Only write spans this recent (relative to the newest span), 0 for all
+		 *
+		 * @return Number of spans written
+		 */
+		static unsigned int writeChromeTrace(std::ostream& out, double seconds = 0.0);
+
+		/**
+		 * Writes the recorded spans as Chrome trace event JSON to a file
+		 *
+		 * @param filename File to write
+		 * @param seconds Only write spans this recent, 0 for all
+		 *
+		 * @return true if the file was written, false otherwise
+		 */
+		static bool writeChromeTrace(const std::string& filename, double seconds = 0.0);
+	protected:
+		static boost::atomic<bool> s_enabled; /**< True while recording */
+	};
+
+/**
+ * @class FalconTraceScope
+ * @ingroup CoreClasses
+ *
+ * Records a FalconTrace span covering its own lifetime. Use through FALCON_TRACE_SCOPE.
+ */
+	class FalconTraceScope
+	{
+	public:
+		/**
+		 * Constructor, starts the span
+		 *
+		 * @param name Span name, which must outlive the trace (a string literal)
+		 */
+		FalconTraceScope(const char* name) :
+			m_name(name),
+			m_begin(FalconTrace::isEnabled() ? FalconTrace::getTicks() : 0)
+		{
+		}
+
+		/**
+		 * Destructor, ends the span
+		 */
+		~FalconTraceScope()
+		{
+			if(m_begin != 0)
+			{
+				FalconTrace::write(m_name, m_begin, FalconTrace::getTicks());
+			}
+		}
+	protected:
+		const char* m_name; /**< Span name */
+		uint64_t m_begin; /**< Ticks at the start of the span, 0 if not recording */
+	};
+}
+
+#endif
@@ -0,0 +1,86 @@
+/***
+ * @file FalconVelocityEstimator.h
+ * @brief Base class for velocity/acceleration estimator policy classes
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONVELOCITYESTIMATOR_H
+#define FALCONVELOCITYESTIMATOR_H
+
+#include <boost/array.hpp>
+#include "falcon/core/FalconCore.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconVelocityEstimator
+ * @ingroup CoreClasses
+ * @ingroup EstimatorClasses
+ *
+ * Estimators turn the stream of timestamped end effector positions coming out of the kinematics into
+ * velocity and acceleration values. Differentiating positions over host loop time is very noisy, since
+ * the falcon position is quantized by the encoders and the time between I/O loops jitters, so
+ * estimators are fed with the time each sample was actually received at (see FalconClock).
+ *
+ * FalconDevice runs the estimator in runIOLoop() whenever a new sample arrives from the falcon, and
+ * publishes the results in the FalconState snapshot.
+ */
+	class FalconVelocityEstimator : public FalconCore
+	{
+	public:
+		/**
+		 * Constructor
+		 *
+		 */
+		FalconVelocityEstimator()
+		{
+			m_velocity.assign(0.0);
+			m_acceleration.assign(0.0);
+		}
+
+		/**
+		 * Destructor
+		 *
+		 */
+		virtual ~FalconVelocityEstimator() {}
+
+		/**
+		 * Clears all sample history. Called when the device is opened or closed, or when the
+		 * coordinate system jumps (i.e. the falcon has just been homed).
+		 *
+		 */
+		virtual void reset() = 0;
+
+		/**
+		 * Adds a new position sample and updates the velocity and acceleration estimates
+		 *
+		 * @param timestamp Time the sample was received at, in seconds
+		 * @param position End effector position, in cartesian coordinates (meters)
+		 */
+		virtual void addSample(double timestamp, const boost::array<double, 3>& position) = 0;
+
+		/**
+		 * Returns the current velocity estimate
+		 *
+		 * @return Velocity in meters/second
+		 */
+		const boost::array<double, 3>& getVelocity() const { return m_velocity; }
+
+		/**
+		 * Returns the current acceleration estimate
+		 *
+		 * @return Acceleration in meters/second^2
+		 */
+		const boost::array<double, 3>& getAcceleration() const { return m_acceleration; }
+	protected:
+		boost::array<double, 3> m_velocity; /**< Current velocity estimate */
+		boost::array<double, 3> m_acceleration; /**< Current acceleration estimate */
+	};
+}
+
+#endif
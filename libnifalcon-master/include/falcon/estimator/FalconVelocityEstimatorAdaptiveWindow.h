@@ -0,0 +1,93 @@
+/***
+ * @file FalconVelocityEstimatorAdaptiveWindow.h
+ * @brief First order adaptive windowing (FOAW) velocity estimation
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONVELOCITYESTIMATORADAPTIVEWINDOW_H
+#define FALCONVELOCITYESTIMATORADAPTIVEWINDOW_H
+
+#include "falcon/core/FalconVelocityEstimator.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconVelocityEstimatorAdaptiveWindow
+ * @ingroup EstimatorClasses
+ *
+ * Implementation of the first order adaptive windowing estimator from Janabi-Sharifi, Hayward and Chen,
+ * "Discrete-time adaptive windowing for velocity estimation" (IEEE Transactions on Control Systems
+ * Technology, 2000).
+ *
+ * For each axis, the estimator looks back through the sample history for the longest window whose
+ * end-to-end slope explains every sample inside it to within the position noise bound. Slow motion gets
+ * long windows (low noise), fast motion gets short windows (low lag), with no filter tuning beyond the
+ * noise bound, which should be set to about half the position quantization of the device.
+ *
+ * Acceleration is estimated by running the same windowing over the velocity estimates.
+ */
+	class FalconVelocityEstimatorAdaptiveWindow : public FalconVelocityEstimator
+	{
+	public:
+		enum {
+			MAX_WINDOW_SIZE = 32 /**< Maximum number of samples kept in the history */
+		};
+
+		/**
+		 * Constructor
+		 *
+		 * @param position_noise Position noise bound, in meters
+		 * @param velocity_noise Velocity noise bound used for acceleration estimation, in meters/second
+		 * @param window_size Maximum number of samples in a window (capped at MAX_WINDOW_SIZE)
+		 */
+		FalconVelocityEstimatorAdaptiveWindow(double position_noise = 0.00005, double velocity_noise = 0.005, unsigned int window_size = 16);
+
+		/**
+		 * Destructor
+		 *
+		 */
+		~FalconVelocityEstimatorAdaptiveWindow() {}
+
+		/**
+		 * Sets the noise bounds used to decide how far back a window can stretch
+		 *
+		 * @param position_noise Position noise bound, in meters
+		 * @param velocity_noise Velocity noise bound used for acceleration estimation, in meters/second
+		 */
+		void setNoiseBounds(double position_noise, double velocity_noise)
+		{
+			m_positionNoise = position_noise;
+			m_velocityNoise = velocity_noise;
+		}
+
+		void reset();
+		void addSample(double timestamp, const boost::array<double, 3>& position);
+	protected:
+		/**
+		 * Finds the slope of the longest window that fits the history to within a noise bound
+		 *
+		 * @param values History of values for all axes, indexed the same as m_timestamps
+		 * @param axis Axis to estimate the slope for
+		 * @param noise Noise bound for the values
+		 *
+		 * @return Estimated slope (derivative) of the values
+		 */
+		double fitWindow(const boost::array<double, 3>* values, int axis, double noise) const;
+
+		double m_positionNoise; /**< Position noise bound, in meters */
+		double m_velocityNoise; /**< Velocity noise bound, in meters/second */
+		unsigned int m_windowSize; /**< Maximum window size, in samples */
+		unsigned int m_head; /**< Index of the newest sample in the history */
+		unsigned int m_count; /**< Number of valid samples in the history */
+		double m_timestamps[MAX_WINDOW_SIZE]; /**< Sample timestamps */
+		boost::array<double, 3> m_positions[MAX_WINDOW_SIZE]; /**< Position history */
+		boost::array<double, 3> m_velocities[MAX_WINDOW_SIZE]; /**< Velocity estimate history */
+	};
+}
+
+#endif
@@ -0,0 +1,65 @@
+/***
+ * @file FalconVelocityEstimatorFilteredDifference.h
+ * @brief Finite difference velocity estimation with a first order low pass filter
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONVELOCITYESTIMATORFILTEREDDIFFERENCE_H
+#define FALCONVELOCITYESTIMATORFILTEREDDIFFERENCE_H
+
+#include "falcon/core/FalconVelocityEstimator.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconVelocityEstimatorFilteredDifference
+ * @ingroup EstimatorClasses
+ *
+ * Backwards difference between consecutive samples, run through a first order low pass filter. The
+ * filter coefficient is recomputed from the real time between samples, so the cutoff frequency stays
+ * put even when the loop rate jitters. Acceleration is the filtered difference of the filtered velocity.
+ *
+ * Cheapest of the estimators, at the cost of a phase lag that grows as the cutoff is lowered.
+ */
+	class FalconVelocityEstimatorFilteredDifference : public FalconVelocityEstimator
+	{
+	public:
+		/**
+		 * Constructor
+		 *
+		 * @param velocity_cutoff Cutoff frequency of the velocity filter, in Hz
+		 * @param acceleration_cutoff Cutoff frequency of the acceleration filter, in Hz
+		 */
+		FalconVelocityEstimatorFilteredDifference(double velocity_cutoff = 50.0, double acceleration_cutoff = 20.0);
+
+		/**
+		 * Destructor
+		 *
+		 */
+		~FalconVelocityEstimatorFilteredDifference() {}
+
+		/**
+		 * Sets the filter cutoff frequencies
+		 *
+		 * @param velocity_cutoff Cutoff frequency of the velocity filter, in Hz
+		 * @param acceleration_cutoff Cutoff frequency of the acceleration filter, in Hz
+		 */
+		void setCutoffFrequencies(double velocity_cutoff, double acceleration_cutoff);
+
+		void reset();
+		void addSample(double timestamp, const boost::array<double, 3>& position);
+	protected:
+		double m_velocityTimeConstant; /**< Time constant of the velocity filter, in seconds */
+		double m_accelerationTimeConstant; /**< Time constant of the acceleration filter, in seconds */
+		unsigned int m_sampleCount; /**< Number of samples seen since the last reset */
+		double m_lastTimestamp; /**< Timestamp of the previous sample */
+		boost::array<double, 3> m_lastPosition; /**< Position of the previous sample */
+	};
+}
+
+#endif
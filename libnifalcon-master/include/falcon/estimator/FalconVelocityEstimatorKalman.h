@@ -0,0 +1,72 @@
+/***
+ * @file FalconVelocityEstimatorKalman.h
+ * @brief Constant acceleration Kalman filter velocity estimation
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONVELOCITYESTIMATORKALMAN_H
+#define FALCONVELOCITYESTIMATORKALMAN_H
+
+#include "falcon/core/FalconVelocityEstimator.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconVelocityEstimatorKalman
+ * @ingroup EstimatorClasses
+ *
+ * Small Kalman filter run independently on each axis, with a [position, velocity, acceleration] state
+ * and a constant acceleration (white jerk) process model. The transition and process noise matrices are
+ * rebuilt from the real time between samples, so irregular sample spacing is handled properly.
+ *
+ * Tuning is done with two numbers: the measurement noise (variance of the position quantization) and the
+ * jerk spectral density (how quickly the hand is expected to change acceleration). Raising the jerk
+ * density makes the filter track faster at the cost of more noise.
+ */
+	class FalconVelocityEstimatorKalman : public FalconVelocityEstimator
+	{
+	public:
+		/**
+		 * Constructor
+		 *
+		 * @param measurement_noise Variance of the position measurement, in meters^2
+		 * @param jerk_density Spectral density of the jerk process noise, in meters^2/second^5
+		 */
+		FalconVelocityEstimatorKalman(double measurement_noise = 1e-9, double jerk_density = 100.0);
+
+		/**
+		 * Destructor
+		 *
+		 */
+		~FalconVelocityEstimatorKalman() {}
+
+		/**
+		 * Sets the filter tuning
+		 *
+		 * @param measurement_noise Variance of the position measurement, in meters^2
+		 * @param jerk_density Spectral density of the jerk process noise, in meters^2/second^5
+		 */
+		void setNoise(double measurement_noise, double jerk_density)
+		{
+			m_measurementNoise = measurement_noise;
+			m_jerkDensity = jerk_density;
+		}
+
+		void reset();
+		void addSample(double timestamp, const boost::array<double, 3>& position);
+	protected:
+		double m_measurementNoise; /**< Position measurement variance */
+		double m_jerkDensity; /**< Jerk process noise spectral density */
+		bool m_initialized; /**< True once the first sample has seeded the state */
+		double m_lastTimestamp; /**< Timestamp of the previous sample */
+		double m_state[3][3]; /**< Per axis state: position, velocity, acceleration */
+		double m_covariance[3][3][3]; /**< Per axis 3x3 state covariance */
+	};
+}
+
+#endif
@@ -0,0 +1,78 @@
+/***
+ * @file FalconBinaryLogBoostThread.h
+ * @brief Utility class for draining the binary log from a boost::thread (http://www.boost.org)
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONBINARYLOGBOOSTTHREAD_H
+#define FALCONBINARYLOGBOOSTTHREAD_H
+#include <ostream>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+
+namespace libnifalcon
+{
+/**
+ * @class FalconBinaryLogBoostThread
+ * @ingroup UtilityClasses
+ *
+ * Background thread that periodically drains the binary log (see FalconBinaryLog) to a stream, so the
+ * threads doing the logging never format anything. Only useful when libnifalcon is built with
+ * ENABLE_BINARY_LOGGING.
+ *
+ * Only one drain thread should run per process.
+ *
+ * The FalconBinaryLogBoostThread class is only available if the boost::thread library is available on the system.
+ */
+
+	class FalconBinaryLogBoostThread
+	{
+	public:
+		/**
+		 * Constructor
+		 */
+		FalconBinaryLogBoostThread();
+
+		/**
+		 * Destructor. Stops the thread, draining whatever is left.
+		 */
+		virtual ~FalconBinaryLogBoostThread();
+
+		/**
+		 * Starts a thread draining the log
+		 *
+		 * @param out Stream to write formatted records to. Must outlive the thread.
+		 * @param interval_ms Time between drains, in milliseconds
+		 */
+		void startThread(std::ostream& out, unsigned int interval_ms = 100);
+
+		/**
+		 * Stops thread if running, after a final drain
+		 */
+		void stopThread();
+
+		/**
+		 * Thread run status
+		 *
+		 * @return True if running, false otherwise
+		 */
+		bool isThreadRunning() { return m_runThreadLoop; }
+	protected:
+		/**
+		 * Drain loop run by the thread
+		 */
+		void runThreadLoop();
+
+		boost::shared_ptr<boost::thread> m_drainThread; /**< Internal thread object */
+		std::ostream* m_out; /**< Stream records are written to */
+		unsigned int m_interval; /**< Time between drains, in milliseconds */
+		boost::atomic<bool> m_runThreadLoop; /**< Internal thread execution state. Thread loop exits if this is false. */
+	};
+}
+#endif
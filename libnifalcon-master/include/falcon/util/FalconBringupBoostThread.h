@@ -0,0 +1,213 @@
+/***
+ * @file FalconBringupBoostThread.h
+ * @brief Utility class for opening, loading and homing several falcons at once using boost::thread (http://www.boost.org)
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONBRINGUPBOOSTTHREAD_H
+#define FALCONBRINGUPBOOSTTHREAD_H
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include "falcon/core/FalconDevice.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconBringupBoostThread
+ * @ingroup UtilityClasses
+ *
+ * Brings up a rig of falcons concurrently, one boost::thread per device. Each thread opens its device
+ * (which configures the FTDI), makes sure firmware is running (loading a FalconFirmwareRegistry image
+ * if not), then optionally waits for the device to be homed. Devices don't wait for each other, so a
+ * device that is already loaded and homed is ready long before one that needs firmware.
+ *
+ * Each phase is timed per device; see getReport(). As soon as a device is ready, deviceReady() is called
+ * from its bring-up thread, so the application can start servoing it while the others are still coming
+ * up. From then on the device belongs to the application; the bring-up threads never touch it again.
+ *
+ * Devices have to outlive the bring-up, and need their comm and firmware policies set before start().
+ *
+ * Classes overriding deviceReady() or deviceFailed() must call wait() from their own destructor. The
+ * bring-up threads call those functions, and by the time the base destructor runs the derived part of
+ * the object is gone, so joining the threads there is too late.
+ *
+ * The FalconBringupBoostThread class is only available if the boost::thread library is available on the system.
+ */
+
+	class FalconBringupBoostThread
+	{
+	public:
+		/**
+		 * Bring-up phases, in order
+		 */
+		enum Phase {
+			PHASE_OPEN, /**< Opening the device and configuring the FTDI */
+			PHASE_FIRMWARE, /**< Checking for and loading firmware */
+			PHASE_HOMING, /**< Waiting for the encoders to be homed */
+			PHASE_COUNT
+		};
+
+		/**
+		 * Device bring-up states
+		 */
+		enum State {
+			STATE_PENDING, /**< Not started */
+			STATE_RUNNING, /**< Bring-up thread running */
+			STATE_READY, /**< Ready for the application */
+			STATE_FAILED /**< Bring-up failed, see Report::failedPhase and Report::errorCode */
+		};
+
+		/**
+		 * Bring-up results for one device
+		 */
+		struct Report
+		{
+			State state; /**< Bring-up state */
+			Phase failedPhase; /**< Phase that failed, if state is STATE_FAILED */
+			int errorCode; /**< Device error code, if state is STATE_FAILED */
+			double phaseTimes[PHASE_COUNT]; /**< Time spent in each phase, in seconds */
+			double readyTime; /**< Time from start() until the device was ready or failed, in seconds */
+			bool firmwareLoaded; /**< True if the device had no firmware running and it had to be loaded */
+		};
+
+		/**
+		 * Constructor
+		 */
+		FalconBringupBoostThread();
+
+		/**
+		 * Destructor, waits for bring-up to finish. Derived classes must have called wait() already (see the
+		 * class description).
+		 */
+		virtual ~FalconBringupBoostThread();
+
+		/**
+		 * Adds a device to bring up
+		 *
+		 * @param device Device with comm and firmware policies set, not open yet
+		 * @param index Index to open the device with
+		 *
+		 * @return Device number, used by the other functions
+		 */
+		unsigned int addDevice(FalconDevice* device, unsigned int index);
+
+		/**
+		 * Sets the registered firmware loaded to devices without firmware. Defaults to "nvent".
+		 *
+		 * @param name FalconFirmwareRegistry image name
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 * @param retries Number of upload attempts
+		 */
+		void setFirmware(const std::string& name, bool skip_checksum = false, unsigned int retries = 3);
+
+		/**
+		 * Sets whether bring-up waits for homing. When it does, the LEDs are red until the device is homed,
+		 * then green. Homing needs the grip pulled out and pushed in by hand, so the wait can be long.
+		 * Defaults to not waiting.
+		 *
+		 * @param wait_for_homing True to wait for homing
+		 * @param timeout How long to wait, in seconds
+		 */
+		void setHoming(bool wait_for_homing, double timeout = 30.0);
+
+		/**
+		 * Starts a bring-up thread per device
+		 */
+		void start();
+
+		/**
+		 * Waits for every device to be ready or failed. Derived classes must call this from their destructor,
+		 * as the bring-up threads call their overrides. Safe to call more than once.
+		 *
+		 * @return true if every device is ready, false otherwise
+		 */
+		bool wait();
+
+		/**
+		 * Returns the number of devices added
+		 *
+		 * @return Device count
+		 */
+		unsigned int getDeviceCount() const { return m_devices.size(); }
+
+		/**
+		 * Returns the bring-up state of a device, without waiting
+		 *
+		 * @param device Device number
+		 *
+		 * @return Bring-up state
+		 */
+		State getState(unsigned int device) const;
+
+		/**
+		 * Returns whether a device is ready for the application
+		 *
+		 * @param device Device number
+		 *
+		 * @return true if ready
+		 */
+		bool isReady(unsigned int device) const { return getState(device) == STATE_READY; }
+
+		/**
+		 * Returns the bring-up results for a device. Until the device is ready or failed, only the state
+		 * is filled in.
+		 *
+		 * @param device Device number
+		 *
+		 * @return Bring-up results
+		 */
+		Report getReport(unsigned int device) const;
+	protected:
+		/**
+		 * Called from a device's bring-up thread as soon as it is ready. Overridden to start servoing
+		 * the device (starting its I/O thread, for instance). Does nothing by default.
+		 *
+		 * @param device Device number
+		 */
+		virtual void deviceReady(unsigned int /*device*/) {}
+
+		/**
+		 * Called from a device's bring-up thread if bring-up fails. Does nothing by default.
+		 *
+		 * @param device Device number
+		 */
+		virtual void deviceFailed(unsigned int /*device*/) {}
+
+		/**
+		 * Brings up one device
+		 *
+		 * @param device Device number
+		 */
+		void runBringup(unsigned int device);
+
+		/**
+		 * Per device bring-up state
+		 */
+		struct DeviceEntry
+		{
+			FalconDevice* device; /**< Device to bring up */
+			unsigned int index; /**< Index to open it with */
+			Report report; /**< Results, written by the bring-up thread before state is published */
+			boost::atomic<int> state; /**< State, published last */
+		};
+
+		std::vector<boost::shared_ptr<DeviceEntry> > m_devices; /**< Devices to bring up */
+		boost::thread_group m_threads; /**< Bring-up threads */
+		std::string m_firmwareName; /**< Registered firmware to load */
+		bool m_skipChecksum; /**< Whether to skip checksums when loading firmware */
+		unsigned int m_firmwareRetries; /**< Firmware upload attempts */
+		bool m_waitForHoming; /**< True to wait for homing */
+		double m_homingTimeout; /**< Homing wait, in seconds */
+		double m_startTime; /**< Time start() was called */
+	};
+}
+
+#endif
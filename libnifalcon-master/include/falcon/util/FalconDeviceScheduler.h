@@ -0,0 +1,360 @@
+/***
+ * @file FalconDeviceScheduler.h
+ * @brief Single threaded C++20 coroutine scheduler for writing sample driven falcon behaviors
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONDEVICESCHEDULER_H
+#define FALCONDEVICESCHEDULER_H
+
+#include "falcon/core/FalconDevice.h"
+
+//Header only, so the library itself can keep building as C++03. Only visible to C++20 code.
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+#include <exception>
+#include <vector>
+
+namespace libnifalcon
+{
+	class FalconDeviceScheduler;
+
+/**
+ * @class FalconTask
+ * @ingroup UtilityClasses
+ *
+ * Return type for coroutines run by a FalconDeviceScheduler. A FalconTask does nothing until it is handed
+ * to FalconDeviceScheduler::spawn(), which takes ownership of the coroutine.
+ */
+	class FalconTask
+	{
+	public:
+		struct promise_type
+		{
+			FalconTask get_return_object() { return FalconTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return std::suspend_always(); }
+			std::suspend_always final_suspend() noexcept { return std::suspend_always(); }
+			void return_void() {}
+			//libnifalcon doesn't use exceptions, and there's nowhere sensible to rethrow them to
+			void unhandled_exception() { std::terminate(); }
+		};
+
+		FalconTask(FalconTask&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+
+		~FalconTask()
+		{
+			if(m_handle)
+			{
+				m_handle.destroy();
+			}
+		}
+
+		/**
+		 * Gives up ownership of the coroutine
+		 *
+		 * @return Coroutine handle, which the caller now has to destroy
+		 */
+		std::coroutine_handle<> release()
+		{
+			std::coroutine_handle<> handle = m_handle;
+			m_handle = nullptr;
+			return handle;
+		}
+	private:
+		explicit FalconTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+		FalconTask(const FalconTask&) = delete;
+		FalconTask& operator=(const FalconTask&) = delete;
+
+		std::coroutine_handle<promise_type> m_handle; /**< Owned coroutine */
+	};
+
+/**
+ * @class FalconDeviceScheduler
+ * @ingroup UtilityClasses
+ *
+ * Control code written around FalconDevice::runIOLoop() polling tends to turn into state machines of
+ * flags (see the examples' FalconCubeTest::runFunction). FalconDeviceScheduler lets each behavior be
+ * written as a straight line C++20 coroutine instead:
+ *
+ * @code
+ * FalconTask waitForGrip(FalconDeviceScheduler& s)
+ * {
+ *     co_await s.homed();
+ *     co_await s.buttonPressed(FalconGripFourButton::CENTER_BUTTON);
+ *     const FalconState& state = co_await s.nextSample();
+ *     ...
+ * }
+ *
+ * FalconDeviceScheduler scheduler(device);
+ * scheduler.spawn(waitForGrip(scheduler));
+ * while(scheduler.getTaskCount() > 0) scheduler.runIOLoop();
+ * @endcode
+ *
+ * The scheduler runs entirely on the thread calling runIOLoop() (or dispatch(), for applications that run
+ * the device loop themselves), and resumes every waiting coroutine whose condition has been met after each
+ * new sample. Awaiters live in the coroutine frames and are chained into an intrusive list, so awaiting
+ * never allocates; the only allocations are the coroutine frames themselves, when behaviors are spawned.
+ * Any number of behaviors can wait on the same device.
+ *
+ * This header is only usable from C++20 code, and compiles to nothing otherwise. The falcon_scheduler
+ * example runs a couple of behaviors against the simulated falcon.
+ */
+	class FalconDeviceScheduler
+	{
+	public:
+		/**
+		 * Base of all awaitables. Kept in the coroutine frame while suspended, linked into the scheduler's
+		 * wait list.
+		 */
+		class Waiter
+		{
+		public:
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				m_handle = handle;
+				m_scheduler.addWaiter(this);
+			}
+		protected:
+			friend class FalconDeviceScheduler;
+			explicit Waiter(FalconDeviceScheduler& scheduler) : m_scheduler(scheduler), m_next(nullptr) {}
+
+			/**
+			 * Checks whether the waiting coroutine should be resumed on the current sample
+			 *
+			 * @return true to resume
+			 */
+			virtual bool isReady() const = 0;
+
+			FalconDeviceScheduler& m_scheduler; /**< Scheduler the waiter is queued on */
+			Waiter* m_next; /**< Next waiter in the wait list */
+			std::coroutine_handle<> m_handle; /**< Suspended coroutine */
+		};
+
+		/**
+		 * Awaitable for the next sample from the falcon. Resumes with the sample's state.
+		 */
+		class SampleWaiter : public Waiter
+		{
+		public:
+			explicit SampleWaiter(FalconDeviceScheduler& scheduler) : Waiter(scheduler) {}
+			bool await_ready() const { return false; }
+			const FalconState& await_resume() const { return m_scheduler.getState(); }
+		protected:
+			virtual bool isReady() const { return true; }
+		};
+
+		/**
+		 * Awaitable for all 3 legs being homed. Completes immediately if they already are.
+		 */
+		class HomedWaiter : public Waiter
+		{
+		public:
+			explicit HomedWaiter(FalconDeviceScheduler& scheduler) : Waiter(scheduler) {}
+			bool await_ready() const { return isReady(); }
+			void await_resume() const {}
+		protected:
+			virtual bool isReady() const { return m_scheduler.getState().isHomed; }
+		};
+
+		/**
+		 * Awaitable for a grip button going from released to pressed
+		 */
+		class ButtonWaiter : public Waiter
+		{
+		public:
+			ButtonWaiter(FalconDeviceScheduler& scheduler, unsigned int button) : Waiter(scheduler), m_button(button) {}
+			bool await_ready() const { return false; }
+			void await_resume() const {}
+		protected:
+			virtual bool isReady() const { return (m_scheduler.getPressedButtons() & m_button) != 0; }
+
+			unsigned int m_button; /**< Button flag to wait for */
+		};
+
+		/**
+		 * Constructor
+		 *
+		 * @param device Device to run behaviors against. Must outlive the scheduler.
+		 */
+		explicit FalconDeviceScheduler(FalconDevice& device) :
+			m_device(device),
+			m_waiters(nullptr),
+			m_lastSampleCount(0),
+			m_pressedButtons(0)
+		{
+		}
+
+		/**
+		 * Destructor. Destroys any behaviors that have not finished.
+		 */
+		~FalconDeviceScheduler()
+		{
+			for(std::vector<std::coroutine_handle<> >::iterator i = m_tasks.begin(); i != m_tasks.end(); ++i)
+			{
+				i->destroy();
+			}
+		}
+
+		/**
+		 * Starts a behavior. It runs until its first co_await before spawn() returns.
+		 *
+		 * @param task Behavior coroutine
+		 */
+		void spawn(FalconTask task)
+		{
+			std::coroutine_handle<> handle = task.release();
+			m_tasks.push_back(handle);
+			handle.resume();
+			reap();
+		}
+
+		/**
+		 * Runs one iteration of FalconDevice::runIOLoop(), then dispatch()
+		 *
+		 * @param exe_flags Flags passed to FalconDevice::runIOLoop()
+		 *
+		 * @return Result of FalconDevice::runIOLoop()
+		 */
+		bool runIOLoop(unsigned int exe_flags = (FalconDevice::FALCON_LOOP_FIRMWARE | FalconDevice::FALCON_LOOP_KINEMATIC | FalconDevice::FALCON_LOOP_GRIP | FalconDevice::FALCON_LOOP_ESTIMATOR))
+		{
+			bool success = m_device.runIOLoop(exe_flags);
+			dispatch();
+			return success;
+		}
+
+		/**
+		 * Resumes waiting behaviors if the device has a new sample. Must be called from the thread running
+		 * the device's I/O loop, after FalconDevice::runIOLoop().
+		 */
+		void dispatch()
+		{
+			unsigned int last_buttons = m_state.digitalInputs;
+			m_device.getState(m_state);
+			if(m_state.sampleCount == m_lastSampleCount)
+			{
+				return;
+			}
+			m_lastSampleCount = m_state.sampleCount;
+			m_pressedButtons = m_state.digitalInputs & ~last_buttons;
+
+			//Take the whole list, so behaviors that wait again while we're walking it wait for the next sample
+			Waiter* waiter = m_waiters;
+			m_waiters = nullptr;
+			while(waiter != nullptr)
+			{
+				//The waiter is gone once its coroutine resumes
+				Waiter* next = waiter->m_next;
+				if(waiter->isReady())
+				{
+					waiter->m_handle.resume();
+				}
+				else
+				{
+					addWaiter(waiter);
+				}
+				waiter = next;
+			}
+			reap();
+		}
+
+		/**
+		 * Waits for the next sample
+		 *
+		 * @return Awaitable resuming with the new sample's state
+		 */
+		SampleWaiter nextSample() { return SampleWaiter(*this); }
+
+		/**
+		 * Waits for the falcon to be homed
+		 *
+		 * @return Awaitable
+		 */
+		HomedWaiter homed() { return HomedWaiter(*this); }
+
+		/**
+		 * Waits for a grip button press
+		 *
+		 * @param button Button flag (see the grip's button enum, e.g. FalconGripFourButton::CENTER_BUTTON)
+		 *
+		 * @return Awaitable
+		 */
+		ButtonWaiter buttonPressed(unsigned int button) { return ButtonWaiter(*this, button); }
+
+		/**
+		 * Returns the state of the last dispatched sample
+		 *
+		 * @return State snapshot
+		 */
+		const FalconState& getState() const { return m_state; }
+
+		/**
+		 * Returns the buttons that went from released to pressed on the last dispatched sample
+		 *
+		 * @return Button bitfield
+		 */
+		unsigned int getPressedButtons() const { return m_pressedButtons; }
+
+		/**
+		 * Returns the number of behaviors that have not finished yet
+		 *
+		 * @return Number of running behaviors
+		 */
+		size_t getTaskCount() const { return m_tasks.size(); }
+
+		/**
+		 * Returns the device behaviors are run against
+		 *
+		 * @return Device
+		 */
+		FalconDevice& getDevice() { return m_device; }
+	protected:
+		/**
+		 * Queues a suspended waiter
+		 *
+		 * @param waiter Waiter to queue
+		 */
+		void addWaiter(Waiter* waiter)
+		{
+			waiter->m_next = m_waiters;
+			m_waiters = waiter;
+		}
+
+		/**
+		 * Destroys behaviors that have run to completion
+		 *
+		 */
+		void reap()
+		{
+			for(size_t i = 0; i < m_tasks.size(); )
+			{
+				if(m_tasks[i].done())
+				{
+					m_tasks[i].destroy();
+					m_tasks[i] = m_tasks.back();
+					m_tasks.pop_back();
+				}
+				else
+				{
+					++i;
+				}
+			}
+		}
+
+		FalconDevice& m_device; /**< Device behaviors run against */
+		std::vector<std::coroutine_handle<> > m_tasks; /**< Behaviors that have not finished */
+		Waiter* m_waiters; /**< Intrusive list of suspended waiters */
+		FalconState m_state; /**< State of the last dispatched sample */
+		uint64_t m_lastSampleCount; /**< Sample count at the last dispatch */
+		unsigned int m_pressedButtons; /**< Buttons pressed on the last dispatched sample */
+	};
+}
+
+#endif
+
+#endif
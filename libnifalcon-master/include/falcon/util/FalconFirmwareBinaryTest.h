@@ -14,6 +14,10 @@ namespace libnifalcon {
 	/**
 	 * Array of byte values that make up the nvent firmware. Firmware is hex2000 encoded file that
 	 * represents the memory layout of the TMS320 DSP chip.
+	 *
+	 * Every translation unit that includes this header gets its own copy of the array. Prefer
+	 * FalconDevice::loadRegisteredFirmware("test", ...), which uses the single compressed copy in
+	 * FalconFirmwareRegistry.
 	 */
 	const static uint8_t NOVINT_FALCON_TEST_FIRMWARE[] = {
 	0xaa,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
@@ -0,0 +1,79 @@
+/***
+ * @file FalconFirmwareLoaderBoostThread.h
+ * @brief Utility class for loading firmware to several falcons at once using boost::thread (http://www.boost.org)
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#ifndef FALCONFIRMWARELOADERBOOSTTHREAD_H
+#define FALCONFIRMWARELOADERBOOSTTHREAD_H
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "falcon/core/FalconDevice.h"
+
+namespace libnifalcon
+{
+/**
+ * @class FalconFirmwareLoaderBoostThread
+ * @ingroup UtilityClasses
+ *
+ * Loads firmware to several opened devices at once, one boost::thread per device. Each falcon sits on
+ * its own USB endpoint and spends most of an upload waiting on its bootloader, so bringing up N falcons
+ * this way takes about as long as bringing up one.
+ *
+ * Devices are loaded through FalconDevice::loadFirmware(), so the firmware cache (see
+ * FalconDevice::setFirmwareCacheFile()) applies to each of them.
+ *
+ * The FalconFirmwareLoaderBoostThread class is only available if the boost::thread library is available on the system.
+ */
+
+	class FalconFirmwareLoaderBoostThread
+	{
+	public:
+		/**
+		 * Loads a firmware image to every device, in parallel
+		 *
+		 * @param devices Opened devices, each with a firmware policy set
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 * @param firmware_size Size of the firmware image
+		 * @param buffer Firmware image, shared (read only) by all loads
+		 * @param retries Number of upload attempts per device
+		 * @param results If not NULL, filled with whether each device loaded
+		 *
+		 * @return true if every device loaded, false otherwise
+		 */
+		static bool loadFirmware(const std::vector<FalconDevice*>& devices, bool skip_checksum, unsigned int firmware_size, uint8_t* buffer, unsigned int retries = 1, std::vector<bool>* results = NULL);
+
+		/**
+		 * Loads each device's own firmware file (see FalconDevice::setFirmwareFile()), in parallel
+		 *
+		 * @param devices Opened devices, each with a firmware policy and file set
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 * @param retries Number of upload attempts per device
+		 * @param results If not NULL, filled with whether each device loaded
+		 *
+		 * @return true if every device loaded, false otherwise
+		 */
+		static bool loadFirmware(const std::vector<FalconDevice*>& devices, bool skip_checksum, unsigned int retries = 1, std::vector<bool>* results = NULL);
+
+		/**
+		 * Loads a FalconFirmwareRegistry image to every device, in parallel (see
+		 * FalconDevice::loadRegisteredFirmware())
+		 *
+		 * @param devices Opened devices, each with a firmware policy set
+		 * @param name Registered image name
+		 * @param skip_checksum Whether or not to skip checksum tests when loading firmware
+		 * @param retries Number of upload attempts per device
+		 * @param results If not NULL, filled with whether each device loaded
+		 *
+		 * @return true if every device loaded, false otherwise
+		 */
+		static bool loadRegisteredFirmware(const std::vector<FalconDevice*>& devices, const std::string& name, bool skip_checksum, unsigned int retries = 1, std::vector<bool>* results = NULL);
+	};
+}
+
+#endif
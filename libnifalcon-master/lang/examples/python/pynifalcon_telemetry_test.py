@@ -0,0 +1,39 @@
+import sys
+import time
+
+#Runs the I/O loop on the bridge's native thread, and reads telemetry through numpy views
+from pynifalcon import *
+fdd = FalconDeviceBridge()
+print "Devices attached: %d" % (fdd.getCount())
+if fdd.getCount() is 0:
+    print "No devices attached, exiting..."
+    sys.exit()
+
+if not fdd.open(0):
+    print "Cannot open device, exiting..."
+    sys.exit()
+
+if not fdd.loadFirmware():
+    print "Cannot load firmware, exiting..."
+    sys.exit()
+
+if not fdd.startIOThread(FalconDeviceBridge.LOOP_DEFAULT):
+    print "Cannot start I/O thread, exiting..."
+    sys.exit()
+
+state = fdd.getStateArray()
+p = FalconDeviceBridge.SAMPLE_POSITION
+
+try:
+    while 1:
+        time.sleep(0.1)
+        samples = fdd.fetchSampleArray()
+        fdd.updateState()
+        if len(samples) is 0:
+            continue
+        rate = (len(samples) - 1) / max(samples[-1, 0] - samples[0, 0], 1e-6)
+        print "%4d samples (%6.1f Hz, %d dropped) mean z %.4f, latest %s" % (len(samples), rate, fdd.getDroppedSampleCount(), samples[:, p + 2].mean(), state[FalconDeviceBridge.STATE_POSITION:FalconDeviceBridge.STATE_POSITION + 3])
+except KeyboardInterrupt:
+    pass
+
+fdd.close()
@@ -12,6 +12,9 @@
 #ifndef FALCONDEVICEBRIDGE_H
 #define FALCONDEVICEBRIDGE_H
 
+#include <cstddef>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 #include "falcon/core/FalconDevice.h"
 
 struct FalconVec3d
@@ -21,10 +24,58 @@ struct FalconVec3d
 	double z;
 };   
 
+/**
+ * Bindings friendly wrapper around FalconDevice.
+ *
+ * Besides the per call getters, the bridge can run the I/O loop on its own native thread
+ * (startIOThread()), so scripting languages don't have to call runIOLoop() at 1kHz. The thread records
+ * every new sample into a ring buffer. Telemetry is read through two flat arrays of doubles owned by the
+ * bridge, which the python module wraps as numpy arrays without copying:
+ *
+ * - The state buffer (STATE_* offsets) holds the latest sample, refreshed by updateState()
+ * - The sample buffer (SAMPLE_FIELDS doubles per row, SAMPLE_* offsets) is filled by fetchSamples() with
+ *   every sample recorded since the previous fetch, oldest first
+ *
+ * Neither refresh allocates, and the python module releases the GIL around every call.
+ *
+ * While the I/O thread runs, the per call functions stay safe to use from the calling thread: setForces()
+ * goes through the device's force channel, getPosition() reads the published state, setLEDStatus() is
+ * handed to the I/O thread, and getRawOutput() returns the last packet the I/O thread copied out (copies
+ * only start once it's been asked for, so the first call returns an empty string).
+ */
 class FalconDeviceBridge : public libnifalcon::FalconDevice
 {
 public:
-	
+	enum {
+		LOOP_FIRMWARE = libnifalcon::FalconDevice::FALCON_LOOP_FIRMWARE, /**< Run firmware I/O */
+		LOOP_KINEMATIC = libnifalcon::FalconDevice::FALCON_LOOP_KINEMATIC, /**< Compute position from the encoders */
+		LOOP_GRIP = libnifalcon::FalconDevice::FALCON_LOOP_GRIP, /**< Update the grip */
+		LOOP_ESTIMATOR = libnifalcon::FalconDevice::FALCON_LOOP_ESTIMATOR, /**< Estimate velocity */
+		LOOP_PREDICTION = libnifalcon::FalconDevice::FALCON_LOOP_PREDICTION, /**< Predict position for force computation */
+		LOOP_DEFAULT = LOOP_FIRMWARE | LOOP_KINEMATIC | LOOP_GRIP | LOOP_ESTIMATOR /**< Everything but prediction */
+	};
+
+	enum {
+		STATE_TIMESTAMP = 0, /**< FalconClock time of the sample, in seconds */
+		STATE_SAMPLE_COUNT = 1, /**< Samples received since the device was opened */
+		STATE_POSITION = 2, /**< Position x, y, z (meters) */
+		STATE_VELOCITY = 5, /**< Velocity x, y, z (meters/second) */
+		STATE_FORCE = 8, /**< Force sent x, y, z (newtons) */
+		STATE_BUTTONS = 11, /**< Grip digital inputs bitfield */
+		STATE_HOMED = 12, /**< 1 if homed, 0 otherwise */
+		STATE_FIELDS = 13 /**< Size of the state buffer */
+	};
+
+	enum {
+		SAMPLE_TIMESTAMP = 0, /**< FalconClock time of the sample, in seconds */
+		SAMPLE_POSITION = 1, /**< Position x, y, z (meters) */
+		SAMPLE_VELOCITY = 4, /**< Velocity x, y, z (meters/second) */
+		SAMPLE_FORCE = 7, /**< Force sent x, y, z (newtons) */
+		SAMPLE_BUTTONS = 10, /**< Grip digital inputs bitfield */
+		SAMPLE_FIELDS = 11, /**< Doubles per sample row */
+		SAMPLE_CAPACITY = 4096 /**< Samples buffered between fetches, about 4 seconds at 1kHz */
+	};
+
 	FalconDeviceBridge();
 	virtual ~FalconDeviceBridge();
 	int getCount();
@@ -38,6 +89,81 @@ public:
 	void setForces(FalconVec3d v);
 	FalconVec3d getPosition();
 	void setLEDStatus(int v);
+
+	/**
+	 * Starts a native thread running the I/O loop and recording samples. runIOLoop() must not be called
+	 * while it runs.
+	 *
+	 * @param exe_flags Flags passed to FalconDevice::runIOLoop() (LOOP_* values)
+	 *
+	 * @return true if the thread is running, false if the device isn't open
+	 */
+	bool startIOThread(unsigned int exe_flags);
+
+	/**
+	 * Stops the I/O thread, if running. Also called by close().
+	 */
+	void stopIOThread();
+
+	/**
+	 * @return true if the I/O thread is running
+	 */
+	bool isIOThreadRunning();
+
+	/**
+	 * Copies the latest published sample into the state buffer
+	 *
+	 * @return Sample count of the copied sample
+	 */
+	double updateState();
+
+	/**
+	 * Moves every sample recorded since the last fetch into the sample buffer, oldest first
+	 *
+	 * @return Number of rows filled
+	 */
+	int fetchSamples();
+
+	/**
+	 * @return Number of samples overwritten before they could be fetched, since the thread was started
+	 */
+	unsigned int getDroppedSampleCount();
+
+	/**
+	 * @return Address of the STATE_FIELDS doubles of the state buffer
+	 */
+	std::size_t getStateBufferAddress();
+
+	/**
+	 * @return Address of the SAMPLE_CAPACITY * SAMPLE_FIELDS doubles of the sample buffer
+	 */
+	std::size_t getSampleBufferAddress();
+
+protected:
+	/**
+	 * I/O thread body
+	 */
+	void runIOThread();
+
+	/**
+	 * Appends the sample the last I/O loop produced to the ring. Called from the I/O thread.
+	 */
+	void recordSample();
+
+	boost::shared_ptr<boost::thread> m_ioThread; /**< I/O thread, if started */
+	boost::atomic<bool> m_runIOThread; /**< I/O thread exits when false */
+	unsigned int m_ioFlags; /**< Flags the I/O thread runs the loop with */
+	uint64_t m_lastRecordedSample; /**< Sample count of the last recorded sample */
+	boost::atomic<int> m_pendingLEDStatus; /**< LED status for the I/O thread to apply, -1 if none */
+	boost::atomic<bool> m_rawOutputRequested; /**< True once getRawOutput() has been called while the I/O thread runs */
+	std::string m_rawOutput; /**< Last raw packet copied by the I/O thread, guarded by m_ringMutex */
+	boost::mutex m_ringMutex; /**< Guards the ring and its counters */
+	double m_ring[SAMPLE_CAPACITY][SAMPLE_FIELDS]; /**< Recorded samples */
+	unsigned int m_ringHead; /**< Next row written */
+	unsigned int m_ringCount; /**< Rows waiting to be fetched */
+	unsigned int m_droppedSamples; /**< Rows overwritten before being fetched */
+	double m_stateBuffer[STATE_FIELDS]; /**< State buffer exposed to the bindings */
+	double m_sampleBuffer[SAMPLE_CAPACITY][SAMPLE_FIELDS]; /**< Sample buffer exposed to the bindings */
 };
 
 #endif
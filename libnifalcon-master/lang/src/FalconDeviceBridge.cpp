@@ -10,6 +10,10 @@
  */
 
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#include <boost/bind.hpp>
 
 #include "falcon/util/FalconDeviceBridge.h"
 
@@ -22,12 +26,21 @@
 #include "falcon/firmware/FalconFirmwareNovintSDK.h"
 #include "falcon/kinematic/FalconKinematicStamper.h"
 #include "falcon/grip/FalconGripFourButton.h"
-#include "falcon/util/FalconFirmwareBinaryNvent.h"
 
 using namespace libnifalcon;
 
-	FalconDeviceBridge::FalconDeviceBridge()
+	FalconDeviceBridge::FalconDeviceBridge() :
+		m_runIOThread(false),
+		m_ioFlags(0),
+		m_lastRecordedSample(0),
+		m_pendingLEDStatus(-1),
+		m_rawOutputRequested(false),
+		m_ringHead(0),
+		m_ringCount(0),
+		m_droppedSamples(0)
 	{
+		memset(m_stateBuffer, 0, sizeof(m_stateBuffer));
+		memset(m_sampleBuffer, 0, sizeof(m_sampleBuffer));
 		//Fall back through the default device chain
 #if defined(LIBUSB)
 		setFalconComm<FalconCommLibUSB>();
@@ -42,6 +55,7 @@ using namespace libnifalcon;
 
 	FalconDeviceBridge::~FalconDeviceBridge()
 	{
+		stopIOThread();
 	}
 
 	int FalconDeviceBridge::getCount()
@@ -63,7 +77,7 @@ using namespace libnifalcon;
 			std::cout << "Loading firmware" << std::endl;
 			for(int i = 0; i < 10; ++i)
 			{
-				if(!getFalconFirmware()->loadFirmware(true, NOVINT_FALCON_NVENT_FIRMWARE_SIZE, const_cast<uint8_t*>(NOVINT_FALCON_NVENT_FIRMWARE)))
+				if(!loadRegisteredFirmware("nvent", true))
 				{
 					std::cout << "Could not load firmware" << std::endl;
 					return false;
@@ -85,17 +99,25 @@ using namespace libnifalcon;
 	
 	void FalconDeviceBridge::close()
 	{
+		stopIOThread();
 		FalconDevice::close();
 	}
 	
 	bool FalconDeviceBridge::runIOLoop(unsigned int exe_flags)
 	{
+		if(isIOThreadRunning()) return false;
 		return FalconDevice::runIOLoop(exe_flags);
 	}
 	
 	std::string FalconDeviceBridge::getRawOutput()
 	{
-		return FalconDevice::getFalconFirmware()->getRawReturn();
+		if(!isIOThreadRunning())
+		{
+			return FalconDevice::getFalconFirmware()->getRawReturn();
+		}
+		m_rawOutputRequested = true;
+		boost::mutex::scoped_lock lock(m_ringMutex);
+		return m_rawOutput;
 	}
 	
 	void FalconDeviceBridge::setRawInput(char* str)
@@ -113,12 +135,27 @@ using namespace libnifalcon;
 		j[0] = v.x;
 		j[1] = v.y;
 		j[2] = v.z;
+		if(isIOThreadRunning())
+		{
+			getForceChannel().pushForceSetpoint(j);
+			return;
+		}
 		FalconDevice::setForce(j);
 	}
 
 	FalconVec3d FalconDeviceBridge::getPosition()
 	{
-		boost::array<double, 3> j = FalconDevice::getPosition();
+		boost::array<double, 3> j;
+		if(isIOThreadRunning())
+		{
+			FalconState state;
+			FalconDevice::getState(state);
+			j = state.position;
+		}
+		else
+		{
+			j = FalconDevice::getPosition();
+		}
 		FalconVec3d v;
 		v.x = j[0];
 		v.y = j[1];
@@ -128,5 +165,147 @@ using namespace libnifalcon;
 
 	void FalconDeviceBridge::setLEDStatus(int v)
 	{
-		return FalconDevice::getFalconFirmware()->setLEDStatus(v);		
+		//The firmware's output packet belongs to whoever runs the I/O loop
+		if(isIOThreadRunning())
+		{
+			m_pendingLEDStatus = v;
+			return;
+		}
+		FalconDevice::getFalconFirmware()->setLEDStatus(v);
+	}
+
+	bool FalconDeviceBridge::startIOThread(unsigned int exe_flags)
+	{
+		if(isIOThreadRunning()) return true;
+		if(!isOpen()) return false;
+		m_ioFlags = exe_flags;
+		{
+			boost::mutex::scoped_lock lock(m_ringMutex);
+			m_ringHead = 0;
+			m_ringCount = 0;
+			m_droppedSamples = 0;
+		}
+		m_lastRecordedSample = m_ioState.sampleCount;
+		m_rawOutputRequested = false;
+		m_runIOThread = true;
+		m_ioThread.reset(new boost::thread(boost::bind(&FalconDeviceBridge::runIOThread, this)));
+		return true;
+	}
+
+	void FalconDeviceBridge::stopIOThread()
+	{
+		m_runIOThread = false;
+		if(m_ioThread)
+		{
+			m_ioThread->join();
+			m_ioThread.reset();
+			//Hand the device back to the per call functions: drop queued forces, keep the last LED change
+			getForceChannel().clear();
+			int led = m_pendingLEDStatus.exchange(-1);
+			if(led >= 0)
+			{
+				FalconDevice::getFalconFirmware()->setLEDStatus(led);
+			}
+		}
+	}
+
+	bool FalconDeviceBridge::isIOThreadRunning()
+	{
+		return m_ioThread.get() != NULL;
+	}
+
+	void FalconDeviceBridge::runIOThread()
+	{
+		while(m_runIOThread)
+		{
+			int led = m_pendingLEDStatus.exchange(-1);
+			if(led >= 0)
+			{
+				FalconDevice::getFalconFirmware()->setLEDStatus(led);
+			}
+			if(FalconDevice::runIOLoop(m_ioFlags))
+			{
+				recordSample();
+			}
+		}
+	}
+
+	void FalconDeviceBridge::recordSample()
+	{
+		if(m_ioState.sampleCount == m_lastRecordedSample) return;
+		m_lastRecordedSample = m_ioState.sampleCount;
+
+		boost::mutex::scoped_lock lock(m_ringMutex);
+		double* row = m_ring[m_ringHead];
+		row[SAMPLE_TIMESTAMP] = m_ioState.timestamp;
+		for(int i = 0; i < 3; ++i)
+		{
+			row[SAMPLE_POSITION + i] = m_ioState.position[i];
+			row[SAMPLE_VELOCITY + i] = m_ioState.velocity[i];
+			row[SAMPLE_FORCE + i] = m_ioState.force[i];
+		}
+		row[SAMPLE_BUTTONS] = m_ioState.digitalInputs;
+		//getRawReturn() allocates, so only pay for it once somebody has asked
+		if(m_rawOutputRequested)
+		{
+			m_rawOutput = FalconDevice::getFalconFirmware()->getRawReturn();
+		}
+		m_ringHead = (m_ringHead + 1) % SAMPLE_CAPACITY;
+		if(m_ringCount == SAMPLE_CAPACITY)
+		{
+			++m_droppedSamples;
+		}
+		else
+		{
+			++m_ringCount;
+		}
+	}
+
+	double FalconDeviceBridge::updateState()
+	{
+		FalconState state;
+		FalconDevice::getState(state);
+		m_stateBuffer[STATE_TIMESTAMP] = state.timestamp;
+		m_stateBuffer[STATE_SAMPLE_COUNT] = (double)state.sampleCount;
+		for(int i = 0; i < 3; ++i)
+		{
+			m_stateBuffer[STATE_POSITION + i] = state.position[i];
+			m_stateBuffer[STATE_VELOCITY + i] = state.velocity[i];
+			m_stateBuffer[STATE_FORCE + i] = state.force[i];
+		}
+		m_stateBuffer[STATE_BUTTONS] = state.digitalInputs;
+		m_stateBuffer[STATE_HOMED] = state.isHomed ? 1.0 : 0.0;
+		return m_stateBuffer[STATE_SAMPLE_COUNT];
+	}
+
+	int FalconDeviceBridge::fetchSamples()
+	{
+		boost::mutex::scoped_lock lock(m_ringMutex);
+		unsigned int count = m_ringCount;
+		//Oldest row, then copy in at most two runs around the end of the ring
+		unsigned int tail = (m_ringHead + SAMPLE_CAPACITY - count) % SAMPLE_CAPACITY;
+		unsigned int first = std::min(count, (unsigned int)SAMPLE_CAPACITY - tail);
+		memcpy(m_sampleBuffer[0], m_ring[tail], first * sizeof(m_ring[0]));
+		if(count > first)
+		{
+			memcpy(m_sampleBuffer[first], m_ring[0], (count - first) * sizeof(m_ring[0]));
+		}
+		m_ringCount = 0;
+		return count;
+	}
+
+	unsigned int FalconDeviceBridge::getDroppedSampleCount()
+	{
+		boost::mutex::scoped_lock lock(m_ringMutex);
+		return m_droppedSamples;
+	}
+
+	std::size_t FalconDeviceBridge::getStateBufferAddress()
+	{
+		return (std::size_t)m_stateBuffer;
+	}
+
+	std::size_t FalconDeviceBridge::getSampleBufferAddress()
+	{
+		return (std::size_t)m_sampleBuffer;
 	}
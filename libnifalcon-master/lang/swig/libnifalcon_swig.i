@@ -13,7 +13,36 @@ struct FalconVec3d
 class FalconDeviceBridge
 {
 public:
-	
+	enum {
+		LOOP_FIRMWARE = 0x1,
+		LOOP_KINEMATIC = 0x2,
+		LOOP_GRIP = 0x4,
+		LOOP_ESTIMATOR = 0x8,
+		LOOP_PREDICTION = 0x10,
+		LOOP_DEFAULT = 0xf
+	};
+
+	enum {
+		STATE_TIMESTAMP = 0,
+		STATE_SAMPLE_COUNT = 1,
+		STATE_POSITION = 2,
+		STATE_VELOCITY = 5,
+		STATE_FORCE = 8,
+		STATE_BUTTONS = 11,
+		STATE_HOMED = 12,
+		STATE_FIELDS = 13
+	};
+
+	enum {
+		SAMPLE_TIMESTAMP = 0,
+		SAMPLE_POSITION = 1,
+		SAMPLE_VELOCITY = 4,
+		SAMPLE_FORCE = 7,
+		SAMPLE_BUTTONS = 10,
+		SAMPLE_FIELDS = 11,
+		SAMPLE_CAPACITY = 4096
+	};
+
 	FalconDeviceBridge();
 	virtual ~FalconDeviceBridge();
 	int getCount();
@@ -27,4 +56,43 @@ public:
 	void setForces(FalconVec3d v);
 	FalconVec3d getPosition();
 	void setLEDStatus(int v);
+	bool startIOThread(unsigned int exe_flags);
+	void stopIOThread();
+	bool isIOThreadRunning();
+	double updateState();
+	int fetchSamples();
+	unsigned int getDroppedSampleCount();
+	size_t getStateBufferAddress();
+	size_t getSampleBufferAddress();
 };
+
+#ifdef SWIGPYTHON
+// numpy views over the bridge's telemetry buffers. Built over the buffers' memory, so they are never
+// copied, and only valid while the bridge object is alive. numpy is only needed if these are used.
+%extend FalconDeviceBridge {
+%pythoncode %{
+    def _doubleView(self, address, shape):
+        import ctypes, numpy
+        count = 1
+        for d in shape:
+            count *= d
+        return numpy.ctypeslib.as_array((ctypes.c_double * count).from_address(address)).reshape(shape)
+
+    def getStateArray(self):
+        """STATE_FIELDS doubles, refreshed in place by updateState()"""
+        if getattr(self, "_stateArray", None) is None:
+            self._stateArray = self._doubleView(self.getStateBufferAddress(), (self.STATE_FIELDS,))
+        return self._stateArray
+
+    def getSampleArray(self):
+        """SAMPLE_CAPACITY x SAMPLE_FIELDS doubles, rows filled in place by fetchSamples()"""
+        if getattr(self, "_sampleArray", None) is None:
+            self._sampleArray = self._doubleView(self.getSampleBufferAddress(), (self.SAMPLE_CAPACITY, self.SAMPLE_FIELDS))
+        return self._sampleArray
+
+    def fetchSampleArray(self):
+        """Samples recorded since the last fetch, oldest first. The view is overwritten by the next fetch."""
+        return self.getSampleArray()[:self.fetchSamples()]
+%}
+}
+#endif
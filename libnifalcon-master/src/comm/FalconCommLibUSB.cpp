@@ -11,6 +11,7 @@
 
 #include <boost/bind.hpp>
 #include "falcon/comm/FalconCommLibUSB.h"
+#include "falcon/core/FalconTrace.h"
 #include <iostream>
 #include <cstdio>
 #include <cstring>
@@ -57,6 +58,9 @@
 #define SIO_SET_RTS_HIGH ( 2 | ( SIO_SET_RTS_MASK << 8 ))
 #define SIO_SET_RTS_LOW ( 0 | ( SIO_SET_RTS_MASK << 8 ))
 
+#define FTDI_LATENCY_TIMER_REQUEST_TYPE 0x40
+#define FTDI_LATENCY_TIMER_REQUEST 0x09
+
 #define SIO_RTS_CTS_HS (0x1 << 8)
 
 #define INTERFACE_ANY 0
@@ -67,9 +71,23 @@
 namespace libnifalcon
 {
 
+#if defined(LIBUSB_HOTPLUG_MATCH_ANY)
+	//Hotplug callbacks can't do synchronous I/O, so just hand the device to the registry.
+	//Serial numbers are read later, from refreshRegistry.
+	static int LIBUSB_CALL hotplugCallback(libusb_context* /*context*/, libusb_device* device, libusb_hotplug_event event, void* user_data)
+	{
+		((FalconCommLibUSB*)user_data)->setHotplugEvent(device, event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+		return 0;
+	}
+#endif
+
 	FalconCommLibUSB::FalconCommLibUSB() :
+		m_hasHotplug(false),
+		m_hotplugHandle(0),
+		m_openDevice(NULL),
 		m_isWriteAllocated(false),
 		m_isReadAllocated(false),
+		m_falconDevice(NULL),
 		INIT_LOGGER("FalconCommLibUSB")
 	{
 		LOG_INFO("Constructing object");
@@ -86,6 +104,17 @@ namespace libnifalcon
 			close();
 		}
 		reset();
+#if defined(LIBUSB_HOTPLUG_MATCH_ANY)
+		if(m_hasHotplug)
+		{
+			libusb_hotplug_deregister_callback(m_usbContext, m_hotplugHandle);
+		}
+#endif
+		for(std::vector<DeviceEntry>::iterator i = m_registry.begin(); i != m_registry.end(); ++i)
+		{
+			libusb_unref_device(i->device);
+		}
+		m_registry.clear();
 		//libusb_exit(m_usbContext);
 		delete m_tv;
 		LOG_INFO("Destructing object");
@@ -108,122 +137,273 @@ namespace libnifalcon
 		LOG_INFO("Setting libusb debug level to 0");
 		libusb_set_debug(m_usbContext, 0);
 #endif
+#if defined(LIBUSB_HOTPLUG_MATCH_ANY)
+		//With hotplug, the enumerate flag fills the registry with everything already plugged in,
+		//and we never have to walk the bus again
+		if(libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+		{
+			m_hasHotplug = (libusb_hotplug_register_callback(m_usbContext,
+															 (libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+															 LIBUSB_HOTPLUG_ENUMERATE, FALCON_VENDOR_ID, FALCON_PRODUCT_ID, LIBUSB_HOTPLUG_MATCH_ANY,
+															 hotplugCallback, this, &m_hotplugHandle) == 0);
+			LOG_INFO("Hotplug support " << (m_hasHotplug ? "enabled" : "failed to register"));
+		}
+#endif
+		return true;
 	}
 
-	//Ripped out of libusb_open_device_with_vid_pid
-	bool FalconCommLibUSB::getDeviceCount(unsigned int& count)
+	void FalconCommLibUSB::setHotplugEvent(libusb_device* device, bool arrived)
 	{
-		LOG_INFO("Getting device count");
-		struct libusb_device **devs;
-		struct libusb_device *found = NULL;
-		struct libusb_device *dev;
-		size_t i = 0;
-		count = 0;
+		if(arrived)
+		{
+			addRegistryDevice(device);
+		}
+		else
+		{
+			removeRegistryDevice(device);
+		}
+	}
 
-		if (libusb_get_device_list(m_usbContext, &devs) < 0)
+	void FalconCommLibUSB::addRegistryDevice(libusb_device* device)
+	{
+		for(std::vector<DeviceEntry>::iterator i = m_registry.begin(); i != m_registry.end(); ++i)
 		{
-			LOG_ERROR("Device list not retrievable");
-			return false;
+			if(i->device == device) return;
+		}
+		DeviceEntry entry;
+		entry.device = libusb_ref_device(device);
+		entry.hasSerial = false;
+		char path[64];
+		int length = sprintf(path, "%d", libusb_get_bus_number(device));
+#if defined(LIBUSB_HOTPLUG_MATCH_ANY)
+		uint8_t ports[8];
+		int port_count = libusb_get_port_numbers(device, ports, 8);
+		for(int i = 0; i < port_count; ++i)
+		{
+			length += sprintf(path + length, "%c%d", (i == 0) ? '-' : '.', ports[i]);
 		}
+#else
+		sprintf(path + length, "-%d", libusb_get_device_address(device));
+#endif
+		entry.path = path;
+		//Keep the registry in path order, so indexes don't depend on plug order
+		std::vector<DeviceEntry>::iterator pos = m_registry.begin();
+		while(pos != m_registry.end() && pos->path < entry.path) ++pos;
+		m_registry.insert(pos, entry);
+		LOG_INFO("Falcon arrived at " << entry.path);
+	}
 
-		while ((dev = devs[i++]) != NULL)
+	void FalconCommLibUSB::removeRegistryDevice(libusb_device* device)
+	{
+		for(std::vector<DeviceEntry>::iterator i = m_registry.begin(); i != m_registry.end(); ++i)
 		{
-			struct libusb_device_descriptor desc;
-			m_deviceErrorCode = libusb_get_device_descriptor(dev, &desc);
-			if (m_deviceErrorCode < 0)
+			if(i->device != device) continue;
+			LOG_INFO("Falcon left " << i->path);
+			if(device == m_openDevice)
 			{
-				LOG_ERROR("Device descriptor not retrievable - Device error code " << m_deviceErrorCode);
-				break;
-			}
-			if (desc.idVendor == FALCON_VENDOR_ID && desc.idProduct == FALCON_PRODUCT_ID)
-			{
-				++count;
+				setDisconnected();
 			}
+			libusb_unref_device(i->device);
+			m_registry.erase(i);
+			return;
 		}
-
-		libusb_free_device_list(devs, 1);
-		return true;
 	}
 
-	//Ripped out of libusb_open_device_with_vid_pid
-	bool FalconCommLibUSB::open(unsigned int index)
+	bool FalconCommLibUSB::refreshRegistry()
 	{
-		LOG_INFO("Opening device");
-		struct libusb_device **devs;
-		struct libusb_device *found = NULL;
-		struct libusb_device *dev;
-		size_t i = 0;
-		int count = 0;
-
-
-		if ((m_deviceErrorCode = libusb_get_device_list(m_usbContext, &devs)) < 0)
+		if(m_hasHotplug)
 		{
-			LOG_ERROR("Device list not retrievable - Device error code " << m_deviceErrorCode);
-			m_errorCode = FALCON_COMM_DEVICE_ERROR;
-			return false;
+			//Dispatch any arrivals/departures that came in while nobody was polling
+			struct timeval zero = {0, 0};
+			libusb_handle_events_timeout_completed(m_usbContext, &zero, NULL);
 		}
-
-		while ((dev = devs[i++]) != NULL)
+		else
 		{
-			struct libusb_device_descriptor desc;
-			m_deviceErrorCode = libusb_get_device_descriptor(dev, &desc);
-			if (m_deviceErrorCode < 0)
+			struct libusb_device **devs;
+			struct libusb_device *dev;
+			size_t i = 0;
+			if ((m_deviceErrorCode = libusb_get_device_list(m_usbContext, &devs)) < 0)
 			{
-				LOG_ERROR("Device descriptor not retrievable - Device error code " << m_deviceErrorCode);
+				LOG_ERROR("Device list not retrievable - Device error code " << m_deviceErrorCode);
 				m_errorCode = FALCON_COMM_DEVICE_ERROR;
-				libusb_free_device_list(devs, 1);
 				return false;
 			}
-			if (desc.idVendor == FALCON_VENDOR_ID && desc.idProduct == FALCON_PRODUCT_ID)
+			std::vector<libusb_device*> present;
+			while ((dev = devs[i++]) != NULL)
 			{
-				if(count == index)
+				struct libusb_device_descriptor desc;
+				if (libusb_get_device_descriptor(dev, &desc) < 0) continue;
+				if (desc.idVendor == FALCON_VENDOR_ID && desc.idProduct == FALCON_PRODUCT_ID)
 				{
-					found = dev;
-					break;
+					present.push_back(dev);
+					addRegistryDevice(dev);
+				}
+			}
+			//Anything we knew about that's no longer on the bus is gone
+			for(unsigned int j = 0; j < m_registry.size(); )
+			{
+				bool found = false;
+				for(unsigned int k = 0; k < present.size(); ++k)
+				{
+					if(present[k] == m_registry[j].device) found = true;
 				}
-				++count;
+				if(found) ++j;
+				else removeRegistryDevice(m_registry[j].device);
 			}
+			libusb_free_device_list(devs, 1);
 		}
 
-		if (found)
+		//Serials are only read once per device. Opening fails for devices claimed by another
+		//process, in which case the path stands in for the serial. The synchronous libusb calls
+		//below can dispatch hotplug callbacks that change the registry, so they run over a
+		//referenced copy of the devices, and results are matched back by device afterwards.
+		std::vector<libusb_device*> pending;
+		for(std::vector<DeviceEntry>::iterator i = m_registry.begin(); i != m_registry.end(); ++i)
 		{
-			m_deviceErrorCode = libusb_open(found, &m_falconDevice);
-			if (m_deviceErrorCode < 0)
+			if(i->hasSerial) continue;
+			i->hasSerial = true;
+			pending.push_back(libusb_ref_device(i->device));
+		}
+		for(unsigned int j = 0; j < pending.size(); ++j)
+		{
+			struct libusb_device_descriptor desc;
+			libusb_device_handle* handle = NULL;
+			if(libusb_get_device_descriptor(pending[j], &desc) < 0 || desc.iSerialNumber == 0)
 			{
-				LOG_ERROR("Cannot open device - Device error code " << m_deviceErrorCode);
-				m_falconDevice = NULL;
-				m_errorCode = FALCON_COMM_DEVICE_ERROR;
-				libusb_free_device_list(devs, 1);
-				return false;
+				libusb_unref_device(pending[j]);
+				continue;
+			}
+			if(pending[j] == m_openDevice)
+			{
+				handle = m_falconDevice;
+			}
+			else if(libusb_open(pending[j], &handle) < 0)
+			{
+				libusb_unref_device(pending[j]);
+				continue;
+			}
+			unsigned char serial[64];
+			int length = libusb_get_string_descriptor_ascii(handle, desc.iSerialNumber, serial, sizeof(serial) - 1);
+			if(handle != m_falconDevice)
+			{
+				libusb_close(handle);
+			}
+			if(length > 0)
+			{
+				for(std::vector<DeviceEntry>::iterator i = m_registry.begin(); i != m_registry.end(); ++i)
+				{
+					if(i->device != pending[j]) continue;
+					i->serial.assign((char*)serial, length);
+					break;
+				}
 			}
+			libusb_unref_device(pending[j]);
 		}
-		else
+		return true;
+	}
+
+	bool FalconCommLibUSB::getDeviceCount(unsigned int& count)
+	{
+		LOG_INFO("Getting device count");
+		count = 0;
+		if(!refreshRegistry())
+		{
+			return false;
+		}
+		count = m_registry.size();
+		return true;
+	}
+
+	bool FalconCommLibUSB::getDeviceSerial(unsigned int index, std::string& serial)
+	{
+		if(!refreshRegistry())
+		{
+			return false;
+		}
+		if(index >= m_registry.size())
+		{
+			m_errorCode = FALCON_COMM_DEVICE_INDEX_OUT_OF_RANGE_ERROR;
+			return false;
+		}
+		serial = m_registry[index].serial.empty() ? m_registry[index].path : m_registry[index].serial;
+		return true;
+	}
+
+	bool FalconCommLibUSB::open(unsigned int index)
+	{
+		LOG_INFO("Opening device");
+		if(!refreshRegistry())
+		{
+			return false;
+		}
+		if(index >= m_registry.size())
 		{
 			LOG_ERROR("Device index " << index << " out of range");
 			m_errorCode = FALCON_COMM_DEVICE_INDEX_OUT_OF_RANGE_ERROR;
 			return false;
 		}
+		return openDevice(m_registry[index]);
+	}
+
+	bool FalconCommLibUSB::openBySerial(const std::string& serial)
+	{
+		LOG_INFO("Opening device " << serial);
+		if(!refreshRegistry())
+		{
+			return false;
+		}
+		for(std::vector<DeviceEntry>::iterator i = m_registry.begin(); i != m_registry.end(); ++i)
+		{
+			if(i->serial == serial || i->path == serial)
+			{
+				return openDevice(*i);
+			}
+		}
+		LOG_ERROR("Device " << serial << " not found");
+		m_errorCode = FALCON_COMM_DEVICE_NOT_FOUND_ERROR;
+		return false;
+	}
 
+	bool FalconCommLibUSB::openDevice(const DeviceEntry& entry)
+	{
+		//The transfers below pump libusb events, and a hotplug callback can change m_registry under entry.
+		//Keep what we need from it first. The handle holds its own reference to the device once opened.
+		libusb_device* device = entry.device;
+		std::string serial = entry.serial.empty() ? entry.path : entry.serial;
 
-		if ((m_deviceErrorCode = libusb_claim_interface(m_falconDevice, 0)) < 0)
+		m_deviceErrorCode = libusb_open(device, &m_falconDevice);
+		if (m_deviceErrorCode < 0)
 		{
-			LOG_ERROR("Cannot claim device interface - Device error code " << m_deviceErrorCode);
+			LOG_ERROR("Cannot open device - Device error code " << m_deviceErrorCode);
+			m_falconDevice = NULL;
 			m_errorCode = FALCON_COMM_DEVICE_ERROR;
 			return false;
 		}
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_RX, INTERFACE_ANY, NULL, 0, 1000)) != 0)
+
+		if ((m_deviceErrorCode = libusb_claim_interface(m_falconDevice, 0)) < 0)
 		{
+			LOG_ERROR("Cannot claim device interface - Device error code " << m_deviceErrorCode);
 			m_errorCode = FALCON_COMM_DEVICE_ERROR;
-			LOG_ERROR("Cannot rx purge - Device error code " << m_deviceErrorCode);
+			libusb_close(m_falconDevice);
+			m_falconDevice = NULL;
 			return false;
 		}
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_TX, INTERFACE_ANY, NULL, 0, 1000)) != 0)
+		const ControlRequest purge[] = {
+			{SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_RX, "rx purge"},
+			{SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_TX, "tx purge"}
+		};
+		if (!controlTransfers(purge, 2))
 		{
 			m_errorCode = FALCON_COMM_DEVICE_ERROR;
-			LOG_ERROR("Cannot tx purge - Device error code " << m_deviceErrorCode);
+			libusb_release_interface(m_falconDevice, 0);
+			libusb_close(m_falconDevice);
+			m_falconDevice = NULL;
 			return false;
 		}
 		reset();
+		m_openDevice = device;
+		m_openDeviceSerial = serial;
+		m_isDisconnected = false;
 		m_isCommOpen = true;
 		setNormalMode();
 
@@ -241,17 +421,22 @@ namespace libnifalcon
 		}
 		m_isCommOpen = false;
 
-		if ((m_deviceErrorCode = libusb_release_interface(m_falconDevice, 0)) < 0)
+		bool released = true;
+		//Releasing an unplugged device always fails, but the handle still needs closing
+		if ((m_deviceErrorCode = libusb_release_interface(m_falconDevice, 0)) < 0 && !m_isDisconnected)
 		{
 			m_errorCode = FALCON_COMM_DEVICE_ERROR;
 			LOG_ERROR("Cannot release device interface - Device error code " << m_deviceErrorCode);
-			return false;
+			released = false;
 		}
 
 		reset();
 		libusb_close(m_falconDevice);
 		m_falconDevice = NULL;
-		return true;
+		m_openDevice = NULL;
+		m_openDeviceSerial.clear();
+		m_isDisconnected = false;
+		return released;
 	}
 
 	void FalconCommLibUSB::setHasBytesAvailable(bool v)
@@ -259,6 +444,16 @@ namespace libnifalcon
 		m_hasBytesAvailable = true;
 	}
 
+	void FalconCommLibUSB::setDisconnected()
+	{
+		if(!m_isDisconnected)
+		{
+			LOG_ERROR("Device disconnected");
+		}
+		m_isDisconnected = true;
+		m_errorCode = FALCON_COMM_DEVICE_DISCONNECTED_ERROR;
+	}
+
 	bool FalconCommLibUSB::read(uint8_t* buffer, unsigned int size)
 	{
 		LOG_DEBUG("Reading " << size << " bytes");
@@ -313,7 +508,18 @@ namespace libnifalcon
 
 		libusb_fill_bulk_transfer(in_transfer, m_falconDevice, 0x02, buffer,
 								  size, FalconCommLibUSB::cb_in, this, 0);
-		libusb_submit_transfer(in_transfer);
+		if ((m_deviceErrorCode = libusb_submit_transfer(in_transfer)) < 0)
+		{
+			libusb_free_transfer(in_transfer);
+			if(m_deviceErrorCode == LIBUSB_ERROR_NO_DEVICE)
+			{
+				setDisconnected();
+				return false;
+			}
+			m_errorCode = FALCON_COMM_WRITE_ERROR;
+			LOG_ERROR("Cannot submit inbound transfer - Device error " << m_deviceErrorCode);
+			return false;
+		}
 		m_isWriteAllocated = true;
 		m_hasBytesAvailable = false;
 		issueRead();
@@ -333,6 +539,7 @@ namespace libnifalcon
 		if((m_deviceErrorCode = libusb_bulk_transfer(m_falconDevice, 0x81, buffer, size+2, &m_lastBytesRead, 1000)) != 0)
 		{
 			LOG_ERROR("Cannot do blocking read - Device error " << m_deviceErrorCode);
+			if(m_deviceErrorCode == LIBUSB_ERROR_NO_DEVICE) setDisconnected();
 			return false;
 		}
 		m_lastBytesRead -= 2;
@@ -355,6 +562,7 @@ namespace libnifalcon
 		if((m_deviceErrorCode = libusb_bulk_transfer(m_falconDevice, 0x2, buffer, size, &m_lastBytesWritten, 1000)) != 0)
 		{
 			LOG_ERROR("Cannot do blocking write - Device error " << m_deviceErrorCode);
+			if(m_deviceErrorCode == LIBUSB_ERROR_NO_DEVICE) setDisconnected();
 			return false;
 		}
 		LOG_DEBUG("Wrote " << m_lastBytesWritten << " bytes while blocking");
@@ -386,76 +594,36 @@ namespace libnifalcon
 		//Clear out current buffers to make sure we have a fresh start
 		//if((m_deviceErrorCode = ftdi_usb_purge_buffers(&(m_falconDevice))) < 0) return false;
 
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_RX, INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot purge buffers - Device error " << m_deviceErrorCode);
-			return false;
-		}
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_TX, INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot purge buffers - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
 		//Reset the device
 		//if((m_deviceErrorCode = ftdi_usb_reset(&(m_falconDevice))) < 0) return false;
 
-		//Make sure our latency timer is at 16ms, otherwise firmware checks tend to always fail
-		//if((m_deviceErrorCode = ftdi_set_latency_timer(&(m_falconDevice), 16)) < 0) return false;
-	    if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, 0x40, 0x09, 16, INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot set latency timer - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
-		//Set to:
-		// 9600 baud
+		//Purge, then make sure our latency timer is at 16ms (otherwise firmware checks tend to always
+		//fail), then set to:
+		// 9600 baud (0x4138. Just trust me. It is.)
 		// 8n1
 		// No Flow Control
 		// RTS Low
 		// DTR High
-
-		//if((m_deviceErrorCode = ftdi_set_baudrate(&(m_falconDevice), 9600)) < 0) return false;
-		//Baud for 9600 is 0x4138. Just trust me. It is.
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_BAUDRATE_REQUEST_TYPE, SIO_SET_BAUDRATE_REQUEST, 0x4138, INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot set baud rate - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
-		//if((m_deviceErrorCode = ftdi_set_line_property(&(m_falconDevice), BITS_8, STOP_BIT_1, NONE)) < 0) return false;
-		//BITS_8 = 8, STOP_BIT_1 = 0, NONE = 0
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_DATA_REQUEST_TYPE, SIO_SET_DATA_REQUEST, (8 | (0x00 << 11) | (0x00 << 8)), INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot set line properties - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
-		//if((m_deviceErrorCode = ftdi_setflowctrl(&(m_falconDevice), SIO_DISABLE_FLOW_CTRL)) < 0) return false;
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_FLOW_CTRL_REQUEST_TYPE, SIO_SET_FLOW_CTRL_REQUEST, 0, INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot set flow control - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
-		//if((m_deviceErrorCode = ftdi_setrts(&(m_falconDevice), 0)) < 0) return false;
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_RTS_LOW, INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot set RTS properties - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
-		//if((m_deviceErrorCode = ftdi_setdtr(&(m_falconDevice), 0)) < 0) return false;
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_DTR_LOW, INTERFACE_ANY, NULL, 0, 1000)) != 0)
+		const ControlRequest bootloader_setup[] = {
+			{SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_RX, "purge buffers"},
+			{SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_TX, "purge buffers"},
+			{FTDI_LATENCY_TIMER_REQUEST_TYPE, FTDI_LATENCY_TIMER_REQUEST, 16, "set latency timer"},
+			{SIO_SET_BAUDRATE_REQUEST_TYPE, SIO_SET_BAUDRATE_REQUEST, 0x4138, "set baud rate"},
+			//BITS_8 = 8, STOP_BIT_1 = 0, NONE = 0
+			{SIO_SET_DATA_REQUEST_TYPE, SIO_SET_DATA_REQUEST, (8 | (0x00 << 11) | (0x00 << 8)), "set line properties"},
+			{SIO_SET_FLOW_CTRL_REQUEST_TYPE, SIO_SET_FLOW_CTRL_REQUEST, SIO_DISABLE_FLOW_CTRL, "set flow control"},
+			{SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_RTS_LOW, "set RTS properties"},
+			{SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_DTR_LOW, "set DTR properties (1)"},
+			{SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_DTR_HIGH, "set DTR properties (2)"}
+		};
+		//The configuration only has to arrive in order, so it's batched. The DTR low/high pulse is what
+		//resets the bootloader, and nothing guarantees how far apart back to back requests land, so each
+		//edge waits for the previous one to complete, like the blocking calls did.
+		const unsigned int dtr_low = 7;
+		if (!controlTransfers(bootloader_setup, dtr_low) ||
+			!controlTransfers(&bootloader_setup[dtr_low], 1) ||
+			!controlTransfers(&bootloader_setup[dtr_low + 1], 1))
 		{
-			LOG_ERROR("Cannot set DTR properties (1) - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
-		//if((m_deviceErrorCode = ftdi_setdtr(&(m_falconDevice), 1)) < 0) return false;
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_DTR_HIGH, INTERFACE_ANY, NULL, 0, 1000)) != 0)
-		{
-			LOG_ERROR("Cannot set DTR properties (2) - Device error " << m_deviceErrorCode);
 			return false;
 		}
 
@@ -500,17 +668,13 @@ namespace libnifalcon
 		// DTR Low
 		// 140000 baud (0x15 clock ticks per signal)
 
-		//if((m_deviceErrorCode = ftdi_setdtr(&(m_falconDevice),0)) < 0) return false;
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_DTR_LOW, INTERFACE_ANY, NULL, 0, 1000)) != 0)
+		const ControlRequest bootloader_speed[] = {
+			{SIO_SET_MODEM_CTRL_REQUEST_TYPE, SIO_SET_MODEM_CTRL_REQUEST, SIO_SET_DTR_LOW, "set DTR properties (3)"},
+			{SIO_SET_BAUDRATE_REQUEST_TYPE, SIO_SET_BAUDRATE_REQUEST, 0x15, "set baudrate for firmware load"}
+		};
+		//DTR has to be settled low before the baud rate changes
+		if (!controlTransfers(&bootloader_speed[0], 1) || !controlTransfers(&bootloader_speed[1], 1))
 		{
-			LOG_ERROR("Cannot set DTR properties (3) - Device error " << m_deviceErrorCode);
-			return false;
-		}
-
-		//if((m_deviceErrorCode = ftdi_set_baudrate(&(m_falconDevice), 140000)) < 0) return false;
-		if (m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_BAUDRATE_REQUEST_TYPE, SIO_SET_BAUDRATE_REQUEST, 0x15, INTERFACE_ANY, NULL, 0, 1000) != 0)
-		{
-			LOG_ERROR("Cannot set baudrate for firmware load - Device error " << m_deviceErrorCode);
 			return false;
 		}
 
@@ -553,29 +717,98 @@ namespace libnifalcon
 		}
 
 		m_errorCode = FALCON_COMM_DEVICE_ERROR;
-		if (m_deviceErrorCode = libusb_control_transfer(m_falconDevice, 0x40, 0x09, 1, INTERFACE_ANY, NULL, 0, 1000) != 0)
+		const ControlRequest normal_setup[] = {
+			{FTDI_LATENCY_TIMER_REQUEST_TYPE, FTDI_LATENCY_TIMER_REQUEST, 1, "set latency timers"},
+			{SIO_SET_BAUDRATE_REQUEST_TYPE, SIO_SET_BAUDRATE_REQUEST, 0x2, "set baud rate"},
+			{SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_RX, "purge buffers"},
+			{SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_TX, "purge buffers"}
+		};
+		if (!controlTransfers(normal_setup, 4))
 		{
-			LOG_ERROR("Cannot set latency timers - Device error " << m_deviceErrorCode);
 			return false;
 		}
-		if (m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_SET_BAUDRATE_REQUEST_TYPE, SIO_SET_BAUDRATE_REQUEST, 0x2, INTERFACE_ANY, NULL, 0, 0) != 0)
+		m_errorCode = 0;
+		return true;
+	}
+
+	namespace
+	{
+		struct ControlBatch
 		{
-			LOG_ERROR("Cannot set baud rate - Device error " << m_deviceErrorCode);
-			return false;
-		}
+			int completed; /**< Set once every transfer has finished */
+			unsigned int pending; /**< Transfers not finished yet */
+		};
+	}
 
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_RX, INTERFACE_ANY, NULL, 0, 1000)) != 0)
+	bool FalconCommLibUSB::controlTransfers(const ControlRequest* requests, unsigned int count)
+	{
+		std::vector<struct libusb_transfer*> transfers(count, (struct libusb_transfer*)NULL);
+		std::vector<unsigned char> setup(count * LIBUSB_CONTROL_SETUP_SIZE);
+		ControlBatch batch;
+		batch.completed = 0;
+		batch.pending = 0;
+		m_deviceErrorCode = 0;
+		unsigned int submitted = 0;
+		for(; submitted < count; ++submitted)
+		{
+			transfers[submitted] = libusb_alloc_transfer(0);
+			if(transfers[submitted] == NULL)
+			{
+				m_deviceErrorCode = LIBUSB_ERROR_NO_MEM;
+				break;
+			}
+			unsigned char* buffer = &setup[submitted * LIBUSB_CONTROL_SETUP_SIZE];
+			libusb_fill_control_setup(buffer, requests[submitted].requestType, requests[submitted].request, requests[submitted].value, INTERFACE_ANY, 0);
+			libusb_fill_control_transfer(transfers[submitted], m_falconDevice, buffer, FalconCommLibUSB::cb_control, &batch, 1000);
+			++batch.pending;
+			if((m_deviceErrorCode = libusb_submit_transfer(transfers[submitted])) != 0)
+			{
+				--batch.pending;
+				libusb_free_transfer(transfers[submitted]);
+				transfers[submitted] = NULL;
+				break;
+			}
+		}
+		//If a submit failed, the ones already queued still have to finish before their buffers go away
+		if(submitted != count)
 		{
-			LOG_ERROR("Cannot purge buffers - Device error " << m_deviceErrorCode);
-			return false;
+			for(unsigned int i = 0; i < submitted; ++i)
+			{
+				libusb_cancel_transfer(transfers[i]);
+			}
 		}
-		if ((m_deviceErrorCode = libusb_control_transfer(m_falconDevice, SIO_RESET_REQUEST_TYPE, SIO_RESET_REQUEST, SIO_RESET_PURGE_TX, INTERFACE_ANY, NULL, 0, 1000)) != 0)
+		batch.completed = (batch.pending == 0);
+		//Every transfer has its own timeout, so this can't wait forever
+		struct timeval tv;
+		tv.tv_sec = 1;
+		tv.tv_usec = 0;
+		while(!batch.completed)
 		{
-			LOG_ERROR("Cannot purge buffers - Device error " << m_deviceErrorCode);
-			return false;
+			libusb_handle_events_timeout_completed(m_usbContext, &tv, &batch.completed);
+		}
+		for(unsigned int i = 0; i < submitted; ++i)
+		{
+			if(m_deviceErrorCode == 0 && transfers[i]->status != LIBUSB_TRANSFER_COMPLETED)
+			{
+				m_deviceErrorCode = (transfers[i]->status == LIBUSB_TRANSFER_NO_DEVICE) ? LIBUSB_ERROR_NO_DEVICE : LIBUSB_ERROR_IO;
+				LOG_ERROR("Cannot " << requests[i].description << " - Device error " << m_deviceErrorCode);
+			}
+			libusb_free_transfer(transfers[i]);
+		}
+		if(submitted != count)
+		{
+			LOG_ERROR("Cannot " << requests[submitted].description << " - Device error " << m_deviceErrorCode);
+		}
+		return m_deviceErrorCode == 0;
+	}
+
+	void FalconCommLibUSB::cb_control(struct libusb_transfer *transfer)
+	{
+		ControlBatch* batch = (ControlBatch*)transfer->user_data;
+		if(--batch->pending == 0)
+		{
+			batch->completed = 1;
 		}
-		m_errorCode = 0;
-		return true;
 	}
 
 	void FalconCommLibUSB::poll()
@@ -618,7 +851,15 @@ namespace libnifalcon
 
 		libusb_fill_bulk_transfer(out_transfer, m_falconDevice, 0x81, output,
 								  64, FalconCommLibUSB::cb_out, this, 1000);
-		libusb_submit_transfer(out_transfer);
+		if ((m_deviceErrorCode = libusb_submit_transfer(out_transfer)) < 0)
+		{
+			libusb_free_transfer(out_transfer);
+			if(m_deviceErrorCode == LIBUSB_ERROR_NO_DEVICE)
+			{
+				setDisconnected();
+			}
+			return;
+		}
 		m_isReadAllocated = true;
 
 	}
@@ -637,12 +878,18 @@ namespace libnifalcon
 
 	void FalconCommLibUSB::cb_in(struct libusb_transfer *transfer)
 	{
+		FALCON_TRACE_SCOPE("cb_in");
+		if(transfer->status == LIBUSB_TRANSFER_NO_DEVICE)
+		{
+			((FalconCommLibUSB*)transfer->user_data)->setDisconnected();
+		}
 		((FalconCommLibUSB*)transfer->user_data)->setSent();
 		libusb_free_transfer(transfer);
 	}
 
 	void FalconCommLibUSB::cb_out(struct libusb_transfer *transfer)
 	{
+		FALCON_TRACE_SCOPE("cb_out");
 		if(transfer->status == LIBUSB_TRANSFER_COMPLETED && transfer->actual_length >= 2)
 		{
 			((FalconCommLibUSB*)transfer->user_data)->setBytesAvailable(transfer->actual_length);
@@ -652,8 +899,12 @@ namespace libnifalcon
 		else
 		{
 			// We can't assume 0 bytes back = disconnected on linux, as it causes massive problems
-			// with other applications (mainly Pd). So, just set that we got nothing back and try to figure out
-			// some other way to detect unplugs
+			// with other applications (mainly Pd). libusb does tell us outright when the device is
+			// gone though, so use that (along with hotplug departures) for unplug detection.
+			if(transfer->status == LIBUSB_TRANSFER_NO_DEVICE)
+			{
+				((FalconCommLibUSB*)transfer->user_data)->setDisconnected();
+			}
 			((FalconCommLibUSB*)transfer->user_data)->setBytesAvailable(0);
 			((FalconCommLibUSB*)transfer->user_data)->setHasBytesAvailable(false);
 			((FalconCommLibUSB*)transfer->user_data)->setReceived();
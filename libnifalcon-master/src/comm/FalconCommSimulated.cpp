@@ -0,0 +1,452 @@
+/***
+ * @file FalconCommSimulated.cpp
+ * @brief Simulated falcon, for testing libnifalcon without hardware
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/comm/FalconCommSimulated.h"
+#include "falcon/core/FalconClock.h"
+#include "falcon/core/FalconGeometry.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+namespace libnifalcon
+{
+	using namespace StamperKinematicImpl;
+
+	//Integration step for the mechanics. Small enough to keep a 10kN/m wall stable on its own.
+	const static double SIMULATION_STEP = 0.0002;
+	//Longest gap we'll integrate over in one go. Anything past this is a stalled process, not physics.
+	const static double SIMULATION_MAX_GAP = 0.1;
+	//Longest poll() waits for a reply, same as the libusb comm's event timeout
+	const static double POLL_TIMEOUT = 0.0001;
+	//Reachable workspace, kept well inside the range where the Stamper IK is valid
+	const static double WORKSPACE_MIN[3] = { -0.06, -0.06, 0.075 };
+	const static double WORKSPACE_MAX[3] = { 0.06, 0.06, 0.175 };
+
+	//Busy waits like poll() does, so simulated USB timing doesn't depend on the scheduler
+	static void waitUntil(double time)
+	{
+		while(FalconClock::getTime() < time)
+		{
+		}
+	}
+
+	FalconCommSimulated::FalconCommSimulated() :
+		m_deviceCount(1),
+		m_openIndex(0),
+		m_isUnplugged(false),
+		m_latency(0.001),
+		m_isFirmwareMode(false),
+		m_isFirmwareLoaded(false),
+		m_autoHome(true),
+		m_homingStatus(0),
+		m_ledStatus(0),
+		m_gripButtons(0),
+		m_echoSize(0),
+		m_firmwareBaudRate(140000.0),
+		m_lineFreeTime(0.0),
+		m_hasPendingPacket(false),
+		m_hasPendingApply(false),
+		m_pendingApplyTime(0.0),
+		m_pendingReplyTime(0.0),
+		m_lastTime(0.0),
+		m_mass(0.15),
+		m_damping(1.0),
+		m_handStiffness(0.0),
+		m_handDamping(0.0),
+		INIT_LOGGER("FalconCommSimulated")
+	{
+		m_deviceErrorCode = 0;
+		m_lastBytesRead = 0;
+		m_lastBytesWritten = 0;
+		m_pendingMotor.assign(0);
+		m_motorForce.assign(0.0);
+		m_velocity.assign(0.0);
+		m_position[0] = 0.0;
+		m_position[1] = 0.0;
+		m_position[2] = 0.11;
+		m_handTarget = m_position;
+		memset(m_reply, 0, 16);
+	}
+
+	FalconCommSimulated::~FalconCommSimulated()
+	{
+		close();
+	}
+
+	bool FalconCommSimulated::getDeviceCount(unsigned int& count)
+	{
+		count = m_deviceCount;
+		return true;
+	}
+
+	bool FalconCommSimulated::getDeviceSerial(unsigned int index, std::string& serial)
+	{
+		if(index >= m_deviceCount)
+		{
+			m_errorCode = FALCON_COMM_DEVICE_INDEX_OUT_OF_RANGE_ERROR;
+			return false;
+		}
+		char buffer[16];
+		sprintf(buffer, "SIM%04u", index);
+		serial = buffer;
+		return true;
+	}
+
+	bool FalconCommSimulated::open(unsigned int index)
+	{
+		if(index >= m_deviceCount)
+		{
+			LOG_ERROR("Device index " << index << " out of range");
+			m_errorCode = FALCON_COMM_DEVICE_INDEX_OUT_OF_RANGE_ERROR;
+			return false;
+		}
+		if(m_isUnplugged)
+		{
+			LOG_ERROR("Device is unplugged");
+			m_errorCode = FALCON_COMM_DEVICE_NOT_FOUND_ERROR;
+			return false;
+		}
+		reset();
+		getDeviceSerial(index, m_openDeviceSerial);
+		m_openIndex = index;
+		m_lastTime = FalconClock::getTime();
+		m_isDisconnected = false;
+		m_isCommOpen = true;
+		return true;
+	}
+
+	bool FalconCommSimulated::close()
+	{
+		m_isCommOpen = false;
+		m_isDisconnected = false;
+		m_openDeviceSerial.clear();
+		reset();
+		return true;
+	}
+
+	void FalconCommSimulated::simulateUnplug()
+	{
+		m_isUnplugged = true;
+		if(m_isCommOpen)
+		{
+			m_isDisconnected = true;
+		}
+		reset();
+	}
+
+	void FalconCommSimulated::simulatePlug(bool power_cycled)
+	{
+		m_isUnplugged = false;
+		if(power_cycled)
+		{
+			m_isFirmwareLoaded = false;
+			m_isFirmwareMode = false;
+			m_homingStatus = 0;
+			m_ledStatus = 0;
+			m_motorForce.assign(0.0);
+		}
+	}
+
+	bool FalconCommSimulated::checkConnected()
+	{
+		if(!m_isCommOpen)
+		{
+			m_errorCode = FALCON_COMM_DEVICE_NOT_VALID_ERROR;
+			return false;
+		}
+		if(m_isDisconnected)
+		{
+			m_errorCode = FALCON_COMM_DEVICE_DISCONNECTED_ERROR;
+			return false;
+		}
+		return true;
+	}
+
+	void FalconCommSimulated::reset()
+	{
+		m_hasPendingPacket = false;
+		m_hasPendingApply = false;
+		m_hasBytesAvailable = false;
+		m_bytesAvailable = 0;
+		m_echoSize = 0;
+	}
+
+	bool FalconCommSimulated::setFirmwareMode()
+	{
+		if(!checkConnected())
+		{
+			return false;
+		}
+		reset();
+		m_isFirmwareMode = true;
+		m_isFirmwareLoaded = false;
+		return true;
+	}
+
+	bool FalconCommSimulated::setNormalMode()
+	{
+		if(!checkConnected())
+		{
+			return false;
+		}
+		if(m_isFirmwareMode)
+		{
+			m_isFirmwareLoaded = true;
+		}
+		m_isFirmwareMode = false;
+		reset();
+		return true;
+	}
+
+	bool FalconCommSimulated::writeBlocking(uint8_t* str, unsigned int size)
+	{
+		if(!checkConnected())
+		{
+			return false;
+		}
+		if(!m_isFirmwareMode)
+		{
+			return write(str, size);
+		}
+		//The bulk transfer completes once the FTDI has the data, then the bootloader echoes it byte by byte
+		waitUntil(FalconClock::getTime() + m_latency * 0.5);
+		double byte_time = 10.0 / m_firmwareBaudRate;
+		double now = FalconClock::getTime();
+		if(m_lineFreeTime < now)
+		{
+			m_lineFreeTime = now;
+		}
+		for(unsigned int i = 0; i < size; ++i)
+		{
+			m_lineFreeTime += byte_time;
+			//No flow control, so echoes past a full receive buffer are gone
+			if(m_echoSize == ECHO_BUFFER_SIZE)
+			{
+				continue;
+			}
+			m_echoBuffer[m_echoSize] = str[i];
+			m_echoTimes[m_echoSize] = m_lineFreeTime;
+			++m_echoSize;
+		}
+		m_lastBytesWritten = size;
+		return true;
+	}
+
+	bool FalconCommSimulated::readBlocking(uint8_t* str, unsigned int size)
+	{
+		if(!checkConnected())
+		{
+			return false;
+		}
+		if(!m_isFirmwareMode)
+		{
+			poll();
+			return read(str, size);
+		}
+		if(m_echoSize == 0)
+		{
+			m_lastBytesRead = 0;
+			m_errorCode = FALCON_COMM_READ_ERROR;
+			return false;
+		}
+		//Wait for the first echo, then take everything that arrived by the time the transfer went out
+		waitUntil(m_echoTimes[0]);
+		double arrived = FalconClock::getTime();
+		waitUntil(arrived + m_latency * 0.5);
+		unsigned int count = 0;
+		while(count < size && count < m_echoSize && m_echoTimes[count] <= arrived)
+		{
+			++count;
+		}
+		memcpy(str, m_echoBuffer, count);
+		memmove(m_echoBuffer, m_echoBuffer + count, m_echoSize - count);
+		memmove(m_echoTimes, m_echoTimes + count, (m_echoSize - count) * sizeof(double));
+		m_echoSize -= count;
+		m_lastBytesRead = count;
+		return true;
+	}
+
+	bool FalconCommSimulated::write(uint8_t* str, unsigned int size)
+	{
+		if(!checkConnected())
+		{
+			return false;
+		}
+		m_lastBytesWritten = size;
+		//Without firmware the device swallows whatever it gets
+		if(!m_isFirmwareLoaded || size != 16 || str[0] != '<' || str[15] != '>')
+		{
+			return true;
+		}
+		for(int i = 0; i < 3; ++i)
+		{
+			int idx = 1 + (i*4);
+			int16_t val =
+				((str[idx] - 0x41) & 0xf) |
+				(((str[idx+1] - 0x41) & 0xf) << 4) |
+				(((str[idx+2] - 0x41) & 0xf) << 8) |
+				(((str[idx+3] - 0x41) & 0xf) << 12);
+			m_pendingMotor[i] = val;
+		}
+		uint8_t flags = str[13] - 0x41;
+		m_ledStatus = flags & 0x0e;
+		if((flags & 0x01) && m_autoHome)
+		{
+			m_homingStatus = 0x7;
+		}
+		//A packet already in flight just has its motor values replaced, the firmware only answers once
+		if(!m_hasPendingPacket)
+		{
+			double now = FalconClock::getTime();
+			advance(now);
+			m_hasPendingPacket = true;
+			m_hasPendingApply = true;
+			m_pendingApplyTime = now + m_latency * 0.5;
+			m_pendingReplyTime = now + m_latency;
+		}
+		return true;
+	}
+
+	bool FalconCommSimulated::read(uint8_t* str, unsigned int size)
+	{
+		if(!checkConnected())
+		{
+			return false;
+		}
+		if(!m_hasBytesAvailable)
+		{
+			m_lastBytesRead = 0;
+			return true;
+		}
+		unsigned int count = (size < 16) ? size : 16;
+		memcpy(str, m_reply, count);
+		m_lastBytesRead = count;
+		m_hasBytesAvailable = false;
+		m_bytesAvailable = 0;
+		m_hasPendingPacket = false;
+		return true;
+	}
+
+	void FalconCommSimulated::poll()
+	{
+		if(!m_isCommOpen || m_isDisconnected)
+		{
+			return;
+		}
+		double now = FalconClock::getTime();
+		//libusb waits up to POLL_TIMEOUT for transfers to complete, so do the same instead of returning
+		//straight away. Otherwise loops that count polls (FalconFirmware::isFirmwareLoaded) run out early.
+		if(m_hasPendingPacket && now < m_pendingReplyTime)
+		{
+			double wait_until = (m_pendingReplyTime < now + POLL_TIMEOUT) ? m_pendingReplyTime : now + POLL_TIMEOUT;
+			while(now < wait_until)
+			{
+				now = FalconClock::getTime();
+			}
+		}
+		advance(now);
+		if(m_hasPendingPacket && !m_hasPendingApply && now >= m_pendingReplyTime)
+		{
+			m_hasBytesAvailable = true;
+			m_bytesAvailable = 16;
+		}
+	}
+
+	void FalconCommSimulated::setSimulatedPosition(const boost::array<double, 3>& position)
+	{
+		m_position = position;
+		m_velocity.assign(0.0);
+	}
+
+	void FalconCommSimulated::advance(double time)
+	{
+		if(time - m_lastTime > SIMULATION_MAX_GAP)
+		{
+			m_lastTime = time - SIMULATION_MAX_GAP;
+		}
+		while(m_lastTime < time)
+		{
+			double step = time - m_lastTime;
+			if(step > SIMULATION_STEP) step = SIMULATION_STEP;
+			bool apply = false;
+			if(m_hasPendingApply && m_lastTime + step >= m_pendingApplyTime)
+			{
+				step = m_pendingApplyTime - m_lastTime;
+				if(step < 0.0) step = 0.0;
+				apply = true;
+			}
+			for(int i = 0; i < 3; ++i)
+			{
+				double force = m_motorForce[i] - m_damping * m_velocity[i]
+					+ m_handStiffness * (m_handTarget[i] - m_position[i]) - m_handDamping * m_velocity[i];
+				//Semi-implicit euler, good enough for a spring/mass with this step size
+				m_velocity[i] += (force / m_mass) * step;
+				m_position[i] += m_velocity[i] * step;
+				if(m_position[i] < WORKSPACE_MIN[i])
+				{
+					m_position[i] = WORKSPACE_MIN[i];
+					m_velocity[i] = 0.0;
+				}
+				else if(m_position[i] > WORKSPACE_MAX[i])
+				{
+					m_position[i] = WORKSPACE_MAX[i];
+					m_velocity[i] = 0.0;
+				}
+			}
+			m_lastTime += step;
+			if(apply)
+			{
+				applyPendingPacket();
+			}
+		}
+		if(m_hasPendingApply && m_lastTime >= m_pendingApplyTime)
+		{
+			applyPendingPacket();
+		}
+	}
+
+	void FalconCommSimulated::applyPendingPacket()
+	{
+		m_hasPendingApply = false;
+
+		Angle angles;
+		gmtl::Vec3d pos(m_position[0], m_position[1], m_position[2]);
+		m_kinematic.IK(angles, pos);
+
+		//Undo FalconKinematicStamper::getForces: motor = -(J' * F) * 10000
+		gmtl::Matrix33d J = m_kinematic.jacobian(angles);
+		J.setTranspose(J.getData());
+		J.setState(gmtl::Matrix33d::FULL);
+		gmtl::invert(J);
+		gmtl::Vec3d torque(-m_pendingMotor[0] / 10000.0, -m_pendingMotor[1] / 10000.0, -m_pendingMotor[2] / 10000.0);
+		gmtl::Vec3d force = J * torque;
+		m_motorForce[0] = force[0];
+		m_motorForce[1] = force[1];
+		m_motorForce[2] = force[2];
+
+		//Encoders are sampled as the packet is processed. Inverse of FalconKinematic::getTheta.
+		const double degrees_per_tick = ((SHAFT_DIAMETER*PI) / (WHEEL_SLOTS_NUMBER*4)) / ((PI*SMALL_ARM_DIAMETER)/360.0f);
+		m_reply[0] = '<';
+		for(int i = 0; i < 3; ++i)
+		{
+			double theta = angles.theta1[i] * (180.0 / PI);
+			int16_t encoder = (int16_t)floor((theta - THETA_OFFSET_ANGLE) / degrees_per_tick + 0.5);
+			int idx = 1 + (i*4);
+			m_reply[idx] = (encoder & 0xf) + 0x41;
+			m_reply[idx+1] = ((encoder >> 4) & 0xf) + 0x41;
+			m_reply[idx+2] = ((encoder >> 8) & 0xf) + 0x41;
+			m_reply[idx+3] = ((encoder >> 12) & 0xf) + 0x41;
+		}
+		m_reply[13] = (((m_homingStatus & 0x7) << 4) | m_gripButtons) + 0x41;
+		m_reply[14] = 0x41;
+		m_reply[15] = '>';
+	}
+}
@@ -0,0 +1,382 @@
+/***
+ * @file FalconBinaryLog.cpp
+ * @brief Low overhead binary logging backend, usable from the I/O loop
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconBinaryLog.h"
+#include "falcon/core/FalconClock.h"
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/static_assert.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define FALCON_THREAD_LOCAL __declspec(thread)
+#else
+#define FALCON_THREAD_LOCAL __thread
+#endif
+
+namespace libnifalcon
+{
+	namespace
+	{
+		enum {
+			TAG_STRING = 's',
+			TAG_SIGNED = 'i',
+			TAG_UNSIGNED = 'u',
+			TAG_DOUBLE = 'd',
+			TAG_CHAR = 'c',
+			TAG_BOOL = 'b',
+			TAG_SUPPRESSED = 'x'
+		};
+
+		struct LogRing
+		{
+			boost::lockfree::spsc_queue<FalconLogRecord, boost::lockfree::capacity<FalconBinaryLog::RING_SIZE> > queue;
+			uint16_t index;
+		};
+
+		boost::atomic<LogRing*> s_rings[FalconBinaryLog::MAX_THREADS];
+		boost::atomic<unsigned int> s_ringCount(0);
+		//Bit i set when ring i's thread has exited and the ring can be handed to another thread
+		BOOST_STATIC_ASSERT(FalconBinaryLog::MAX_THREADS <= 32);
+		boost::atomic<uint32_t> s_freeRings(0);
+		boost::atomic<uint64_t> s_dropped(0);
+		//Fast path for write(). Set once a thread has tried to get a ring, so threads that found none
+		//don't keep retrying.
+		FALCON_THREAD_LOCAL LogRing* s_threadRing = NULL;
+		FALCON_THREAD_LOCAL bool s_threadRingFailed = false;
+
+		//Rings outlive their thread, as drain() may still be reading them. Anything left in a ring when it
+		//changes hands is drained as usual.
+		void releaseRing(LogRing* ring)
+		{
+			s_freeRings.fetch_or(1u << ring->index, boost::memory_order_release);
+		}
+
+		//Only used to find out when a thread exits, write() goes through s_threadRing
+		boost::thread_specific_ptr<LogRing> s_ringOwner(releaseRing);
+
+		LogRing* takeFreeRing()
+		{
+			uint32_t free_rings = s_freeRings.load(boost::memory_order_acquire);
+			while(free_rings != 0)
+			{
+				uint32_t bit = free_rings & (~free_rings + 1);
+				if(s_freeRings.compare_exchange_weak(free_rings, free_rings & ~bit, boost::memory_order_acquire))
+				{
+					unsigned int index = 0;
+					while(!(bit & (1u << index)))
+					{
+						++index;
+					}
+					return s_rings[index].load(boost::memory_order_relaxed);
+				}
+			}
+			return NULL;
+		}
+
+		LogRing* getThreadRing()
+		{
+			if(s_threadRing != NULL || s_threadRingFailed)
+			{
+				return s_threadRing;
+			}
+			LogRing* ring = takeFreeRing();
+			if(ring == NULL)
+			{
+				unsigned int index = s_ringCount.fetch_add(1);
+				if(index >= FalconBinaryLog::MAX_THREADS)
+				{
+					s_threadRingFailed = true;
+					return NULL;
+				}
+				ring = new LogRing;
+				ring->index = index;
+				s_rings[index].store(ring, boost::memory_order_release);
+			}
+			s_ringOwner.reset(ring);
+			s_threadRing = ring;
+			return ring;
+		}
+
+		bool compareRecords(const FalconLogRecord& a, const FalconLogRecord& b)
+		{
+			return a.timestamp < b.timestamp;
+		}
+	}
+
+	FalconLogSite::FalconLogSite(const char* file, int line, int level, const char* logger, unsigned int max_per_second) :
+		file(file),
+		line(line),
+		level(level),
+		logger(logger),
+		maxPerSecond(max_per_second),
+		windowStart(0),
+		windowCount(0),
+		suppressed(0)
+	{
+	}
+
+	bool FalconLogSite::allow()
+	{
+		if(maxPerSecond == 0)
+		{
+			return true;
+		}
+		//Racy window reset, which can let a few extra records through on a second boundary. That's fine.
+		uint32_t second = (uint32_t)FalconClock::getTime();
+		if(windowStart.load(boost::memory_order_relaxed) != second)
+		{
+			windowStart.store(second, boost::memory_order_relaxed);
+			windowCount.store(0, boost::memory_order_relaxed);
+		}
+		if(windowCount.fetch_add(1, boost::memory_order_relaxed) < maxPerSecond)
+		{
+			return true;
+		}
+		suppressed.fetch_add(1, boost::memory_order_relaxed);
+		return false;
+	}
+
+	FalconLogRecordBuilder::FalconLogRecordBuilder(const FalconLogSite& site)
+	{
+		m_record.timestamp = FalconClock::getTime();
+		m_record.site = &site;
+		m_record.size = 0;
+		m_record.truncated = 0;
+		uint32_t suppressed = const_cast<FalconLogSite&>(site).suppressed.exchange(0, boost::memory_order_relaxed);
+		if(suppressed > 0)
+		{
+			put(TAG_SUPPRESSED, &suppressed, sizeof(suppressed));
+		}
+	}
+
+	FalconLogRecordBuilder::~FalconLogRecordBuilder()
+	{
+		FalconBinaryLog::write(m_record);
+	}
+
+	void FalconLogRecordBuilder::put(uint8_t tag, const void* data, unsigned int size)
+	{
+		if(m_record.size + 1 + size > FalconLogRecord::PAYLOAD_SIZE)
+		{
+			m_record.truncated = 1;
+			return;
+		}
+		m_record.payload[m_record.size] = tag;
+		memcpy(m_record.payload + m_record.size + 1, data, size);
+		m_record.size += 1 + size;
+	}
+
+	FalconLogRecordBuilder& FalconLogRecordBuilder::operator<<(const char* value)
+	{
+		if(value == NULL)
+		{
+			value = "(null)";
+		}
+		unsigned int space = FalconLogRecord::PAYLOAD_SIZE - m_record.size;
+		if(space < 3)
+		{
+			m_record.truncated = 1;
+			return *this;
+		}
+		unsigned int length = strlen(value);
+		if(length > space - 2)
+		{
+			length = space - 2;
+			m_record.truncated = 1;
+		}
+		m_record.payload[m_record.size] = TAG_STRING;
+		m_record.payload[m_record.size + 1] = (uint8_t)length;
+		memcpy(m_record.payload + m_record.size + 2, value, length);
+		m_record.size += 2 + length;
+		return *this;
+	}
+
+	FalconLogRecordBuilder& FalconLogRecordBuilder::operator<<(const std::string& value)
+	{
+		return *this << value.c_str();
+	}
+
+	FalconLogRecordBuilder& FalconLogRecordBuilder::operator<<(char value)
+	{
+		put(TAG_CHAR, &value, 1);
+		return *this;
+	}
+
+	FalconLogRecordBuilder& FalconLogRecordBuilder::operator<<(bool value)
+	{
+		uint8_t v = value ? 1 : 0;
+		put(TAG_BOOL, &v, 1);
+		return *this;
+	}
+
+	FalconLogRecordBuilder& FalconLogRecordBuilder::operator<<(double value)
+	{
+		put(TAG_DOUBLE, &value, sizeof(value));
+		return *this;
+	}
+
+	FalconLogRecordBuilder& FalconLogRecordBuilder::putSigned(int64_t value)
+	{
+		put(TAG_SIGNED, &value, sizeof(value));
+		return *this;
+	}
+
+	FalconLogRecordBuilder& FalconLogRecordBuilder::putUnsigned(uint64_t value)
+	{
+		put(TAG_UNSIGNED, &value, sizeof(value));
+		return *this;
+	}
+
+	void FalconBinaryLog::write(FalconLogRecord& record)
+	{
+		LogRing* ring = getThreadRing();
+		if(ring == NULL)
+		{
+			s_dropped.fetch_add(1, boost::memory_order_relaxed);
+			return;
+		}
+		record.thread = ring->index;
+		if(!ring->queue.push(record))
+		{
+			s_dropped.fetch_add(1, boost::memory_order_relaxed);
+		}
+	}
+
+	unsigned int FalconBinaryLog::drain(std::ostream& out)
+	{
+		std::vector<FalconLogRecord> records;
+		unsigned int count = s_ringCount.load(boost::memory_order_acquire);
+		if(count > MAX_THREADS)
+		{
+			count = MAX_THREADS;
+		}
+		for(unsigned int i = 0; i < count; ++i)
+		{
+			//A ring can be counted but not stored yet
+			LogRing* ring = s_rings[i].load(boost::memory_order_acquire);
+			if(ring == NULL)
+			{
+				continue;
+			}
+			FalconLogRecord record;
+			while(ring->queue.pop(record))
+			{
+				records.push_back(record);
+			}
+		}
+		//Each ring is in order, but threads interleave
+		std::stable_sort(records.begin(), records.end(), compareRecords);
+		for(std::vector<FalconLogRecord>::const_iterator i = records.begin(); i != records.end(); ++i)
+		{
+			format(*i, out);
+			out << std::endl;
+		}
+		return records.size();
+	}
+
+	void FalconBinaryLog::format(const FalconLogRecord& record, std::ostream& out)
+	{
+		std::ios_base::fmtflags flags = out.flags();
+		std::streamsize precision = out.precision();
+		out.setf(std::ios_base::fixed, std::ios_base::floatfield);
+		out.precision(6);
+		out << record.timestamp;
+		out.flags(flags);
+		out.precision(precision);
+
+		const FalconLogSite* site = record.site;
+		out << " " << getLevelName(site->level) << " [" << site->logger << "] (" << record.thread << ") - ";
+		uint32_t suppressed = 0;
+		unsigned int pos = 0;
+		while(pos < record.size)
+		{
+			uint8_t tag = record.payload[pos++];
+			switch(tag)
+			{
+			case TAG_STRING:
+			{
+				uint8_t length = record.payload[pos++];
+				out.write((const char*)record.payload + pos, length);
+				pos += length;
+				break;
+			}
+			case TAG_SIGNED:
+			{
+				int64_t v;
+				memcpy(&v, record.payload + pos, sizeof(v));
+				out << (long long)v;
+				pos += sizeof(v);
+				break;
+			}
+			case TAG_UNSIGNED:
+			{
+				uint64_t v;
+				memcpy(&v, record.payload + pos, sizeof(v));
+				out << (unsigned long long)v;
+				pos += sizeof(v);
+				break;
+			}
+			case TAG_DOUBLE:
+			{
+				double v;
+				memcpy(&v, record.payload + pos, sizeof(v));
+				out << v;
+				pos += sizeof(v);
+				break;
+			}
+			case TAG_CHAR:
+				out << (char)record.payload[pos++];
+				break;
+			case TAG_BOOL:
+				out << (record.payload[pos++] ? "true" : "false");
+				break;
+			case TAG_SUPPRESSED:
+				memcpy(&suppressed, record.payload + pos, sizeof(suppressed));
+				pos += sizeof(suppressed);
+				break;
+			default:
+				//Corrupt payload, don't try to make sense of the rest
+				pos = record.size;
+				break;
+			}
+		}
+		if(record.truncated)
+		{
+			out << "...";
+		}
+		out << " (" << site->file << ":" << site->line << ")";
+		if(suppressed > 0)
+		{
+			out << " [" << suppressed << " suppressed]";
+		}
+	}
+
+	uint64_t FalconBinaryLog::getDroppedCount()
+	{
+		return s_dropped.load(boost::memory_order_relaxed);
+	}
+
+	const char* FalconBinaryLog::getLevelName(int level)
+	{
+		switch(level)
+		{
+		case LEVEL_DEBUG: return "DEBUG";
+		case LEVEL_INFO: return "INFO ";
+		case LEVEL_WARN: return "WARN ";
+		case LEVEL_ERROR: return "ERROR";
+		case LEVEL_FATAL: return "FATAL";
+		}
+		return "?????";
+	}
+}
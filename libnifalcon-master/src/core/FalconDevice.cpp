@@ -10,6 +10,9 @@
  */
 
 #include "falcon/core/FalconDevice.h"
+#include "falcon/core/FalconClock.h"
+#include "falcon/core/FalconTrace.h"
+#include "falcon/core/FalconFirmwareRegistry.h"
 #if defined(LIBNIFALCON_USE_LIBUSB)
 #include "falcon/comm/FalconCommLibUSB.h"
 #elif defined(LIBNIFALCON_USE_LIBFTD2XX)
@@ -17,15 +20,41 @@
 #else
 #error "Cannot build FalconDevice class without default comm core"
 #endif
+#include <boost/crc.hpp>
+#include <boost/thread/mutex.hpp>
 #include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <map>
 
 namespace libnifalcon
 {
 
     FalconDevice::FalconDevice() :
 		m_errorCount(0),
+		m_deviceIndex(0),
+		m_autoReconnect(false),
+		m_isReconnectPending(false),
+		m_reconnectInterval(0.5),
+		m_lastReconnectAttempt(0.0),
+		m_reconnectCount(0),
+		m_wasFirmwareUploadSkipped(false),
+		m_flightStatus(0),
+		m_isIOFailing(false),
+		m_flightDumpSeconds(0.0),
+		m_lastFlightDump(0.0),
+		m_flightDumpRequested(false),
+		m_maxPredictionHorizon(0.01),
+		m_maxPredictionDistance(0.005),
+		m_lastOutputCount(0),
+		m_stateSequence(0),
 		INIT_LOGGER("FalconDevice")
 	{
+		m_position.assign(0.0);
+		m_predictedPosition.assign(0.0);
+		m_forceVec.assign(0.0);
+		m_flightRecorder.allocate(FLIGHT_RECORDER_SIZE);
 #if defined(LIBNIFALCON_USE_LIBUSB)
 		setFalconComm<FalconCommLibUSB>();
 #elif defined(LIBNIFALCON_USE_LIBFTD2XX)
@@ -61,10 +90,21 @@ namespace libnifalcon
 			m_errorCode = m_falconComm->getErrorCode();
 			return false;
 		}
+		m_deviceIndex = index;
+		m_deviceSerial = m_falconComm->getOpenDeviceSerial();
+		m_isReconnectPending = false;
+		m_reconnectCount = 0;
 		if(m_falconFirmware != NULL)
 		{
 			m_falconFirmware->resetFirmwareState();
+			m_lastOutputCount = m_falconFirmware->getOutputCount();
 		}
+		if(m_falconVelocityEstimator != NULL)
+		{
+			m_falconVelocityEstimator->reset();
+		}
+		m_ioState = FalconState();
+		publishState();
 		return true;
 	}
 
@@ -76,10 +116,58 @@ namespace libnifalcon
 			return;
 		}
 		m_falconComm->close();
+		m_isReconnectPending = false;
 		if(m_falconFirmware != NULL)
 		{
 			m_falconFirmware->resetFirmwareState();
 		}
+		if(m_falconVelocityEstimator != NULL)
+		{
+			m_falconVelocityEstimator->reset();
+		}
+	}
+
+	bool FalconDevice::reconnect()
+	{
+		double now = FalconClock::getTime();
+		if(now - m_lastReconnectAttempt < m_reconnectInterval)
+		{
+			return false;
+		}
+		m_lastReconnectAttempt = now;
+		if(m_falconComm->isCommOpen())
+		{
+			m_falconComm->close();
+		}
+		bool opened = m_deviceSerial.empty() ? m_falconComm->open(m_deviceIndex) : m_falconComm->openBySerial(m_deviceSerial);
+		if(!opened)
+		{
+			return false;
+		}
+		LOG_INFO("Device reopened, checking firmware");
+		//A device that only dropped off the bus still has its firmware, one that lost power needs it again
+		if(!m_falconFirmware->isFirmwareLoaded())
+		{
+			LOG_INFO("Firmware lost, reloading");
+			if(!m_falconFirmware->reloadFirmware() || !m_falconFirmware->isFirmwareLoaded())
+			{
+				LOG_ERROR("Cannot reload firmware after reconnecting");
+				m_falconComm->close();
+				return false;
+			}
+		}
+		m_falconFirmware->resetFirmwareState();
+		m_lastOutputCount = m_falconFirmware->getOutputCount();
+		if(m_falconVelocityEstimator != NULL)
+		{
+			m_falconVelocityEstimator->reset();
+		}
+		m_isReconnectPending = false;
+		m_flightStatus |= FalconFlightRecord::STATUS_RECONNECTED;
+		++m_reconnectCount;
+		m_metrics.increment(FalconMetrics::COUNTER_RECONNECTS);
+		LOG_INFO("Device reconnected");
+		return true;
 	}
 
 	bool FalconDevice::setFirmwareFile(const std::string& filename)
@@ -99,17 +187,174 @@ namespace libnifalcon
 			m_errorCode = FALCON_DEVICE_NO_FIRMWARE_SET;
 			return false;
 		}
-		return m_falconFirmware->loadFirmware(retries, skip_checksum);
+		std::vector<uint8_t> image;
+		if(!m_falconFirmware->readFirmwareFile(image))
+		{
+			m_errorCode = FALCON_DEVICE_FIRMWARE_NOT_VALID;
+			return false;
+		}
+		return loadFirmwareImage(image, retries, skip_checksum);
 	}
 
 	bool FalconDevice::loadFirmware(bool skip_checksum)
+	{
+		return loadFirmware(1, skip_checksum);
+	}
+
+	bool FalconDevice::loadFirmware(bool skip_checksum, const unsigned int& firmware_size, uint8_t* buffer)
 	{
 		if(m_falconFirmware == NULL)
 		{
 			m_errorCode = FALCON_DEVICE_NO_FIRMWARE_SET;
 			return false;
 		}
-		return m_falconFirmware->loadFirmware(skip_checksum);
+		if(firmware_size == 0 || buffer == NULL)
+		{
+			m_errorCode = FALCON_DEVICE_FIRMWARE_NOT_VALID;
+			return false;
+		}
+		return loadFirmwareImage(std::vector<uint8_t>(buffer, buffer + firmware_size), 1, skip_checksum);
+	}
+
+	namespace
+	{
+		//Cache files can be shared by devices loading firmware from different threads. Held across file
+		//I/O, so it has to block rather than spin.
+		boost::mutex s_firmwareCacheMutex;
+
+		//One "serial checksum" pair per line, checksum in hex
+		void readFirmwareCache(const std::string& filename, std::map<std::string, uint32_t>& cache)
+		{
+			std::ifstream in(filename.c_str());
+			std::string serial;
+			uint32_t checksum;
+			while(in >> serial >> std::hex >> checksum >> std::dec)
+			{
+				cache[serial] = checksum;
+			}
+		}
+
+		bool writeFirmwareCache(const std::string& filename, const std::map<std::string, uint32_t>& cache)
+		{
+			std::string temp = filename + ".tmp";
+			{
+				std::ofstream out(temp.c_str());
+				if(!out.is_open())
+				{
+					return false;
+				}
+				for(std::map<std::string, uint32_t>::const_iterator i = cache.begin(); i != cache.end(); ++i)
+				{
+					out << i->first << " " << std::hex << i->second << std::dec << std::endl;
+				}
+				if(!out.good())
+				{
+					return false;
+				}
+			}
+#if defined(WIN32) || defined(_WIN32)
+			//rename() won't replace an existing file on windows
+			std::remove(filename.c_str());
+#endif
+			return std::rename(temp.c_str(), filename.c_str()) == 0;
+		}
+	}
+
+	bool FalconDevice::isFirmwareCached(uint32_t checksum)
+	{
+		if(m_firmwareCacheFile.empty() || m_deviceSerial.empty())
+		{
+			return false;
+		}
+		std::map<std::string, uint32_t> cache;
+		{
+			boost::mutex::scoped_lock lock(s_firmwareCacheMutex);
+			readFirmwareCache(m_firmwareCacheFile, cache);
+		}
+		std::map<std::string, uint32_t>::const_iterator cached = cache.find(m_deviceSerial);
+		if(cached == cache.end() || cached->second != checksum || !m_falconFirmware->isFirmwareLoaded())
+		{
+			return false;
+		}
+		LOG_INFO("Device " << m_deviceSerial << " already runs the requested firmware, skipping upload");
+		return true;
+	}
+
+	bool FalconDevice::uploadFirmware(uint8_t* buffer, unsigned int firmware_size, uint32_t checksum, unsigned int retries, bool skip_checksum)
+	{
+		for(unsigned int i = 0; i < retries; ++i)
+		{
+			if(m_falconFirmware->loadFirmware(skip_checksum, firmware_size, buffer))
+			{
+				if(!m_firmwareCacheFile.empty() && !m_deviceSerial.empty())
+				{
+					std::map<std::string, uint32_t> cache;
+					boost::mutex::scoped_lock lock(s_firmwareCacheMutex);
+					readFirmwareCache(m_firmwareCacheFile, cache);
+					cache[m_deviceSerial] = checksum;
+					if(!writeFirmwareCache(m_firmwareCacheFile, cache))
+					{
+						LOG_WARN("Cannot write firmware cache " << m_firmwareCacheFile);
+					}
+				}
+				return true;
+			}
+		}
+		m_errorCode = (m_falconFirmware->getErrorCode() == FalconFirmware::FALCON_FIRMWARE_CHECKSUM_MISMATCH) ?
+			FALCON_DEVICE_FIRMWARE_CHECKSUM_MISMATCH : m_falconFirmware->getErrorCode();
+		return false;
+	}
+
+	bool FalconDevice::loadFirmwareImage(const std::vector<uint8_t>& image, unsigned int retries, bool skip_checksum)
+	{
+		m_wasFirmwareUploadSkipped = false;
+		if(image.empty())
+		{
+			m_errorCode = FALCON_DEVICE_FIRMWARE_NOT_VALID;
+			return false;
+		}
+		boost::crc_32_type crc;
+		crc.process_bytes(&image[0], image.size());
+		uint32_t checksum = crc.checksum();
+		if(isFirmwareCached(checksum))
+		{
+			m_falconFirmware->setFirmwareImage(image);
+			m_wasFirmwareUploadSkipped = true;
+			return true;
+		}
+		return uploadFirmware(const_cast<uint8_t*>(&image[0]), image.size(), checksum, retries, skip_checksum);
+	}
+
+	bool FalconDevice::loadRegisteredFirmware(const std::string& name, bool skip_checksum, unsigned int retries)
+	{
+		m_wasFirmwareUploadSkipped = false;
+		if(m_falconFirmware == NULL)
+		{
+			m_errorCode = FALCON_DEVICE_NO_FIRMWARE_SET;
+			return false;
+		}
+		unsigned int index;
+		if(!FalconFirmwareRegistry::findImage(name, index))
+		{
+			LOG_ERROR("No registered firmware named " << name);
+			m_errorCode = FALCON_DEVICE_FIRMWARE_NOT_VALID;
+			return false;
+		}
+		//The registry knows the checksum up front, so a cached device never has the image unpacked
+		uint32_t checksum = FalconFirmwareRegistry::getChecksum(index);
+		if(isFirmwareCached(checksum))
+		{
+			m_falconFirmware->setRegisteredFirmwareImage(index);
+			m_wasFirmwareUploadSkipped = true;
+			return true;
+		}
+		const uint8_t* image = FalconFirmwareRegistry::getImage(index);
+		if(image == NULL)
+		{
+			m_errorCode = FALCON_DEVICE_FIRMWARE_NOT_VALID;
+			return false;
+		}
+		return uploadFirmware(const_cast<uint8_t*>(image), FalconFirmwareRegistry::getSize(index), checksum, retries, skip_checksum);
 	}
 
 	bool FalconDevice::isFirmwareLoaded()
@@ -124,41 +369,264 @@ namespace libnifalcon
 
 	bool FalconDevice::runIOLoop(unsigned int exe_flags)
 	{
+		FALCON_TRACE_SCOPE("FalconDevice::runIOLoop");
 		if(m_falconFirmware == NULL)
 		{
 			m_errorCode = FALCON_DEVICE_NO_FIRMWARE_SET;
 			return false;
 		}
+		if(m_falconComm != NULL && m_falconComm->isDisconnected())
+		{
+			if(!m_isReconnectPending)
+			{
+				LOG_ERROR("Device disconnected");
+				recordFlight(FalconFlightRecord::STATUS_DISCONNECTED);
+				m_isReconnectPending = true;
+				//First attempt goes out right away
+				m_lastReconnectAttempt = FalconClock::getTime() - m_reconnectInterval;
+			}
+		}
+		if(m_isReconnectPending && (!m_autoReconnect || !reconnect()))
+		{
+			m_errorCode = FALCON_DEVICE_DISCONNECTED;
+			return false;
+		}
+		bool predict = (m_falconVelocityEstimator != NULL) && (exe_flags & FALCON_LOOP_PREDICTION) && (exe_flags & FALCON_LOOP_ESTIMATOR);
 		if(m_falconKinematic != NULL && (exe_flags & FALCON_LOOP_KINEMATIC))
 		{
 			boost::array<int, 3> enc_vec;
-			m_falconKinematic->getForces(m_position, m_forceVec, enc_vec);
+			if(predict && m_ioState.sampleCount > 0)
+			{
+				//The sample was taken about half a round trip before it arrived, and this write lands
+				//about half a round trip from now
+				double horizon = (FalconClock::getTime() - m_ioState.timestamp) + m_falconFirmware->getRoundTripTime();
+				predictPosition(horizon, m_predictedPosition);
+			}
+			boost::array<double, 3> force = m_forceVec;
+			boost::array<double, 3> channel_force;
+			if(m_forceChannel.evaluate(FalconClock::getTime(), m_predictedPosition, channel_force))
+			{
+				force = channel_force;
+			}
+			m_ioState.force = force;
+			{
+				FALCON_TRACE_SCOPE("getForces");
+				m_falconKinematic->getForces(m_predictedPosition, force, enc_vec);
+			}
 			m_falconFirmware->setForces(enc_vec);
+			if(m_falconKinematic->isLastForceSaturated())
+			{
+				m_metrics.increment(FalconMetrics::COUNTER_TORQUE_SATURATION);
+			}
 		}
-		if(!m_falconFirmware->runIOLoop() && (exe_flags & FALCON_LOOP_FIRMWARE))
+		uint64_t underruns = m_falconFirmware->getReadUnderrunCount();
+		bool io_ok = m_falconFirmware->runIOLoop();
+		m_metrics.setCounter(FalconMetrics::COUNTER_MALFORMED_PACKETS, m_falconFirmware->getMalformedPacketCount());
+		m_metrics.setCounter(FalconMetrics::COUNTER_READ_UNDERRUNS, m_falconFirmware->getReadUnderrunCount());
+		if(!io_ok && (exe_flags & FALCON_LOOP_FIRMWARE))
 		{
 			++m_errorCount;
+			//Underruns are counted on their own, so they don't drown out real I/O failures
+			if(m_falconFirmware->getReadUnderrunCount() == underruns)
+			{
+				m_metrics.increment(FalconMetrics::COUNTER_IO_ERRORS);
+				//Record the start of a run of failures only, so a dead link doesn't push the lead up out of the ring
+				if(!m_isIOFailing)
+				{
+					m_isIOFailing = true;
+					recordFlight(FalconFlightRecord::STATUS_IO_ERROR);
+				}
+			}
 			m_errorCode = m_falconFirmware->getErrorCode();
 			return false;
 		}
+		m_isIOFailing = false;
+		//Timestamp as close to the read as we can get, estimators differentiate over this
+		bool new_sample = (m_falconFirmware->getOutputCount() != m_lastOutputCount);
+		if(new_sample)
+		{
+			m_lastOutputCount = m_falconFirmware->getOutputCount();
+			double now = FalconClock::getTime();
+			if(m_ioState.sampleCount > 0)
+			{
+				m_metrics.recordTime(FalconMetrics::HISTOGRAM_SAMPLE_PERIOD, now - m_ioState.timestamp);
+			}
+			if(m_falconFirmware->getLastRoundTripTime() > 0.0)
+			{
+				m_metrics.recordTime(FalconMetrics::HISTOGRAM_ROUND_TRIP, m_falconFirmware->getLastRoundTripTime());
+			}
+			m_metrics.increment(FalconMetrics::COUNTER_SAMPLES);
+			m_ioState.timestamp = now;
+			++m_ioState.sampleCount;
+			m_ioState.encoders = m_falconFirmware->getEncoderValues();
+			bool was_homed = m_ioState.isHomed;
+			m_ioState.homingStatus = m_falconFirmware->getHomingModeStatus();
+			m_ioState.isHomed = m_falconFirmware->isHomed();
+			//Homing resets the coordinate system, so any history from before it is garbage
+			if(m_ioState.isHomed != was_homed && m_falconVelocityEstimator != NULL)
+			{
+				m_falconVelocityEstimator->reset();
+			}
+		}
 		if(m_falconGrip != NULL && (exe_flags & FALCON_LOOP_GRIP))
 		{
+			FALCON_TRACE_SCOPE("runGripLoop");
 			if(!m_falconGrip->runGripLoop(m_falconFirmware->getGripInfoSize(), m_falconFirmware->getGripInfo()))
 			{
 				m_errorCode = m_falconGrip->getErrorCode();
+				if(new_sample) recordFlight(FalconFlightRecord::STATUS_GRIP_ERROR);
 				return false;
 			}
+			if(new_sample)
+			{
+				m_falconGrip->updateEvents(m_ioState.timestamp);
+			}
+			m_ioState.digitalInputs = m_falconGrip->getDigitalInputs();
+			m_ioState.debouncedInputs = m_falconGrip->getDebouncedInputs();
+			for(unsigned int i = 0; i < FalconState::MAX_ANALOG_INPUTS && i < m_falconGrip->getNumAnalogInputs(); ++i)
+			{
+				m_ioState.analogInputs[i] = m_falconGrip->getAnalogInput(i);
+			}
 		}
 		if(m_falconKinematic != NULL && (exe_flags & FALCON_LOOP_KINEMATIC))
 		{
 			boost::array<int, 3> p = m_falconFirmware->getEncoderValues();
-			if(!m_falconKinematic->getPosition(p, m_position))
+			bool solved;
+			{
+				FALCON_TRACE_SCOPE("getPosition");
+				solved = m_falconKinematic->getPosition(p, m_position);
+			}
+			if(m_falconKinematic->getLastSolveIterations() > 0)
+			{
+				m_metrics.record(FalconMetrics::HISTOGRAM_KINEMATIC_ITERATIONS, m_falconKinematic->getLastSolveIterations());
+			}
+			if(!m_falconKinematic->isLastSolveConverged())
+			{
+				m_metrics.increment(FalconMetrics::COUNTER_KINEMATIC_NONCONVERGENCE);
+			}
+			if(!solved)
 			{
 				++m_errorCount;
+				m_metrics.increment(FalconMetrics::COUNTER_KINEMATIC_ERRORS);
 				m_errorCode = m_falconKinematic->getErrorCode();
+				if(new_sample) recordFlight(FalconFlightRecord::STATUS_KINEMATIC_ERROR);
 				return false;
 			}
+			m_ioState.position = m_position;
+			if(new_sample && m_falconVelocityEstimator != NULL && (exe_flags & FALCON_LOOP_ESTIMATOR))
+			{
+				FALCON_TRACE_SCOPE("addSample");
+				m_falconVelocityEstimator->addSample(m_ioState.timestamp, m_position);
+				m_ioState.velocity = m_falconVelocityEstimator->getVelocity();
+				m_ioState.acceleration = m_falconVelocityEstimator->getAcceleration();
+			}
+			if(predict)
+			{
+				//Best guess for the next write, refined at the top of the next loop
+				predictPosition(m_falconFirmware->getRoundTripTime(), m_predictedPosition);
+			}
+			else
+			{
+				m_predictedPosition = m_position;
+			}
+			m_ioState.predictedPosition = m_predictedPosition;
+		}
+		m_ioState.roundTripTime = m_falconFirmware->getRoundTripTime();
+		if(new_sample)
+		{
+			FALCON_TRACE_SCOPE("publishState");
+			publishState();
+			recordFlight(FalconFlightRecord::STATUS_OK);
 		}
 		return true;
 	}
+
+	void FalconDevice::recordFlight(uint8_t status)
+	{
+		FalconFlightRecord record;
+		record.timestamp = m_ioState.timestamp;
+		record.roundTripTime = (float)m_ioState.roundTripTime;
+		boost::array<int, 3> motor = m_falconFirmware->getForces();
+		for(int i = 0; i < 3; ++i)
+		{
+			record.encoders[i] = (int16_t)m_ioState.encoders[i];
+			record.motorForces[i] = (int16_t)motor[i];
+			record.position[i] = (float)m_ioState.position[i];
+			record.force[i] = (float)m_ioState.force[i];
+		}
+		record.homingStatus = (uint8_t)m_ioState.homingStatus;
+		record.digitalInputs = (uint8_t)m_ioState.digitalInputs;
+		record.status = status | m_flightStatus;
+		record.reserved = 0;
+		record.errorCount = m_errorCount;
+		m_flightStatus = 0;
+		m_flightRecorder.append(record);
+
+		//Formatting and writing the dump would stall the loop, so it's left to dumpRequestedFlightRecord()
+		if(status & (FalconFlightRecord::STATUS_KINEMATIC_ERROR | FalconFlightRecord::STATUS_DISCONNECTED | FalconFlightRecord::STATUS_IO_ERROR))
+		{
+			m_flightDumpRequested.store(true, boost::memory_order_release);
+		}
+	}
+
+	bool FalconDevice::dumpRequestedFlightRecord()
+	{
+		if(m_flightDumpFile.empty() || !m_flightDumpRequested.load(boost::memory_order_acquire))
+		{
+			return false;
+		}
+		//Leave the request pending until the rate limit allows another dump
+		double now = FalconClock::getTime();
+		if(now - m_lastFlightDump < 1.0)
+		{
+			return false;
+		}
+		m_flightDumpRequested.store(false, boost::memory_order_relaxed);
+		m_lastFlightDump = now;
+		LOG_INFO("Dumping flight recorder to " << m_flightDumpFile);
+		return m_flightRecorder.dump(m_flightDumpFile, m_flightDumpSeconds);
+	}
+
+	void FalconDevice::predictPosition(double horizon, boost::array<double, 3>& predicted)
+	{
+		if(horizon < 0.0) horizon = 0.0;
+		if(horizon > m_maxPredictionHorizon) horizon = m_maxPredictionHorizon;
+		const boost::array<double, 3>& v = m_ioState.velocity;
+		const boost::array<double, 3>& a = m_ioState.acceleration;
+		boost::array<double, 3> offset;
+		double length = 0.0;
+		for(int i = 0; i < 3; ++i)
+		{
+			offset[i] = v[i] * horizon + 0.5 * a[i] * horizon * horizon;
+			length += offset[i] * offset[i];
+		}
+		length = sqrt(length);
+		double scale = (length > m_maxPredictionDistance) ? (m_maxPredictionDistance / length) : 1.0;
+		for(int i = 0; i < 3; ++i)
+		{
+			predicted[i] = m_position[i] + offset[i] * scale;
+		}
+	}
+
+	void FalconDevice::publishState()
+	{
+		//Single writer seqlock. Readers retry if the sequence is odd or changes under them.
+		uint32_t seq = m_stateSequence.load(boost::memory_order_relaxed);
+		m_stateSequence.store(seq + 1, boost::memory_order_relaxed);
+		boost::atomic_thread_fence(boost::memory_order_release);
+		m_publishedState = m_ioState;
+		m_stateSequence.store(seq + 2, boost::memory_order_release);
+	}
+
+	void FalconDevice::getState(FalconState& state) const
+	{
+		uint32_t before, after;
+		do
+		{
+			before = m_stateSequence.load(boost::memory_order_acquire);
+			state = m_publishedState;
+			boost::atomic_thread_fence(boost::memory_order_acquire);
+			after = m_stateSequence.load(boost::memory_order_relaxed);
+		} while((before & 1) || before != after);
+	}
 };
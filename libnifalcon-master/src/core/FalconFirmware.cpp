@@ -10,18 +10,27 @@
  */
 
 #include "falcon/core/FalconFirmware.h"
+#include "falcon/core/FalconFirmwareRegistry.h"
 #include <iostream>
 #include <fstream>
 #include <cstring>
+#include <algorithm>
 
 namespace libnifalcon
 {
 	FalconFirmware::FalconFirmware() :
-		m_homingMode(false),
+		m_registeredImage(NO_REGISTERED_IMAGE),
 		m_isFirmwareLoaded(false),
-		m_hasWritten(false),
+		m_uploadWindow(2),
+		m_homingMode(false),
 		m_loopCount(0),
 		m_outputCount(0),
+		m_hasWritten(false),
+		m_lastWriteTime(0.0),
+		m_roundTripTime(0.0),
+		m_lastRoundTripTime(0.0),
+		m_malformedPacketCount(0),
+		m_readUnderrunCount(0),
 		INIT_LOGGER("FalconFirmware")
 		//m_packetBufferSize(1)
 	{
@@ -58,7 +67,7 @@ namespace libnifalcon
 		return false;
 	}
 
-	bool FalconFirmware::loadFirmware(bool skip_checksum)
+	bool FalconFirmware::readFirmwareFile(std::vector<uint8_t>& image)
 	{
 		if(m_firmwareFilename.length() == 0)
 		{
@@ -78,12 +87,28 @@ namespace libnifalcon
 		file_size = end-begin;
 		firmware_file.seekg (0, std::ios::beg);
 
-		uint8_t* buf = new uint8_t[file_size];
-		firmware_file.read((char*)buf, file_size);
-		bool success = loadFirmware(skip_checksum, file_size, buf);
+		image.resize(file_size);
+		if(file_size > 0)
+		{
+			firmware_file.read((char*)&image[0], file_size);
+		}
 		firmware_file.close();
-		delete[] buf;
-		return success;
+		if(image.empty())
+		{
+			m_errorCode = FALCON_FIRMWARE_FILE_NOT_VALID;
+			return false;
+		}
+		return true;
+	}
+
+	bool FalconFirmware::loadFirmware(bool skip_checksum)
+	{
+		std::vector<uint8_t> image;
+		if(!readFirmwareFile(image))
+		{
+			return false;
+		}
+		return loadFirmware(skip_checksum, image.size(), &image[0]);
 	}
 
 	bool FalconFirmware::loadFirmware(bool skip_checksum, const unsigned int& firmware_size, uint8_t* buffer)
@@ -103,8 +128,8 @@ namespace libnifalcon
 			m_errorCode = m_falconComm->getErrorCode();
 			return false;
 		}
-		uint8_t send_buf[128], receive_buf[128];
-		int bytes_read, total_read = 0;
+		uint8_t receive_buf[128];
+		unsigned int total_written = 0, total_read = 0;
 
 		//58 is an odd number to use for this, isn't it?
 		//Well, full speed USB packets can only take 64 bytes
@@ -112,61 +137,87 @@ namespace libnifalcon
 		//If you send 60-62, libusb-1.0 freaks out
 		//So, 58 it is. Happy medium
 
-		const int READ_SIZE = 62;
+		const unsigned int READ_SIZE = 62;
 
+		if(skip_checksum)
+		{
+			LOG_DEBUG("Skipping checksum for firmware");
+		}
 		while(total_read != firmware_size)
 		{
-
-			if(total_read + READ_SIZE > firmware_size)
+			//Keep the next chunks queued in the FTDI, so the bootloader isn't left waiting on a USB round
+			//trip for every echo
+			while(total_written != firmware_size && total_written - total_read + READ_SIZE <= m_uploadWindow * READ_SIZE)
 			{
-				bytes_read = firmware_size-total_read;
-				//bytes_read = READ_SIZE;
+				unsigned int bytes_written = std::min(READ_SIZE, firmware_size - total_written);
+				if(!m_falconComm->writeBlocking(buffer+total_written, bytes_written))
+				{
+					m_errorCode = m_falconComm->getErrorCode();
+					return false;
+				}
+				total_written += bytes_written;
 			}
-			else
+			//Echoes come back in order, but not necessarily on chunk boundaries, so they're checked as a
+			//stream against what has been written
+			unsigned int bytes_expected = std::min(READ_SIZE, total_written - total_read);
+			if(!m_falconComm->readBlocking(receive_buf, bytes_expected))
 			{
-				bytes_read = READ_SIZE;
+				LOG_DEBUG("Firmware read failed, only returned " << m_falconComm->getLastBytesRead() << " bytes");
+				m_errorCode = m_falconComm->getErrorCode();
+				return false;
 			}
-			if(!m_falconComm->writeBlocking(buffer+total_read, bytes_read))
+			unsigned int bytes_read = m_falconComm->getLastBytesRead();
+			if(bytes_read > total_written - total_read)
 			{
-				m_errorCode = m_falconComm->getErrorCode();
+				m_errorCode = FALCON_FIRMWARE_CHECKSUM_MISMATCH;
 				return false;
 			}
-			int bytes_check = 0;
-			int bytes_current = 0;
-			while(bytes_check < bytes_read)
+			if(!skip_checksum && memcmp(buffer + total_read, receive_buf, bytes_read) != 0)
 			{
-				if(!m_falconComm->readBlocking(receive_buf, bytes_read))
-				{
-					LOG_DEBUG("Firmware read failed, only returned " << m_falconComm->getLastBytesRead() << " bytes");
-					m_errorCode = m_falconComm->getErrorCode();
-
-					return false;
-				}
-				if(!skip_checksum)
-				{
-					for(unsigned int i = 0; i < m_falconComm->getLastBytesRead(); ++i)
-					{
-						if((buffer[total_read+i]) != receive_buf[i])
-						{
-							m_errorCode = FALCON_FIRMWARE_CHECKSUM_MISMATCH;
-							return false;
-						}
-					}
-				}
-				else
-				{
-					LOG_DEBUG("Skipping checksum for firmware");
-				}
-				bytes_check += m_falconComm->getLastBytesRead();
-				total_read += m_falconComm->getLastBytesRead();
+				m_errorCode = FALCON_FIRMWARE_CHECKSUM_MISMATCH;
+				return false;
 			}
+			total_read += bytes_read;
 		}
 		m_falconComm->setNormalMode();
 		m_hasWritten = false;
 		m_isFirmwareLoaded = true;
+		//Registry images stay unpacked for the life of the process, so only their index needs keeping
+		unsigned int registered;
+		if(FalconFirmwareRegistry::findImage(buffer, registered))
+		{
+			m_firmwareImage.clear();
+			m_registeredImage = registered;
+		}
+		//reloadFirmware() passes our own copy back in
+		else if(m_firmwareImage.empty() || buffer != &m_firmwareImage[0])
+		{
+			m_firmwareImage.assign(buffer, buffer + firmware_size);
+			m_registeredImage = NO_REGISTERED_IMAGE;
+		}
 		return true;
 	}
 
+	bool FalconFirmware::reloadFirmware(bool skip_checksum)
+	{
+		if(m_registeredImage != NO_REGISTERED_IMAGE)
+		{
+			const uint8_t* image = FalconFirmwareRegistry::getImage(m_registeredImage);
+			if(image == NULL)
+			{
+				m_errorCode = FALCON_FIRMWARE_FILE_NOT_VALID;
+				return false;
+			}
+			return loadFirmware(skip_checksum, FalconFirmwareRegistry::getSize(m_registeredImage), const_cast<uint8_t*>(image));
+		}
+		if(m_firmwareImage.empty())
+		{
+			m_errorCode = FALCON_FIRMWARE_FILE_NOT_VALID;
+			return false;
+		}
+		return loadFirmware(skip_checksum, m_firmwareImage.size(), &m_firmwareImage[0]);
+	}
+
 	bool FalconFirmware::isFirmwareLoaded()
 	{
 		resetFirmwareState();
@@ -0,0 +1,776 @@
+/***
+ * @file FalconFirmwareRegistry.cpp
+ * @brief Firmware images compiled into libnifalcon, stored compressed and unpacked on demand
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconFirmwareRegistry.h"
+#include <boost/atomic.hpp>
+#include <boost/crc.hpp>
+
+namespace libnifalcon
+{
+	namespace
+	{
+		/*
+		 * Images are LZSS packed. Each flag byte covers the next 8 items, low bit first: a set bit is a
+		 * literal byte, a clear bit a 2 byte back reference, big endian, with the distance minus 1 in the
+		 * top 12 bits and the length minus 3 in the low 4.
+		 */
+		const unsigned int LZSS_LENGTH_BITS = 4;
+		const unsigned int LZSS_MIN_LENGTH = 3;
+
+		//Same image as FalconFirmwareBinaryNvent.h, 8492 bytes, CRC32 0x0363acfc
+		const uint8_t NVENT_IMAGE[] = {
+		0xf7,0xaa,0x08,0x00,0x00,0x0c,0x3f,0x00,0x02,0x80,0xfb,0x3b,0x0e,0x00,0x51,0xad,
+		0x28,0x00,0x80,0x69,0xff,0xff,0x1f,0x56,0x16,0x56,0x1a,0x56,0x40,0xff,0x29,0x1f,
+		0x76,0x00,0x00,0x02,0x29,0x1b,0xff,0x76,0x22,0x76,0xa9,0x28,0x3d,0x8e,0xa8,0xff,
+		0x28,0x3f,0x00,0x01,0x09,0x1b,0x61,0xff,0xff,0x76,0x3d,0x8e,0x04,0x29,0x0f,0x6f,
+		0x00,0xff,0x9b,0xa9,0x24,0x01,0xdf,0x04,0x6c,0x04,0xfb,0x29,0xa8,0x00,0x70,0xa6,
+		0x1e,0xa1,0xf7,0x86,0xff,0x24,0xa7,0x06,0xa1,0x81,0x01,0x09,0xa7,0xff,0x1e,0xa9,
+		0x24,0x03,0x63,0x5c,0xff,0x04,0xff,0x3b,0xa9,0x59,0x01,0xdf,0x09,0x00,0xec,0xbb,
+		0xff,0x1a,0x04,0x10,0xff,0xff,0xa8,0x00,0x30,0x01,0xfb,0x09,0x0e,0x04,0x10,0xff,
+		0xff,0x06,0x6f,0x01,0xff,0xdf,0xbd,0xc3,0xa7,0x1e,0x67,0x3e,0xbe,0xfd,0xc5,0x04,
+		0x71,0xa8,0x24,0x58,0xff,0xf7,0x60,0xff,0x7f,0x76,0x99,0x80,0x7f,0x76,0x46,0x80,
+		0xff,0xbd,0xb2,0x1f,0x76,0x4a,0x02,0xbd,0xaa,0xff,0x28,0xc5,0x67,0x3e,0x1f,0x76,
+		0x4b,0x02,0xff,0x00,0x59,0xa1,0x92,0x10,0xec,0x01,0x3b,0xff,0x00,0x8f,0x00,0x93,
+		0x03,0x56,0xa1,0x01,0xff,0x01,0x56,0xa4,0x00,0xa4,0x86,0x82,0xda,0xfd,0xc2,0x01,
+		0xf0,0xa1,0x92,0xff,0x9c,0xa9,0x59,0x7b,0xfa,0xed,0x02,0x71,0x02,0x06,0x03,0xec,
+		0x05,0x31,0x7a,0x03,0x31,0x04,0x00,0xb4,0x00,0x77,0x00,0x6f,0x04,0xd2,0xdf,0xb2,
+		0x28,0xc5,0xa4,0x8b,0x04,0xf4,0x92,0x20,0xd7,0x52,0x07,0x64,0x06,0x31,0x26,0x06,
+		0x10,0x01,0x9a,0xeb,0x0f,0x6f,0x05,0xb5,0x00,0x05,0xb2,0xc4,0xb2,0x00,0xfd,0x0a,
+		0x01,0xd5,0x00,0x9a,0xbe,0x8b,0x06,0x00,0x6f,0x00,0x6f,0x06,0x00,0x09,0x31,0x28,
+		0xa8,0x00,0x73,0x7d,0x26,0x00,0x70,0x3f,0x8f,0xff,0xff,0x7f,0x00,0x30,0xff,0xa9,
+		0xa8,0xa5,0x0f,0x04,0xed,0x00,0xd4,0xef,0x00,0xbe,0x07,0x6f,0x01,0x31,0xc4,0x88,
+		0x02,0xff,0x02,0xa4,0x07,0xa9,0x8a,0xa6,0x92,0x7f,0xff,0x76,0x6d,0x87,0x06,0x00,
+		0x02,0xfe,0x41,0x7f,0x2b,0x41,0x92,0x06,0x52,0x14,0x63,0x0c,0x11,0xf5,0x60,0x0c,
+		0x10,0x41,0x0c,0x12,0x00,0x02,0xc4,0x1e,0xbf,0x41,0x85,0x00,0x8f,0x5a,0x93,0x07,
+		0x32,0x2b,0xeb,0x41,0x0a,0x02,0x51,0xee,0x09,0x70,0xc4,0x01,0x00,0xff,0x1a,0x00,
+		0x40,0x14,0xf6,0x00,0x77,0x69,0xff,0xff,0xa9,0x28,0xb0,0x36,0x18,0x28,0xc2,0xdf,
+		0x00,0x7f,0x76,0x3f,0x86,0x01,0x91,0x18,0x1a,0xef,0x20,0x00,0x28,0x9a,0x00,0xd5,
+		0x02,0x28,0x05,0xff,0x00,0x03,0x18,0xf0,0xff,0x03,0xcc,0x0f,0xff,0xff,0x10,0x50,
+		0x03,0x96,0x03,0xcc,0xff,0x5f,0xf0,0xa9,0x1a,0x00,0x02,0x00,0x92,0x0f,0x00,0x90,
+		0xff,0x30,0x03,0x96,0x04,0xcc,0xf0,0xff,0x04,0xbb,0x50,0x04,0x00,0x70,0x0f,0xff,
+		0x50,0x00,0x70,0x00,0xff,0x28,0x90,0x0f,0x01,0x28,0x00,0x88,0x1f,0xef,0x76,0x33,
+		0x00,0x22,0x04,0xd0,0x23,0x76,0x01,0xff,0x00,0x82,0xfe,0x06,0x00,0x22,0x76,0xc0,
+		0xff,0xb9,0x29,0x28,0x68,0x00,0x1a,0x76,0x7f,0xfe,0x21,0x10,0x04,0xfe,0x43,0x7c,
+		0x42,0x97,0x41,0xff,0x96,0x44,0x96,0x43,0x92,0x44,0x54,0x02,0xef,0x63,0x44,0x96,
+		0x42,0x00,0x71,0x65,0x44,0x96,0xf7,0x44,0x92,0x84,0x02,0xd0,0x1b,0x76,0x42,0x29,
+		0x3f,0x16,0x56,0x25,0x76,0x00,0x6f,0x00,0x9f,0x01,0x3f,0x00,0x02,0x7f,0x03,0xbf,
+		0x04,0xff,0x06,0x3f,0x06,0xdf,0x08,0x1f,0x09,0x5f,0x0a,0x9f,0x3c,0x0b,0xd3,0x10,
+		0x11,0x21,0x28,0x01,0x00,0x01,0x1f,0x0d,0x73,0xff,0x05,0x00,0x69,0xff,0xbd,0xa8,
+		0xbd,0xa0,0xbf,0xbd,0xc2,0xbd,0xc3,0xbd,0xab,0x03,0x19,0x7f,0xff,0x76,0x02,0x88,
+		0xbe,0x87,0xbe,0xc5,0xbe,0xff,0xc4,0xbe,0x83,0xbe,0x8a,0x03,0x00,0x17,0x87,0x76,
+		0x02,0x76,0x02,0xff,0x02,0xff,0x02,0xff,0x05,0xf7,0x04,0xfd,0xfe,0x09,0x39,0x1f,
+		0x76,0xd4,0x01,0x04,0x18,0xeb,0xbf,0xff,0x20,0xd1,0x01,0x20,0xd0,0x19,0x1a,0x10,
+		0xef,0x00,0x08,0x92,0xc3,0x00,0xf0,0x4d,0x02,0x1a,0x55,0x96,0x22,0x31,0x09,0x00,
+		0xd4,0x1b,0x00,0xd2,0x0a,0x01,0xb4,0x55,0x1c,0x01,0xb2,0x0b,0x02,0x94,0x1d,0x02,
+		0x92,0x0c,0x03,0x74,0xd5,0x1e,0x03,0x72,0x0d,0x04,0x54,0x1f,0x04,0x50,0x40,0x02,
+		0xff,0x01,0x02,0x1a,0x07,0xa6,0x1e,0x1a,0x1e,0xff,0x20,0xff,0xe8,0x03,0xa6,0x0f,
+		0x07,0x66,0xaf,0x00,0x02,0x1a,0x1e,0x01,0x71,0x04,0x08,0x32,0x4e,0xdf,0x02,0x0d,
+		0x92,0x0f,0xec,0x00,0x71,0x0c,0x28,0x9b,0xd0,0x07,0x00,0xf1,0x0a,0x2b,0x01,0x52,
+		0x00,0x50,0x40,0xcf,0x02,0x08,0x2b,0x0c,0x35,0xb0,0x01,0xb0,0x0b,0x08,0xa7,0xed,
+		0x01,0x9a,0x01,0xd2,0x05,0x32,0x08,0x09,0xf0,0x4d,0xfe,0x36,0x50,0x1a,0xec,0x43,
+		0x2b,0x43,0x92,0x00,0xaf,0x2b,0x06,0x52,0x15,0x2f,0xb6,0x43,0x3b,0xd2,0x40,0xbf,
+		0x8f,0x00,0x08,0xc4,0xa0,0x43,0x2f,0xd0,0x54,0xae,0x2f,0xd4,0x43,0x0a,0x43,0x32,
+		0x30,0xed,0x39,0x50,0x4d,0xff,0x02,0x05,0x92,0x7b,0xec,0x09,0x0a,0x09,0xff,0x92,
+		0x14,0x52,0x77,0xed,0x09,0x2b,0x07,0xbe,0x38,0xb0,0x4e,0x02,0x12,0x92,0x68,0x3e,
+		0x30,0x4e,0xef,0x02,0x14,0x92,0x64,0x00,0x72,0x13,0x92,0x60,0xbd,0xed,0x05,0xd1,
+		0x06,0x52,0x25,0x65,0x41,0x91,0x54,0xef,0x93,0x43,0x85,0x40,0x34,0xb4,0x43,0x85,
+		0x01,0xff,0x56,0xa5,0x00,0xc5,0x92,0xc4,0x9e,0xa9,0x7f,0x85,0x56,0xff,0x02,0x52,
+		0x10,0x65,0x06,0x91,0xbc,0x36,0x73,0x13,0xf1,0x07,0x2b,0xc4,0x88,0x07,0xb8,0x7e,
+		0xb6,0x07,0xb3,0xdd,0x62,0x01,0xb2,0x92,0x37,0x0e,0xf2,0x19,0xd7,0x92,0x01,0x3b,
+		0x16,0xb1,0x08,0x04,0x34,0x08,0x65,0xb8,0x01,0x53,0x03,0xf3,0x0e,0x11,0x4e,0x02,
+		0x18,0x00,0xd2,0x02,0x5c,0x02,0x1a,0x01,0x33,0x07,0x2b,0x02,0x02,0x12,0x1b,0x02,
+		0xf2,0xc5,0x01,0x08,0x74,0x0a,0x04,0x32,0x01,0x34,0x12,0x32,0x07,0x2b,0xff,0x07,
+		0x92,0x50,0x52,0x04,0x64,0x05,0x2b,0x9d,0x06,0x28,0x70,0x06,0x92,0x3a,0x13,0x12,
+		0x42,0xb9,0x43,0x99,0x01,0x0d,0x5c,0x0d,0xb0,0xc4,0x00,0x12,0xd3,0x42,0xb1,0x4d,
+		0xff,0x02,0x0d,0x0a,0x0d,0x92,0x80,0x52,0x23,0xf9,0x64,0x10,0xd3,0x16,0x9d,0xc4,
+		0xc4,0xac,0x28,0x19,0xff,0x00,0xa6,0x06,0x45,0xff,0x22,0x56,0xa6,0xdf,0x07,0x46,
+		0xff,0xc4,0x1e,0x16,0x99,0x06,0x2b,0xff,0x07,0x6f,0x7f,0x76,0x73,0x88,0x7f,0x76,
+		0x3d,0xdd,0x00,0x30,0x47,0x89,0x84,0xfe,0x2d,0x5f,0x32,0x9f,0x84,0x33,0xbf,0x34,
+		0xd7,0x02,0x01,0x1f,0x02,0x3f,0x35,0xff,0x35,0xf6,0xd0,0x8f,0x01,0x2f,0x28,0x80,
+		0x56,0xb0,0x04,0xb3,0x30,0x51,0x01,0xef,0x2b,0x04,0x1a,0x40,0x57,0xd0,0xd0,0x01,
+		0x05,0x5c,0x17,0xd0,0x19,0x90,0x54,0x09,0x63,0x29,0x91,0x06,0x28,0x92,0x9f,0x0b,
+		0x18,0xfe,0xff,0x62,0x5e,0x10,0x01,0xd7,0x61,0xe8,0x1a,0x92,0x14,0xf1,0x2b,0xf1,
+		0x0e,0x23,0xd2,0x0b,0x40,0x19,0xff,0xee,0x1f,0x76,0xc3,0x01,0x24,0xcc,0x10,0xef,
+		0x00,0xc3,0xff,0x50,0x2d,0x12,0x01,0x92,0x4c,0x3e,0x25,0x12,0x0e,0x92,0x32,0x52,
+		0x44,0x60,0xd0,0x04,0xb0,0x95,0x1a,0x2f,0x33,0x01,0x41,0x30,0x3b,0x63,0x50,0x02,
+		0xf5,0x2e,0xd2,0x02,0xf4,0xf2,0x30,0x92,0x02,0xf1,0x2f,0x2a,0x72,0x0c,0x92,0xdf,
+		0x2b,0xec,0x0c,0x2b,0x00,0x58,0xd0,0xb1,0x89,0x97,0x00,0x52,0x09,0x32,0x72,0x02,
+		0x08,0xf0,0x3a,0x31,0x03,0xf3,0x2b,0x0b,0x09,0x56,0x00,0xd0,0x94,0xce,0x9c,0x03,
+		0x3f,0x96,0x00,0x02,0x10,0x1e,0x32,0x32,0x70,0x0c,0x90,0x46,0x23,0xf2,0x19,0x96,
+		0x02,0x31,0x04,0x70,0x36,0xb4,0x01,0x35,0xb2,0xf9,0x0e,0x36,0x10,0x0e,0xb5,0x00,
+		0x8f,0x40,0x06,0x19,0xfa,0x34,0xd2,0x03,0x0f,0xb3,0x94,0xa8,0x28,0xc0,0xf9,0xaf,
+		0x7f,0x76,0x08,0x81,0x39,0xb1,0x16,0x36,0x72,0x01,0xff,0x02,0x01,0x56,0x10,0x00,
+		0x10,0xa3,0x00,0xff,0x02,0x1f,0x76,0x53,0x02,0x1f,0xf6,0x17,0x3f,0x56,0x28,0x00,
+		0x58,0xff,0x0a,0x71,0x10,0x03,0x51,0xff,0x03,0x63,0x03,0x0a,0x04,0x6f,0x00,0x52,
+		0x4f,0x02,0x65,0x03,0x0b,0x45,0x31,0x14,0x33,0x18,0x14,0x34,0x45,0x07,0x14,0x34,
+		0xfd,0x14,0x32,0x01,0xd7,0x14,0x33,0x07,0x40,0x34,0x75,0x11,0x14,0x33,0x41,0x14,
+		0x35,0x04,0x00,0xc1,0x14,0x34,0x05,0x00,0x14,0x34,0x11,0x14,0x38,0x1b,0x51,0x0b,
+		0x90,0x14,0x38,0x02,0xf1,0xa2,0x14,0x33,0x00,0x14,0x34,0x02,0xf1,0x14,0x33,0x0a,
+		0x14,0x30,0x0a,0x2b,0x2b,0x01,0x14,0x3c,0xfd,0x4e,0x72,0x04,0x14,0x32,0x0b,0x33,
+		0x80,0x00,0xd0,0x14,0x30,0x6b,0xd0,0x14,0x34,0x0c,0x90,0x38,0x33,0x14,0x34,0x0a,
+		0x8a,0x4a,0xf4,0x00,0x49,0xf2,0x11,0x4a,0x50,0x0e,0xb5,0x14,0x31,0x18,0xd2,0x49,
+		0x12,0x04,0x0f,0xb3,0x14,0x3a,0x17,0x14,0x36,0x0e,0x00,0xb9,0x0e,0x14,0x3f,0x03,
+		0x52,0x03,0x63,0x04,0x14,0x34,0x04,0xf3,0x0b,0x01,0x16,0x50,0x3d,0x10,0x56,0x12,
+		0x00,0x12,0xd4,0x17,0x1f,0x59,0xb0,0x0b,0x17,0x10,0x0b,0x17,0x14,0x0b,0x0b,0x20,
+		0x62,0x3f,0x32,0x9f,0x33,0xbf,0x34,0xdf,0x6a,0xd7,0x04,0x01,0x1f,0x02,0x3f,0x20,
+		0x03,0x5f,0x04,0x7f,0x05,0x9f,0x06,0xbf,0x71,0x9e,0x08,0x01,0x1f,0x02,0x3f,0x20,
+		0x03,0x5f,0x04,0x7f,0x05,0x9f,0x06,0xbf,0x79,0x7e,0x10,0x01,0x1f,0x02,0x3f,0x20,
+		0x03,0x5f,0x04,0x7f,0x05,0x9f,0x06,0xbf,0x81,0x5e,0x20,0x01,0x1f,0x02,0x3f,0xf8,
+		0x03,0x5f,0x84,0xbf,0x84,0xba,0x00,0x01,0x1f,0x76,0xc1,0xff,0x01,0x15,0xcc,0x80,
+		0x00,0xc6,0xff,0x0a,0xbf,0xec,0x11,0x18,0xdf,0xff,0x11,0x9e,0x10,0x1b,0xff,0x18,
+		0xff,0xdf,0x1b,0x1a,0x00,0x20,0x03,0x66,0x59,0xd0,0x6a,0x8a,0x02,0x11,0x00,0xd0,
+		0x40,0x1b,0x50,0x70,0x1c,0x87,0x5f,0x8c,0x93,0xc1,0x01,0x1a,0x52,0x52,0x05,0x33,
+		0x88,0xff,0x32,0x07,0x3d,0xdd,0x07,0x3f,0x07,0x38,0x8e,0x8c,0x02,0x11,0x07,0x3f,
+		0x32,0x61,0x3b,0xdd,0x07,0x3f,0x95,0x78,0x00,0x01,0x96,0x9d,0x01,0x19,0xee,0xa3,
+		0x9b,0x00,0x9b,0x8f,0xae,0xd0,0x01,0x19,0xc2,0xdf,0x56,0xfd,0xff,0x06,0x00,0x84,
+		0xb1,0xd0,0x01,0xf5,0x09,0x8e,0x50,0xd4,0x00,0x52,0xd0,0x01,0x2c,0x2b,0x5f,0x2d,
+		0x2b,0x2e,0x2b,0x2f,0xc4,0x50,0x30,0xc4,0x90,0xc1,0x31,0xc4,0xd0,0x91,0xf1,0x01,
+		0x5f,0x63,0xf1,0x40,0x11,0xd4,0x01,0xfd,0x00,0x15,0x92,0xd0,0x01,0x04,0x2b,0x01,
+		0x2b,0x7f,0x03,0x28,0xc8,0x19,0x15,0x2b,0x15,0xb3,0x90,0x7d,0x15,0x64,0x90,0x15,
+		0x1a,0x80,0x00,0x15,0xb2,0x73,0xff,0x08,0x15,0x96,0x15,0xcc,0xe3,0xff,0x08,0xff,
+		0x50,0x15,0x96,0x17,0x2b,0x18,0x2b,0x19,0xfc,0x43,0x52,0x00,0x95,0xd0,0x01,0x13,
+		0x28,0xaa,0x0a,0xff,0x11,0x28,0xe0,0x82,0x04,0x28,0x42,0xd0,0x69,0x2c,0x03,0x50,
+		0xb3,0x11,0x24,0x30,0x30,0x23,0x76,0x69,0x91,0x7f,0xd0,0x01,0x08,0x2b,0x05,0x2b,
+		0x07,0xcd,0x90,0xcf,0x08,0x28,0x70,0xd8,0x9a,0xf2,0x06,0xb2,0x78,0x0f,0xef,0x04,
+		0x28,0x00,0xd0,0x01,0xbb,0xd0,0x01,0x20,0xe3,0x2b,0x20,0xd5,0xd0,0xb6,0x51,0x68,
+		0x71,0x02,0x2b,0x01,0x7f,0x28,0xff,0x7c,0x00,0x18,0xff,0x7f,0x00,0x30,0x55,0xbf,
+		0x00,0x70,0xdf,0x00,0xb0,0xef,0x00,0xf0,0xf7,0x01,0x30,0xf5,0xfb,0xbf,0xd0,0x02,
+		0xc0,0x10,0x01,0x00,0x18,0x7f,0xab,0xff,0x00,0xa0,0x30,0x00,0xbf,0x30,0x00,0x9f,
+		0xf0,0x00,0x2d,0x1a,0xdb,0xc0,0x1a,0x04,0x00,0xb0,0x02,0x00,0xf0,0xa2,0x31,0xbf,
+		0xc3,0x01,0x21,0x1a,0x00,0x04,0x00,0x30,0x08,0x5a,0x00,0x70,0x10,0x00,0xb0,0x20,
+		0x21,0xa3,0x30,0x21,0x03,0x70,0x29,0x21,0x05,0x70,0x6f,0x11,0x06,0x0a,0x30,0x05,
+		0xc3,0x30,0x6f,0xd2,0x04,0x25,0xd0,0x70,0x51,0x05,0x74,0xf2,0x00,0xf1,0xa5,0xf1,
+		0x00,0xf1,0x77,0x11,0x4a,0x01,0xf1,0x7f,0x01,0xf2,0x04,0x09,0x70,0x00,0x30,0xbf,
+		0x00,0x70,0xd5,0xdf,0x00,0xb0,0xef,0x00,0xf0,0xf7,0x01,0x30,0xfb,0x04,0x58,0xc5,
+		0x90,0x00,0x30,0xa9,0x70,0x7f,0xff,0xa9,0xb1,0x04,0x2a,0xd0,0x57,0x04,0x18,0xef,
+		0x00,0xb0,0xf7,0x00,0xf0,0xfb,0x01,0x30,0xfd,0xfd,0x01,0x70,0xfe,0xff,0x0e,0x2b,
+		0x0d,0x2b,0x55,0x0c,0xab,0xb0,0x0c,0x2c,0xd0,0x0c,0x65,0xb0,0x0c,0x7a,0x30,0x5f,
+		0x12,0x2b,0x11,0x2b,0x10,0x02,0x30,0x10,0x66,0xb0,0x9d,0x10,0x7b,0x30,0x15,0x2b,
+		0x14,0x0f,0x90,0x00,0x30,0xdf,0xaa,0x00,0x70,0xef,0x00,0xb0,0xf7,0x00,0xf0,0xfb,
+		0x01,0x30,0xfd,0x56,0x01,0x70,0xfe,0x14,0x0f,0x90,0x14,0xaf,0xd0,0x14,0xce,0xd0,
+		0x55,0x14,0xaf,0x90,0x14,0x0f,0x90,0x14,0x0f,0x90,0x14,0x65,0xd0,0xd1,0x14,0x7a,
+		0x50,0x1c,0x31,0x7c,0xf1,0x34,0x0b,0x14,0x19,0x2b,0x4a,0xd1,0x71,0x18,0x08,0xb0,
+		0x19,0x08,0xf0,0x7e,0x91,0x38,0xb2,0xf0,0xf7,0x1a,0x76,0x69,0x24,0xd0,0x7f,0x76,
+		0x9d,0x8d,0xff,0x7f,0x76,0xb4,0x86,0x7f,0x76,0xc1,0x89,0xf4,0xe5,0xd0,0x00,0x70,
+		0xad,0xe6,0x50,0x44,0x8a,0x7f,0x76,0xff,0x6e,0x8c,0x7f,0x76,0xe5,0x87,0xa9,0x20,
+		0xff,0x7f,0x76,0x9a,0x8d,0x30,0x29,0x69,0xff,0xd7,0x7f,0x76,0x51,0x01,0x10,0x15,
+		0x02,0xd0,0x22,0x8d,0xef,0xf9,0x6f,0x02,0xfe,0x83,0x11,0x30,0x40,0x41,0x57,0x2b,
+		0x08,0xef,0x3a,0x31,0x41,0x81,0xd0,0x30,0x0e,0x50,0x9d,0x05,0xe4,0xf0,0xc1,0x01,
+		0x30,0x18,0x70,0x01,0xf2,0xcc,0xdf,0x02,0x00,0xc0,0xff,0x08,0xb2,0x30,0xc1,0x01,
+		0xa5,0x31,0x10,0x30,0x41,0x6f,0xf0,0x02,0x13,0x31,0x1a,0x90,0x41,0xed,0x92,0xd5,
+		0x91,0x02,0xfe,0xeb,0xb1,0xee,0x94,0x41,0xf3,0x96,0x41,0xa9,0x90,0xa8,0x31,0x4e,
+		0x02,0xc4,0x92,0xbd,0x08,0x00,0xd0,0x00,0x8f,0xea,0x94,0xe7,0x12,0x92,0x03,0x05,
+		0x96,0xd8,0x31,0x8a,0x37,0x8a,0x12,0xbe,0x70,0x76,0xf5,0x80,0xd2,0xee,0x00,0xf4,
+		0x08,0x00,0xc2,0x01,0xf2,0x03,0x96,0x01,0xbf,0x9a,0x04,0x96,0x0f,0x96,0x0e,0x15,
+		0xb1,0x2b,0x3f,0x02,0x28,0x07,0x00,0x0b,0x2b,0xea,0x71,0xba,0xd3,0xfd,0x0a,0x18,
+		0x50,0x7f,0x76,0x89,0x87,0x7f,0x76,0x3b,0xae,0x87,0x0b,0x13,0x01,0x00,0x31,0x8e,
+		0x12,0xdf,0x71,0xe5,0x08,0xdf,0xb0,0x10,0xbe,0x12,0x03,0x71,0x04,0x2b,0x0f,0xe6,
+		0x03,0x90,0x02,0xfe,0x02,0xf1,0xbf,0x51,0x41,0x96,0x08,0xff,0x92,0x41,0x54,0x4c,
+		0xed,0x1b,0x0a,0x10,0x3b,0x0a,0x09,0xd2,0x10,0x0b,0x42,0x13,0x93,0xf4,0x07,0xb1,
+		0x7d,0x49,0xc1,0x12,0x03,0x92,0x45,0xed,0x10,0x93,0xb0,0x57,0x41,0x64,0x0b,0x29,
+		0x30,0x03,0xd4,0x70,0x3c,0x93,0x34,0xda,0x09,0xf1,0x29,0x02,0x34,0xf4,0xec,0x02,
+		0x31,0x30,0x64,0x7f,0x15,0x92,0x2e,0xec,0x15,0x2b,0x02,0x92,0xbc,0x9d,0xfb,0xcc,
+		0xf2,0x0b,0x2b,0x0d,0xc4,0x72,0xb2,0xd3,0x0b,0x92,0x92,0xb0,0x0b,0x92,0xb0,0xce,
+		0x91,0x12,0xc8,0xb0,0xb4,0x50,0x28,0xd7,0x32,0x00,0x0f,0xc6,0x92,0x15,0xda,0xd0,
+		0x08,0x6f,0xdd,0x05,0x09,0xb0,0x07,0xed,0x0b,0x27,0x10,0x09,0x2b,0x07,0x1b,0x0b,
+		0x03,0x0f,0xb0,0x77,0x93,0x92,0xd1,0xb7,0x52,0x92,0x5a,0x37,0x1a,0x96,0x41,0xf8,
+		0x90,0xae,0x87,0x15,0xf3,0xa3,0x70,0x8f,0xfe,0x0a,0x92,0x07,0xc4,0xb0,0x1b,0xb1,
+		0x8c,0x91,0x08,0xfe,0xc5,0x72,0x00,0x02,0x12,0x2b,0x46,0x1e,0x44,0xff,0x1e,0x52,
+		0x6f,0x20,0xcc,0x00,0x04,0xc9,0x37,0xff,0x0c,0xec,0xbf,0xf3,0x1b,0x85,0xc7,0xd2,
+		0x96,0xf0,0x3f,0x4d,0x02,0x22,0x03,0x0b,0x6f,0xc1,0x51,0xc8,0xd0,0x74,0x01,0x50,
+		0xd8,0x70,0xae,0xd8,0xd1,0x20,0x07,0x42,0x0a,0x52,0xff,0x00,0x8f,0x00,0xfa,0x42,
+		0x06,0x01,0x56,0xff,0x1e,0x00,0xa9,0xa8,0x1e,0x0f,0x03,0x63,0xff,0x1e,0xa8,0x0a,
+		0x6f,0x29,0xff,0x83,0xff,0xdf,0x1e,0x0f,0x06,0x65,0xaa,0x4b,0x90,0xab,0x28,0xff,
+		0x00,0x06,0x1e,0xa9,0x1e,0x06,0x30,0xff,0xff,0x6c,0xff,0x46,0x1e,0x42,0x06,0x46,
+		0xa3,0xff,0x31,0xff,0xac,0x10,0x44,0x1e,0x44,0x06,0x71,0x06,0xac,0xf0,0x3c,0x93,
+		0x25,0xb1,0xc3,0x01,0x22,0x3d,0x30,0xed,0x44,0xcb,0x90,0xa9,0x85,0x01,0xd1,0x03,
+		0x63,0x00,0xff,0x02,0xb4,0x6f,0x00,0x8f,0x78,0x0f,0xa9,0xf7,0xa8,0x44,0x0f,0xf8,
+		0x90,0xa8,0x44,0x92,0x69,0x4e,0x4e,0x92,0x17,0x96,0x86,0x0d,0x3f,0x0d,0x3a,0x14,
+		0x0d,0x37,0xab,0x08,0xca,0x0d,0x36,0x1d,0x0d,0x32,0x14,0x0d,0x32,0x26,0xaa,0x0d,
+		0x36,0x14,0x0d,0x32,0x1c,0x0d,0x32,0x24,0x0d,0x3c,0x1c,0xaa,0x0d,0x30,0x1c,0x0d,
+		0x30,0x1c,0x0d,0x34,0x1c,0x0d,0x38,0x1c,0x53,0xa9,0x1c,0x0d,0x3f,0x0d,0x37,0x08,
+		0x0d,0x36,0x08,0x0d,0x3f,0xd2,0x0d,0x3f,0x18,0x0d,0x3f,0x1a,0x7c,0x13,0x1a,0x77,
+		0x10,0xcb,0xaa,0x1a,0x76,0x1f,0x1a,0x72,0x13,0x1a,0x72,0x2a,0x1a,0x76,0x13,0xaa,
+		0x1a,0x72,0x1e,0x1a,0x72,0x28,0x1a,0x7c,0x20,0x1a,0x70,0x20,0xea,0x1a,0x70,0x20,
+		0x1a,0x74,0x20,0x1a,0x78,0x20,0xa9,0x20,0x94,0x1a,0x7f,0x1a,0x77,0x10,0x1a,0x76,
+		0x10,0x1a,0x7f,0x1a,0x7f,0x19,0xf8,0x1a,0x72,0x44,0xf1,0x35,0x91,0x04,0x92,0x08,
+		0xec,0x41,0xff,0x2d,0x01,0x9a,0x66,0xff,0x02,0xce,0x03,0x7f,0xec,0x01,0x9a,0x02,
+		0x6f,0x00,0x9a,0x42,0x51,0x5d,0x30,0xe6,0xf0,0x33,0x00,0x20,0xcc,0xf0,0x22,0x4b,
+		0x70,0xef,0x40,0x8f,0xa2,0x93,0x25,0x10,0x0d,0x28,0xff,0x9d,0x01,0x4c,0x10,0x05,
+		0x8e,0x1a,0x63,0x70,0x3b,0x70,0x2b,0xff,0x24,0x2b,0x26,0x2b,0x28,0x2b,0x2a,0x2b,
+		0xfd,0x2c,0x70,0xf0,0x30,0x2b,0x32,0x2b,0x34,0x2b,0xff,0x36,0x2b,0x38,0x2b,0x23,
+		0x2b,0x25,0x2b,0xdf,0x27,0x2b,0x29,0x2b,0x2b,0x72,0x70,0x2f,0x2b,0xff,0x69,0xff,
+		0x31,0x2b,0x33,0x2b,0x35,0x2b,0x5f,0x37,0x2b,0x39,0x2b,0x21,0x73,0x30,0x20,0xcd,
+		0x70,0xf7,0x06,0x00,0x06,0x4c,0xf0,0x40,0x02,0x44,0x97,0xff,0x43,0x96,0x42,0xa8,
+		0x00,0x8f,0xc0,0x90,0xff,0x14,0x92,0x46,0xa8,0x03,0xec,0x00,0x9a,0xff,0x2d,0x6f,
+		0x46,0x8a,0x01,0x02,0xa4,0x07,0xbf,0x46,0x1e,0xc4,0x28,0x3c,0x00,0x00,0xb5,0x43,
+		0x9f,0x92,0xc7,0xff,0xc4,0x96,0x00,0xd7,0x00,0xb7,0x44,0x7e,0x00,0xb0,0x42,0x83,
+		0x46,0x8a,0x43,0x0e,0x09,0x71,0xdf,0x43,0x0e,0x01,0x56,0x46,0x03,0x50,0xc4,0x28,
+		0xf7,0x3e,0x00,0x43,0xf1,0xd0,0x40,0x02,0x05,0x9c,0xbd,0x0c,0x49,0x70,0x14,0x96,
+		0x0d,0x2b,0x0f,0x55,0x40,0xfe,0xfb,0x50,0x41,0x2b,0x0f,0xec,0x0c,0x92,0x0d,0xfb,
+		0x54,0x0b,0xfa,0xd2,0xc0,0x90,0x0d,0x85,0x0d,0xfd,0x0a,0x4f,0x93,0x41,0x96,0x02,
+		0x6f,0x14,0x2b,0xd3,0x41,0x2b,0x52,0xb3,0x90,0xd1,0x10,0x4c,0x90,0x11,0x28,0xf9,
+		0x43,0x5e,0x92,0x5f,0x11,0x12,0x2b,0x13,0x28,0x0a,0xff,0x00,0x1a,0x28,0x50,0xc0,
+		0x1b,0x28,0x70,0x17,0x40,0x1c,0x2b,0x92,0x11,0x1a,0x91,0xd0,0x92,0x11,0xe9,0x91,
+		0xb5,0x32,0xdb,0x70,0x32,0xc7,0x70,0x23,0x76,0x94,0xd1,0x40,0xcf,0x02,0x16,0x2b,
+		0x08,0xf4,0xd1,0x04,0xb2,0x02,0xfe,0xff,0x1b,0xcc,0x00,0x1f,0x01,0x3b,0xc7,0xff,
+		0xbf,0x42,0x96,0x41,0x2b,0x09,0x6f,0x57,0x31,0x40,0xfd,0x92,0xff,0x71,0x17,0xc6,
+		0xc4,0x96,0x41,0x0a,0x85,0x42,0x4e,0x70,0xf6,0xff,0x90,0x03,0x50,0xf8,0x10,0x5a,
+		0xd1,0xbd,0xeb,0xb2,0x04,0x5f,0x90,0x49,0xcd,0xb0,0x3c,0x52,0x41,0xfe,0xf9,0x50,
+		0xc0,0x56,0xcb,0x00,0x0f,0x92,0x3e,0xef,0x52,0xc0,0x56,0xc7,0x89,0x90,0x0f,0x52,
+		0x44,0xbb,0x96,0x0d,0xf9,0xd2,0x40,0x92,0x44,0x5c,0xd2,0x41,0xff,0x9a,0xc4,0x74,
+		0x44,0x0a,0x44,0x92,0x0f,0xff,0x52,0xf5,0x64,0x41,0x92,0x01,0x9c,0xa9,0xfb,0x58,
+		0x40,0x06,0x10,0x41,0x59,0x03,0x56,0x95,0x7f,0x04,0x41,0x93,0x02,0x9d,0xa8,0x58,
+		0x07,0x11,0xff,0x9c,0xca,0xa9,0x88,0x03,0x56,0x94,0x08,0xff,0xa9,0x93,0xa6,0xcb,
+		0xa8,0x80,0x41,0x93,0xb9,0x03,0x01,0x70,0x00,0xf0,0x0c,0xa7,0xca,0x09,0x70,0x08,
+		0xff,0x04,0x00,0x42,0x92,0x5c,0xff,0xa9,0x93,0xff,0xce,0xff,0xa8,0x94,0x00,0x8f,
+		0x10,0x27,0xbf,0xa0,0xff,0xa8,0x28,0xf0,0xd8,0xde,0x75,0x12,0x18,0x4c,0x10,0x05,
+		0x75,0x05,0x53,0x41,0x59,0x05,0x7f,0x05,0x7f,0x05,0x7f,0x82,0x05,0x7b,0x13,0x05,
+		0x7f,0x05,0x7f,0x0a,0xff,0x0a,0xff,0x0a,0xfc,0x14,0xc6,0x0a,0xf4,0x41,0x59,0x10,
+		0x91,0x16,0xf1,0x10,0xb1,0x9c,0xca,0xef,0x43,0x96,0x43,0x40,0x74,0xb1,0x4e,0x02,
+		0x0f,0xbe,0x58,0x10,0x7f,0x76,0xc3,0x87,0x04,0x5f,0x72,0x0f,0x4f,0x2b,0x43,0x41,
+		0x06,0x76,0x30,0x8c,0xd1,0x40,0x73,0xd2,0xfe,0x50,0x31,0x40,0x00,0x43,0x42,0x04,
+		0xef,0x21,0x6e,0x9a,0xd0,0x03,0x6f,0x22,0x9b,0x30,0x43,0x43,0x00,0xd1,0xfb,0x00,
+		0x40,0x00,0xd1,0x00,0x40,0x84,0xfe,0xbe,0xb9,0x8b,0x75,0x91,0x23,0x71,0x10,0x52,
+		0x0f,0x19,0x13,0x91,0xb6,0x75,0xf5,0xc1,0x01,0x25,0x70,0x0a,0x19,0x5f,0x90,0x10,
+		0xf7,0x52,0xf3,0x64,0x78,0x31,0x08,0xfe,0x46,0xa0,0xf7,0x44,0xa8,0x41,0x2d,0x11,
+		0x9b,0xc4,0x92,0xa9,0xff,0x95,0x47,0x96,0x47,0x97,0x44,0x8a,0x01,0xf3,0x3b,0xa9,
+		0x1c,0x33,0x2d,0xf0,0x47,0x92,0x14,0x52,0xbf,0x02,0xed,0x47,0x2b,0x47,0x92,0x2c,
+		0xd0,0x96,0xfd,0x88,0x7b,0x70,0x06,0xfe,0x42,0xa8,0xc4,0x92,0xfe,0x32,0xf0,0x8a,
+		0xc4,0x92,0x44,0x96,0x46,0x2b,0x5d,0x46,0x02,0x10,0x16,0x63,0x42,0x03,0x50,0x46,
+		0x7c,0x72,0xff,0xc4,0x92,0x45,0x96,0x43,0x92,0x45,0x54,0xd7,0x03,0x65,0x45,0x02,
+		0x50,0x44,0x00,0x91,0x63,0x45,0xfa,0x02,0x91,0x0a,0x02,0x91,0xec,0x64,0x00,0x9a,
+		0x44,0xff,0x93,0x43,0x9f,0x02,0x53,0x02,0x62,0x01,0x35,0x9a,0x5a,0x93,0x45,0xf1,
+		0x70,0x3c,0x00,0x25,0xf1,0xfd,0xb2,0xf7,0x91,0x16,0x92,0x26,0x11,0x5c,0xff,0x42,
+		0x2b,0xff,0x43,0x96,0x41,0x58,0x41,0x0a,0x43,0x92,0xdf,0x0f,0x90,0x41,0x9c,0x94,
+		0x00,0xb4,0xa3,0xff,0x48,0x00,0xd1,0xff,0x71,0x01,0x15,0xa7,0x01,0x12,0x01,0xf5,
+		0xab,0x00,0xd4,0x01,0x1a,0x23,0xb0,0x03,0xff,0x03,0xf5,0x03,0xbf,0x03,0xb5,0x7e,
+		0x92,0x06,0xd0,0xa1,0x17,0x03,0xff,0x03,0xff,0x07,0xbf,0x09,0xb2,0x40,0x09,0xb0,
+		0x10,0xfe,0xf6,0x72,0x02,0x40,0x42,0x96,0x03,0xee,0x42,0xf6,0xaa,0x70,0x02,0x41,
+		0x00,0x71,0x40,0x00,0x02,0x42,0xc6,0x00,0xf1,0x20,0x00,0x0d,0x91,0x36,0x70,0x0d,
+		0x74,0x94,0x28,0xf5,0x41,0x01,0x10,0x94,0x42,0xf0,0x7f,0x76,0x5b,0x8b,0xfc,0xcb,
+		0x92,0x3a,0x10,0xc7,0xff,0xfb,0xed,0x14,0xcc,0xdf,0x40,0x00,0xc5,0xff,0xfd,0x94,
+		0xb0,0xc3,0x01,0x75,0x35,0xba,0x50,0x32,0xc1,0x30,0x69,0xff,0x36,0xba,0xf0,0xf9,
+		0x84,0x91,0xb2,0x3d,0x90,0x92,0x19,0xec,0x08,0x92,0xff,0x0c,0xec,0x14,0x2b,0x00,
+		0x8f,0xae,0x94,0xbf,0x7f,0x76,0x25,0x8e,0x00,0x9b,0x00,0x93,0xf1,0x2b,0x89,0x05,
+		0x8e,0xd0,0x85,0x9d,0x50,0xb2,0x05,0x30,0x40,0x31,0xaa,0xff,0xb1,0x0d,0x40,0x74,
+		0xdd,0x45,0x34,0x41,0x44,0xf3,0x28,0x5f,0x06,0x00,0x13,0x28,0xb6,0x45,0x14,0x61,
+		0x45,0x1f,0x2c,0x45,0x10,0x9d,0xd1,0x40,0x02,0x44,0x75,0xdd,0x44,0x74,0x53,0x70,
+		0xf5,0x91,0x44,0x93,0x11,0xa0,0x50,0x40,0x02,0x0b,0x58,0xde,0xd4,0x91,0x64,0x9b,
+		0x17,0xc6,0x10,0x93,0x0b,0x0a,0x7f,0x0b,0x92,0xff,0x00,0x37,0x8e,0x0b,0x45,0x94,
+		0xf5,0xee,0x45,0x92,0x0a,0x45,0x94,0x02,0xfe,0x20,0x52,0xff,0x41,0x96,0x03,0xed,
+		0x00,0x9a,0x06,0x6f,0xff,0x39,0x52,0x03,0x69,0xc9,0x9c,0x02,0x6f,0xbb,0xd0,0x9c,
+		0xa2,0x13,0x42,0xa8,0xcc,0x8a,0x50,0xb2,0xbf,0x8c,0x42,0x8a,0xa9,0x88,0xc4,0x00,
+		0x92,0x03,0xdf,0x56,0xa9,0x04,0xa6,0x94,0xa3,0xf3,0x2b,0x6f,0xdd,0x06,0x44,0x50,
+		0xc0,0x91,0x94,0x52,0xd0,0x06,0x0a,0xef,0x06,0x92,0x64,0x9b,0x06,0x51,0x06,0x96,
+		0x19,0xef,0x6f,0x07,0x2b,0x12,0x99,0xf0,0x1b,0x6f,0x12,0xdc,0x11,0x90,0x9a,0x91,
+		0x12,0x2b,0x15,0x00,0xb0,0x13,0xec,0xf7,0x07,0x58,0x41,0x90,0xf0,0x1c,0x90,0x14,
+		0x9b,0xdf,0x94,0x96,0x07,0x0a,0x07,0x09,0x52,0x07,0x96,0xff,0x07,0x6f,0x41,0x92,
+		0x0a,0x52,0xe6,0xec,0xdf,0x0d,0x52,0xe8,0xec,0xed,0x0c,0x13,0x92,0x06,0x7f,0x54,
+		0x03,0xec,0x09,0x92,0xd0,0xec,0xa7,0xf3,0xdd,0x40,0x2a,0x10,0x01,0x00,0x09,0x86,
+		0xf0,0x1d,0x90,0xff,0x7f,0x76,0xbf,0x8c,0x10,0x96,0x1c,0x92,0xff,0x11,0x96,0x05,
+		0x6f,0x1c,0x92,0xbf,0x9c,0xef,0x02,0x52,0xf5,0x69,0x18,0x73,0x0a,0x92,0x09,0xfb,
+		0xec,0x0a,0xa5,0xd0,0xce,0x8c,0x09,0x92,0x04,0x3f,0xec,0x7f,0x76,0x03,0x8d,0x09,
+		0xa7,0x92,0x5f,0xd0,0x0f,0x92,0x0e,0xed,0x18,0xb5,0xb0,0x19,0x91,0x66,0xf1,0x00,
+		0xb1,0xdd,0xf1,0x9f,0x10,0x69,0xec,0x05,0xa4,0x70,0x04,0x92,0xc7,0x41,0xec,0x04,
+		0xd9,0xf0,0x97,0xb3,0x68,0xf1,0xc1,0xff,0xff,0x03,0x96,0x05,0x92,0x36,0xec,0x03,
+		0x92,0xff,0x0a,0xec,0x15,0x92,0x02,0x52,0x07,0xec,0xdf,0x03,0x52,0x05,0xec,0x02,
+		0xa7,0x30,0x15,0x28,0xf7,0x02,0x00,0x03,0x9a,0x90,0x15,0x92,0x01,0x52,0xfd,0x04,
+		0x72,0x70,0x15,0x96,0x02,0x96,0x00,0x92,0xff,0x21,0xec,0x11,0x92,0x15,0x28,0x03,
+		0x00,0xff,0x00,0x2b,0x41,0x52,0x07,0xed,0x18,0xc4,0xff,0x00,0x8f,0xb8,0x94,0xa9,
+		0xa8,0xa6,0x0f,0x5f,0x13,0xed,0x11,0x92,0x42,0x01,0x14,0xc4,0x01,0x12,0x5d,0x0a,
+		0x01,0x10,0x43,0x52,0x09,0x02,0x32,0xd0,0x02,0x32,0xfd,0x03,0x05,0x72,0x02,0x92,
+		0x23,0xec,0x02,0x2b,0xdd,0x18,0x95,0x10,0xdc,0x94,0x13,0x95,0x70,0xb8,0x94,0xdd,
+		0x10,0x95,0xd0,0xc4,0x94,0x0d,0x96,0x30,0xd0,0x94,0xff,0x0a,0x6f,0x11,0x92,0x41,
+		0x52,0xf5,0xec,0xff,0x42,0x52,0xf6,0xec,0x43,0x52,0xf7,0xec,0xff,0x00,0x8f,0xa2,
+		0x94,0x18,0xa8,0x09,0x6f,0xbe,0x08,0x51,0xe7,0xec,0x02,0x52,0xf8,0x09,0xf0,0xef,
+		0xef,0xec,0xf5,0x6f,0x05,0xb6,0x90,0xbd,0x96,0x12,0x39,0x76,0xbd,0xd1,0xdd,0x31,
+		0x22,0x00,0x06,0xfc,0xb0,0xe0,0xd0,0xfe,0xf8,0x30,0xff,0xfd,0x38,0x92,0x42,0x96,
+		0x39,0xaa,0x00,0x30,0x3a,0x00,0x70,0x3b,0x00,0xb0,0x3c,0x00,0xf0,0x3d,0xea,0x01,
+		0x30,0x3e,0x01,0x70,0x3f,0xae,0x50,0xc0,0x01,0x42,0xbf,0x96,0x29,0x28,0xe8,0x00,
+		0x22,0x0e,0x30,0x21,0xfd,0x28,0xc2,0x70,0x2b,0x41,0x1b,0x00,0x04,0x07,0xdb,0x67,
+		0xff,0xf0,0x50,0x41,0x0a,0x00,0xb1,0xfb,0x68,0x3e,0x02,0x51,0x1a,0x2b,0x1b,0x2b,
+		0x1c,0xff,0x90,0x00,0x30,0xd5,0x10,0x00,0x70,0x08,0x00,0xb0,0x04,0x00,0xf0,0x01,
+		0x1c,0xea,0xe0,0x90,0x1c,0xe0,0x50,0x1c,0xe0,0x50,0x1e,0x28,0xfc,0xc7,0x00,0x1f,
+		0x2b,0xce,0xb1,0xc6,0xb1,0x82,0xb1,0x06,0x00,0xff,0x00,0x52,0xa4,0xc5,0x07,0xec,
+		0xff,0x9c,0xff,0xa9,0x88,0x85,0x92,0x87,0x96,0x0e,0x00,0xe1,0xfe,0xf5,0x50,0x01,
+		0x3f,0x02,0x7f,0x02,0x71,0x5a,0xff,0xa4,0xdf,0xc5,0xa4,0x8e,0xab,0x92,0x03,0xfb,
+		0xab,0x92,0xff,0xa9,0x88,0xa9,0xa9,0xa6,0x0f,0x0f,0xec,0xff,0xaa,0x93,0x0d,0xec,
+		0xff,0x9d,0xa8,0x5c,0xcf,0xbf,0x76,0xfe,0xff,0x05,0xd5,0x06,0x51,0x0c,0x00,0xef,
+		0xf8,0xff,0xa0,0x8a,0x07,0xb0,0x02,0x01,0xd5,0xff,0x01,0x19,0xa6,0x1e,0x81,0xdc,
+		0xa9,0xa8,0xff,0xa5,0x0d,0xa9,0x8a,0x01,0xde,0xc4,0x92,0xff,0xfb,0xed,0xa6,0x06,
+		0x06,0x00,0xa6,0x97,0xff,0x00,0x9b,0x0f,0xf6,0xa6,0x1f,0x20,0x76,0xfe,0x00,0x95,
+		0xa8,0x92,0x20,0x76,0xf1,0x00,0x3f,0xff,0x00,0x3d,0x8e,0xff,0xff,0xc0,0x92,0x00,
+		0x4e,0x00,0x00,0xfe,0xff,0xc2,0x00,0x72,0x00,0x91,0xc4,0x00,0x96,0x5d,0xa6,0x01,
+		0xb0,0x90,0x80,0x3f,0x0c,0x70,0xa8,0x00,0x94,0xdf,0xff,0xff,0x40,0x93,0x00,0xf2,
+		0x20,0xff,0xff,0x55,0x41,0x00,0x70,0x00,0x00,0xf0,0x42,0x00,0x74,0x43,0x00,0xf4,
+		0x55,0x44,0x01,0x74,0x45,0x02,0x74,0x46,0x02,0x74,0x47,0x02,0xf4,0x55,0x48,0x03,
+		0x74,0x49,0x03,0xf4,0x4a,0x04,0xf4,0x4b,0x04,0xf4,0x75,0x4c,0x05,0xf4,0x4d,0x05,
+		0xf2,0xfe,0xff,0x4e,0x06,0x72,0xea,0x0a,0x11,0x50,0x00,0x96,0x52,0x01,0x34,0xff,
+		0xff,0x92,0xaa,0x08,0x54,0x93,0x08,0xd4,0x94,0x09,0x54,0x95,0x0a,0x54,0x96,0xaa,
+		0x0a,0x54,0x97,0x0a,0xd4,0x98,0x0b,0x54,0x99,0x0b,0xd4,0x9a,0xaa,0x0c,0x54,0x9b,
+		0x06,0xd4,0x9c,0x06,0xd6,0x9e,0x07,0x76,0xa0,0x96,0x06,0xd6,0x00,0x90,0x0f,0x33,
+		0x01,0x00,0x70,0x10,0x31,0x02,0xaa,0x00,0xf4,0x04,0x01,0x74,0x05,0x01,0x74,0x06,
+		0x02,0x74,0x07,0xaa,0x02,0xf4,0x09,0x03,0x74,0x0a,0x03,0xf4,0x0b,0x04,0x74,0x0c,
+		0xaa,0x04,0xf4,0x0d,0x05,0x74,0x0e,0x05,0xf4,0x0f,0x06,0x74,0x10,0xaa,0x06,0xf4,
+		0x11,0x07,0x74,0x12,0x07,0xf4,0x13,0x08,0x74,0x14,0xba,0x08,0xf4,0x15,0x09,0x72,
+		0xfe,0xff,0x18,0x09,0xf0,0xa2,0x65,0x94,0x1c,0xd1,0x1a,0x0a,0x92,0x1d,0x91,0x50,
+		0x01,0x01,0x30,0x1f,0x93,0x35,0x86,0x3f,0x00,0x00,0x3f,0x01,0x3f,0x02,0x79,0x5f,
+		0x18,0x81,0x3f,0x00,0x1d,0x00,0x30,0x22,0x00,0x70,0x55,0x27,0x00,0xb0,0x2c,0x00,
+		0xf0,0x31,0x01,0x30,0x36,0x01,0x70,0x55,0x3b,0x01,0xb0,0x40,0x01,0xf0,0x45,0x02,
+		0x30,0x4a,0x02,0x70,0x55,0x4f,0x02,0xb0,0x54,0x02,0xf0,0x59,0x03,0x30,0x5e,0x03,
+		0x70,0x55,0x63,0x03,0xb0,0x68,0x03,0xf0,0x6d,0x04,0x30,0x72,0x04,0x70,0x55,0x77,
+		0x04,0xb0,0x80,0x04,0xf0,0x3a,0x08,0x70,0x89,0x05,0x70,0xf5,0xa1,0x05,0xb0,0xb9,
+		0x05,0xf0,0x0c,0x83,0x3f,0x00,0x55,0x15,0x00,0x30,0x1e,0x00,0x70,0x27,0x00,0xb0,
+		0x30,0x00,0xf0,0x7d,0x39,0x01,0x30,0xb3,0x84,0x3f,0x00,0xbc,0x00,0x30,0xa9,0xc5,
+		0x00,0x70,0x03,0x31,0xce,0x00,0xf0,0xd7,0x01,0x30,0xe0,0xaa,0x01,0x70,0xe9,0x01,
+		0xb0,0xf2,0x01,0xf0,0xfb,0x02,0x30,0x04,0x55,0x85,0x05,0x33,0x0d,0x00,0x70,0x16,
+		0x00,0xb0,0x1f,0x00,0xf0,0xa5,0x28,0x01,0x30,0x31,0x01,0x71,0x01,0xb0,0x43,0x01,
+		0xf4,0x4c,0xaa,0x02,0x70,0x55,0x02,0xb0,0x5e,0x02,0xf0,0x67,0x03,0x30,0x70,0xaa,
+		0x03,0x70,0x79,0x03,0xb0,0x82,0x03,0xf4,0x8b,0x04,0x70,0x94,0x14,0x04,0xb4,0x0a,
+		0x31,0x9d,0x05,0x70,0xa6,0x00,0xf8,0x00,0x7f,0x01,0xbf,0x54,0x02,0xbf,0x04,0xf7,
+		0xaf,0x0a,0x70,0xdc,0x0a,0xb0,0xe9,0x0a,0x71,0x0a,0x18,0xb0,0x23,0x18,0xf0,0x2c,
+		0x05,0xbf,0x06,0xff,0x07,0xff,0x09,0x3f,0xfc,0x0a,0x3f,0x0b,0x7e,0x47,0x00,0x52,
+		0x00,0x49,0x00,0x7f,0x50,0x00,0x5f,0x00,0x31,0x00,0x2e,0x00,0x32,0x5d,0x30,0x3e,
+		0xe2,0x4f,0x00,0x53,0x01,0x38,0x31,0x40,0x22,0x48,0x02,0xbf,0x01,0x7f,0x04,0x33,
+		0x32,0x02,0xff,0x05,0xf2,0x33,0x04,0x7c,0xa9,0x30,0x06,0xf2,0x07,0x35,0x64,0x47,
+		0x00,0x02,0x47,0x40,0x03,0xd2,0x44,0x70,0x01,0x00,0x50,0x00,0xd1,0x02,0x48,0xd0,
+		0x00,0x80,0x3f,0x7f,0x00,0x01,0x81,0x00,0x00
+		};
+
+		//Same image as FalconFirmwareBinaryTest.h, 7324 bytes, CRC32 0x6e9b1d39
+		const uint8_t TEST_IMAGE[] = {
+		0xf7,0xaa,0x08,0x00,0x00,0x0c,0x3f,0x00,0x02,0x80,0xfb,0x8a,0x0c,0x00,0x51,0xad,
+		0x28,0x00,0x04,0x69,0xff,0xff,0x1f,0x56,0x16,0x56,0x1a,0x56,0x40,0xff,0x29,0x1f,
+		0x76,0x00,0x00,0x02,0x29,0x1b,0xff,0x76,0x22,0x76,0xa9,0x28,0x8c,0x8c,0xa8,0xff,
+		0x28,0x3f,0x00,0x01,0x09,0x1b,0x61,0xff,0xff,0x76,0x8c,0x8c,0x04,0x29,0x0f,0x6f,
+		0x00,0xff,0x9b,0xa9,0x24,0x01,0xdf,0x04,0x6c,0x04,0xfb,0x29,0xa8,0x00,0x70,0xa6,
+		0x1e,0xa1,0xf7,0x86,0xff,0x24,0xa7,0x06,0xa1,0x81,0x01,0x09,0xa7,0xff,0x1e,0xa9,
+		0x24,0x03,0x63,0x5c,0xff,0x04,0xff,0x3b,0xa9,0x59,0x01,0xdf,0x09,0x00,0xec,0xbb,
+		0xff,0x1a,0x04,0x10,0xff,0xff,0xa8,0x00,0x30,0x01,0xfb,0x09,0x0e,0x04,0x10,0xff,
+		0xff,0x06,0x6f,0x01,0xff,0xdf,0xbd,0xc3,0xa7,0x1e,0x67,0x3e,0xbe,0xfd,0xc5,0x04,
+		0x71,0xa8,0x24,0x58,0xff,0xf7,0x60,0xff,0x7f,0x76,0x99,0x80,0x7f,0x76,0x46,0x80,
+		0xff,0xbd,0xb2,0x1f,0x76,0x02,0x00,0xbd,0xaa,0xef,0x34,0xc5,0x67,0x3e,0x08,0x51,
+		0x00,0x59,0xa1,0xff,0x92,0x10,0xec,0x01,0x3b,0x00,0x8f,0x40,0xff,0x00,0x03,0x56,
+		0xa1,0x01,0x01,0x56,0xa4,0xbf,0x00,0xa4,0x86,0x82,0xda,0xc2,0x01,0xf0,0xa1,0x7f,
+		0x92,0xff,0x9c,0xa9,0x59,0xfa,0xed,0x0a,0xd2,0xa7,0x06,0x03,0xec,0x05,0x31,0x0b,
+		0x91,0x04,0x00,0xb4,0x00,0xf7,0x77,0x00,0x6f,0x04,0xd2,0xb2,0x34,0xc5,0xa4,0x7d,
+		0x8b,0x04,0xf4,0x92,0x20,0x52,0x07,0x64,0x06,0x31,0xbd,0x32,0x06,0x10,0x01,0x9a,
+		0x0f,0x6f,0x05,0xb5,0x00,0xde,0x05,0xb2,0xc4,0xb2,0x00,0x0a,0x01,0xd5,0x00,0x9a,
+		0xff,0xbe,0x8b,0x06,0x00,0x00,0x6f,0x06,0x00,0xd6,0x09,0x31,0x34,0xa8,0x00,0x73,
+		0x32,0x00,0x70,0x3f,0x8f,0xf7,0xff,0xff,0x7f,0x00,0x30,0xa9,0xa8,0xa5,0x0f,0xff,
+		0x04,0xed,0x00,0xd4,0x00,0xbe,0x07,0x6f,0xfe,0x01,0x31,0xc4,0x88,0x02,0x02,0xa4,
+		0x07,0xa9,0xff,0x8a,0xa6,0x92,0x7f,0x76,0x65,0x86,0x06,0xff,0x00,0x02,0xfe,0x41,
+		0x2b,0x41,0x92,0x06,0x57,0x52,0x14,0x63,0x0c,0x11,0xa6,0x0c,0x10,0x41,0x0c,0x12,
+		0xff,0x00,0x02,0xc4,0x1e,0x41,0x85,0x00,0x8f,0xbb,0xa0,0x00,0x07,0x32,0x2b,0x41,
+		0x0a,0x02,0x51,0xee,0xfe,0x09,0x70,0xc4,0x01,0x00,0x1a,0x00,0x40,0x14,0xff,0xf6,
+		0x00,0x77,0x18,0x28,0xc2,0x00,0x69,0xff,0xff,0xa9,0x28,0xb0,0x36,0x7f,0x76,0x37,
+		0xfd,0x85,0x01,0x91,0x18,0x1a,0x20,0x00,0x28,0x9a,0xfe,0x00,0xd5,0x02,0x28,0x05,
+		0x00,0x03,0x18,0xf0,0xff,0xff,0x03,0xcc,0x0f,0xff,0x10,0x50,0x03,0xff,0x96,0x03,
+		0xcc,0xff,0xf0,0xa9,0x1a,0x00,0xf5,0x02,0x00,0x92,0x0f,0x00,0x90,0x30,0x03,0x96,
+		0x04,0xbf,0xcc,0xf0,0xff,0x04,0x50,0x04,0x00,0x70,0x0f,0xfb,0xff,0x50,0x00,0x70,
+		0x00,0x28,0x90,0x0f,0x01,0xff,0x28,0x00,0x88,0x1f,0x76,0x33,0x00,0x22,0xfe,0x04,
+		0xd0,0x23,0x76,0x01,0x00,0x82,0xfe,0x06,0xff,0x00,0x22,0x76,0xc0,0xb9,0x29,0x28,
+		0x68,0xef,0x00,0x1a,0x76,0x7f,0x21,0x10,0x1b,0x76,0x42,0x7f,0x29,0x16,0x56,0x25,
+		0x76,0x00,0x6f,0x00,0x9f,0x00,0x01,0x3f,0x02,0x7f,0x03,0xbf,0x04,0xff,0x06,0x3f,
+		0x06,0xdf,0x08,0x1f,0x09,0x5f,0x78,0x0a,0x9f,0x0b,0xd3,0x0e,0x11,0x21,0x28,0x01,
+		0x00,0x01,0x1f,0xfe,0x0d,0x73,0x05,0x00,0xbd,0xa8,0xbd,0xa0,0xbd,0x7f,0xc2,0xbd,
+		0xc3,0xbd,0xab,0x69,0xff,0x03,0x19,0xff,0x7f,0x76,0x06,0x87,0xbe,0x87,0xbe,0xc5,
+		0xff,0xbe,0xc4,0xbe,0x83,0xbe,0x8a,0x03,0x00,0x0f,0x17,0x76,0x02,0x76,0x02,0xff,
+		0x02,0xff,0x02,0xff,0x05,0xf5,0xfb,0x04,0xfe,0x06,0x1b,0x1f,0x76,0xd4,0x01,0x04,
+		0xd7,0x18,0xbf,0xff,0x1e,0xd1,0x01,0x1e,0xd0,0x19,0x1a,0xdf,0x10,0x00,0x08,0x92,
+		0xc3,0x00,0xf0,0x02,0x00,0xab,0x20,0x96,0x20,0x31,0x09,0x00,0xd4,0x21,0x00,0xd2,
+		0x0a,0xaa,0x01,0xb4,0x22,0x01,0xb2,0x0b,0x02,0x94,0x23,0x02,0x92,0x0c,0xda,0x03,
+		0x74,0x24,0x03,0x72,0x0d,0x92,0x33,0xd1,0xc3,0xff,0xfd,0x25,0x04,0x50,0x02,0x00,
+		0x0a,0x92,0x26,0xec,0xde,0x34,0xd1,0x14,0x28,0xd0,0x07,0x35,0x51,0x0b,0x2b,0xfc,
+		0x01,0x52,0x00,0x50,0x03,0x00,0x04,0x92,0x23,0xec,0x5f,0x04,0x2b,0x43,0x2b,0x43,
+		0x29,0xd0,0x0f,0x29,0xd6,0xfd,0x43,0x35,0xf2,0x40,0x8f,0x00,0x08,0xc4,0xa0,0xeb,
+		0x43,0x0a,0x01,0xb1,0xf3,0x32,0xb2,0x1e,0x2b,0x0c,0x7e,0x34,0x92,0x14,0x0b,0x08,
+		0xed,0x01,0x9a,0x04,0xb2,0x78,0x0a,0x70,0x04,0x50,0x06,0x72,0x1f,0x92,0x3a,0xec,
+		0x04,0x93,0xee,0x2e,0x77,0x43,0x01,0x40,0x2d,0xd4,0x43,0x85,0x01,0x6f,0x56,0xa5,
+		0x00,0xc5,0x00,0x50,0xc4,0x00,0x05,0x33,0xfc,0x2e,0x71,0x05,0x30,0x0a,0x1e,0x92,
+		0x80,0x52,0x23,0xf5,0x64,0x08,0x33,0x15,0x08,0x3c,0xc4,0xc4,0xac,0x28,0xff,0x19,
+		0x00,0xa6,0x06,0x45,0xff,0x22,0x56,0xbf,0xa6,0x07,0x46,0xff,0xc4,0x1e,0x08,0xf3,
+		0xed,0xfe,0x3b,0xb2,0x1f,0x2b,0x07,0x6f,0x7f,0x76,0x61,0xef,0x87,0x7f,0x76,0xca,
+		0x00,0x30,0x33,0x88,0x84,0x21,0xfe,0x1b,0x1f,0x20,0x5f,0x21,0x7f,0x22,0x97,0x02,
+		0x01,0x1f,0x02,0x3f,0x7c,0x23,0xbf,0x23,0xb6,0xd0,0x01,0x2f,0x28,0x80,0x42,0x70,
+		0x7c,0x04,0xb3,0x1e,0x11,0x01,0x2b,0x04,0x1a,0x40,0x43,0x90,0xf7,0xd0,0x01,0x05,
+		0x19,0x52,0x16,0x54,0x14,0x63,0xee,0x4d,0xb1,0x05,0x2b,0x00,0x3c,0x30,0x9c,0x88,
+		0x00,0xeb,0x52,0x67,0x19,0xd2,0x0f,0x19,0x52,0x08,0x18,0xfe,0xce,0x1f,0xf2,0x01,
+		0x2b,0x5c,0x4b,0x30,0x03,0x37,0x55,0x65,0xc8,0x03,0x32,0x2c,0x90,0x03,0x55,0x4c,
+		0x03,0x53,0x4a,0x52,0x08,0x40,0xff,0x1e,0xee,0x1f,0x76,0xc3,0x01,0x24,0xcc,0x75,
+		0x10,0x1f,0x50,0x3f,0x1e,0xd2,0x01,0x92,0x3b,0x51,0x10,0xfe,0x05,0x70,0x92,0x32,
+		0x52,0x03,0x63,0x0f,0x2b,0xe5,0x34,0x50,0x32,0x01,0x27,0x72,0x06,0xd6,0x1a,0x01,
+		0x00,0x69,0x28,0x51,0xb0,0x03,0x95,0x1c,0x03,0x94,0x07,0xed,0x02,0x77,0x39,0x18,
+		0x53,0xb2,0x04,0x51,0x13,0x64,0x32,0x1f,0x30,0x0c,0x70,0x2a,0x25,0x52,0x16,0x25,
+		0xb2,0x02,0x0a,0xf0,0x07,0x02,0x13,0x25,0x52,0x51,0x01,0x25,0xb0,0x0e,0x96,0x2c,
+		0x30,0xd4,0x0f,0x54,0x17,0x0f,0x54,0x57,0x07,0x2b,0x01,0x0f,0x54,0x66,0x29,0x32,
+		0x0e,0x0f,0x54,0x9d,0xfd,0x2f,0x52,0x00,0x2b,0x5b,0x5a,0x90,0x03,0x37,0x54,0xad,
+		0x65,0x26,0x53,0x07,0x96,0x0f,0x39,0x0e,0x0f,0x33,0x41,0xae,0x0f,0x35,0x04,0x00,
+		0xc1,0x0f,0x34,0x00,0x0f,0x34,0x0e,0xca,0x0f,0x32,0x0e,0x0f,0x34,0x00,0x0f,0x34,
+		0x06,0xb4,0x1a,0x02,0x08,0x0f,0x36,0x03,0x91,0x0f,0x33,0x00,0x0f,0x30,0x02,0x77,
+		0x0f,0x33,0x04,0x51,0x28,0x0f,0x33,0x0c,0x50,0x34,0x92,0x17,0x0f,0x34,0xfd,0x0f,
+		0x34,0x0b,0xd3,0x09,0x00,0x34,0xf0,0x0e,0x76,0x96,0x43,0x3f,0x25,0xdf,0x26,0xff,
+		0x28,0x1f,0x02,0x4b,0xd7,0x04,0x01,0x1f,0x02,0x3f,0x03,0x5f,0x04,0x7f,0x05,0x9f,
+		0x06,0xbf,0x02,0x52,0x9e,0x08,0x01,0x1f,0x02,0x3f,0x03,0x5f,0x04,0x7f,0x05,0x9f,
+		0x06,0xbf,0x02,0x5a,0x7e,0x10,0x01,0x1f,0x02,0x3f,0x03,0x5f,0x04,0x7f,0x05,0x9f,
+		0x06,0xbf,0x82,0x62,0x5e,0x20,0x01,0x1f,0x02,0x3f,0x03,0x5f,0x65,0xbf,0x65,0xba,
+		0x00,0xff,0x01,0x1f,0x76,0xc1,0x01,0x15,0xcc,0x80,0xff,0x00,0xc6,0xff,0x0a,0xec,
+		0x11,0x18,0xdf,0xfb,0xff,0x11,0x7d,0x10,0x1b,0x18,0xff,0xdf,0x1b,0x6f,0x1a,0x00,
+		0x20,0x03,0x4d,0x10,0x02,0x89,0x02,0x11,0xc6,0x00,0xd0,0x40,0x1b,0x43,0xb0,0x68,
+		0x5f,0x6d,0x93,0xc1,0x01,0x21,0x1a,0x45,0x92,0x05,0x33,0x69,0xff,0x07,0x3d,0xdd,
+		0x07,0x3f,0x07,0x38,0x23,0x5b,0x8b,0x02,0x11,0x07,0x3f,0x54,0x7b,0xdd,0x07,0x3f,
+		0x76,0x78,0xe3,0x00,0x01,0x77,0x9d,0x01,0x19,0x84,0x9b,0x00,0x9b,0x8f,0xfe,0x8d,
+		0xd0,0x01,0x19,0xc2,0x56,0xfd,0xff,0x06,0x9d,0x00,0x64,0xd1,0xd0,0x01,0x09,0x43,
+		0x12,0x00,0x51,0xd0,0xff,0x01,0x2c,0x2b,0x2d,0x2b,0x2e,0x2b,0x2f,0x0a,0xa3,0x50,
+		0x30,0xa3,0x90,0x31,0xa3,0xd0,0x72,0xf1,0x01,0x5f,0x57,0x31,0xfa,0x38,0x13,0x00,
+		0x15,0x92,0xd0,0x01,0x04,0x2b,0x01,0xff,0x2b,0x03,0x28,0xc8,0x19,0x15,0x2b,0x15,
+		0xfa,0x92,0x90,0x15,0x57,0xd0,0x15,0x1a,0x80,0x00,0x15,0xfe,0x91,0x73,0x08,0x15,
+		0x96,0x15,0xcc,0xe3,0xff,0xff,0x08,0x50,0x15,0x96,0x17,0x2b,0x18,0x2b,0xf9,0x19,
+		0x3b,0xb2,0x00,0x95,0xd0,0x01,0x13,0x28,0xaa,0xff,0x0a,0x11,0x28,0xe0,0x82,0x04,
+		0x28,0x42,0x53,0xd0,0x2c,0x03,0x50,0x92,0x11,0x24,0x30,0x30,0x23,0x6d,0xf1,0xbe,
+		0x5d,0xd0,0x08,0x2b,0x05,0x2b,0x07,0xac,0x90,0x08,0xe7,0x28,0x70,0xd8,0x7b,0xf2,
+		0x06,0xb2,0x78,0x0f,0x04,0xf7,0x28,0x00,0xd0,0x01,0xbb,0xd0,0x01,0x20,0x2b,0xcf,
+		0x20,0x28,0x00,0x80,0x95,0x51,0x59,0xb1,0x02,0x2b,0xff,0x01,0x28,0xff,0x7c,0x00,
+		0x18,0xff,0x7f,0xaa,0x00,0x30,0xbf,0x00,0x70,0xdf,0x00,0xb0,0xef,0x00,0xf0,0xf7,
+		0xea,0x01,0x30,0xfb,0x9e,0xd0,0x02,0x9f,0x10,0x01,0x00,0x18,0x57,0x7f,0xff,0x00,
+		0x81,0x30,0x00,0x9e,0x30,0x00,0x80,0xf0,0x1b,0x00,0x1a,0xba,0xc0,0x1a,0x04,0x00,
+		0xb0,0x51,0xd0,0x5a,0xd0,0x5e,0x5e,0x51,0x21,0x1a,0x00,0x04,0x00,0x30,0x08,0x00,
+		0x70,0xad,0x10,0x00,0xb0,0x20,0x21,0x84,0x30,0x21,0x03,0x70,0x21,0x14,0x05,0x70,
+		0x60,0x51,0x06,0x0a,0x30,0x05,0xa2,0x30,0x61,0x12,0x25,0xd0,0x02,0x61,0x91,0x05,
+		0x68,0x32,0x00,0xf1,0x86,0xf1,0x00,0xf1,0x6a,0x51,0x01,0xf1,0xa5,0x7f,0x01,0xf2,
+		0x04,0x09,0x70,0x00,0x30,0xbf,0x00,0x70,0xdf,0x6a,0x00,0xb0,0xef,0x00,0xf0,0xf7,
+		0x01,0x30,0xfb,0x04,0xa4,0x90,0xac,0x00,0x30,0x8a,0x70,0x7f,0xff,0x8a,0xb1,0x04,
+		0x2a,0xd0,0x04,0xab,0x18,0xef,0x00,0xb0,0xf7,0x00,0xf0,0xfb,0x01,0x30,0xfd,0xfe,
+		0x01,0x70,0xfe,0xff,0x0e,0x2b,0x0d,0x2b,0x0c,0xaa,0x8c,0xb0,0x0c,0x2c,0xd0,0x0c,
+		0x5c,0xd0,0x0c,0x6c,0x70,0x12,0xaf,0x2b,0x11,0x2b,0x10,0x02,0x30,0x10,0x5d,0xd0,
+		0x10,0x4e,0x6d,0x70,0x15,0x2b,0x14,0x0f,0x90,0x00,0x30,0xdf,0x00,0x70,0x55,0xef,
+		0x00,0xb0,0xf7,0x00,0xf0,0xfb,0x01,0x30,0xfd,0x01,0x70,0xab,0xfe,0x14,0x0f,0x90,
+		0x14,0x90,0xd0,0x14,0xad,0xd0,0x14,0xaa,0x90,0x90,0x14,0x0f,0x90,0x14,0x0f,0x90,
+		0x14,0x5a,0xf0,0x14,0x68,0x6a,0x70,0x1c,0x31,0x6e,0x31,0x34,0x0b,0x14,0x19,0x2b,
+		0xb0,0x71,0xa5,0x18,0x08,0xb0,0x19,0x08,0xf0,0x6f,0xd1,0x38,0x93,0xf0,0x1a,0xfb,
+		0x76,0x69,0x24,0xd0,0x7f,0x76,0xf9,0x8b,0x7f,0xf7,0x76,0xac,0x85,0x00,0x30,0x88,
+		0x7f,0x8f,0x0c,0xff,0x8d,0x3f,0x8f,0x2b,0x8d,0xa9,0xa0,0x41,0xbe,0xc3,0x30,0xa9,
+		0xa8,0x00,0x8f,0x00,0xc6,0x10,0x61,0x57,0x8c,0x40,0x76,0x00,0x71,0x3e,0x02,0x30,
+		0xad,0xc7,0x10,0xdf,0xdc,0x88,0x7f,0x76,0x3f,0x03,0x30,0xe9,0x86,0xff,0xa9,0x20,
+		0x7f,0x76,0xf6,0x8b,0x30,0x29,0xdf,0x69,0xff,0x7f,0x76,0x2f,0x04,0x50,0xe7,0x8b,
+		0xf3,0xfb,0x6f,0xbb,0xf1,0x75,0xf1,0x30,0x40,0x08,0xef,0x2a,0x3b,0xb1,0x30,0x0f,
+		0x90,0x41,0x73,0xb0,0x05,0xc5,0x70,0x00,0xd0,0xfc,0x19,0xf0,0x01,0xd2,0xcc,0x02,
+		0x00,0xc0,0xff,0x08,0x8e,0x96,0xb0,0xc1,0x01,0x31,0x02,0x12,0x7e,0x50,0x02,0x12,
+		0x31,0xa6,0x1c,0x10,0x41,0x92,0xb6,0x11,0xc0,0x90,0x96,0xcc,0x51,0xaa,0xeb,0x03,
+		0x41,0x90,0xf0,0xa4,0xc5,0x12,0xc4,0x92,0x13,0xed,0x96,0xc0,0x51,0xa6,0x03,0xc7,
+		0x92,0x92,0x04,0x96,0x80,0xb8,0xb1,0x7c,0xf7,0x80,0xf2,0xa0,0xf0,0x6e,0xb5,0x72,
+		0x92,0x00,0xf4,0x08,0xfb,0x00,0xc2,0xa2,0xf2,0x03,0x96,0x0f,0x2b,0x0e,0xff,0x2b,
+		0x09,0x2b,0x02,0x28,0x07,0x00,0x08,0x9e,0x76,0x30,0x0d,0x96,0x0c,0x96,0xca,0xf3,
+		0x9f,0x51,0x0b,0xff,0x2b,0x0a,0x2b,0x7f,0x76,0x8d,0x86,0x7f,0x77,0x76,0xb2,0x86,
+		0x0b,0x13,0x01,0x00,0x31,0x24,0xd2,0x8a,0xbf,0xf1,0x08,0xc0,0x30,0x10,0xcd,0xb2,
+		0x03,0xd1,0x1c,0x70,0x2b,0xf4,0xcb,0x11,0x02,0xf1,0x41,0xa3,0xf2,0x13,0x92,0x41,
+		0x54,0x5f,0x3e,0xed,0x15,0x0a,0x06,0xb4,0x70,0x02,0x8b,0x34,0x7d,0x46,0xa5,0x12,
+		0x09,0x0a,0x08,0x42,0x16,0x87,0x94,0xfa,0x08,0x91,0x3b,0xa6,0x72,0x03,0x92,0x37,
+		0xed,0x09,0xbe,0x87,0x52,0x09,0x2b,0x32,0x6f,0x03,0xb7,0xd0,0x09,0x4b,0x2b,0x08,
+		0x2c,0x30,0x2c,0x86,0x94,0x0b,0x31,0x11,0x02,0x94,0xdb,0x05,0xed,0x01,0xf3,0x1e,
+		0x6f,0x03,0x11,0x1b,0x64,0x77,0x15,0x28,0x32,0x85,0x30,0xfb,0xff,0x16,0xdb,0x12,
+		0x7f,0x09,0x2b,0x03,0x2b,0x11,0x6f,0x04,0x07,0xf0,0xbf,0x0e,0xed,0x15,0x0b,0x06,
+		0x2b,0x07,0xd5,0x07,0x16,0x07,0xd3,0x2b,0x08,0x28,0x10,0x03,0xd5,0x90,0x0d,0x71,
+		0xcb,0xf1,0xc3,0x06,0xfe,0xad,0xf2,0x8b,0xf0,0x18,0xf3,0x81,0x91,0x05,0xed,0xff,
+		0x00,0x02,0x46,0x1e,0x44,0x1e,0x54,0x6f,0x7f,0x20,0xcc,0x00,0x04,0xc9,0xff,0x0d,
+		0xe4,0x50,0xbc,0xb5,0x32,0xd4,0xb0,0x02,0x00,0x12,0x81,0xe6,0x71,0x28,0x8f,0x03,
+		0x42,0x1e,0x0c,0xe0,0x10,0x01,0x12,0x01,0x72,0x20,0xfd,0xae,0xe7,0xf1,0x26,0x07,
+		0x42,0x1e,0x42,0x06,0xee,0x98,0xf2,0x56,0x18,0x00,0x23,0x90,0xfa,0xa9,0xa8,0xff,
+		0x18,0x0f,0x03,0x63,0x18,0xa8,0x0a,0x6f,0xff,0x29,0xff,0x83,0xff,0x18,0x0f,0x06,
+		0x65,0xfd,0xaa,0xed,0x70,0xab,0x28,0x00,0x06,0x18,0xa9,0xff,0x18,0x06,0x30,0xff,
+		0x46,0x1e,0x6c,0xff,0xff,0x42,0x06,0x46,0xa3,0x31,0xff,0xac,0x10,0x1f,0x44,0x1e,
+		0x44,0x06,0x06,0x9e,0xb0,0x3b,0x13,0x22,0xb1,0xf7,0xc3,0x01,0x22,0x3b,0xb0,0x44,
+		0x85,0x56,0xff,0xfb,0xa9,0x85,0x01,0xd1,0x04,0x63,0x00,0x02,0x44,0xff,0x1e,0x07,
+		0x6f,0x00,0x8f,0x78,0x0f,0xa9,0xff,0xa8,0x44,0x0f,0x02,0x63,0x44,0xa8,0x44,0x3e,
+		0xbb,0xb0,0xd0,0x01,0x17,0x96,0x86,0xc2,0xd0,0x0d,0x1f,0x56,0x0d,0x1e,0x08,0xca,
+		0x0d,0x16,0x23,0x0d,0x12,0x10,0x0d,0x12,0x55,0x2c,0x0d,0x18,0x10,0x0e,0x92,0x22,
+		0x0d,0x12,0x2a,0x0d,0x18,0x55,0x1a,0x0d,0x14,0x1a,0x0d,0x10,0x1a,0x0d,0x14,0x1a,
+		0x0d,0x18,0xa7,0x1a,0xa9,0x1a,0x0d,0x1f,0x0d,0x17,0x08,0x0d,0x16,0x08,0xc4,0x0d,
+		0x1f,0x0d,0x1f,0x18,0x0d,0x1f,0x1a,0x3f,0x1a,0x31,0x10,0xcb,0xaa,0x1a,0x36,0x25,
+		0x1a,0x32,0x11,0x1a,0x32,0x30,0x1a,0x38,0x11,0xaa,0x1b,0xb2,0x24,0x1a,0x32,0x2e,
+		0x1a,0x38,0x1c,0x1a,0x34,0x1c,0xea,0x1a,0x30,0x1c,0x1a,0x34,0x1c,0x1a,0x38,0x1c,
+		0xa9,0x1c,0x94,0x1a,0x3f,0x1a,0x37,0x10,0x1a,0x36,0x10,0x1a,0x3f,0x1a,0x3f,0x19,
+		0xf8,0x1a,0x34,0x3d,0x31,0xdb,0x31,0x0d,0x92,0x08,0xec,0x41,0xff,0x2d,0x01,0x9a,
+		0x66,0xff,0x02,0xce,0x03,0x7f,0xec,0x01,0x9a,0x02,0x6f,0x00,0x9a,0xf5,0x51,0x5d,
+		0x30,0x26,0xf0,0x33,0x00,0x20,0xbd,0x90,0x22,0x49,0xd0,0xef,0x40,0x8f,0xa6,0x02,
+		0x48,0x30,0x0d,0x28,0xff,0xce,0xe6,0x31,0x61,0x8c,0x1a,0x61,0xd0,0xf8,0x50,0x2b,
+		0x24,0xff,0x2b,0x26,0x2b,0x28,0x2b,0x2a,0x2b,0x2c,0xfe,0x6f,0x50,0x30,0x2b,0x32,
+		0x2b,0x34,0x2b,0x36,0xff,0x2b,0x38,0x2b,0x23,0x2b,0x25,0x2b,0x27,0xef,0x2b,0x29,
+		0x2b,0x2b,0x70,0xd0,0x2f,0x2b,0x31,0xff,0x2b,0x33,0x2b,0x35,0x2b,0x37,0x2b,0x39,
+		0x8b,0x2b,0x21,0x71,0x70,0x20,0xbb,0xd0,0x4e,0xd1,0x84,0xd1,0x10,0xce,0x3f,0x70,
+		0x11,0x28,0x43,0x52,0x92,0x53,0x11,0x12,0x2b,0xff,0x13,0x28,0x0a,0x00,0x1a,0x28,
+		0x50,0xc0,0xbf,0x1b,0x28,0x70,0x40,0x1c,0x2b,0x86,0x11,0x1a,0xa8,0x85,0xd0,0x86,
+		0x11,0xff,0x51,0x32,0xbf,0x90,0x32,0xb0,0x90,0x23,0x15,0x76,0x88,0xd1,0x03,0xc8,
+		0xd0,0x04,0xf2,0x50,0x49,0xf1,0x87,0x92,0xbf,0xcc,0x00,0x1f,0xc7,0xff,0x42,0x4a,
+		0x90,0x41,0xb7,0x2b,0x09,0x6f,0x49,0xb1,0x40,0x02,0xe1,0x11,0x17,0xbf,0xc6,0xc4,
+		0x96,0x41,0x0a,0x42,0x40,0xf0,0xf6,0xf1,0x62,0x03,0x52,0xf5,0x90,0x4d,0x51,0xbd,
+		0xb2,0x04,0xfe,0xf5,0x41,0xed,0x12,0x09,0xb8,0x30,0x3c,0x52,0xc0,0x56,0xd5,0xad,
+		0xc7,0x70,0x3e,0x00,0x70,0xa9,0x7d,0x90,0x44,0x96,0x77,0x0f,0x52,0x0d,0xe5,0xb2,
+		0x40,0x02,0x44,0x4f,0x52,0xff,0x41,0x9a,0xc4,0x74,0x44,0x0a,0x44,0x92,0xff,0x0f,
+		0x52,0xf5,0x64,0x41,0x92,0x01,0x9c,0xf7,0xa9,0x58,0x40,0x06,0x10,0x41,0x59,0x03,
+		0x56,0xff,0x95,0x04,0x41,0x93,0x02,0x9d,0xa8,0x58,0xfe,0x07,0x11,0x9c,0xca,0xa9,
+		0x88,0x03,0x56,0x94,0xff,0x08,0xa9,0x93,0xa6,0xcb,0xa8,0x80,0x41,0xf3,0x93,0x03,
+		0x01,0x70,0x00,0xf0,0x0c,0xa7,0xca,0x42,0xff,0x96,0x41,0x08,0x04,0x00,0x42,0x92,
+		0x5c,0x7f,0xff,0xa9,0x93,0xde,0xff,0xa9,0x95,0xf3,0x11,0x4f,0xb0,0xff,0x12,0x97,
+		0x04,0xb3,0x04,0x52,0x59,0x04,0x73,0x08,0x04,0x3f,0x04,0x3f,0x04,0x39,0x11,0x04,
+		0x3f,0x04,0x3f,0x08,0x7f,0x08,0x7a,0xf9,0x10,0x08,0x74,0x0c,0xf3,0x9c,0xca,0x43,
+		0x96,0x43,0xee,0x63,0x72,0x02,0x00,0x0c,0xd5,0x90,0x7f,0x76,0xc7,0xfb,0x86,0x04,
+		0xf4,0x52,0x0c,0x2b,0x43,0x41,0x06,0xe4,0x64,0xf0,0x7d,0x11,0x40,0x64,0xb2,0x41,
+		0xf1,0x40,0x00,0x43,0xef,0x42,0x04,0xef,0x21,0x8b,0x10,0x03,0x6f,0x22,0xb6,0x8b,
+		0x70,0x43,0x43,0x00,0xd1,0x00,0x40,0x00,0xd1,0x00,0xa5,0x40,0xee,0x10,0x8b,0x64,
+		0x52,0x4f,0x50,0x10,0xfb,0x14,0x40,0x7d,0x01,0x64,0xb5,0xc1,0x01,0xc4,0x92,0x19,
+		0x1a,0x10,0xf6,0x01,0xb1,0xf3,0x64,0x66,0xf1,0x08,0xfe,0x46,0xa0,0xff,0x44,0xa8,
+		0x41,0x96,0x46,0x8a,0xc4,0x92,0xff,0x47,0x96,0x01,0x9b,0xa9,0x95,0x47,0x97,0xdf,
+		0x44,0x8a,0x01,0x3b,0xa9,0x18,0x73,0x92,0xc4,0xff,0x96,0x47,0x92,0x14,0x52,0x02,
+		0xed,0x47,0xb7,0x2b,0x47,0x92,0x02,0x30,0x96,0x88,0x54,0x52,0x42,0xdb,0xa8,0x42,
+		0x02,0xf0,0x43,0x96,0x00,0x51,0x44,0x96,0x77,0x46,0x2b,0x46,0x02,0x30,0x16,0x63,
+		0x42,0x03,0x70,0xfd,0x46,0x6b,0x52,0xc4,0x92,0x45,0x96,0x43,0x92,0x5f,0x45,0x54,
+		0x03,0x65,0x45,0x02,0x50,0x44,0x00,0x91,0xeb,0x63,0x45,0x02,0x91,0x0a,0x02,0x91,
+		0xec,0x64,0x00,0xff,0x9a,0x44,0x93,0x43,0x9f,0x02,0x53,0x02,0xcf,0x62,0x01,0x9a,
+		0x86,0x08,0x52,0x21,0xd1,0x42,0x2b,0x5f,0x44,0x2b,0x45,0x2b,0x46,0xee,0x70,0x05,
+		0xd9,0x30,0xf5,0x3c,0xe8,0x72,0x16,0x1c,0x30,0x43,0x96,0x41,0x58,0x6d,0x41,0xfd,
+		0x50,0x0f,0x90,0x0c,0xb2,0x9c,0x94,0x00,0xf4,0xaf,0xa3,0xff,0x0f,0x90,0x00,0xd7,
+		0xa7,0x00,0xda,0xab,0x84,0x01,0xb4,0xf5,0x11,0x15,0x04,0x3a,0x03,0xff,0x03,0xff,
+		0x03,0xfb,0x17,0x50,0x03,0xff,0x07,0xff,0x07,0xff,0x07,0xf4,0x03,0x66,0xf0,0x42,
+		0xf0,0xb3,0x6f,0x40,0x03,0xee,0x42,0x9b,0x30,0x02,0x41,0x00,0x71,0x6f,0x40,0x00,
+		0x02,0x42,0x00,0xf1,0x20,0x00,0x0d,0xd1,0xdc,0x33,0x30,0x0d,0x74,0x94,0x28,0x41,
+		0x01,0x10,0x94,0x28,0xf5,0x3e,0x8a,0x50,0xd5,0xbe,0x70,0x03,0x00,0x09,0x92,0xbb,
+		0x1f,0xec,0x17,0xf1,0x14,0x52,0x18,0x32,0x52,0x00,0x5b,0x01,0x47,0x16,0x53,0x2b,
+		0x47,0x81,0x50,0xd0,0x67,0xb0,0x6a,0x00,0xb5,0xe4,0x00,0xb5,0x0a,0x1b,0x51,0xea,
+		0x64,0x03,0xd2,0xff,0x2b,0x0f,0x92,0x3d,0xec,0x0a,0x92,0x0a,0xbf,0x0a,0x04,0x52,
+		0x39,0xed,0x0a,0xfd,0x72,0x40,0xdb,0x8f,0xcd,0x6a,0xd1,0x01,0x16,0x71,0x90,0xea,
+		0x89,0xbe,0x05,0x11,0x7f,0x76,0x04,0x8a,0x44,0xfb,0x72,0x40,0x4b,0x8f,0xc8,0x6c,
+		0x90,0xd0,0x0f,0x50,0x01,0xb3,0xd0,0x92,0xd0,0x57,0x04,0x8a,0x45,0x01,0xb4,0xc7,
+		0x6e,0x50,0xe4,0x15,0x10,0xea,0x03,0x73,0xe4,0x01,0xb2,0x46,0x1e,0x10,0x0c,0xec,
+		0x45,0x4f,0x92,0x0a,0xec,0x46,0x4e,0x10,0xff,0xb1,0x1f,0xf5,0x12,0xf1,0x03,0xff,
+		0x32,0xc8,0x50,0x42,0xd2,0xfb,0xed,0x14,0xcc,0xdf,0x40,0x00,0xc5,0xff,0xfd,0xfd,
+		0x70,0xc3,0x01,0x55,0x35,0xb7,0x10,0x32,0xbd,0xf0,0x36,0xb7,0x90,0x88,0x6c,0x92,
+		0xfc,0x46,0x52,0x04,0x70,0x7f,0x76,0x1d,0x89,0x7f,0x76,0x13,0x2d,0x8a,0x47,0x53,
+		0xff,0xd1,0x0a,0x47,0x92,0xc9,0xf1,0x4c,0x53,0xfd,0x41,0x4c,0x13,0x28,0x06,0x00,
+		0x13,0x28,0xb6,0x12,0x4c,0x34,0x61,0x4c,0x3f,0x4c,0x30,0x04,0x4b,0x14,0xcb,0x70,
+		0x4b,0x14,0x9f,0x00,0x8f,0xc0,0x01,0x41,0x83,0x30,0x4d,0x31,0x06,0xed,0x58,0xcf,
+		0x31,0x17,0xc6,0x1a,0x53,0x06,0x0a,0x64,0xff,0x9b,0x06,0x92,0xff,0x00,0x86,0x8c,
+		0x06,0xe2,0x4c,0x34,0xee,0x4c,0x32,0x89,0xf1,0x99,0x95,0x20,0x52,0x03,0xff,0xed,
+		0x00,0x9a,0x06,0x6f,0x39,0x52,0x03,0x7f,0x69,0xc9,0x9c,0x02,0x6f,0xd0,0x9c,0x9b,
+		0x33,0xfa,0x30,0xf1,0xcc,0x86,0x50,0x7f,0x8b,0x42,0x8a,0xa9,0xfb,0x88,0xc4,0x00,
+		0x92,0x03,0x56,0xa9,0x04,0xa6,0xdd,0x94,0x9d,0x33,0x2b,0x6f,0x01,0x4b,0x10,0xc0,
+		0x01,0xfb,0x94,0x92,0x9d,0xd0,0x0a,0x01,0x92,0x64,0x9b,0xbe,0x06,0x71,0x01,0x96,
+		0x19,0x6f,0x0c,0x93,0x30,0x00,0xff,0x2b,0x1b,0x6f,0x0c,0x92,0x19,0xec,0x0c,0xf8,
+		0x99,0xd0,0xac,0x70,0x00,0xb0,0x13,0xec,0x00,0x58,0x41,0xff,0x92,0x00,0x8f,0x14,
+		0x01,0x94,0x96,0x00,0xef,0x0a,0x14,0x9b,0x00,0x09,0x72,0x00,0x96,0x07,0xff,0x6f,
+		0x41,0x92,0x0a,0x52,0xe6,0xec,0x0d,0xef,0x52,0xe8,0xec,0xed,0x0c,0x33,0x92,0x01,
+		0x54,0xbf,0x03,0xec,0x02,0x92,0xd0,0xec,0xa3,0xd1,0x0f,0x0a,0x82,0x90,0x15,0x1c,
+		0xb0,0x8c,0xda,0xb0,0x27,0x70,0xd2,0xd0,0xb1,0xf0,0xce,0x82,0xf0,0x03,0x00,0x0e,
+		0x03,0xb0,0x00,0xd3,0xbf,0x9c,0xef,0x01,0x52,0xed,0x69,0x16,0xf3,0x03,0x92,0x0b,
+		0xfb,0xec,0x03,0x9f,0x90,0x9c,0x8b,0x02,0x92,0x06,0xea,0x17,0x90,0xd1,0x03,0x72,
+		0x02,0x9d,0xf0,0xbd,0x96,0x12,0x39,0x76,0xa8,0xd1,0xc9,0xb1,0x22,0x00,0x06,0xe9,
+		0x30,0xcd,0x50,0xae,0xe4,0xb0,0xff,0xfd,0x38,0x2c,0xd0,0x39,0x2d,0x10,0x3a,0xaa,
+		0x2d,0x50,0x3b,0x2d,0x90,0x3c,0x2d,0xd0,0x3d,0x2e,0x10,0x3e,0xfa,0x2e,0x50,0x3f,
+		0x2e,0x92,0xc0,0x01,0x29,0x28,0xe8,0xd7,0x00,0x22,0x28,0x94,0x30,0x28,0xad,0x70,
+		0x2b,0x41,0x3f,0x1b,0x00,0x04,0x07,0x67,0xff,0xdc,0xd0,0x47,0x90,0xf6,0x00,0xb0,
+		0xfb,0x68,0x02,0x31,0x1a,0x2b,0x1b,0x2b,0xa9,0x1c,0xec,0x10,0x00,0x30,0x10,0x00,
+		0x70,0x08,0x00,0xb0,0x04,0x56,0x00,0xf0,0x01,0x1c,0xcd,0x10,0x1c,0xcc,0xd0,0x1c,
+		0xcc,0xd0,0xff,0x1e,0x28,0xfc,0x00,0x1f,0x2b,0x1a,0x76,0xf9,0x82,0x8e,0xb2,0xb9,
+		0x51,0x06,0x00,0x00,0x52,0xa4,0xff,0xc5,0x07,0xec,0xff,0x9c,0xa9,0x88,0x85,0x3f,
+		0x92,0x87,0x96,0x0e,0x00,0xfe,0xe1,0xd0,0x01,0x3f,0xfc,0x02,0x7f,0x02,0x71,0x5a,
+		0xff,0xa4,0xc5,0xa4,0x8e,0xfb,0xab,0x92,0x03,0xfb,0xab,0x92,0xa9,0x88,0xa9,0xff,
+		0xa9,0xa6,0x0f,0x0f,0xec,0xaa,0x93,0x0d,0xff,0xec,0xff,0x9d,0xa8,0x5c,0xbf,0x76,
+		0xfe,0xf9,0xff,0x05,0xd5,0x06,0x51,0x0c,0x00,0xf8,0xff,0xa0,0xff,0x8a,0x06,0x00,
+		0xa6,0x97,0x00,0x9b,0x0f,0xdf,0xf6,0xa6,0x1f,0x20,0x76,0x00,0x95,0xa8,0x92,0xff,
+		0x20,0x76,0x80,0x00,0x3f,0x00,0x8c,0x8c,0x37,0xff,0xff,0x00,0x00,0x02,0xfe,0xff,
+		0xd8,0x90,0x00,0x94,0x74,0xd9,0x70,0x01,0x34,0xb2,0x01,0xc0,0x90,0x80,0x3f,0x0a,
+		0xd0,0xdd,0xb4,0x00,0x94,0xff,0xff,0x9e,0x03,0x02,0xff,0xff,0x55,0x9f,0x00,0x74,
+		0x90,0x00,0xf4,0x91,0x01,0x74,0x92,0x01,0xf4,0x55,0x95,0x02,0x74,0x96,0x02,0xf4,
+		0x97,0x06,0x74,0x98,0x06,0x76,0x75,0x9a,0x07,0x16,0x9c,0x07,0xb4,0xff,0xff,0xc0,
+		0x05,0xd4,0x55,0xc1,0x06,0x54,0xc2,0x06,0xd4,0xc3,0x07,0x54,0xc6,0x07,0xd4,0x50,
+		0x3d,0x10,0x08,0x52,0x3f,0x50,0x08,0xd2,0xc9,0x0c,0x60,0x01,0x09,0xd0,0x15,0xca,
+		0x09,0xd4,0xcb,0x0a,0x54,0xcc,0x0a,0xd4,0x43,0x90,0x0b,0x52,0x75,0xce,0x0b,0xd4,
+		0xcf,0x02,0xf2,0x00,0x00,0x08,0x2c,0x80,0x3f,0xa6,0x02,0x2d,0x85,0x3f,0x00,0x00,
+		0x3f,0x01,0x3f,0xbe,0x02,0x79,0x08,0x81,0x3f,0x00,0x0d,0x00,0x30,0x12,0xaa,0x00,
+		0x70,0x17,0x00,0xb0,0x1c,0x00,0xf0,0x21,0x01,0x30,0x26,0xaa,0x01,0x70,0x2b,0x01,
+		0xb0,0x30,0x01,0xf0,0x35,0x02,0x30,0x3a,0xaa,0x02,0x70,0x3f,0x02,0xb0,0x44,0x02,
+		0xf0,0x49,0x03,0x30,0x4e,0xaa,0x03,0x70,0x53,0x03,0xb0,0x58,0x03,0xf0,0x5d,0x04,
+		0x30,0x62,0xaa,0x04,0x70,0x67,0x04,0xb0,0x70,0x04,0xf0,0x32,0x08,0x70,0x79,0xea,
+		0x05,0x70,0x91,0x05,0xb0,0xa9,0x05,0xf0,0x6a,0x82,0x3f,0xab,0x00,0x73,0x00,0x30,
+		0x7c,0x00,0x70,0x85,0x00,0xb0,0x8e,0xfa,0x00,0xf0,0x97,0x01,0x30,0xab,0x83,0x3f,
+		0x00,0xb4,0x52,0x00,0x30,0xbd,0x00,0x70,0x03,0x31,0xc6,0x00,0xf0,0xcf,0x01,0x30,
+		0x55,0xd8,0x01,0x70,0xe1,0x01,0xb0,0xea,0x01,0xf0,0xf3,0x02,0x30,0x7d,0xfc,0x01,
+		0xf4,0x05,0x84,0x3f,0x00,0x0e,0x00,0x30,0x55,0x17,0x00,0x70,0x20,0x00,0xb0,0x29,
+		0x00,0xf0,0x32,0x01,0x30,0xa9,0x3b,0x00,0x71,0x0f,0xb0,0x44,0x01,0xf0,0x4d,0x02,
+		0x30,0x56,0xaa,0x02,0x70,0x5f,0x02,0xb0,0x68,0x02,0xf0,0x71,0x03,0x30,0x7a,0x4a,
+		0x01,0xf4,0x83,0x03,0xf0,0x8c,0x02,0xb4,0x0a,0x31,0x95,0x04,0xf0,0x41,0x9e,0x00,
+		0xf8,0x00,0x7f,0x01,0xbf,0x02,0xbf,0x04,0xf7,0xa7,0x09,0xf0,0xa5,0xd4,0x0a,0x30,
+		0xe1,0x0a,0x71,0x18,0xb0,0x1b,0x18,0xf0,0x24,0x80,0x05,0xbf,0x06,0xff,0x07,0xff,
+		0x09,0x3f,0x0a,0x3f,0x0b,0x7e,0x2f,0xb1,0x03,0x2a,0x23,0xf0,0x01,0x00,0x50,0x00,
+		0x00,0xd0,0x02,0x31,0xb0,0xf4,0xf0,0x6f,0x00,0x01,0x81,0x1f,0x32,0x50,0x0c,0x8d,
+		0x44,0xf1,0xcf,0x2a,0x00,0x02,0x1a,0x55,0x70,0x3e,0xb0,0x04,0x1a,0xf7,0xff,0x00,
+		0x05,0x00,0x30,0x06,0xcc,0xf0,0xff,0xff,0x05,0x50,0x06,0x96,0x06,0xcc,0xff,0xf0,
+		0xff,0xa9,0x1a,0x00,0x05,0x06,0x96,0x07,0xcc,0xdd,0xe0,0x01,0x10,0x07,0x96,0x00,
+		0xfd,0x90,0x1a,0x76,0x19,0x0c,0x62,0x90,0xfb,0x71,0x00,0x00
+		};
+
+		struct RegistryImage
+		{
+			const char* name;
+			const uint8_t* packed;
+			unsigned int packedSize;
+			unsigned int size;
+			uint32_t checksum;
+		};
+
+		const RegistryImage IMAGES[] = {
+			{"nvent", NVENT_IMAGE, sizeof(NVENT_IMAGE), 8492, 0x0363acfc},
+			{"test", TEST_IMAGE, sizeof(TEST_IMAGE), 7324, 0x6e9b1d39}
+		};
+
+		const unsigned int IMAGE_COUNT = sizeof(IMAGES) / sizeof(IMAGES[0]);
+
+		//Unpacked images, filled in on first use. Zero initialized before any constructor runs.
+		boost::atomic<uint8_t*> s_unpacked[IMAGE_COUNT];
+
+		bool unpack(const RegistryImage& image, uint8_t* out)
+		{
+			const uint8_t* in = image.packed;
+			const uint8_t* in_end = image.packed + image.packedSize;
+			unsigned int size = 0;
+			while(size < image.size && in < in_end)
+			{
+				uint8_t flags = *in++;
+				for(unsigned int bit = 0; bit < 8 && size < image.size; ++bit)
+				{
+					if(flags & (1 << bit))
+					{
+						if(in == in_end)
+						{
+							return false;
+						}
+						out[size++] = *in++;
+						continue;
+					}
+					if(in_end - in < 2)
+					{
+						return false;
+					}
+					unsigned int value = (in[0] << 8) | in[1];
+					in += 2;
+					unsigned int distance = (value >> LZSS_LENGTH_BITS) + 1;
+					unsigned int length = (value & ((1 << LZSS_LENGTH_BITS) - 1)) + LZSS_MIN_LENGTH;
+					if(distance > size || length > image.size - size)
+					{
+						return false;
+					}
+					//Copies can overlap their source, so go byte by byte
+					for(unsigned int i = 0; i < length; ++i, ++size)
+					{
+						out[size] = out[size - distance];
+					}
+				}
+			}
+			if(size != image.size)
+			{
+				return false;
+			}
+			boost::crc_32_type crc;
+			crc.process_bytes(out, size);
+			return crc.checksum() == image.checksum;
+		}
+	}
+
+	unsigned int FalconFirmwareRegistry::getImageCount()
+	{
+		return IMAGE_COUNT;
+	}
+
+	bool FalconFirmwareRegistry::findImage(const std::string& name, unsigned int& index)
+	{
+		for(unsigned int i = 0; i < IMAGE_COUNT; ++i)
+		{
+			if(name == IMAGES[i].name)
+			{
+				index = i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool FalconFirmwareRegistry::findImage(uint32_t checksum, unsigned int& index)
+	{
+		for(unsigned int i = 0; i < IMAGE_COUNT; ++i)
+		{
+			if(checksum == IMAGES[i].checksum)
+			{
+				index = i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool FalconFirmwareRegistry::findImage(const uint8_t* buffer, unsigned int& index)
+	{
+		if(buffer == NULL)
+		{
+			return false;
+		}
+		for(unsigned int i = 0; i < IMAGE_COUNT; ++i)
+		{
+			if(buffer == s_unpacked[i].load(boost::memory_order_acquire))
+			{
+				index = i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const char* FalconFirmwareRegistry::getName(unsigned int index)
+	{
+		return (index < IMAGE_COUNT) ? IMAGES[index].name : "";
+	}
+
+	unsigned int FalconFirmwareRegistry::getSize(unsigned int index)
+	{
+		return (index < IMAGE_COUNT) ? IMAGES[index].size : 0;
+	}
+
+	uint32_t FalconFirmwareRegistry::getChecksum(unsigned int index)
+	{
+		return (index < IMAGE_COUNT) ? IMAGES[index].checksum : 0;
+	}
+
+	const uint8_t* FalconFirmwareRegistry::getImage(unsigned int index)
+	{
+		if(index >= IMAGE_COUNT)
+		{
+			return NULL;
+		}
+		uint8_t* unpacked = s_unpacked[index].load(boost::memory_order_acquire);
+		if(unpacked != NULL)
+		{
+			return unpacked;
+		}
+		//Threads racing here each unpack a copy; the first to publish wins and the others throw theirs away
+		uint8_t* image = new uint8_t[IMAGES[index].size];
+		if(!unpack(IMAGES[index], image))
+		{
+			delete[] image;
+			return NULL;
+		}
+		if(!s_unpacked[index].compare_exchange_strong(unpacked, image, boost::memory_order_acq_rel))
+		{
+			delete[] image;
+			return unpacked;
+		}
+		return image;
+	}
+}
@@ -0,0 +1,171 @@
+/***
+ * @file FalconFlightRecorder.cpp
+ * @brief Always-on ring of per sample telemetry, optionally backed by a memory mapped file
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconFlightRecorder.h"
+#include <boost/atomic.hpp>
+#include <fstream>
+#include <cstring>
+
+namespace libnifalcon
+{
+	const static char FLIGHT_RECORDER_MAGIC[8] = "NIFFLT1";
+	const static uint32_t FLIGHT_RECORDER_VERSION = 1;
+
+	FalconFlightRecorder::FalconFlightRecorder() :
+		m_header(NULL),
+		m_records(NULL)
+	{
+	}
+
+	FalconFlightRecorder::~FalconFlightRecorder()
+	{
+		close();
+	}
+
+	bool FalconFlightRecorder::allocate(unsigned int capacity)
+	{
+		close();
+		if(capacity == 0)
+		{
+			return false;
+		}
+		m_heap.assign(sizeof(Header) + capacity * sizeof(FalconFlightRecord), 0);
+		m_header = (Header*)&m_heap[0];
+		m_records = (FalconFlightRecord*)(&m_heap[0] + sizeof(Header));
+		initializeHeader(capacity);
+		return true;
+	}
+
+	bool FalconFlightRecorder::open(const std::string& filename, unsigned int capacity)
+	{
+		close();
+		if(capacity == 0)
+		{
+			return false;
+		}
+		if(!m_file.open(filename, sizeof(Header) + capacity * sizeof(FalconFlightRecord)))
+		{
+			return false;
+		}
+		m_header = (Header*)m_file.getData();
+		m_records = (FalconFlightRecord*)((uint8_t*)m_file.getData() + sizeof(Header));
+		initializeHeader(capacity);
+		return true;
+	}
+
+	void FalconFlightRecorder::close()
+	{
+		m_header = NULL;
+		m_records = NULL;
+		m_heap.clear();
+		m_file.close();
+	}
+
+	void FalconFlightRecorder::initializeHeader(unsigned int capacity)
+	{
+		memcpy(m_header->magic, FLIGHT_RECORDER_MAGIC, sizeof(m_header->magic));
+		m_header->version = FLIGHT_RECORDER_VERSION;
+		m_header->recordSize = sizeof(FalconFlightRecord);
+		m_header->capacity = capacity;
+		m_header->writeIndex = 0;
+	}
+
+	void FalconFlightRecorder::storeWriteIndex(uint64_t index)
+	{
+		//Readers load the index, then copy the records it covers, so the record has to land first
+		boost::atomic_thread_fence(boost::memory_order_release);
+		m_header->writeIndex = index;
+		//Readers reload the index after copying to find what was overwritten meanwhile, so the next record's
+		//stores must not land before the index does
+		boost::atomic_thread_fence(boost::memory_order_release);
+	}
+
+	unsigned int FalconFlightRecorder::copyRecords(std::vector<FalconFlightRecord>& records, double seconds) const
+	{
+		records.clear();
+		if(m_header == NULL)
+		{
+			return 0;
+		}
+		//Copy first and validate after, like a seqlock reader: a record can be overwritten while we copy it
+		uint64_t capacity = m_header->capacity;
+		uint64_t end = m_header->writeIndex;
+		boost::atomic_thread_fence(boost::memory_order_acquire);
+		uint64_t begin = (end > capacity) ? end - capacity : 0;
+		records.resize(end - begin);
+		for(uint64_t i = begin; i < end; ++i)
+		{
+			records[i - begin] = m_records[i % capacity];
+		}
+		boost::atomic_thread_fence(boost::memory_order_acquire);
+		//The writer may be part way through the record at the new write index, which overwrites the slot
+		//of the record one capacity before it
+		uint64_t valid = m_header->writeIndex + 1;
+		valid = (valid > capacity) ? valid - capacity : 0;
+		unsigned int kept = 0;
+		for(uint64_t i = begin; i < end; ++i)
+		{
+			const FalconFlightRecord& record = records[i - begin];
+			if(i < valid || record.sequence != i)
+			{
+				continue;
+			}
+			records[kept++] = record;
+		}
+		records.resize(kept);
+		if(seconds > 0.0 && !records.empty())
+		{
+			double cutoff = records.back().timestamp - seconds;
+			std::vector<FalconFlightRecord>::iterator first = records.begin();
+			while(first != records.end() && first->timestamp < cutoff) ++first;
+			records.erase(records.begin(), first);
+		}
+		return records.size();
+	}
+
+	unsigned int FalconFlightRecorder::dump(std::ostream& out, double seconds) const
+	{
+		std::vector<FalconFlightRecord> records;
+		copyRecords(records, seconds);
+		out << "sequence,timestamp,round_trip,encoder_1,encoder_2,encoder_3,motor_1,motor_2,motor_3,"
+			<< "x,y,z,force_x,force_y,force_z,homing,buttons,status,errors" << std::endl;
+		std::ios_base::fmtflags flags = out.flags();
+		std::streamsize precision = out.precision();
+		for(std::vector<FalconFlightRecord>::const_iterator r = records.begin(); r != records.end(); ++r)
+		{
+			//Clock values are large, keep microseconds
+			out.precision(15);
+			out << (unsigned long long)r->sequence << "," << r->timestamp;
+			out.precision(9);
+			out << "," << r->roundTripTime;
+			for(int i = 0; i < 3; ++i) out << "," << r->encoders[i];
+			for(int i = 0; i < 3; ++i) out << "," << r->motorForces[i];
+			for(int i = 0; i < 3; ++i) out << "," << r->position[i];
+			for(int i = 0; i < 3; ++i) out << "," << r->force[i];
+			out << "," << (unsigned int)r->homingStatus << "," << (unsigned int)r->digitalInputs
+				<< "," << (unsigned int)r->status << "," << r->errorCount << std::endl;
+		}
+		out.flags(flags);
+		out.precision(precision);
+		return records.size();
+	}
+
+	bool FalconFlightRecorder::dump(const std::string& filename, double seconds) const
+	{
+		std::ofstream out(filename.c_str());
+		if(!out.is_open())
+		{
+			return false;
+		}
+		dump(out, seconds);
+		return out.good();
+	}
+}
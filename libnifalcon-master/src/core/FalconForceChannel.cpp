@@ -0,0 +1,192 @@
+/***
+ * @file FalconForceChannel.cpp
+ * @brief Thread safe channel for feeding force commands to the I/O loop at a lower rate than it runs
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconForceChannel.h"
+#include "falcon/core/FalconClock.h"
+
+namespace libnifalcon
+{
+	//Setpoints further apart than this (seconds) are an application stall, not its frame time
+	const static double MAX_SETPOINT_INTERVAL = 0.25;
+
+	FalconForceChannel::FalconForceChannel() :
+		m_clearRequested(false),
+		m_playoutDelay(1.0 / 60.0),
+		m_blendTime(0.005),
+		m_isActive(false),
+		m_mode(FalconForceCommand::FORCE_SETPOINT),
+		m_setpointHead(0),
+		m_setpointCount(0),
+		m_setpointInterval(0.0),
+		m_hasPreviousModel(false),
+		m_modelStartTime(0.0)
+	{
+	}
+
+	bool FalconForceChannel::pushForceSetpoint(const boost::array<double, 3>& force)
+	{
+		return pushForceSetpoint(FalconClock::getTime(), force);
+	}
+
+	bool FalconForceChannel::pushForceSetpoint(double timestamp, const boost::array<double, 3>& force)
+	{
+		FalconForceCommand command;
+		command.type = FalconForceCommand::FORCE_SETPOINT;
+		command.timestamp = timestamp;
+		command.force = force;
+		return push(command);
+	}
+
+	bool FalconForceChannel::pushForceModel(const boost::array<double, 3>& force, const boost::array<double, 9>& stiffness, const boost::array<double, 3>& anchor)
+	{
+		FalconForceCommand command;
+		command.type = FalconForceCommand::FORCE_LINEAR_MODEL;
+		command.timestamp = FalconClock::getTime();
+		command.force = force;
+		command.stiffness = stiffness;
+		command.anchor = anchor;
+		return push(command);
+	}
+
+	bool FalconForceChannel::push(const FalconForceCommand& command)
+	{
+		return m_queue.push(command);
+	}
+
+	void FalconForceChannel::evaluateModel(const FalconForceCommand& command, const boost::array<double, 3>& position, boost::array<double, 3>& force)
+	{
+		double dx[3] = { position[0] - command.anchor[0], position[1] - command.anchor[1], position[2] - command.anchor[2] };
+		for(int i = 0; i < 3; ++i)
+		{
+			force[i] = command.force[i] + command.stiffness[i*3] * dx[0] + command.stiffness[i*3+1] * dx[1] + command.stiffness[i*3+2] * dx[2];
+		}
+	}
+
+	bool FalconForceChannel::evaluate(double now, const boost::array<double, 3>& position, boost::array<double, 3>& force)
+	{
+		if(m_clearRequested.exchange(false, boost::memory_order_acquire))
+		{
+			FalconForceCommand dropped;
+			while(m_queue.pop(dropped)) {}
+			m_isActive = false;
+			m_setpointCount = 0;
+			m_setpointInterval = 0.0;
+			m_hasPreviousModel = false;
+		}
+
+		FalconForceCommand command;
+		while(m_queue.pop(command))
+		{
+			m_isActive = true;
+			if(command.type == FalconForceCommand::FORCE_LINEAR_MODEL)
+			{
+				//Fade out whatever was being rendered before, setpoint or model
+				if(m_mode == FalconForceCommand::FORCE_LINEAR_MODEL)
+				{
+					m_previousModel = m_model;
+					m_hasPreviousModel = true;
+				}
+				else if(m_setpointCount > 0)
+				{
+					m_previousModel = m_setpoints[m_setpointHead];
+					m_previousModel.stiffness.assign(0.0);
+					m_previousModel.anchor.assign(0.0);
+					m_hasPreviousModel = true;
+				}
+				m_model = command;
+				m_modelStartTime = now;
+				m_mode = FalconForceCommand::FORCE_LINEAR_MODEL;
+				continue;
+			}
+			//Setpoints have to arrive in order, anything older than the newest is dropped
+			if(m_mode != FalconForceCommand::FORCE_SETPOINT)
+			{
+				m_setpointCount = 0;
+				m_mode = FalconForceCommand::FORCE_SETPOINT;
+			}
+			if(m_setpointCount > 0 && command.timestamp <= m_setpoints[m_setpointHead].timestamp)
+			{
+				continue;
+			}
+			if(m_setpointCount > 0)
+			{
+				//Track the application's frame time, ignoring gaps long enough to be a stall
+				double interval = command.timestamp - m_setpoints[m_setpointHead].timestamp;
+				if(interval < MAX_SETPOINT_INTERVAL)
+				{
+					m_setpointInterval = (m_setpointInterval > 0.0) ? m_setpointInterval + (interval - m_setpointInterval) * 0.1 : interval;
+				}
+				m_setpointHead = (m_setpointHead + 1) % HISTORY_SIZE;
+			}
+			if(m_setpointCount < HISTORY_SIZE) ++m_setpointCount;
+			m_setpoints[m_setpointHead] = command;
+		}
+
+		if(!m_isActive)
+		{
+			return false;
+		}
+
+		if(m_mode == FalconForceCommand::FORCE_LINEAR_MODEL)
+		{
+			evaluateModel(m_model, position, force);
+			if(m_hasPreviousModel)
+			{
+				double blend = (m_blendTime > 0.0) ? (now - m_modelStartTime) / m_blendTime : 1.0;
+				if(blend >= 1.0)
+				{
+					m_hasPreviousModel = false;
+				}
+				else
+				{
+					if(blend < 0.0) blend = 0.0;
+					boost::array<double, 3> previous;
+					evaluateModel(m_previousModel, position, previous);
+					for(int i = 0; i < 3; ++i)
+					{
+						force[i] = previous[i] + (force[i] - previous[i]) * blend;
+					}
+				}
+			}
+			return true;
+		}
+
+		//Find the pair of setpoints around the playout time. Walk back from the newest.
+		//Play out far enough behind that the next setpoint is normally in before the newest one is passed
+		double delay = m_setpointInterval * 1.5;
+		if(delay < m_playoutDelay) delay = m_playoutDelay;
+		double render_time = now - delay;
+		const FalconForceCommand* newer = &m_setpoints[m_setpointHead];
+		if(render_time >= newer->timestamp || m_setpointCount == 1)
+		{
+			//Application is late (or we only have one point), hold the newest
+			force = newer->force;
+			return true;
+		}
+		for(unsigned int n = 1; n < m_setpointCount; ++n)
+		{
+			const FalconForceCommand* older = &m_setpoints[(m_setpointHead + HISTORY_SIZE - n) % HISTORY_SIZE];
+			if(render_time >= older->timestamp)
+			{
+				double t = (render_time - older->timestamp) / (newer->timestamp - older->timestamp);
+				for(int i = 0; i < 3; ++i)
+				{
+					force[i] = older->force[i] + (newer->force[i] - older->force[i]) * t;
+				}
+				return true;
+			}
+			newer = older;
+		}
+		//Playout time is older than anything we have left, use the oldest
+		force = newer->force;
+		return true;
+	}
+}
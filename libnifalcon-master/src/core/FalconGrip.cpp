@@ -0,0 +1,53 @@
+/***
+ * @file FalconGrip.cpp
+ * @brief Base class for grip definition classes
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconGrip.h"
+
+namespace libnifalcon
+{
+	void FalconGrip::updateEvents(double timestamp)
+	{
+		unsigned int changed = (m_digitalInputs ^ m_debouncedInputs);
+		//Inputs that went back to their debounced value were bounces
+		m_pendingInputs &= changed;
+		if(changed == 0)
+		{
+			return;
+		}
+		for(unsigned int i = 0; i < m_numDigitalInputs && i < 32; ++i)
+		{
+			unsigned int bit = (1u << i);
+			if(!(changed & bit))
+			{
+				continue;
+			}
+			if(!(m_pendingInputs & bit))
+			{
+				m_pendingInputs |= bit;
+				m_changeTimes[i] = timestamp;
+			}
+			if(timestamp - m_changeTimes[i] < m_debounceTime)
+			{
+				continue;
+			}
+			m_pendingInputs &= ~bit;
+			m_debouncedInputs ^= bit;
+			FalconGripEvent event;
+			event.timestamp = m_changeTimes[i];
+			event.button = bit;
+			event.pressed = (m_debouncedInputs & bit) != 0;
+			if(!m_events.push(event))
+			{
+				++m_droppedEventCount;
+			}
+		}
+	}
+}
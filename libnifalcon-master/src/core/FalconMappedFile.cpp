@@ -0,0 +1,126 @@
+/***
+ * @file FalconMappedFile.cpp
+ * @brief Minimal cross platform read/write memory mapped file
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconMappedFile.h"
+#include <cstring>
+
+#if defined(WIN32) || defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace libnifalcon
+{
+	FalconMappedFile::FalconMappedFile() :
+		m_mapping(NULL),
+		m_size(0),
+#if defined(WIN32) || defined(_WIN32)
+		m_file(INVALID_HANDLE_VALUE),
+		m_fileMapping(NULL)
+#else
+		m_file(-1)
+#endif
+	{
+	}
+
+	FalconMappedFile::~FalconMappedFile()
+	{
+		close();
+	}
+
+	bool FalconMappedFile::open(const std::string& filename, size_t size)
+	{
+		close();
+		if(size == 0)
+		{
+			return false;
+		}
+#if defined(WIN32) || defined(_WIN32)
+		m_file = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(m_file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		m_fileMapping = CreateFileMappingA(m_file, NULL, PAGE_READWRITE, 0, (DWORD)size, NULL);
+		if(m_fileMapping == NULL)
+		{
+			close();
+			return false;
+		}
+		m_mapping = MapViewOfFile(m_fileMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+		if(m_mapping == NULL)
+		{
+			close();
+			return false;
+		}
+#else
+		m_file = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if(m_file < 0)
+		{
+			return false;
+		}
+		if(ftruncate(m_file, size) != 0)
+		{
+			close();
+			return false;
+		}
+		m_mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+		if(m_mapping == MAP_FAILED)
+		{
+			m_mapping = NULL;
+			close();
+			return false;
+		}
+#endif
+		m_size = size;
+		memset(m_mapping, 0, size);
+		return true;
+	}
+
+	void FalconMappedFile::close()
+	{
+#if defined(WIN32) || defined(_WIN32)
+		if(m_mapping != NULL)
+		{
+			UnmapViewOfFile(m_mapping);
+		}
+		if(m_fileMapping != NULL)
+		{
+			CloseHandle(m_fileMapping);
+		}
+		if(m_file != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_file);
+		}
+		m_fileMapping = NULL;
+		m_file = INVALID_HANDLE_VALUE;
+#else
+		if(m_mapping != NULL)
+		{
+			munmap(m_mapping, m_size);
+		}
+		if(m_file >= 0)
+		{
+			::close(m_file);
+		}
+		m_file = -1;
+#endif
+		m_mapping = NULL;
+		m_size = 0;
+	}
+}
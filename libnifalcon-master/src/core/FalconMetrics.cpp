@@ -0,0 +1,260 @@
+/***
+ * @file FalconMetrics.cpp
+ * @brief Counters and latency histograms for the I/O loop, with Prometheus and shared memory export
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconMetrics.h"
+#include "falcon/core/FalconClock.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace libnifalcon
+{
+	const static char METRICS_MAGIC[8] = "NIFMET1";
+	const static uint32_t METRICS_VERSION = 1;
+
+	FalconHistogram::FalconHistogram()
+	{
+		reset();
+	}
+
+	void FalconHistogram::reset()
+	{
+		for(unsigned int i = 0; i < BUCKET_COUNT; ++i)
+		{
+			m_buckets[i].store(0, boost::memory_order_relaxed);
+		}
+		m_count.store(0, boost::memory_order_relaxed);
+		m_sum.store(0, boost::memory_order_relaxed);
+	}
+
+	unsigned int FalconHistogram::getBucketIndex(uint64_t value)
+	{
+		if(value < 2 * SUB_BUCKETS)
+		{
+			return (unsigned int)value;
+		}
+		if(value >> MAX_BITS)
+		{
+			return BUCKET_COUNT - 1;
+		}
+		unsigned int top_bit = SUB_BUCKET_BITS + 1;
+		while(value >> (top_bit + 1))
+		{
+			++top_bit;
+		}
+		//Keep the top SUB_BUCKET_BITS + 1 bits; the leading one picks the range, the rest the sub bucket
+		unsigned int shift = top_bit - SUB_BUCKET_BITS;
+		return (shift << SUB_BUCKET_BITS) + (unsigned int)(value >> shift);
+	}
+
+	uint64_t FalconHistogram::getBucketUpperBound(unsigned int index)
+	{
+		if(index < 2 * SUB_BUCKETS)
+		{
+			return index;
+		}
+		unsigned int shift = (index >> SUB_BUCKET_BITS) - 1;
+		uint64_t top = (index & (SUB_BUCKETS - 1)) + SUB_BUCKETS;
+		return ((top + 1) << shift) - 1;
+	}
+
+	uint64_t FalconHistogram::getPercentile(double percentile) const
+	{
+		uint64_t count = getCount();
+		if(count == 0)
+		{
+			return 0;
+		}
+		uint64_t target = (uint64_t)(percentile / 100.0 * count + 0.5);
+		if(target < 1) target = 1;
+		uint64_t seen = 0;
+		for(unsigned int i = 0; i < BUCKET_COUNT; ++i)
+		{
+			seen += getBucketCount(i);
+			if(seen >= target)
+			{
+				return getBucketUpperBound(i);
+			}
+		}
+		//Buckets and count are read at different times, so the total can come up short
+		return getBucketUpperBound(BUCKET_COUNT - 1);
+	}
+
+	FalconMetrics::FalconMetrics()
+	{
+		for(unsigned int i = 0; i < COUNTER_COUNT; ++i)
+		{
+			m_counters[i].store(0, boost::memory_order_relaxed);
+		}
+	}
+
+	FalconMetrics::~FalconMetrics()
+	{
+		closeSnapshot();
+	}
+
+	void FalconMetrics::reset()
+	{
+		for(unsigned int i = 0; i < COUNTER_COUNT; ++i)
+		{
+			m_counters[i].store(0, boost::memory_order_relaxed);
+		}
+		for(unsigned int i = 0; i < HISTOGRAM_COUNT; ++i)
+		{
+			m_histograms[i].reset();
+		}
+	}
+
+	const char* FalconMetrics::getCounterName(Counter counter)
+	{
+		switch(counter)
+		{
+		case COUNTER_SAMPLES: return "nifalcon_samples_total";
+		case COUNTER_IO_ERRORS: return "nifalcon_io_errors_total";
+		case COUNTER_MALFORMED_PACKETS: return "nifalcon_malformed_packets_total";
+		case COUNTER_READ_UNDERRUNS: return "nifalcon_read_underruns_total";
+		case COUNTER_KINEMATIC_ERRORS: return "nifalcon_kinematic_errors_total";
+		case COUNTER_KINEMATIC_NONCONVERGENCE: return "nifalcon_kinematic_nonconvergence_total";
+		case COUNTER_TORQUE_SATURATION: return "nifalcon_torque_saturation_total";
+		case COUNTER_RECONNECTS: return "nifalcon_reconnects_total";
+		default: break;
+		}
+		return "nifalcon_unknown_total";
+	}
+
+	const char* FalconMetrics::getHistogramName(Histogram histogram)
+	{
+		switch(histogram)
+		{
+		case HISTOGRAM_SAMPLE_PERIOD: return "nifalcon_sample_period_seconds";
+		case HISTOGRAM_ROUND_TRIP: return "nifalcon_round_trip_seconds";
+		case HISTOGRAM_KINEMATIC_ITERATIONS: return "nifalcon_kinematic_iterations";
+		default: break;
+		}
+		return "nifalcon_unknown";
+	}
+
+	void FalconMetrics::writePrometheus(std::ostream& out, const std::string& labels) const
+	{
+		std::ios_base::fmtflags flags = out.flags();
+		std::streamsize precision = out.precision();
+		out.precision(9);
+		std::string braced = labels.empty() ? "" : "{" + labels + "}";
+		std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+		for(unsigned int i = 0; i < COUNTER_COUNT; ++i)
+		{
+			const char* name = getCounterName((Counter)i);
+			out << "# TYPE " << name << " counter" << std::endl;
+			out << name << braced << " " << (unsigned long long)getCounter((Counter)i) << std::endl;
+		}
+		for(unsigned int i = 0; i < HISTOGRAM_COUNT; ++i)
+		{
+			const char* name = getHistogramName((Histogram)i);
+			const FalconHistogram& histogram = m_histograms[i];
+			//Times are kept in nanoseconds, Prometheus wants seconds
+			double scale = (i == HISTOGRAM_KINEMATIC_ITERATIONS) ? 1.0 : 1e-9;
+			uint64_t count = histogram.getCount();
+			uint64_t sum = histogram.getSum();
+			out << "# TYPE " << name << " histogram" << std::endl;
+			//Prometheus buckets are cumulative, so only buckets something landed in need writing
+			uint64_t cumulative = 0;
+			for(unsigned int b = 0; b < FalconHistogram::BUCKET_COUNT; ++b)
+			{
+				uint64_t bucket = histogram.getBucketCount(b);
+				if(bucket == 0)
+				{
+					continue;
+				}
+				cumulative += bucket;
+				out << name << "_bucket" << prefix << "le=\"" << FalconHistogram::getBucketUpperBound(b) * scale << "\"} "
+					<< (unsigned long long)cumulative << std::endl;
+			}
+			//Buckets can be ahead of the count if the I/O thread recorded in between
+			if(cumulative > count) count = cumulative;
+			out << name << "_bucket" << prefix << "le=\"+Inf\"} " << (unsigned long long)count << std::endl;
+			out << name << "_sum" << braced << " " << sum * scale << std::endl;
+			out << name << "_count" << braced << " " << (unsigned long long)count << std::endl;
+		}
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+	bool FalconMetrics::writePrometheus(const std::string& filename, const std::string& labels) const
+	{
+		std::string temp = filename + ".tmp";
+		{
+			std::ofstream out(temp.c_str());
+			if(!out.is_open())
+			{
+				return false;
+			}
+			writePrometheus(out, labels);
+			if(!out.good())
+			{
+				return false;
+			}
+		}
+#if defined(WIN32) || defined(_WIN32)
+		//rename() won't replace an existing file on windows
+		std::remove(filename.c_str());
+#endif
+		return std::rename(temp.c_str(), filename.c_str()) == 0;
+	}
+
+	bool FalconMetrics::openSnapshot(const std::string& filename)
+	{
+		if(!m_snapshotFile.open(filename, sizeof(Snapshot)))
+		{
+			return false;
+		}
+		Snapshot* snapshot = (Snapshot*)m_snapshotFile.getData();
+		memcpy(snapshot->magic, METRICS_MAGIC, sizeof(snapshot->magic));
+		snapshot->version = METRICS_VERSION;
+		snapshot->bucketCount = FalconHistogram::BUCKET_COUNT;
+		snapshot->counterCount = COUNTER_COUNT;
+		snapshot->histogramCount = HISTOGRAM_COUNT;
+		return true;
+	}
+
+	void FalconMetrics::closeSnapshot()
+	{
+		m_snapshotFile.close();
+	}
+
+	bool FalconMetrics::publishSnapshot()
+	{
+		if(!m_snapshotFile.isOpen())
+		{
+			return false;
+		}
+		Snapshot* snapshot = (Snapshot*)m_snapshotFile.getData();
+		uint64_t sequence = snapshot->sequence;
+		snapshot->sequence = sequence + 1;
+		boost::atomic_thread_fence(boost::memory_order_release);
+		snapshot->timestamp = FalconClock::getTime();
+		for(unsigned int i = 0; i < COUNTER_COUNT; ++i)
+		{
+			snapshot->counters[i] = getCounter((Counter)i);
+		}
+		for(unsigned int i = 0; i < HISTOGRAM_COUNT; ++i)
+		{
+			snapshot->histograms[i].count = m_histograms[i].getCount();
+			snapshot->histograms[i].sum = m_histograms[i].getSum();
+			for(unsigned int b = 0; b < FalconHistogram::BUCKET_COUNT; ++b)
+			{
+				snapshot->histograms[i].buckets[b] = m_histograms[i].getBucketCount(b);
+			}
+		}
+		boost::atomic_thread_fence(boost::memory_order_release);
+		snapshot->sequence = sequence + 2;
+		return true;
+	}
+}
@@ -0,0 +1,246 @@
+/***
+ * @file FalconTrace.cpp
+ * @brief Scoped trace spans for the I/O loop, exported as Chrome trace JSON
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/core/FalconTrace.h"
+#include <boost/thread/tss.hpp>
+#include <boost/static_assert.hpp>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define FALCON_THREAD_LOCAL __declspec(thread)
+#else
+#define FALCON_THREAD_LOCAL __thread
+#endif
+
+namespace libnifalcon
+{
+	namespace
+	{
+		struct TraceEvent
+		{
+			const char* name;
+			uint64_t begin;
+			uint64_t end;
+			uint32_t thread;
+		};
+
+		struct TraceRing
+		{
+			TraceEvent events[FalconTrace::RING_SIZE];
+			boost::atomic<uint64_t> writeIndex;
+			uint32_t index;
+		};
+
+		boost::atomic<TraceRing*> s_rings[FalconTrace::MAX_THREADS];
+		boost::atomic<unsigned int> s_ringCount(0);
+		//Bit i set when ring i's thread has exited and the ring can be handed to another thread
+		BOOST_STATIC_ASSERT(FalconTrace::MAX_THREADS <= 32);
+		boost::atomic<uint32_t> s_freeRings(0);
+		//Tick/time pair taken when tracing is first enabled, to convert ticks to FalconClock time
+		boost::atomic<bool> s_calibrated(false);
+		uint64_t s_calibrationTicks = 0;
+		double s_calibrationTime = 0.0;
+		FALCON_THREAD_LOCAL TraceRing* s_threadRing = NULL;
+		FALCON_THREAD_LOCAL bool s_threadRingFailed = false;
+
+		//Rings outlive their thread, as writeChromeTrace() may still be reading them. The next owner keeps
+		//appending after the spans already in the ring.
+		void releaseRing(TraceRing* ring)
+		{
+			s_freeRings.fetch_or(1u << ring->index, boost::memory_order_release);
+		}
+
+		//Only used to find out when a thread exits, write() goes through s_threadRing
+		boost::thread_specific_ptr<TraceRing> s_ringOwner(releaseRing);
+
+		TraceRing* takeFreeRing()
+		{
+			uint32_t free_rings = s_freeRings.load(boost::memory_order_acquire);
+			while(free_rings != 0)
+			{
+				uint32_t bit = free_rings & (~free_rings + 1);
+				if(s_freeRings.compare_exchange_weak(free_rings, free_rings & ~bit, boost::memory_order_acquire))
+				{
+					unsigned int index = 0;
+					while(!(bit & (1u << index)))
+					{
+						++index;
+					}
+					return s_rings[index].load(boost::memory_order_relaxed);
+				}
+			}
+			return NULL;
+		}
+
+		TraceRing* getThreadRing()
+		{
+			if(s_threadRing != NULL || s_threadRingFailed)
+			{
+				return s_threadRing;
+			}
+			TraceRing* ring = takeFreeRing();
+			if(ring == NULL)
+			{
+				unsigned int index = s_ringCount.fetch_add(1);
+				if(index >= FalconTrace::MAX_THREADS)
+				{
+					s_threadRingFailed = true;
+					return NULL;
+				}
+				ring = new TraceRing;
+				ring->writeIndex.store(0, boost::memory_order_relaxed);
+				ring->index = index;
+				s_rings[index].store(ring, boost::memory_order_release);
+			}
+			s_ringOwner.reset(ring);
+			s_threadRing = ring;
+			return ring;
+		}
+
+		bool compareEvents(const TraceEvent& a, const TraceEvent& b)
+		{
+			return a.begin < b.begin;
+		}
+	}
+
+	boost::atomic<bool> FalconTrace::s_enabled(false);
+
+	void FalconTrace::setEnabled(bool enabled)
+	{
+		if(enabled && !s_calibrated.load(boost::memory_order_acquire))
+		{
+			s_calibrationTime = FalconClock::getTime();
+			s_calibrationTicks = getTicks();
+			s_calibrated.store(true, boost::memory_order_release);
+		}
+		s_enabled.store(enabled, boost::memory_order_relaxed);
+	}
+
+	void FalconTrace::write(const char* name, uint64_t begin, uint64_t end)
+	{
+		TraceRing* ring = getThreadRing();
+		if(ring == NULL)
+		{
+			return;
+		}
+		//Only this thread writes the ring, so the index needs no read-modify-write
+		uint64_t index = ring->writeIndex.load(boost::memory_order_relaxed);
+		TraceEvent& event = ring->events[index % RING_SIZE];
+		event.name = name;
+		event.begin = begin;
+		event.end = end;
+		event.thread = ring->index;
+		ring->writeIndex.store(index + 1, boost::memory_order_release);
+	}
+
+	unsigned int FalconTrace::writeChromeTrace(std::ostream& out, double seconds)
+	{
+		std::vector<TraceEvent> events;
+		std::vector<unsigned int> threads;
+		unsigned int count = s_ringCount.load(boost::memory_order_acquire);
+		if(count > MAX_THREADS)
+		{
+			count = MAX_THREADS;
+		}
+		for(unsigned int i = 0; i < count; ++i)
+		{
+			//A ring can be counted but not stored yet
+			TraceRing* ring = s_rings[i].load(boost::memory_order_acquire);
+			if(ring == NULL)
+			{
+				continue;
+			}
+			threads.push_back(ring->index);
+			uint64_t end = ring->writeIndex.load(boost::memory_order_acquire);
+			uint64_t begin = (end > RING_SIZE) ? end - RING_SIZE : 0;
+			size_t first = events.size();
+			for(uint64_t e = begin; e < end; ++e)
+			{
+				events.push_back(ring->events[e % RING_SIZE]);
+			}
+			//Throw away anything the writer lapped while we were copying
+			boost::atomic_thread_fence(boost::memory_order_acquire);
+			uint64_t lapped = ring->writeIndex.load(boost::memory_order_relaxed);
+			if(lapped >= begin + RING_SIZE)
+			{
+				uint64_t valid = lapped - RING_SIZE + 1;
+				size_t discard = (size_t)std::min<uint64_t>(valid - begin, end - begin);
+				events.erase(events.begin() + first, events.begin() + first + discard);
+			}
+		}
+		std::stable_sort(events.begin(), events.end(), compareEvents);
+
+		//Ticks per second, measured over the time since tracing was enabled
+		double now = FalconClock::getTime();
+		uint64_t now_ticks = getTicks();
+		double rate = 1e9;
+		if(s_calibrated.load(boost::memory_order_acquire) && now > s_calibrationTime && now_ticks > s_calibrationTicks)
+		{
+			rate = (double)(now_ticks - s_calibrationTicks) / (now - s_calibrationTime);
+		}
+
+		if(seconds > 0.0 && !events.empty())
+		{
+			uint64_t newest = 0;
+			for(std::vector<TraceEvent>::const_iterator e = events.begin(); e != events.end(); ++e)
+			{
+				newest = std::max(newest, e->end);
+			}
+			uint64_t window = (uint64_t)(seconds * rate);
+			uint64_t cutoff = (newest > window) ? newest - window : 0;
+			std::vector<TraceEvent> recent;
+			for(std::vector<TraceEvent>::const_iterator e = events.begin(); e != events.end(); ++e)
+			{
+				if(e->end >= cutoff) recent.push_back(*e);
+			}
+			events.swap(recent);
+		}
+
+		std::ios_base::fmtflags flags = out.flags();
+		std::streamsize precision = out.precision();
+		out.setf(std::ios_base::fixed, std::ios_base::floatfield);
+		out.precision(3);
+		out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		bool first = true;
+		for(std::vector<unsigned int>::const_iterator t = threads.begin(); t != threads.end(); ++t)
+		{
+			out << (first ? "" : ",") << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << *t
+				<< ",\"args\":{\"name\":\"libnifalcon " << *t << "\"}}";
+			first = false;
+		}
+		for(std::vector<TraceEvent>::const_iterator e = events.begin(); e != events.end(); ++e)
+		{
+			//Chrome wants microseconds
+			double ts = (s_calibrationTime + ((double)e->begin - (double)s_calibrationTicks) / rate) * 1e6;
+			double dur = (double)(e->end - e->begin) / rate * 1e6;
+			out << (first ? "" : ",") << std::endl << "{\"name\":\"" << e->name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+				<< e->thread << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+			first = false;
+		}
+		out << std::endl << "]}" << std::endl;
+		out.flags(flags);
+		out.precision(precision);
+		return events.size();
+	}
+
+	bool FalconTrace::writeChromeTrace(const std::string& filename, double seconds)
+	{
+		std::ofstream out(filename.c_str());
+		if(!out.is_open())
+		{
+			return false;
+		}
+		writeChromeTrace(out, seconds);
+		return out.good();
+	}
+}
@@ -0,0 +1,86 @@
+/***
+ * @file FalconVelocityEstimatorAdaptiveWindow.cpp
+ * @brief First order adaptive windowing (FOAW) velocity estimation
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/estimator/FalconVelocityEstimatorAdaptiveWindow.h"
+#include <cmath>
+
+namespace libnifalcon
+{
+	FalconVelocityEstimatorAdaptiveWindow::FalconVelocityEstimatorAdaptiveWindow(double position_noise, double velocity_noise, unsigned int window_size) :
+		m_positionNoise(position_noise),
+		m_velocityNoise(velocity_noise),
+		m_windowSize(window_size),
+		m_head(0),
+		m_count(0)
+	{
+		if(m_windowSize > MAX_WINDOW_SIZE) m_windowSize = MAX_WINDOW_SIZE;
+		if(m_windowSize < 2) m_windowSize = 2;
+	}
+
+	void FalconVelocityEstimatorAdaptiveWindow::reset()
+	{
+		m_head = 0;
+		m_count = 0;
+		m_velocity.assign(0.0);
+		m_acceleration.assign(0.0);
+	}
+
+	double FalconVelocityEstimatorAdaptiveWindow::fitWindow(const boost::array<double, 3>* values, int axis, double noise) const
+	{
+		const double newest_time = m_timestamps[m_head];
+		const double newest_value = values[m_head][axis];
+		double slope = 0.0;
+		for(unsigned int n = 1; n < m_count; ++n)
+		{
+			unsigned int oldest = (m_head + MAX_WINDOW_SIZE - n) % MAX_WINDOW_SIZE;
+			double span = newest_time - m_timestamps[oldest];
+			if(span <= 0.0) break;
+			double candidate = (newest_value - values[oldest][axis]) / span;
+			//Every sample inside the window has to lie on the candidate line, give or take the noise bound
+			bool fits = true;
+			for(unsigned int j = 1; j < n; ++j)
+			{
+				unsigned int idx = (m_head + MAX_WINDOW_SIZE - j) % MAX_WINDOW_SIZE;
+				double expected = newest_value - candidate * (newest_time - m_timestamps[idx]);
+				if(fabs(values[idx][axis] - expected) > noise)
+				{
+					fits = false;
+					break;
+				}
+			}
+			if(!fits) break;
+			slope = candidate;
+		}
+		return slope;
+	}
+
+	void FalconVelocityEstimatorAdaptiveWindow::addSample(double timestamp, const boost::array<double, 3>& position)
+	{
+		if(m_count > 0 && timestamp <= m_timestamps[m_head])
+		{
+			//Duplicate or out of order timestamp, nothing to differentiate over
+			return;
+		}
+		if(m_count > 0) m_head = (m_head + 1) % MAX_WINDOW_SIZE;
+		if(m_count < m_windowSize) ++m_count;
+		m_timestamps[m_head] = timestamp;
+		m_positions[m_head] = position;
+		for(int i = 0; i < 3; ++i)
+		{
+			m_velocity[i] = fitWindow(m_positions, i, m_positionNoise);
+		}
+		m_velocities[m_head] = m_velocity;
+		for(int i = 0; i < 3; ++i)
+		{
+			m_acceleration[i] = fitWindow(m_velocities, i, m_velocityNoise);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/***
+ * @file FalconVelocityEstimatorFilteredDifference.cpp
+ * @brief Finite difference velocity estimation with a first order low pass filter
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/estimator/FalconVelocityEstimatorFilteredDifference.h"
+#include <cmath>
+
+namespace libnifalcon
+{
+	FalconVelocityEstimatorFilteredDifference::FalconVelocityEstimatorFilteredDifference(double velocity_cutoff, double acceleration_cutoff) :
+		m_sampleCount(0),
+		m_lastTimestamp(0.0)
+	{
+		setCutoffFrequencies(velocity_cutoff, acceleration_cutoff);
+		m_lastPosition.assign(0.0);
+	}
+
+	void FalconVelocityEstimatorFilteredDifference::setCutoffFrequencies(double velocity_cutoff, double acceleration_cutoff)
+	{
+		m_velocityTimeConstant = 1.0 / (2.0 * M_PI * velocity_cutoff);
+		m_accelerationTimeConstant = 1.0 / (2.0 * M_PI * acceleration_cutoff);
+	}
+
+	void FalconVelocityEstimatorFilteredDifference::reset()
+	{
+		m_sampleCount = 0;
+		m_velocity.assign(0.0);
+		m_acceleration.assign(0.0);
+	}
+
+	void FalconVelocityEstimatorFilteredDifference::addSample(double timestamp, const boost::array<double, 3>& position)
+	{
+		double dt = timestamp - m_lastTimestamp;
+		if(m_sampleCount > 0 && dt <= 0.0)
+		{
+			//Duplicate or out of order timestamp, nothing to differentiate over
+			return;
+		}
+		if(m_sampleCount > 0)
+		{
+			double velocity_alpha = dt / (m_velocityTimeConstant + dt);
+			double acceleration_alpha = dt / (m_accelerationTimeConstant + dt);
+			for(int i = 0; i < 3; ++i)
+			{
+				double raw_velocity = (position[i] - m_lastPosition[i]) / dt;
+				double filtered_velocity = m_velocity[i] + velocity_alpha * (raw_velocity - m_velocity[i]);
+				//Need two velocities before the acceleration means anything
+				if(m_sampleCount > 1)
+				{
+					double raw_acceleration = (filtered_velocity - m_velocity[i]) / dt;
+					m_acceleration[i] += acceleration_alpha * (raw_acceleration - m_acceleration[i]);
+				}
+				m_velocity[i] = filtered_velocity;
+			}
+		}
+		m_lastTimestamp = timestamp;
+		m_lastPosition = position;
+		++m_sampleCount;
+	}
+}
@@ -0,0 +1,118 @@
+/***
+ * @file FalconVelocityEstimatorKalman.cpp
+ * @brief Constant acceleration Kalman filter velocity estimation
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/estimator/FalconVelocityEstimatorKalman.h"
+#include <cstring>
+
+namespace libnifalcon
+{
+	FalconVelocityEstimatorKalman::FalconVelocityEstimatorKalman(double measurement_noise, double jerk_density) :
+		m_measurementNoise(measurement_noise),
+		m_jerkDensity(jerk_density)
+	{
+		reset();
+	}
+
+	void FalconVelocityEstimatorKalman::reset()
+	{
+		m_initialized = false;
+		m_lastTimestamp = 0.0;
+		memset(m_state, 0, sizeof(m_state));
+		memset(m_covariance, 0, sizeof(m_covariance));
+		m_velocity.assign(0.0);
+		m_acceleration.assign(0.0);
+	}
+
+	void FalconVelocityEstimatorKalman::addSample(double timestamp, const boost::array<double, 3>& position)
+	{
+		if(!m_initialized)
+		{
+			//Seed with the measured position and a wide prior on the derivatives
+			for(int i = 0; i < 3; ++i)
+			{
+				m_state[i][0] = position[i];
+				m_covariance[i][0][0] = m_measurementNoise;
+				m_covariance[i][1][1] = 1.0;
+				m_covariance[i][2][2] = 100.0;
+			}
+			m_lastTimestamp = timestamp;
+			m_initialized = true;
+			return;
+		}
+
+		double dt = timestamp - m_lastTimestamp;
+		if(dt <= 0.0)
+		{
+			//Duplicate or out of order timestamp, nothing to propagate over
+			return;
+		}
+		m_lastTimestamp = timestamp;
+
+		const double dt2 = dt * dt;
+		const double dt3 = dt2 * dt;
+		const double F[3][3] = {
+			{ 1.0, dt, 0.5 * dt2 },
+			{ 0.0, 1.0, dt },
+			{ 0.0, 0.0, 1.0 } };
+		const double Q[3][3] = {
+			{ m_jerkDensity * dt3 * dt2 / 20.0, m_jerkDensity * dt2 * dt2 / 8.0, m_jerkDensity * dt3 / 6.0 },
+			{ m_jerkDensity * dt2 * dt2 / 8.0, m_jerkDensity * dt3 / 3.0, m_jerkDensity * dt2 / 2.0 },
+			{ m_jerkDensity * dt3 / 6.0, m_jerkDensity * dt2 / 2.0, m_jerkDensity * dt } };
+
+		for(int axis = 0; axis < 3; ++axis)
+		{
+			double* x = m_state[axis];
+			double (*P)[3] = m_covariance[axis];
+
+			//Predict: x = F x, P = F P F' + Q
+			double xp[3];
+			for(int r = 0; r < 3; ++r)
+			{
+				xp[r] = F[r][0] * x[0] + F[r][1] * x[1] + F[r][2] * x[2];
+			}
+			double FP[3][3];
+			for(int r = 0; r < 3; ++r)
+			{
+				for(int c = 0; c < 3; ++c)
+				{
+					FP[r][c] = F[r][0] * P[0][c] + F[r][1] * P[1][c] + F[r][2] * P[2][c];
+				}
+			}
+			double Pp[3][3];
+			for(int r = 0; r < 3; ++r)
+			{
+				for(int c = 0; c < 3; ++c)
+				{
+					Pp[r][c] = FP[r][0] * F[c][0] + FP[r][1] * F[c][1] + FP[r][2] * F[c][2] + Q[r][c];
+				}
+			}
+
+			//Update with a position-only measurement (H = [1 0 0]), so the innovation is scalar
+			double innovation = position[axis] - xp[0];
+			double s = Pp[0][0] + m_measurementNoise;
+			double K[3] = { Pp[0][0] / s, Pp[1][0] / s, Pp[2][0] / s };
+			for(int r = 0; r < 3; ++r)
+			{
+				x[r] = xp[r] + K[r] * innovation;
+			}
+			for(int r = 0; r < 3; ++r)
+			{
+				for(int c = 0; c < 3; ++c)
+				{
+					P[r][c] = Pp[r][c] - K[r] * Pp[0][c];
+				}
+			}
+
+			m_velocity[axis] = x[1];
+			m_acceleration[axis] = x[2];
+		}
+	}
+}
@@ -10,6 +10,8 @@
  */
 
 #include "falcon/firmware/FalconFirmwareNovintSDK.h"
+#include "falcon/core/FalconClock.h"
+#include "falcon/core/FalconTrace.h"
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
@@ -79,6 +81,7 @@ namespace libnifalcon
 			else if(m_currentOutputIndex == 16)
 			{
 				LOG_WARN("Clearing malformed packet!");
+				++m_malformedPacketCount;
 				m_currentOutputIndex = 0;
 			}
 		}
@@ -115,6 +118,7 @@ namespace libnifalcon
 
 	bool FalconFirmwareNovintSDK::runIOLoop()
 	{
+		FALCON_TRACE_SCOPE("FalconFirmwareNovintSDK::runIOLoop");
 		bool read_successful = false;
 
 		if(m_falconComm == NULL || !m_falconComm->isCommOpen())
@@ -123,7 +127,10 @@ namespace libnifalcon
 			return false;
 		}
 
-		m_falconComm->poll();
+		{
+			FALCON_TRACE_SCOPE("poll");
+			m_falconComm->poll();
+		}
 
 		//Receive information from the falcon
 		if(m_hasWritten && m_falconComm->hasBytesAvailable())
@@ -136,9 +143,23 @@ namespace libnifalcon
 				m_falconComm->read((uint8_t*)m_rawData, (uint32_t)m_rawDataSize);
 				return false;
 			}
-			if(m_falconComm->read((uint8_t*)m_rawData, m_rawDataSize))
+			bool read_ok;
 			{
-				formatOutput();
+				FALCON_TRACE_SCOPE("read");
+				read_ok = m_falconComm->read((uint8_t*)m_rawData, m_rawDataSize);
+			}
+			if(read_ok)
+			{
+				bool formatted;
+				{
+					FALCON_TRACE_SCOPE("formatOutput");
+					formatted = formatOutput();
+				}
+				if(formatted)
+				{
+					m_lastRoundTripTime = FalconClock::getTime() - m_lastWriteTime;
+					m_roundTripTime = (m_roundTripTime == 0.0) ? m_lastRoundTripTime : (m_roundTripTime * 0.9 + m_lastRoundTripTime * 0.1);
+				}
 				m_hasWritten = false;
 				if(m_rawDataSize <= 0) read_successful = false;
 				else read_successful = true;
@@ -152,15 +173,22 @@ namespace libnifalcon
 		}
 		else if(m_hasWritten && !m_falconComm->hasBytesAvailable())
 		{
+			++m_readUnderrunCount;
 			return false;
 		}
 		//Send information to the falcon
 		formatInput();
-		if(!m_falconComm->write((uint8_t*)m_rawInput, 16))
+		bool write_ok;
+		{
+			FALCON_TRACE_SCOPE("write");
+			write_ok = m_falconComm->write((uint8_t*)m_rawInput, 16);
+		}
+		if(!write_ok)
 		{
 			return false;
 		}
 		m_hasWritten = true;
+		m_lastWriteTime = FalconClock::getTime();
 		return read_successful;
 	}
 
@@ -206,6 +206,8 @@ namespace libnifalcon
 			{
 				//Error is low enough so return the current position estimate
 				pos = previousPos;
+				m_lastSolveIterations = i + 1;
+				m_lastSolveConverged = true;
 				//cout << i << endl;
 				return;
 			}
@@ -221,6 +223,8 @@ namespace libnifalcon
 		}
 
 		//Failed to converge, leave last position as it was
+		m_lastSolveIterations = maxTries;
+		m_lastSolveConverged = false;
 		//cout << "Failed to find the tool position in the max tries" << endl;
 
 	}
@@ -264,6 +268,7 @@ namespace libnifalcon
 		}
 		//If axis with the largest torque is over the limit, scale them all to
 		//bring it back to the limit:
+		m_lastForceSaturated = (largestTorqueValue>maxTorque);
 		if(largestTorqueValue>maxTorque)
 		{
 			double scale = largestTorqueValue/maxTorque;
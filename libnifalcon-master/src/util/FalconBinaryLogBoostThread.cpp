@@ -0,0 +1,62 @@
+/***
+ * @file FalconBinaryLogBoostThread.cpp
+ * @brief Utility class for draining the binary log from a boost::thread (http://www.boost.org)
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/util/FalconBinaryLogBoostThread.h"
+#include "falcon/core/FalconBinaryLog.h"
+
+#include <boost/bind.hpp>
+namespace libnifalcon
+{
+
+	FalconBinaryLogBoostThread::FalconBinaryLogBoostThread() :
+		m_out(NULL),
+		m_interval(100),
+		m_runThreadLoop(false)
+	{
+	}
+
+	FalconBinaryLogBoostThread::~FalconBinaryLogBoostThread()
+	{
+		stopThread();
+	}
+
+	void FalconBinaryLogBoostThread::startThread(std::ostream& out, unsigned int interval_ms)
+	{
+		if(!m_runThreadLoop)
+		{
+			m_out = &out;
+			m_interval = interval_ms;
+			m_runThreadLoop = true;
+			m_drainThread.reset(new boost::thread(boost::bind(&libnifalcon::FalconBinaryLogBoostThread::runThreadLoop, this)));
+		}
+	}
+
+	void FalconBinaryLogBoostThread::runThreadLoop()
+	{
+		while(m_runThreadLoop)
+		{
+			FalconBinaryLog::drain(*m_out);
+			boost::this_thread::sleep(boost::posix_time::milliseconds(m_interval));
+		}
+		FalconBinaryLog::drain(*m_out);
+		m_out->flush();
+	}
+
+	void FalconBinaryLogBoostThread::stopThread()
+	{
+		m_runThreadLoop = false;
+		if(m_drainThread)
+		{
+			m_drainThread->join();
+			m_drainThread.reset();
+		}
+	}
+}
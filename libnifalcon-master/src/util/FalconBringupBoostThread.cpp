@@ -0,0 +1,172 @@
+/***
+ * @file FalconBringupBoostThread.cpp
+ * @brief Utility class for opening, loading and homing several falcons at once using boost::thread (http://www.boost.org)
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/util/FalconBringupBoostThread.h"
+#include "falcon/core/FalconClock.h"
+
+#include <boost/bind.hpp>
+namespace libnifalcon
+{
+
+	FalconBringupBoostThread::FalconBringupBoostThread() :
+		m_firmwareName("nvent"),
+		m_skipChecksum(false),
+		m_firmwareRetries(3),
+		m_waitForHoming(false),
+		m_homingTimeout(30.0),
+		m_startTime(0.0)
+	{
+	}
+
+	FalconBringupBoostThread::~FalconBringupBoostThread()
+	{
+		//Only safe for classes that don't override the callbacks, the rest have joined in wait() already
+		m_threads.join_all();
+	}
+
+	unsigned int FalconBringupBoostThread::addDevice(FalconDevice* device, unsigned int index)
+	{
+		boost::shared_ptr<DeviceEntry> entry(new DeviceEntry);
+		entry->device = device;
+		entry->index = index;
+		entry->report.state = STATE_PENDING;
+		entry->report.failedPhase = PHASE_OPEN;
+		entry->report.errorCode = 0;
+		for(unsigned int i = 0; i < PHASE_COUNT; ++i)
+		{
+			entry->report.phaseTimes[i] = 0.0;
+		}
+		entry->report.readyTime = 0.0;
+		entry->report.firmwareLoaded = false;
+		entry->state.store(STATE_PENDING, boost::memory_order_relaxed);
+		m_devices.push_back(entry);
+		return m_devices.size() - 1;
+	}
+
+	void FalconBringupBoostThread::setFirmware(const std::string& name, bool skip_checksum, unsigned int retries)
+	{
+		m_firmwareName = name;
+		m_skipChecksum = skip_checksum;
+		m_firmwareRetries = retries;
+	}
+
+	void FalconBringupBoostThread::setHoming(bool wait_for_homing, double timeout)
+	{
+		m_waitForHoming = wait_for_homing;
+		m_homingTimeout = timeout;
+	}
+
+	void FalconBringupBoostThread::start()
+	{
+		m_startTime = FalconClock::getTime();
+		for(unsigned int i = 0; i < m_devices.size(); ++i)
+		{
+			if(m_devices[i]->state.load(boost::memory_order_acquire) != STATE_PENDING)
+			{
+				continue;
+			}
+			m_devices[i]->state.store(STATE_RUNNING, boost::memory_order_release);
+			m_threads.create_thread(boost::bind(&FalconBringupBoostThread::runBringup, this, i));
+		}
+	}
+
+	bool FalconBringupBoostThread::wait()
+	{
+		m_threads.join_all();
+		bool ready = true;
+		for(unsigned int i = 0; i < m_devices.size(); ++i)
+		{
+			ready = ready && isReady(i);
+		}
+		return ready;
+	}
+
+	FalconBringupBoostThread::State FalconBringupBoostThread::getState(unsigned int device) const
+	{
+		return (State)m_devices[device]->state.load(boost::memory_order_acquire);
+	}
+
+	FalconBringupBoostThread::Report FalconBringupBoostThread::getReport(unsigned int device) const
+	{
+		State state = getState(device);
+		if(state == STATE_READY || state == STATE_FAILED)
+		{
+			return m_devices[device]->report;
+		}
+		//Still being written by the bring-up thread
+		Report report = Report();
+		report.state = state;
+		return report;
+	}
+
+	void FalconBringupBoostThread::runBringup(unsigned int device)
+	{
+		DeviceEntry& entry = *m_devices[device];
+		FalconDevice* falcon = entry.device;
+		Report& report = entry.report;
+		bool ok = true;
+
+		//Open, which purges the FTDI and puts it in normal mode
+		double phase_start = FalconClock::getTime();
+		report.failedPhase = PHASE_OPEN;
+		ok = falcon->open(entry.index);
+		report.phaseTimes[PHASE_OPEN] = FalconClock::getTime() - phase_start;
+
+		//Firmware, skipping the upload if it's already running (or the firmware cache says so)
+		if(ok)
+		{
+			phase_start = FalconClock::getTime();
+			report.failedPhase = PHASE_FIRMWARE;
+			if(!falcon->isFirmwareLoaded())
+			{
+				report.firmwareLoaded = true;
+				ok = falcon->loadRegisteredFirmware(m_firmwareName, m_skipChecksum, m_firmwareRetries) && falcon->isFirmwareLoaded();
+			}
+			report.phaseTimes[PHASE_FIRMWARE] = FalconClock::getTime() - phase_start;
+		}
+
+		if(ok && m_waitForHoming)
+		{
+			phase_start = FalconClock::getTime();
+			report.failedPhase = PHASE_HOMING;
+			boost::shared_ptr<FalconFirmware> firmware = falcon->getFalconFirmware();
+			firmware->setHomingMode(true);
+			firmware->setLEDStatus(FalconFirmware::RED_LED);
+			double end = phase_start + m_homingTimeout;
+			ok = false;
+			while(FalconClock::getTime() < end)
+			{
+				falcon->runIOLoop();
+				if(firmware->isHomed())
+				{
+					ok = true;
+					break;
+				}
+			}
+			firmware->setLEDStatus(ok ? FalconFirmware::GREEN_LED : FalconFirmware::RED_LED);
+			falcon->runIOLoop();
+			report.phaseTimes[PHASE_HOMING] = FalconClock::getTime() - phase_start;
+		}
+
+		report.readyTime = FalconClock::getTime() - m_startTime;
+		if(!ok)
+		{
+			report.errorCode = falcon->getErrorCode();
+			report.state = STATE_FAILED;
+			entry.state.store(STATE_FAILED, boost::memory_order_release);
+			deviceFailed(device);
+			return;
+		}
+		report.state = STATE_READY;
+		entry.state.store(STATE_READY, boost::memory_order_release);
+		deviceReady(device);
+	}
+}
@@ -15,8 +15,6 @@
 
 #include "falcon/util/FalconCLIBase.h"
 #include "falcon/firmware/FalconFirmwareNovintSDK.h"
-#include "falcon/util/FalconFirmwareBinaryTest.h"
-#include "falcon/util/FalconFirmwareBinaryNvent.h"
 
 
 #ifdef ENABLE_LOGGING
@@ -171,8 +169,6 @@ namespace libnifalcon
 		if(!firmware_loaded)
 		{
 			std::cout << "Loading firmware" << std::endl;
-			uint8_t* firmware_block;
-			long firmware_size;
 			//First, see if we're trying to load a custom firmware file
 			if(m_varMap.count("firmware"))
 			{
@@ -209,19 +205,11 @@ namespace libnifalcon
 			}
 			else
 			{
-				if(m_varMap.count("nvent_firmware"))
-				{
-					firmware_block = const_cast<uint8_t*>(NOVINT_FALCON_NVENT_FIRMWARE);
-					firmware_size = NOVINT_FALCON_NVENT_FIRMWARE_SIZE;
-				}
-				else if(m_varMap.count("test_firmware"))
-				{
-					firmware_block = const_cast<uint8_t*>(NOVINT_FALCON_TEST_FIRMWARE);
-					firmware_size = NOVINT_FALCON_TEST_FIRMWARE_SIZE;
-				}
+				//nVent unless asked otherwise
+				std::string firmware_name = m_varMap.count("test_firmware") ? "test" : "nvent";
 				for(int i = 0; i < 10; ++i)
 				{
-					if(!m_falconDevice->getFalconFirmware()->loadFirmware(m_varMap.count("skip_checksum") > 0, NOVINT_FALCON_NVENT_FIRMWARE_SIZE, const_cast<uint8_t*>(NOVINT_FALCON_NVENT_FIRMWARE)))
+					if(!m_falconDevice->loadRegisteredFirmware(firmware_name, m_varMap.count("skip_checksum") > 0))
 					{
 						LOG_ERROR("Firmware loading try failed");
 						//Completely close and reopen
@@ -0,0 +1,94 @@
+/***
+ * @file FalconFirmwareLoaderBoostThread.cpp
+ * @brief Utility class for loading firmware to several falcons at once using boost::thread (http://www.boost.org)
+ * @author Kyle Machulis (kyle@nonpolynomial.com)
+ * @copyright (c) 2007-2009 Nonpolynomial Labs/Kyle Machulis
+ * @license BSD License
+ *
+ * Project info at http://libnifalcon.nonpolynomial.com/
+ *
+ */
+
+#include "falcon/util/FalconFirmwareLoaderBoostThread.h"
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+namespace libnifalcon
+{
+	namespace
+	{
+		//vector<bool> packs bits, so threads can't write neighbouring results safely
+		void loadImage(FalconDevice* device, bool skip_checksum, unsigned int firmware_size, uint8_t* buffer, unsigned int retries, char* result)
+		{
+			*result = 0;
+			for(unsigned int i = 0; i < retries && !*result; ++i)
+			{
+				*result = device->loadFirmware(skip_checksum, firmware_size, buffer) ? 1 : 0;
+			}
+		}
+
+		void loadFile(FalconDevice* device, bool skip_checksum, unsigned int retries, char* result)
+		{
+			*result = device->loadFirmware(retries, skip_checksum) ? 1 : 0;
+		}
+
+		void loadRegistered(FalconDevice* device, const std::string& name, bool skip_checksum, unsigned int retries, char* result)
+		{
+			*result = device->loadRegisteredFirmware(name, skip_checksum, retries) ? 1 : 0;
+		}
+
+		bool collectResults(const std::vector<char>& loaded, std::vector<bool>* results)
+		{
+			bool all = true;
+			if(results != NULL)
+			{
+				results->assign(loaded.size(), false);
+			}
+			for(unsigned int i = 0; i < loaded.size(); ++i)
+			{
+				if(results != NULL)
+				{
+					(*results)[i] = (loaded[i] != 0);
+				}
+				all = all && loaded[i];
+			}
+			return all;
+		}
+	}
+
+	bool FalconFirmwareLoaderBoostThread::loadFirmware(const std::vector<FalconDevice*>& devices, bool skip_checksum, unsigned int firmware_size, uint8_t* buffer, unsigned int retries, std::vector<bool>* results)
+	{
+		std::vector<char> loaded(devices.size(), 0);
+		boost::thread_group threads;
+		for(unsigned int i = 0; i < devices.size(); ++i)
+		{
+			threads.create_thread(boost::bind(&loadImage, devices[i], skip_checksum, firmware_size, buffer, retries, &loaded[i]));
+		}
+		threads.join_all();
+		return collectResults(loaded, results);
+	}
+
+	bool FalconFirmwareLoaderBoostThread::loadFirmware(const std::vector<FalconDevice*>& devices, bool skip_checksum, unsigned int retries, std::vector<bool>* results)
+	{
+		std::vector<char> loaded(devices.size(), 0);
+		boost::thread_group threads;
+		for(unsigned int i = 0; i < devices.size(); ++i)
+		{
+			threads.create_thread(boost::bind(&loadFile, devices[i], skip_checksum, retries, &loaded[i]));
+		}
+		threads.join_all();
+		return collectResults(loaded, results);
+	}
+
+	bool FalconFirmwareLoaderBoostThread::loadRegisteredFirmware(const std::vector<FalconDevice*>& devices, const std::string& name, bool skip_checksum, unsigned int retries, std::vector<bool>* results)
+	{
+		std::vector<char> loaded(devices.size(), 0);
+		boost::thread_group threads;
+		for(unsigned int i = 0; i < devices.size(); ++i)
+		{
+			threads.create_thread(boost::bind(&loadRegistered, devices[i], name, skip_checksum, retries, &loaded[i]));
+		}
+		threads.join_all();
+		return collectResults(loaded, results);
+	}
+}